@@ -0,0 +1,505 @@
+/**
+ * @file lwir_bench.cpp
+ * @brief Kernel micro-benchmarks
+ *
+ * Times each encoder kernel across frame sizes and parameter sets using
+ * warm-up runs, repeated measurements and median reporting. Residual kernels
+ * are also timed in the variant selected for the size at fp_bits = 8
+ * ("<kernel>_fixed"), and the gain over the generic kernel is reported.
+ * Results can be written as JSON and compared against a saved baseline.
+ *
+ * Usage:
+ *   lwir_bench
+ *   lwir_bench --sizes 640x512 --reps 31 --json bench.json
+ *   lwir_bench --compare bench_baseline.json --tolerance 0.10
+ */
+
+#include "residual.hpp"
+#include "kernels.hpp"
+#include "bitdepth.hpp"
+#include "packed.hpp"
+#include "stats.hpp"
+#include "encoder.hpp"
+#include "synthetic.hpp"
+#include <yaml-cpp/yaml.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct BenchOptions {
+    std::vector<std::pair<uint32_t, uint32_t>> sizes;
+    uint32_t warmup = 3;
+    uint32_t reps = 15;
+    std::string filter;
+    std::string json_path;
+    std::string compare_path;
+    double tolerance = 0.10;
+};
+
+struct BenchResult {
+    std::string kernel;
+    std::string size;
+    std::string params;
+    double median_ms;
+    double min_ms;
+    double max_ms;
+    double mpix_per_s;
+
+    std::string key() const { return kernel + "|" + size + "|" + params; }
+};
+
+// Keeps results of kernels that return values from being optimized away
+volatile uint64_t g_sink = 0;
+
+void print_usage(const char* program_name)
+{
+    std::cout << "LWIR Kernel Benchmarks" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Usage:" << std::endl;
+    std::cout << "  " << program_name << " [options]" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --sizes <WxH,...>      Frame sizes (default: 640x512,1024x768)" << std::endl;
+    std::cout << "  --warmup <N>           Warm-up runs per kernel (default: 3)" << std::endl;
+    std::cout << "  --reps <N>             Timed runs per kernel (default: 15)" << std::endl;
+    std::cout << "  --filter <substring>   Only run kernels whose name contains substring" << std::endl;
+    std::cout << "  --json <path>          Write results as JSON" << std::endl;
+    std::cout << "  --compare <path>       Compare against a saved JSON baseline" << std::endl;
+    std::cout << "  --tolerance <frac>     Allowed slowdown vs baseline (default: 0.10)" << std::endl;
+    std::cout << "  --help                 Show this help message" << std::endl;
+    std::cout << std::endl;
+}
+
+bool parse_sizes(const std::string& text, std::vector<std::pair<uint32_t, uint32_t>>& sizes)
+{
+    std::istringstream iss(text);
+    std::string item;
+    while (std::getline(iss, item, ',')) {
+        const size_t x = item.find('x');
+        if (x == std::string::npos) {
+            return false;
+        }
+        const uint32_t w = static_cast<uint32_t>(std::stoul(item.substr(0, x)));
+        const uint32_t h = static_cast<uint32_t>(std::stoul(item.substr(x + 1)));
+        if (w == 0 || h == 0) {
+            return false;
+        }
+        sizes.emplace_back(w, h);
+    }
+    return !sizes.empty();
+}
+
+bool parse_command_line(int argc, char** argv, BenchOptions& opts)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const bool has_value = (i + 1 < argc);
+
+        if (arg == "--help" || arg == "-h") {
+            return false;
+        }
+        else if (arg == "--sizes" && has_value) {
+            if (!parse_sizes(argv[++i], opts.sizes)) {
+                std::cerr << "Error: --sizes expects WxH[,WxH...]" << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--warmup" && has_value) {
+            opts.warmup = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--reps" && has_value) {
+            opts.reps = std::max(1u, static_cast<uint32_t>(std::stoul(argv[++i])));
+        }
+        else if (arg == "--filter" && has_value) {
+            opts.filter = argv[++i];
+        }
+        else if (arg == "--json" && has_value) {
+            opts.json_path = argv[++i];
+        }
+        else if (arg == "--compare" && has_value) {
+            opts.compare_path = argv[++i];
+        }
+        else if (arg == "--tolerance" && has_value) {
+            opts.tolerance = std::stod(argv[++i]);
+        }
+        else {
+            std::cerr << "Error: Unknown or incomplete argument: " << arg << std::endl;
+            return false;
+        }
+    }
+
+    if (opts.sizes.empty()) {
+        opts.sizes = {{640, 512}, {1024, 768}};
+    }
+    return true;
+}
+
+/**
+ * Time fn() with warm-up and repetitions; returns per-run milliseconds
+ */
+template<typename Fn>
+std::vector<double> time_runs(Fn&& fn, uint32_t warmup, uint32_t reps)
+{
+    for (uint32_t i = 0; i < warmup; ++i) {
+        fn();
+    }
+
+    std::vector<double> samples;
+    samples.reserve(reps);
+    for (uint32_t i = 0; i < reps; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        fn();
+        const auto end = std::chrono::steady_clock::now();
+        samples.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    return samples;
+}
+
+class BenchRunner {
+public:
+    explicit BenchRunner(const BenchOptions& opts) : opts_(opts) {}
+
+    template<typename Fn>
+    void run(const std::string& kernel, uint32_t width, uint32_t height,
+             const std::string& params, Fn&& fn)
+    {
+        if (!opts_.filter.empty() && kernel.find(opts_.filter) == std::string::npos) {
+            return;
+        }
+
+        std::vector<double> samples = time_runs(fn, opts_.warmup, opts_.reps);
+        std::sort(samples.begin(), samples.end());
+
+        BenchResult r;
+        r.kernel = kernel;
+        r.size = std::to_string(width) + "x" + std::to_string(height);
+        r.params = params;
+        r.median_ms = samples[samples.size() / 2];
+        r.min_ms = samples.front();
+        r.max_ms = samples.back();
+        r.mpix_per_s = (r.median_ms > 0.0)
+            ? (static_cast<double>(width) * height / 1e6) / (r.median_ms / 1000.0)
+            : 0.0;
+        results_.push_back(r);
+
+        std::cout << std::left << std::setw(28) << r.kernel
+                  << std::setw(11) << r.size
+                  << std::setw(16) << r.params
+                  << std::right << std::fixed
+                  << std::setw(10) << std::setprecision(3) << r.median_ms << " ms"
+                  << std::setw(10) << std::setprecision(3) << r.min_ms << " min"
+                  << std::setw(10) << std::setprecision(1) << r.mpix_per_s << " Mpix/s"
+                  << std::endl;
+    }
+
+    const std::vector<BenchResult>& results() const { return results_; }
+
+private:
+    const BenchOptions& opts_;
+    std::vector<BenchResult> results_;
+};
+
+void run_size(BenchRunner& runner, uint32_t width, uint32_t height)
+{
+    const size_t n = static_cast<size_t>(width) * height;
+
+    // Two consecutive frames of a deterministic synthetic flight
+    lwir::SyntheticConfig synth;
+    synth.width = width;
+    synth.height = height;
+    synth.frame_count = 2;
+    const lwir::SyntheticSequence sequence(synth);
+
+    lwir::Frame frame0, frame1;
+    sequence.generate(0, frame0);
+    sequence.generate(1, frame1);
+    const std::vector<uint16_t>& previous = frame0.data;
+    const std::vector<uint16_t>& current = frame1.data;
+
+    std::vector<int16_t> residual(n), quantized(n), dequantized(n);
+    std::vector<uint16_t> mapped(n), unmapped(n), decoded;
+    lwir::compute_residual(current.data(), previous.data(), residual.data(), n);
+
+    const lwir::RangeMap range_map = lwir::compute_range_map(current.data(), n);
+
+    // Variant the encoder selects for this size at the default fp_bits
+    const lwir::ResidualKernels& fixed = lwir::select_residual_kernels(width, height, 8);
+    std::vector<uint16_t> reconstructed(n);
+
+    runner.run("compute_residual", width, height, "-", [&]() {
+        lwir::compute_residual(current.data(), previous.data(), residual.data(), n);
+    });
+
+    runner.run("compute_residual_fixed", width, height, "-", [&]() {
+        fixed.compute_residual(current.data(), previous.data(), residual.data(), n);
+    });
+
+    runner.run("reconstruct_frame", width, height, "-", [&]() {
+        lwir::reconstruct_frame(residual.data(), previous.data(), reconstructed.data(), n);
+    });
+
+    runner.run("reconstruct_frame_fixed", width, height, "-", [&]() {
+        fixed.reconstruct_frame(residual.data(), previous.data(), reconstructed.data(), n);
+    });
+
+    runner.run("compute_range_map", width, height, "-", [&]() {
+        g_sink += lwir::compute_range_map(current.data(), n).range;
+    });
+
+    // Packed sensor input (ingest should keep up with memory bandwidth)
+    for (lwir::PackedFormat format : {lwir::PackedFormat::RAW12, lwir::PackedFormat::RAW14}) {
+        const size_t packed_bytes = lwir::packed_frame_bytes(format, width, height);
+        if (packed_bytes == 0) {
+            continue;
+        }
+        std::vector<uint8_t> packed(packed_bytes);
+        lwir::pack_pixels(format, current.data(), packed.data(), n);
+        runner.run(format == lwir::PackedFormat::RAW12 ? "unpack_raw12" : "unpack_raw14", width, height, "-", [&]() {
+            lwir::unpack_pixels(format, packed.data(), unmapped.data(), n);
+        });
+    }
+
+    runner.run("map_to_12bit", width, height, "-", [&]() {
+        lwir::map_to_12bit(current.data(), mapped.data(), n, range_map);
+    });
+
+    runner.run("map_from_12bit", width, height, "-", [&]() {
+        lwir::map_from_12bit(mapped.data(), unmapped.data(), n, range_map);
+    });
+
+    runner.run("compute_error_stats", width, height, "-", [&]() {
+        g_sink += static_cast<uint64_t>(lwir::compute_error_stats(current.data(), previous.data(), n).rmse);
+    });
+
+    const std::pair<uint32_t, double> quant_sets[] = {{2, 2.0}, {4, 3.0}};
+    for (const auto& qs : quant_sets) {
+        const lwir::QuantizationParams qp(qs.first, qs.second, 8);
+        std::ostringstream label;
+        label << "T=" << qs.first << ",Q=" << std::fixed << std::setprecision(1) << qs.second;
+
+        runner.run("quantize_residual", width, height, label.str(), [&]() {
+            lwir::quantize_residual(residual.data(), quantized.data(), n, qp);
+        });
+
+        runner.run("quantize_residual_fixed", width, height, label.str(), [&]() {
+            fixed.quantize_residual(residual.data(), quantized.data(), n, qp);
+        });
+
+        runner.run("dequantize_residual", width, height, label.str(), [&]() {
+            lwir::dequantize_residual(quantized.data(), dequantized.data(), n, qp);
+        });
+
+        runner.run("dequantize_residual_fixed", width, height, label.str(), [&]() {
+            fixed.dequantize_residual(quantized.data(), dequantized.data(), n, qp);
+        });
+
+        runner.run("compute_residual_stats", width, height, label.str(), [&]() {
+            g_sink += static_cast<uint64_t>(
+                lwir::compute_residual_stats(residual.data(), n, qp.dead_zone_T, quantized.data()).p99);
+        });
+    }
+
+    // JPEG-LS planes: range-mapped keyframe and biased quantized residual
+    lwir::map_to_12bit(current.data(), mapped.data(), n, range_map);
+    lwir::quantize_residual(residual.data(), quantized.data(), n, lwir::QuantizationParams(2, 2.0, 8));
+    std::vector<uint16_t> residual_plane(n);
+    for (size_t i = 0; i < n; ++i) {
+        residual_plane[i] = static_cast<uint16_t>(quantized[i] + 32768);
+    }
+
+    lwir::CharlsEncoder codec;
+    const uint32_t near_sets[] = {0, 10};
+    for (uint32_t near : near_sets) {
+        const std::string label = "NEAR=" + std::to_string(near);
+        std::vector<uint8_t> encoded;
+        uint32_t w = 0, h = 0;
+
+        runner.run("charls_encode_keyframe", width, height, label, [&]() {
+            codec.encode(mapped.data(), width, height, near, encoded, 12);
+        });
+        runner.run("charls_decode_keyframe", width, height, label, [&]() {
+            codec.decode(encoded.data(), encoded.size(), decoded, w, h);
+        });
+
+        runner.run("charls_encode_residual", width, height, label, [&]() {
+            codec.encode(residual_plane.data(), width, height, near, encoded);
+        });
+        runner.run("charls_decode_residual", width, height, label, [&]() {
+            codec.decode(encoded.data(), encoded.size(), decoded, w, h);
+        });
+    }
+}
+
+/**
+ * Speedup of each "<kernel>_fixed" result over the generic kernel
+ */
+void report_specialization_gain(const std::vector<BenchResult>& results)
+{
+    const std::string suffix = "_fixed";
+    std::map<std::string, double> generic;
+    for (const BenchResult& r : results) {
+        generic[r.key()] = r.median_ms;
+    }
+
+    bool header = false;
+    for (const BenchResult& r : results) {
+        if (r.kernel.size() <= suffix.size() ||
+            r.kernel.compare(r.kernel.size() - suffix.size(), suffix.size(), suffix) != 0)
+        {
+            continue;
+        }
+        const std::string base = r.kernel.substr(0, r.kernel.size() - suffix.size());
+        const auto it = generic.find(base + "|" + r.size + "|" + r.params);
+        if (it == generic.end() || r.median_ms <= 0.0) {
+            continue;
+        }
+
+        if (!header) {
+            std::cout << std::endl;
+            std::cout << "=== Specialized kernels (fp_bits = 8) vs generic ===" << std::endl;
+            header = true;
+        }
+        uint32_t width = 0, height = 0;
+        std::sscanf(r.size.c_str(), "%ux%u", &width, &height);
+        std::cout << std::left << std::setw(28) << base
+                  << std::setw(11) << r.size
+                  << std::setw(16) << r.params
+                  << std::setw(14) << lwir::select_residual_kernels(width, height, 8).name
+                  << std::right << std::fixed
+                  << std::setw(10) << std::setprecision(3) << it->second << " ->"
+                  << std::setw(10) << std::setprecision(3) << r.median_ms << " ms"
+                  << std::setw(8) << std::setprecision(2) << (it->second / r.median_ms) << "x"
+                  << std::endl;
+    }
+}
+
+bool write_json(const std::string& path, const BenchOptions& opts, const std::vector<BenchResult>& results)
+{
+    std::ofstream ofs(path);
+    if (!ofs) {
+        std::cerr << "Failed to write benchmark results to " << path << std::endl;
+        return false;
+    }
+
+    ofs << std::fixed << std::setprecision(4);
+    ofs << "{\n";
+    ofs << "  \"warmup\": " << opts.warmup << ",\n";
+    ofs << "  \"reps\": " << opts.reps << ",\n";
+    ofs << "  \"results\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        ofs << (i ? "," : "") << "\n    {"
+            << "\"kernel\": \"" << r.kernel << "\", "
+            << "\"size\": \"" << r.size << "\", "
+            << "\"params\": \"" << r.params << "\", "
+            << "\"median_ms\": " << r.median_ms << ", "
+            << "\"min_ms\": " << r.min_ms << ", "
+            << "\"max_ms\": " << r.max_ms << ", "
+            << "\"mpix_per_s\": " << r.mpix_per_s << "}";
+    }
+    ofs << "\n  ]\n";
+    ofs << "}\n";
+
+    std::cout << "Results written to " << path << std::endl;
+    return true;
+}
+
+/**
+ * Compare medians against a baseline JSON (parsed with yaml-cpp)
+ * @return Number of regressions beyond tolerance, or -1 on error
+ */
+int compare_to_baseline(const std::string& path, double tolerance, const std::vector<BenchResult>& results)
+{
+    std::map<std::string, double> baseline;
+    try {
+        const YAML::Node root = YAML::LoadFile(path);
+        for (const YAML::Node& entry : root["results"]) {
+            const std::string key = entry["kernel"].as<std::string>() + "|" +
+                                    entry["size"].as<std::string>() + "|" +
+                                    entry["params"].as<std::string>();
+            baseline[key] = entry["median_ms"].as<double>();
+        }
+    }
+    catch (const YAML::Exception& e) {
+        std::cerr << "Failed to read baseline " << path << ": " << e.what() << std::endl;
+        return -1;
+    }
+
+    std::cout << std::endl;
+    std::cout << "=== Comparison vs " << path << " (tolerance "
+              << std::fixed << std::setprecision(0) << (tolerance * 100.0) << "%) ===" << std::endl;
+
+    int regressions = 0;
+    for (const BenchResult& r : results) {
+        const auto it = baseline.find(r.key());
+        if (it == baseline.end() || it->second <= 0.0) {
+            continue;
+        }
+
+        const double speedup = it->second / r.median_ms;
+        const bool regressed = r.median_ms > it->second * (1.0 + tolerance);
+        if (regressed) {
+            regressions++;
+        }
+
+        std::cout << std::left << std::setw(28) << r.kernel
+                  << std::setw(11) << r.size
+                  << std::setw(16) << r.params
+                  << std::right << std::fixed
+                  << std::setw(10) << std::setprecision(3) << it->second << " ->"
+                  << std::setw(10) << std::setprecision(3) << r.median_ms << " ms"
+                  << std::setw(8) << std::setprecision(2) << speedup << "x"
+                  << (regressed ? "  REGRESSION" : "")
+                  << std::endl;
+    }
+
+    std::cout << regressions << " regression(s)" << std::endl;
+    return regressions;
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+    BenchOptions opts;
+    if (!parse_command_line(argc, argv, opts)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    std::cout << "=== LWIR Kernel Benchmarks ===" << std::endl;
+    std::cout << "Warm-up: " << opts.warmup << ", repetitions: " << opts.reps
+              << " (median reported)" << std::endl;
+    std::cout << std::endl;
+
+    BenchRunner runner(opts);
+    for (const auto& size : opts.sizes) {
+        run_size(runner, size.first, size.second);
+    }
+
+    report_specialization_gain(runner.results());
+
+    if (!opts.json_path.empty() && !write_json(opts.json_path, opts, runner.results())) {
+        return 1;
+    }
+
+    if (!opts.compare_path.empty()) {
+        const int regressions = compare_to_baseline(opts.compare_path, opts.tolerance, runner.results());
+        if (regressions != 0) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
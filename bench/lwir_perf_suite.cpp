@@ -0,0 +1,726 @@
+/**
+ * @file lwir_perf_suite.cpp
+ * @brief End-to-end throughput regression suite
+ *
+ * Runs the full CompressionPipeline over a corpus (synthetic or a local PNG
+ * directory) for every combination of GOP, NEAR, Q, T, 12-bit mode and
+ * thread count, and records fps, MB/s, compression ratio, RMSE and peak RSS.
+ * Results can be written as JSON and compared against a committed baseline;
+ * the exit code is non-zero when any case regresses beyond tolerance.
+ *
+ * The corpus is decoded into memory once, so the measurement covers
+ * decide + encode + write, not PNG decoding. Each case runs in a forked
+ * child so peak RSS is per case (it includes the shared corpus). The
+ * thread count is the number of independent pipelines run concurrently
+ * over the corpus (one per camera stream); fps is aggregate over all of
+ * them.
+ *
+ * Usage:
+ *   lwir_perf_suite --synthetic 300 --size 640x512
+ *   lwir_perf_suite --input frames/ --gop 30,60 --near 0,10 --threads 1,4
+ *   lwir_perf_suite --json perf.json --compare perf_baseline.json
+ */
+
+#include "pipeline.hpp"
+#include "frame_source.hpp"
+#include "synthetic.hpp"
+#include <yaml-cpp/yaml.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+struct SuiteOptions {
+    // Corpus
+    std::string input_dir;              // Empty = synthetic
+    uint32_t frames = 300;
+    uint32_t width = 640;
+    uint32_t height = 512;
+    uint64_t seed = 1;
+
+    // Matrix
+    std::vector<uint32_t> gop = {60};
+    std::vector<uint32_t> near = {10};
+    std::vector<double> quant_Q = {2.0};
+    std::vector<uint32_t> dead_zone_T = {2};
+    std::vector<uint32_t> map12 = {1};
+    std::vector<uint32_t> threads = {1};
+
+    uint32_t reps = 3;
+    std::string work_dir = "/tmp/lwir_perf_suite";
+    std::string json_path;
+    bool quality_only = false;          // JSON: RMSE and max error only (no speed, memory or ratio)
+    std::string compare_path;
+    double tolerance = 0.10;            // fps / MB/s / RSS
+    double quality_tolerance = 0.01;    // ratio / RMSE (deterministic)
+};
+
+struct SuiteCase {
+    uint32_t gop;
+    uint32_t near;
+    double quant_Q;
+    uint32_t dead_zone_T;
+    bool map12;
+    uint32_t threads;
+
+    std::string name() const
+    {
+        std::ostringstream oss;
+        oss << "gop" << gop << "_near" << near << "_q" << quant_Q << "_t" << dead_zone_T
+            << "_12bit" << (map12 ? 1 : 0) << "_thr" << threads;
+        return oss.str();
+    }
+};
+
+struct SuiteResult {
+    SuiteCase test_case;
+    bool ok;
+    uint32_t frames;
+    double fps;
+    double mb_per_s;
+    double compression_ratio;
+    double rmse;
+    double max_error;
+    double peak_rss_mb;
+};
+
+// What a child reports back to the parent through a pipe
+struct ChildReport {
+    uint32_t ok;
+    uint32_t frames;
+    double elapsed_s;
+    uint64_t original_bytes;
+    uint64_t compressed_bytes;
+    double rmse;
+    double max_error;
+};
+
+void print_usage(const char* program_name)
+{
+    std::cout << "LWIR End-to-End Performance Suite" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Usage:" << std::endl;
+    std::cout << "  " << program_name << " [options]" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Corpus:" << std::endl;
+    std::cout << "  --input <dir>          PNG directory (default: synthetic)" << std::endl;
+    std::cout << "  --frames <N>           Frames to use (default: 300)" << std::endl;
+    std::cout << "  --size <WxH>           Synthetic frame size (default: 640x512)" << std::endl;
+    std::cout << "  --seed <N>             Synthetic seed (default: 1)" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Matrix (comma-separated lists):" << std::endl;
+    std::cout << "  --gop <N,...>          GOP periods (default: 60)" << std::endl;
+    std::cout << "  --near <N,...>         Residual NEAR values (default: 10)" << std::endl;
+    std::cout << "  --q <Q,...>            Quantization steps (default: 2.0)" << std::endl;
+    std::cout << "  --t <T,...>            Dead-zone thresholds (default: 2)" << std::endl;
+    std::cout << "  --12bit <0|1,...>      12-bit range mapping (default: 1)" << std::endl;
+    std::cout << "  --threads <N,...>      Concurrent pipelines (default: 1)" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Run:" << std::endl;
+    std::cout << "  --reps <N>             Runs per case, median fps reported (default: 3)" << std::endl;
+    std::cout << "  --work-dir <dir>       Scratch output directory (default: /tmp/lwir_perf_suite)" << std::endl;
+    std::cout << "  --json <path>          Write results as JSON" << std::endl;
+    std::cout << "  --quality-only         With --json: keep only RMSE and max error (a portable baseline)" << std::endl;
+    std::cout << "  --compare <path>       Compare against a baseline JSON" << std::endl;
+    std::cout << "  --tolerance <frac>     Allowed fps/RSS regression (default: 0.10)" << std::endl;
+    std::cout << "  --quality-tolerance <frac>  Allowed ratio/RMSE regression (default: 0.01)" << std::endl;
+    std::cout << "  --help                 Show this help message" << std::endl;
+    std::cout << std::endl;
+}
+
+template<typename T>
+bool parse_list(const std::string& text, std::vector<T>& values)
+{
+    values.clear();
+    std::istringstream iss(text);
+    std::string item;
+    while (std::getline(iss, item, ',')) {
+        std::istringstream item_stream(item);
+        T value;
+        if (!(item_stream >> value)) {
+            return false;
+        }
+        values.push_back(value);
+    }
+    return !values.empty();
+}
+
+bool parse_command_line(int argc, char** argv, SuiteOptions& opts)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const bool has_value = (i + 1 < argc);
+        bool list_ok = true;
+
+        if (arg == "--help" || arg == "-h") {
+            return false;
+        }
+        else if (arg == "--input" && has_value) {
+            opts.input_dir = argv[++i];
+        }
+        else if ((arg == "--frames" || arg == "--synthetic") && has_value) {
+            opts.frames = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--size" && has_value) {
+            const std::string size = argv[++i];
+            const size_t x = size.find('x');
+            if (x == std::string::npos) {
+                std::cerr << "Error: --size expects WxH" << std::endl;
+                return false;
+            }
+            opts.width = static_cast<uint32_t>(std::stoul(size.substr(0, x)));
+            opts.height = static_cast<uint32_t>(std::stoul(size.substr(x + 1)));
+        }
+        else if (arg == "--seed" && has_value) {
+            opts.seed = std::stoull(argv[++i]);
+        }
+        else if (arg == "--gop" && has_value) {
+            list_ok = parse_list(argv[++i], opts.gop);
+        }
+        else if (arg == "--near" && has_value) {
+            list_ok = parse_list(argv[++i], opts.near);
+        }
+        else if (arg == "--q" && has_value) {
+            list_ok = parse_list(argv[++i], opts.quant_Q);
+        }
+        else if (arg == "--t" && has_value) {
+            list_ok = parse_list(argv[++i], opts.dead_zone_T);
+        }
+        else if (arg == "--12bit" && has_value) {
+            list_ok = parse_list(argv[++i], opts.map12);
+        }
+        else if (arg == "--threads" && has_value) {
+            list_ok = parse_list(argv[++i], opts.threads);
+        }
+        else if (arg == "--reps" && has_value) {
+            opts.reps = std::max(1u, static_cast<uint32_t>(std::stoul(argv[++i])));
+        }
+        else if (arg == "--work-dir" && has_value) {
+            opts.work_dir = argv[++i];
+        }
+        else if (arg == "--json" && has_value) {
+            opts.json_path = argv[++i];
+        }
+        else if (arg == "--quality-only") {
+            opts.quality_only = true;
+        }
+        else if (arg == "--compare" && has_value) {
+            opts.compare_path = argv[++i];
+        }
+        else if (arg == "--tolerance" && has_value) {
+            opts.tolerance = std::stod(argv[++i]);
+        }
+        else if (arg == "--quality-tolerance" && has_value) {
+            opts.quality_tolerance = std::stod(argv[++i]);
+        }
+        else {
+            std::cerr << "Error: Unknown or incomplete argument: " << arg << std::endl;
+            return false;
+        }
+
+        if (!list_ok) {
+            std::cerr << "Error: " << arg << " expects a comma-separated list" << std::endl;
+            return false;
+        }
+    }
+
+    if (opts.frames == 0 || opts.width == 0 || opts.height == 0) {
+        std::cerr << "Error: frame count and size must be non-zero" << std::endl;
+        return false;
+    }
+    for (uint32_t t : opts.threads) {
+        if (t == 0) {
+            std::cerr << "Error: --threads values must be >= 1" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool make_directory(const std::string& path)
+{
+    struct stat st;
+    if (stat(path.c_str(), &st) == 0) {
+        return true;
+    }
+    if (mkdir(path.c_str(), 0755) != 0) {
+        std::cerr << "Failed to create directory: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Decode the corpus into memory once, shared (copy-on-write) by all cases
+ */
+bool load_corpus(const SuiteOptions& opts, std::vector<lwir::Frame>& corpus, std::string& description)
+{
+    if (opts.input_dir.empty()) {
+        lwir::SyntheticConfig synth;
+        synth.width = opts.width;
+        synth.height = opts.height;
+        synth.frame_count = opts.frames;
+        synth.seed = opts.seed;
+
+        lwir::SyntheticFrameSource source(synth);
+        description = source.description();
+        corpus.resize(source.frame_count());
+        for (size_t i = 0; i < corpus.size(); ++i) {
+            source.read_frame(i, corpus[i]);
+        }
+        return true;
+    }
+
+    lwir::PngDirectorySource source;
+    if (!source.open(opts.input_dir)) {
+        return false;
+    }
+    description = source.description();
+
+    const size_t count = std::min<size_t>(opts.frames, source.frame_count());
+    corpus.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        if (!source.read_frame(i, corpus[i])) {
+            std::cerr << "Failed to load corpus frame " << i << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<SuiteCase> build_matrix(const SuiteOptions& opts)
+{
+    std::vector<SuiteCase> cases;
+    for (uint32_t gop : opts.gop)
+    for (uint32_t near : opts.near)
+    for (double q : opts.quant_Q)
+    for (uint32_t t : opts.dead_zone_T)
+    for (uint32_t map12 : opts.map12)
+    for (uint32_t threads : opts.threads) {
+        SuiteCase c;
+        c.gop = gop;
+        c.near = near;
+        c.quant_Q = q;
+        c.dead_zone_T = t;
+        c.map12 = (map12 != 0);
+        c.threads = threads;
+        cases.push_back(c);
+    }
+    return cases;
+}
+
+/**
+ * Child side: run `threads` pipelines concurrently over the corpus
+ */
+ChildReport run_case_child(const SuiteCase& c, const std::vector<lwir::Frame>& corpus,
+                           const std::string& case_dir)
+{
+    ChildReport report = {};
+
+    std::vector<lwir::CompressionConfig> configs(c.threads);
+    for (uint32_t t = 0; t < c.threads; ++t) {
+        lwir::CompressionConfig& config = configs[t];
+        config.input_dir = "memory";
+        config.output_dir = case_dir + "/stream" + std::to_string(t);
+        config.gop_period = c.gop;
+        config.residual_near = c.near;
+        config.quant_Q = c.quant_Q;
+        config.dead_zone_T = c.dead_zone_T;
+        config.enable_12bit_mode = c.map12;
+        config.frame_deadline_ms = 0.0;
+        config.compute_error_stats = true;
+        config.verbose = false;
+    }
+
+    std::vector<lwir::SessionStats> sessions(c.threads);
+    std::vector<int> success(c.threads, 0);
+
+    const auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> workers;
+    for (uint32_t t = 0; t < c.threads; ++t) {
+        workers.emplace_back([&, t]() {
+            lwir::MemoryFrameSource source(corpus);
+            lwir::CompressionPipeline pipeline(configs[t]);
+            success[t] = pipeline.run(source) ? 1 : 0;
+            sessions[t] = pipeline.session_stats();
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    const auto end = std::chrono::steady_clock::now();
+    report.elapsed_s = std::chrono::duration<double>(end - start).count();
+
+    report.ok = 1;
+    double rmse_sum = 0.0;
+    for (uint32_t t = 0; t < c.threads; ++t) {
+        report.ok &= success[t];
+        report.frames += sessions[t].total_frames;
+        report.original_bytes += sessions[t].total_original_bytes;
+        report.compressed_bytes += sessions[t].total_compressed_bytes;
+        rmse_sum += sessions[t].avg_rmse;
+        report.max_error = std::max(report.max_error, sessions[t].avg_max_error);
+    }
+    report.rmse = rmse_sum / c.threads;
+    return report;
+}
+
+/**
+ * Run one case in a forked child; peak RSS comes from the child's rusage
+ */
+bool run_case_once(const SuiteCase& c, const std::vector<lwir::Frame>& corpus,
+                   const std::string& case_dir, ChildReport& report, double& peak_rss_mb)
+{
+    int fds[2];
+    if (pipe(fds) != 0) {
+        std::cerr << "pipe() failed" << std::endl;
+        return false;
+    }
+
+    std::cout.flush();
+    const pid_t pid = fork();
+    if (pid < 0) {
+        std::cerr << "fork() failed" << std::endl;
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+
+    if (pid == 0) {
+        close(fds[0]);
+        // Pipeline summaries would swamp the suite table
+        if (!freopen("/dev/null", "w", stdout)) {
+            _exit(2);
+        }
+        const ChildReport child = run_case_child(c, corpus, case_dir);
+        const ssize_t written = write(fds[1], &child, sizeof(child));
+        close(fds[1]);
+        _exit(written == static_cast<ssize_t>(sizeof(child)) ? 0 : 2);
+    }
+
+    close(fds[1]);
+    const ssize_t got = read(fds[0], &report, sizeof(report));
+    close(fds[0]);
+
+    int status = 0;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) < 0) {
+        std::cerr << "wait4() failed" << std::endl;
+        return false;
+    }
+
+    // ru_maxrss is in kilobytes on Linux
+    peak_rss_mb = usage.ru_maxrss / 1024.0;
+
+    return got == static_cast<ssize_t>(sizeof(report)) &&
+           WIFEXITED(status) && WEXITSTATUS(status) == 0 && report.ok;
+}
+
+SuiteResult run_case(const SuiteOptions& opts, const SuiteCase& c, const std::vector<lwir::Frame>& corpus)
+{
+    SuiteResult result = {};
+    result.test_case = c;
+    result.ok = false;
+
+    const std::string case_dir = opts.work_dir + "/" + c.name();
+    if (!make_directory(case_dir)) {
+        return result;
+    }
+
+    std::vector<double> fps;
+    ChildReport report = {};
+    for (uint32_t rep = 0; rep < opts.reps; ++rep) {
+        double rss_mb = 0.0;
+        if (!run_case_once(c, corpus, case_dir, report, rss_mb) || report.elapsed_s <= 0.0) {
+            std::cerr << "Case " << c.name() << " failed" << std::endl;
+            return result;
+        }
+        fps.push_back(report.frames / report.elapsed_s);
+        result.peak_rss_mb = std::max(result.peak_rss_mb, rss_mb);
+    }
+
+    std::sort(fps.begin(), fps.end());
+    result.ok = true;
+    result.frames = report.frames;
+    result.fps = fps[fps.size() / 2];
+    // Every run processes identical data, so MB/s follows the median fps
+    result.mb_per_s = result.fps * (static_cast<double>(report.original_bytes) / report.frames) / 1e6;
+    result.compression_ratio = report.compressed_bytes > 0
+        ? static_cast<double>(report.original_bytes) / report.compressed_bytes : 0.0;
+    result.rmse = report.rmse;
+    result.max_error = report.max_error;
+    return result;
+}
+
+void print_header()
+{
+    std::cout << std::left << std::setw(40) << "case"
+              << std::right
+              << std::setw(10) << "fps"
+              << std::setw(10) << "MB/s"
+              << std::setw(9) << "ratio"
+              << std::setw(9) << "rmse"
+              << std::setw(9) << "maxerr"
+              << std::setw(10) << "rss MB"
+              << std::endl;
+}
+
+void print_result(const SuiteResult& r)
+{
+    std::cout << std::left << std::setw(40) << r.test_case.name() << std::right << std::fixed;
+    if (!r.ok) {
+        std::cout << "  FAILED" << std::endl;
+        return;
+    }
+    std::cout << std::setw(10) << std::setprecision(1) << r.fps
+              << std::setw(10) << std::setprecision(1) << r.mb_per_s
+              << std::setw(9) << std::setprecision(2) << r.compression_ratio
+              << std::setw(9) << std::setprecision(3) << r.rmse
+              << std::setw(9) << std::setprecision(1) << r.max_error
+              << std::setw(10) << std::setprecision(1) << r.peak_rss_mb
+              << std::endl;
+}
+
+bool write_json(const std::string& path, const SuiteOptions& opts, const std::string& corpus,
+                const std::vector<SuiteResult>& results)
+{
+    std::ofstream ofs(path);
+    if (!ofs) {
+        std::cerr << "Failed to write suite results to " << path << std::endl;
+        return false;
+    }
+
+    ofs << std::fixed << std::setprecision(4);
+    ofs << "{\n";
+    ofs << "  \"corpus\": \"" << corpus << "\",\n";
+    if (opts.quality_only) {
+        ofs << "  \"quality_only\": true,\n";
+    }
+    else {
+        ofs << "  \"codec\": \"" << lwir::jpegls_codec_version() << "\",\n";
+    }
+    ofs << "  \"reps\": " << opts.reps << ",\n";
+    ofs << "  \"results\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const SuiteResult& r = results[i];
+        const SuiteCase& c = r.test_case;
+        ofs << (i ? "," : "") << "\n    {"
+            << "\"name\": \"" << c.name() << "\", "
+            << "\"gop\": " << c.gop << ", "
+            << "\"near\": " << c.near << ", "
+            << "\"quant_Q\": " << c.quant_Q << ", "
+            << "\"dead_zone_T\": " << c.dead_zone_T << ", "
+            << "\"enable_12bit_mode\": " << (c.map12 ? "true" : "false") << ", "
+            << "\"threads\": " << c.threads << ", "
+            << "\"ok\": " << (r.ok ? "true" : "false") << ", "
+            << "\"frames\": " << r.frames << ", ";
+        if (!opts.quality_only) {
+            ofs << "\"fps\": " << r.fps << ", "
+                << "\"mb_per_s\": " << r.mb_per_s << ", "
+                << "\"compression_ratio\": " << r.compression_ratio << ", ";
+        }
+        ofs << "\"rmse\": " << r.rmse << ", "
+            << "\"max_error\": " << r.max_error;
+        if (!opts.quality_only) {
+            ofs << ", \"peak_rss_mb\": " << r.peak_rss_mb;
+        }
+        ofs << "}";
+    }
+    ofs << "\n  ]\n";
+    ofs << "}\n";
+
+    std::cout << "Results written to " << path << std::endl;
+    return true;
+}
+
+/**
+ * Compare against a baseline JSON (parsed with yaml-cpp)
+ *
+ * A full baseline must carry fps and peak RSS for every case; it is only
+ * meaningful for the same corpus and CharLS build, so a mismatch is an
+ * error rather than a pass. A quality-only baseline (--quality-only) holds
+ * just RMSE and max error, which do not depend on the machine or, for
+ * NEAR=0 cases, on the CharLS build.
+ * @return Number of regressions beyond tolerance, or -1 on error
+ */
+int compare_to_baseline(const SuiteOptions& opts, const std::string& corpus,
+                        const std::vector<SuiteResult>& results)
+{
+    std::map<std::string, YAML::Node> baseline;
+    std::string base_corpus;
+    std::string base_codec;
+    bool quality_only = false;
+    try {
+        const YAML::Node root = YAML::LoadFile(opts.compare_path);
+        base_corpus = root["corpus"].as<std::string>("");
+        base_codec = root["codec"].as<std::string>("");
+        quality_only = root["quality_only"].as<bool>(false);
+        for (const YAML::Node& entry : root["results"]) {
+            baseline[entry["name"].as<std::string>()] = entry;
+        }
+    }
+    catch (const YAML::Exception& e) {
+        std::cerr << "Failed to read baseline " << opts.compare_path << ": " << e.what() << std::endl;
+        return -1;
+    }
+
+    if (base_corpus != corpus) {
+        std::cerr << "Baseline corpus \"" << base_corpus << "\" differs from \"" << corpus << "\"" << std::endl;
+        return -1;
+    }
+    const std::string codec = lwir::jpegls_codec_version();
+    if (!quality_only && base_codec != codec) {
+        std::cerr << "Baseline was recorded with " << base_codec << ", this build uses " << codec
+                  << "; re-record it with --json" << std::endl;
+        return -1;
+    }
+
+    std::cout << std::endl;
+    std::cout << "=== Comparison vs " << opts.compare_path << " (tolerance "
+              << std::fixed << std::setprecision(0) << (opts.tolerance * 100.0) << "% perf, "
+              << std::setprecision(1) << (opts.quality_tolerance * 100.0) << "% quality) ===" << std::endl;
+
+    int regressions = 0;
+    size_t compared = 0;
+    for (const SuiteResult& r : results) {
+        const auto it = baseline.find(r.test_case.name());
+        if (it == baseline.end()) {
+            continue;
+        }
+        const YAML::Node& base = it->second;
+        compared++;
+
+        std::vector<std::string> failed;
+        if (!r.ok) {
+            failed.push_back("failed");
+        }
+        else {
+            const double base_fps = base["fps"].as<double>(0.0);
+            const double base_ratio = base["compression_ratio"].as<double>(0.0);
+            const double base_rmse = base["rmse"].as<double>(0.0);
+            const double base_max_error = base["max_error"].as<double>(0.0);
+            const double base_rss = base["peak_rss_mb"].as<double>(0.0);
+
+            if (!quality_only) {
+                if (base_fps <= 0.0 || base_rss <= 0.0) {
+                    std::cerr << "Baseline " << opts.compare_path << " has no fps or peak RSS for "
+                              << r.test_case.name() << "; record it without --quality-only" << std::endl;
+                    return -1;
+                }
+                if (r.fps < base_fps * (1.0 - opts.tolerance)) {
+                    failed.push_back("fps");
+                }
+                if (r.peak_rss_mb > base_rss * (1.0 + opts.tolerance)) {
+                    failed.push_back("rss");
+                }
+                if (r.compression_ratio < base_ratio * (1.0 - opts.quality_tolerance)) {
+                    failed.push_back("ratio");
+                }
+            }
+            // Small absolute slack so lossless (RMSE 0) baselines stay stable
+            if (r.rmse > base_rmse * (1.0 + opts.quality_tolerance) + 1e-3) {
+                failed.push_back("rmse");
+            }
+            if (r.max_error > base_max_error + 1e-3) {
+                failed.push_back("max_error");
+            }
+        }
+
+        std::cout << std::left << std::setw(40) << r.test_case.name() << std::right << std::fixed;
+        if (quality_only) {
+            std::cout << std::setw(9) << std::setprecision(3) << base["rmse"].as<double>(0.0) << " ->"
+                      << std::setw(9) << std::setprecision(3) << r.rmse << " RMSE";
+        }
+        else {
+            std::cout << std::setw(9) << std::setprecision(1) << base["fps"].as<double>(0.0) << " ->"
+                      << std::setw(9) << std::setprecision(1) << r.fps << " fps"
+                      << std::setw(8) << std::setprecision(2) << base["compression_ratio"].as<double>(0.0) << " ->"
+                      << std::setw(7) << std::setprecision(2) << r.compression_ratio << "x";
+        }
+        if (!failed.empty()) {
+            regressions++;
+            std::cout << "  REGRESSION (";
+            for (size_t i = 0; i < failed.size(); ++i) {
+                std::cout << (i ? ", " : "") << failed[i];
+            }
+            std::cout << ")";
+        }
+        std::cout << std::endl;
+    }
+
+    if (compared == 0) {
+        std::cerr << "No case of this run is in the baseline" << std::endl;
+        return -1;
+    }
+
+    std::cout << regressions << " regression(s)" << std::endl;
+    return regressions;
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+    SuiteOptions opts;
+    if (!parse_command_line(argc, argv, opts)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    std::vector<lwir::Frame> corpus;
+    std::string corpus_description;
+    if (!load_corpus(opts, corpus, corpus_description)) {
+        return 1;
+    }
+    if (!make_directory(opts.work_dir)) {
+        return 1;
+    }
+
+    const std::vector<SuiteCase> cases = build_matrix(opts);
+
+    std::cout << "=== LWIR End-to-End Performance Suite ===" << std::endl;
+    std::cout << "Corpus: " << corpus_description << std::endl;
+    std::cout << "Cases: " << cases.size() << ", repetitions: " << opts.reps
+              << " (median fps reported)" << std::endl;
+    std::cout << std::endl;
+
+    print_header();
+    std::vector<SuiteResult> results;
+    bool all_ok = true;
+    for (const SuiteCase& c : cases) {
+        results.push_back(run_case(opts, c, corpus));
+        print_result(results.back());
+        all_ok = all_ok && results.back().ok;
+    }
+
+    if (!opts.json_path.empty() && !write_json(opts.json_path, opts, corpus_description, results)) {
+        return 1;
+    }
+
+    if (!opts.compare_path.empty()) {
+        const int regressions = compare_to_baseline(opts, corpus_description, results);
+        if (regressions != 0) {
+            return 1;
+        }
+    }
+
+    return all_ok ? 0 : 1;
+}
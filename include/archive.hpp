@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "frame.hpp"
+#include "frame_format.hpp"
+
+namespace lwir {
+
+/**
+ * @file archive.hpp
+ * @brief Header-only access to a directory of frame records
+ *
+ * Each time the pipeline writes frame_NNNNNN.lwir, it also appends that
+ * record's header to index.lwidx in the same directory. The index is an
+ * 8-byte magic followed by fixed-size entries in write order. Each entry is
+ * a verbatim copy of the record header plus the number of frames the
+ * capture dropped just before that frame (u32, host byte order):
+ *
+ *   "LWIRIDX2" | header 0 | dropped 0 | header 1 | dropped 1 | ...
+ *
+ * Version 1 indexes ("LWIRIDX1", headers only) are still read, with no
+ * dropped frames. Appending to one first rewrites it as version 2.
+ *
+ * Reading an archive overview then means mapping one small file instead of
+ * opening every record. A frame written twice (encoded again after a
+ * resume) has two entries, and the later one wins. A partial entry at the
+ * end, left by a crash, is ignored.
+ */
+
+static constexpr const char* ARCHIVE_INDEX_FILE = "index.lwidx";
+static constexpr size_t ARCHIVE_INDEX_MAGIC_SIZE = 8;
+static constexpr size_t ARCHIVE_INDEX_ENTRY_SIZE = FRAME_HEADER_SIZE + 4;
+
+/**
+ * One record as described by its header
+ */
+struct ArchiveEntry {
+    CompressedFrame header;   // All fields except compressed_data
+    uint32_t payload_size;
+    uint32_t frames_dropped;  // Capture gap before this frame (index only; 0 when scanned)
+
+    ArchiveEntry() : payload_size(0), frames_dropped(0) {}
+
+    size_t record_size() const { return FRAME_HEADER_SIZE + payload_size; }
+};
+
+/**
+ * Read an archive index through a read-only mapping
+ * @param path Index file (usually <dir>/index.lwidx)
+ * @param entries Output: one entry per frame, sorted by frame index
+ * @return false if the file is missing or not an archive index
+ */
+bool read_archive_index(const std::string& path, std::vector<ArchiveEntry>& entries);
+
+/**
+ * Read the header of every frame_*.lwir record in a directory
+ * (FRAME_HEADER_SIZE bytes per file; payloads are never read)
+ * @param entries Output: one entry per readable record, sorted by frame index
+ * @return false if the directory cannot be opened
+ */
+bool scan_archive_headers(const std::string& dir, std::vector<ArchiveEntry>& entries);
+
+/**
+ * Number of frame_*.lwir files in a directory (staleness check for the index)
+ */
+size_t count_frame_records(const std::string& dir);
+
+/**
+ * Write an index for a set of entries (replaces path atomically)
+ */
+bool write_archive_index(const std::string& path, const std::vector<ArchiveEntry>& entries);
+
+/**
+ * @brief Appends index entries as records are written
+ *
+ * Opened lazily on the first append. An index truncated mid-entry by a crash
+ * is trimmed back to whole entries before new ones are added.
+ */
+class ArchiveIndexWriter {
+public:
+    ArchiveIndexWriter() : fd_(-1) {}
+    ~ArchiveIndexWriter() { close(); }
+
+    ArchiveIndexWriter(const ArchiveIndexWriter&) = delete;
+    ArchiveIndexWriter& operator=(const ArchiveIndexWriter&) = delete;
+
+    /**
+     * Append the header of a record just written
+     * @param path Index file
+     * @param frame Compressed frame
+     * @param frames_dropped Frames the capture dropped just before this one
+     * @return false on I/O error
+     */
+    bool append(const std::string& path, const CompressedFrame& frame, uint32_t frames_dropped = 0);
+
+    void close();
+
+private:
+    bool open(const std::string& path);
+
+    int fd_;
+    std::string path_;
+};
+
+} // namespace lwir
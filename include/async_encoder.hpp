@@ -0,0 +1,191 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "config.hpp"
+#include "frame.hpp"
+#include "pipeline.hpp"
+#include "stats.hpp"
+#include "stream_encoder.hpp"
+#include "worker_pool.hpp"
+
+namespace lwir {
+
+/**
+ * @file async_encoder.hpp
+ * @brief Submit/poll encoding API for embedders with their own event loop
+ *
+ * Any number of AsyncEncoder streams share one WorkerPool (the executor)
+ * and post their results to a CompletionQueue, so a single integration
+ * thread can drive several cameras without blocking in encode:
+ *
+ *   lwir::WorkerPool executor(2);
+ *   lwir::CompletionQueue completions;
+ *   lwir::AsyncEncoder left(executor, completions, config, 0);
+ *   lwir::AsyncEncoder right(executor, completions, config, 1);
+ *
+ *   uint64_t ticket;
+ *   left.submit(lwir::FrameView(pixels, 640, 512), ticket);
+ *   ...
+ *   lwir::Completion done;
+ *   while (completions.poll(done)) { downlink(done.stream_id, done.frame); }
+ */
+
+/**
+ * @brief Result of one submitted frame
+ */
+struct Completion {
+    uint32_t stream_id;        // AsyncEncoder that produced it
+    uint64_t ticket;           // Value returned by submit()
+    bool ok;                   // false if the encode failed (frame is empty)
+    CompressedFrame frame;
+    FrameStats stats;
+
+    Completion() : stream_id(0), ticket(0), ok(false) {}
+};
+
+/**
+ * @brief Thread-safe queue of completed frames
+ *
+ * Completions of one stream appear in ticket order; completions of
+ * different streams interleave in the order they finish.
+ */
+class CompletionQueue {
+public:
+    CompletionQueue() = default;
+
+    CompletionQueue(const CompletionQueue&) = delete;
+    CompletionQueue& operator=(const CompletionQueue&) = delete;
+
+    /**
+     * @brief Take the oldest completion without blocking
+     * @return false if the queue is empty
+     */
+    bool poll(Completion& completion);
+
+    /**
+     * @brief Block until a completion is available and take it
+     */
+    void wait(Completion& completion);
+
+    /**
+     * @brief Block for at most timeout
+     * @return false if nothing completed in time
+     */
+    bool wait_for(Completion& completion, std::chrono::milliseconds timeout);
+
+    size_t size() const;
+
+    /**
+     * @brief Called by the encoders on the executor
+     */
+    void post(Completion&& completion);
+
+private:
+    mutable std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<Completion> completions_;
+};
+
+/**
+ * @brief One camera stream encoded asynchronously on a shared executor
+ *
+ * Frames of a stream are encoded one at a time and in submission order
+ * (each residual needs the previous reconstruction), so several streams
+ * can share an executor without interfering. At most max_in_flight frames
+ * are submitted but not yet completed; submit() refuses further frames until
+ * one completes. Errors are sticky: after a failed encode every pending
+ * frame completes with ok = false and submit() returns false.
+ *
+ * The executor and the completion queue must outlive the encoder.
+ */
+class AsyncEncoder {
+public:
+    /**
+     * @param executor Worker pool that runs the encodes
+     * @param completions Queue receiving the results
+     * @param config Compression configuration (output_dir may be empty)
+     * @param stream_id Copied into every completion of this stream
+     * @param max_in_flight Frames submitted but not yet completed
+     */
+    AsyncEncoder(WorkerPool& executor, CompletionQueue& completions,
+                 const CompressionConfig& config, uint32_t stream_id = 0,
+                 uint32_t max_in_flight = 4);
+
+    /**
+     * @brief Encode all submitted frames, then detach from the executor
+     */
+    ~AsyncEncoder();
+
+    AsyncEncoder(const AsyncEncoder&) = delete;
+    AsyncEncoder& operator=(const AsyncEncoder&) = delete;
+
+    /**
+     * @brief Copy a frame and schedule its encode
+     *
+     * The samples are always copied into a pooled buffer, packed rows
+     * included, because the encode runs after submit() returns.
+     * @param frame Frame to encode (only read during the call)
+     * @param ticket Output: identifies the frame's completion
+     * @return false if max_in_flight frames are pending, the view is
+     *         invalid, or an earlier encode failed
+     */
+    bool submit(const FrameView& frame, uint64_t& ticket);
+
+    /**
+     * @brief Block until every submitted frame has been posted
+     * @return false if any frame failed to encode
+     */
+    bool drain();
+
+    uint32_t in_flight() const;
+    bool ok() const;
+    uint32_t stream_id() const { return stream_id_; }
+
+    /**
+     * @brief Session totals and averages of the frames completed so far
+     *
+     * A snapshot taken after each frame, so it can be read while frames
+     * are being encoded.
+     */
+    SessionStats stats() const;
+
+    /**
+     * @brief Latency and deadline tracking (call after drain)
+     */
+    const DeadlineMonitor& deadline_monitor() const { return pipeline_.deadline_monitor(); }
+
+private:
+    struct Pending {
+        std::unique_ptr<Frame> frame;
+        DeadlineMonitor::Clock::time_point arrival;
+        uint64_t ticket;
+    };
+
+    WorkerPool& executor_;
+    CompletionQueue& completions_;
+    CompressionPipeline pipeline_;
+    uint32_t stream_id_;
+    uint32_t capacity_;
+    Completion* current_;           // Filled by the pipeline sink (executor only)
+
+    mutable std::mutex mutex_;
+    std::condition_variable idle_;
+    std::deque<Pending> pending_;
+    std::vector<std::unique_ptr<Frame>> free_buffers_;
+    SessionStats stats_;            // Pipeline totals after the last completed frame
+    uint32_t in_flight_;            // Submitted, completion not yet posted
+    uint64_t next_ticket_;
+    bool scheduled_;                // A run() task is queued or running
+    bool failed_;
+
+    void run();
+};
+
+} // namespace lwir
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "segment.hpp"
+
+namespace lwir {
+
+/**
+ * @file batch.hpp
+ * @brief Sharded batch compression: GOP-aligned shards, worker processes, merge
+ *
+ * A long input is cut into shards that each start on a GOP boundary. Each
+ * shard is encoded by its own worker process (lwir_compress_tool with
+ * --frame-range), into its own directory, so a crash takes down one shard
+ * and not the batch. A worker that exits with an error or a signal is run
+ * again, up to a retry limit, without touching the other shards.
+ *
+ * A worker starts without a reference, so its first frame is a keyframe.
+ * Sharded output is not equivalent to a single-process encode. Each shard
+ * starts with fresh decision state: the GOP counter, the statistics EMAs
+ * and the overload ladder. An adaptive or heuristic keyframe restarts the
+ * GOP counter, so the keyframes after it land differently than they would
+ * in one process. Capture gaps are not lost at a boundary: a worker seeds
+ * its gap detector with the timestamp of the frame just before its range,
+ * so a gap between two shards is counted in the second.
+ *
+ * The merge copies the shard records unchanged (nothing is re-encoded)
+ * into one segmented archive (segment.hpp), in frame order. Without
+ * segment limits that archive is a single segment, with one index that
+ * covers every frame.
+ */
+
+/**
+ * @brief Frames [first, first + count) of the input
+ */
+struct ShardRange {
+    uint32_t first;
+    uint32_t count;
+
+    ShardRange() : first(0), count(0) {}
+    ShardRange(uint32_t first_frame, uint32_t frame_count) : first(first_frame), count(frame_count) {}
+};
+
+/**
+ * @brief Split frame_count frames into at most `shards` GOP-aligned ranges
+ *
+ * Every range but the last is a whole number of GOPs. Short inputs get
+ * fewer shards (never less than one GOP each).
+ */
+std::vector<ShardRange> plan_shards(size_t frame_count, uint32_t gop_period, uint32_t shards);
+
+/**
+ * @brief Outcome of one shard after the coordinator is done with it
+ */
+struct ShardResult {
+    ShardRange range;
+    std::string output_dir;
+    uint32_t attempts;
+    bool ok;
+    double seconds;   // Wall time of the last attempt
+
+    ShardResult() : attempts(0), ok(false), seconds(0.0) {}
+};
+
+/**
+ * @brief Runs one worker process per shard, a few at a time
+ *
+ * A worker is started as
+ *   <command...> --frame-range <first>:<count> --shard-output <dir>
+ * with its stdout and stderr appended to <dir>.log. Before a retry, the shard
+ * directory is emptied, so a retry never sees the records of a crashed
+ * attempt.
+ */
+class ShardCoordinator {
+public:
+    /**
+     * @param command Worker executable and its arguments (execv, no shell)
+     * @param shard_root Directory for shard_NNN/ outputs and logs (created if missing)
+     * @param jobs Workers running at once (0 = hardware concurrency)
+     * @param retries Extra attempts for a failed shard
+     */
+    ShardCoordinator(const std::vector<std::string>& command, const std::string& shard_root,
+                     uint32_t jobs, uint32_t retries);
+
+    /**
+     * @brief Run every shard to completion or until its retries are used up
+     * @param stop Optional: once set, running workers get SIGTERM and no new ones start
+     * @return true if every shard succeeded
+     */
+    bool run(const std::vector<ShardRange>& shards, std::vector<ShardResult>& results,
+             const std::atomic<bool>* stop = nullptr);
+
+    /**
+     * @brief Output directory of shard i ("<shard_root>/shard_003")
+     */
+    std::string shard_dir(size_t shard) const;
+
+private:
+    std::vector<std::string> command_;
+    std::string shard_root_;
+    uint32_t jobs_;
+    uint32_t retries_;
+
+    int launch(const ShardRange& range, const std::string& dir) const;
+};
+
+/**
+ * @brief Copy the records of several archives into one segmented archive
+ *
+ * Each input may be per-frame records (with or without index.lwidx) or a
+ * segmented archive. Inputs are taken in order, each by frame index, and
+ * their records are written without decoding the payloads; dropped-frame
+ * counts are carried over from the input indexes.
+ * @param output_dir Must exist and must not already hold a segment manifest
+ * @param frames_written Optional output: records in the merged archive
+ */
+bool merge_archives(const std::vector<std::string>& input_dirs, const std::string& output_dir,
+                    const SegmentLimits& limits, uint64_t* frames_written = nullptr);
+
+/**
+ * @brief Remove a directory and everything below it
+ */
+bool remove_directory_tree(const std::string& path);
+
+} // namespace lwir
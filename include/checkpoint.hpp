@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include "config.hpp"
+#include "frame.hpp"
+
+namespace lwir {
+
+/**
+ * @file checkpoint.hpp
+ * @brief Encoder state snapshots for fast failover
+ *
+ * A checkpoint holds everything a restarted encoder needs to continue the
+ * current GOP: the decision engine state (GOP position, EMA estimates) and
+ * a frame record that decodes to the encoder's reference frame. At a
+ * keyframe that record is the keyframe itself, so checkpointing costs one
+ * small file write; elsewhere the reference is re-encoded losslessly.
+ *
+ * File layout (host byte order, like .lwir records):
+ *
+ *   magic "LWCK" | version u32 | frames_since_keyframe u32 |
+ *   last_keyframe_index u32 | last_decision u8 | ema_initialized u8 |
+ *   ema_residual_bpp f64 | ema_keyframe_bpp f64 | frame record...
+ *
+ * Files are written to a temporary name and renamed, so a crash during a
+ * write leaves the previous checkpoint intact.
+ */
+
+/**
+ * @brief Snapshot of the encoder state carried between frames
+ */
+struct EncoderCheckpoint {
+    DecisionEngineState decision;
+    CompressedFrame reference;    // Decodes to the encoder reference (frame_index = last frame)
+};
+
+/**
+ * @brief Write a checkpoint atomically (temporary file + rename)
+ * @return true if successful, false otherwise
+ */
+bool write_checkpoint(const std::string& path, const EncoderCheckpoint& checkpoint);
+
+/**
+ * @brief Read a checkpoint
+ * @return false if the file is missing, truncated or of another version
+ */
+bool read_checkpoint(const std::string& path, EncoderCheckpoint& checkpoint);
+
+} // namespace lwir
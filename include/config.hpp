@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include <cstdint>
 #include <yaml-cpp/yaml.h>
 #include "stats.hpp"
@@ -18,6 +19,19 @@ struct CompressionConfig {
     std::string input_dir;
     std::string output_dir;
 
+    // Input frames: "png" (16-bit PNG files), packed sensor dumps
+    // ("raw12", "raw14"; see packed.hpp), which carry no geometry, or
+    // "tiff" stacks (input_dir is a stack or a directory of stacks)
+    std::string input_format = "png";
+    uint32_t input_width = 0;
+    uint32_t input_height = 0;
+    uint32_t prefetch_workers = 0;   // Threads decoding compressed TIFF pages ahead (0 = inline)
+
+    // Encode only frames [frame_range_first, frame_range_first + frame_range_count)
+    // of the input: one shard of a batch (see batch.hpp; command line only)
+    uint32_t frame_range_first = 0;
+    uint32_t frame_range_count = 0;  // 0 = the whole input
+
     // GOP (Group of Pictures) settings
     uint32_t gop_period = 60;  // Keyframe every N frames
 
@@ -36,10 +50,60 @@ struct CompressionConfig {
     double decision_p99_threshold = 100.0;     // P99 threshold for intra decision
     double decision_entropy_threshold = 6.0;   // Entropy threshold for intra decision
     double decision_hysteresis_bpp = 0.15;     // Hysteresis to prevent flip-flop
+    bool enable_decision_stats = false;        // Feed residual stats to the heuristic stage
+
+    // Repeat frames: header-only records for frames that need no residual
+    bool detect_repeats = false;      // Exact repeat of the previous input (frozen driver buffer)
+    bool static_gating = false;       // Residual entirely within the dead zone (static scene)
+
+    // Capture timeline: dropped-frame detection (see timeline.hpp)
+    double frame_period_us = 0.0;         // Nominal capture period (0 = no gap detection)
+    std::string gap_policy = "keyframe";  // After a gap: "keyframe", "widen" or "ignore"
+    uint32_t gap_widen_near = 5;          // widen: residual_near increment for that frame
+
+    // Real-time budget
+    double frame_deadline_ms = 33.3;  // Arrival-to-write budget per frame (0 = disabled)
+
+    // Overlapped encoding: JPEG-LS coding of NEAR=0 frames runs on workers
+    // while the next frame is prepared (see CompressionPipeline)
+    uint32_t encode_workers = 0;      // Entropy coding threads (0 = inline)
+
+    // Overload degradation ladder (see overload.hpp)
+    bool overload_enable = false;
+    std::vector<std::string> overload_ladder = {
+        "skip_verify", "raise_qt", "extend_gop", "raise_near", "subsample_stats"};
+    double overload_slack_low_ms = 3.0;      // Step down when slack falls below
+    double overload_slack_high_ms = 10.0;    // Step up when slack stays above
+    uint32_t overload_queue_high = 2;        // Step down at this queue depth
+    uint32_t overload_cooldown_frames = 5;   // Frames between consecutive step-downs
+    uint32_t overload_hold_frames = 60;      // Clear frames before stepping up
+    uint32_t overload_near_step = 5;         // raise_near: residual_near increment
+    double overload_q_scale = 1.5;           // raise_qt: Q multiplier
+    uint32_t overload_t_step = 2;            // raise_qt: T increment
+    uint32_t overload_gop_scale = 2;         // extend_gop: GOP multiplier
+    uint32_t overload_stats_stride = 4;      // subsample_stats: pixel stride
+
+    // Profiling
+    bool enable_perf_counters = false;  // Hardware counters per encoder stage
 
     // Output options
     bool write_residual_histograms = false;  // Write CSV histograms
     bool write_decoded_frames = false;       // Write decoded frames for validation
+    bool compute_error_stats = false;        // Per-frame RMSE/max error against reconstruction
+    bool verbose = true;                     // Per-frame progress and summary on stdout
+    bool dry_run = false;                    // Encode without writing frames or statistics
+    bool sync_writes = false;                // fsync each frame file before it counts as written
+
+    // Segmented output (see segment.hpp): records go to rolling segment
+    // files, started at the first keyframe after any limit is reached
+    uint32_t segment_gops = 0;               // GOPs per segment (0 = no limit)
+    uint32_t segment_mb = 0;                 // MB per segment (0 = no limit)
+    double segment_minutes = 0.0;            // Capture minutes per segment (0 = no limit)
+    uint32_t storage_budget_mb = 0;          // Ring storage: keep the newest segments within this (0 = keep all)
+
+    // Failover checkpoints (see checkpoint.hpp)
+    std::string checkpoint_path;             // Snapshot file, ideally on tmpfs (empty = disabled)
+    uint32_t checkpoint_interval = 0;        // Frames between snapshots (0 = at every keyframe)
 
     /**
      * @brief Load configuration from YAML file
@@ -56,18 +120,59 @@ struct CompressionConfig {
      */
     bool load_from_node(const YAML::Node& node);
 
+    /**
+     * @brief Load configuration from YAML text (input/output paths optional)
+     * @param yaml_text YAML document
+     * @param profile_name Optional profile name to load
+     * @return true if successful, false otherwise
+     */
+    bool load_from_string(const std::string& yaml_text, const std::string& profile_name = "");
+
+    /**
+     * @brief Read the optional encoding parameters (everything except paths)
+     * @param node YAML node containing configuration
+     */
+    void load_parameters(const YAML::Node& node);
+
     /**
      * @brief Validate configuration parameters
      * @return true if valid, false otherwise
      */
     bool validate() const;
 
+    /**
+     * @brief Validate encoding parameters only (no input/output paths needed)
+     * @return true if valid, false otherwise
+     */
+    bool validate_parameters() const;
+
+    /**
+     * @brief Whether records go to segment files instead of one file per frame
+     */
+    bool segmented_output() const { return segment_gops > 0 || segment_mb > 0 || segment_minutes > 0.0; }
+
     /**
      * @brief Print configuration summary to stdout
      */
     void print() const;
 };
 
+/**
+ * @brief Decision engine state carried from frame to frame (checkpoints)
+ */
+struct DecisionEngineState {
+    uint32_t last_keyframe_index;
+    uint32_t frames_since_keyframe;
+    FrameMode last_decision;
+    double ema_residual_bpp;
+    double ema_keyframe_bpp;
+    bool ema_initialized;
+
+    DecisionEngineState()
+        : last_keyframe_index(0), frames_since_keyframe(0), last_decision(FrameMode::USE_INTRA),
+          ema_residual_bpp(0.0), ema_keyframe_bpp(0.0), ema_initialized(false) {}
+};
+
 /**
  * @brief Frame decision engine
  *
@@ -92,13 +197,52 @@ public:
      */
     FrameMode decide_mode(const ResidualStats& stats, uint32_t frame_index);
 
+    /**
+     * @brief Start a new GOP at this frame regardless of the decision stages
+     * @param frame_index Current frame index
+     */
+    void force_keyframe(uint32_t frame_index);
+
     /**
      * @brief Update EMA statistics after encoding
+     *
+     * A residual without payload (a repeat record) says nothing about the
+     * residual rate and leaves the EMAs unchanged.
      * @param compressed_bytes Size of compressed frame in bytes
      * @param was_keyframe True if frame was encoded as keyframe
      */
     void update_stats(size_t compressed_bytes, bool was_keyframe);
 
+    /**
+     * @brief Change the periodic keyframe interval (overload ladder)
+     * @param gop_period New GOP period in frames
+     */
+    void set_gop_period(uint32_t gop_period) { config_.gop_period = gop_period; }
+
+    /**
+     * @brief Adopt new thresholds (config reload), keeping the EMA history
+     * @param config Updated compression configuration
+     */
+    void reconfigure(const CompressionConfig& config) { config_ = config; }
+
+    /**
+     * @brief Snapshot of the GOP position and EMA estimates
+     */
+    DecisionEngineState state() const;
+
+    /**
+     * @brief Resume from a snapshot (thresholds still come from the config)
+     */
+    void restore_state(const DecisionEngineState& state);
+
+    /**
+     * @brief Account for a frame encoded by an earlier process (roll forward)
+     * @param frame_index Index of the frame
+     * @param was_keyframe True if it was a keyframe
+     * @param compressed_bytes Its payload size
+     */
+    void record_frame(uint32_t frame_index, bool was_keyframe, size_t compressed_bytes);
+
 private:
     CompressionConfig config_;
     uint32_t last_keyframe_index_;
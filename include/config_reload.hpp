@@ -0,0 +1,127 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "config.hpp"
+
+namespace lwir {
+
+/**
+ * @file config_reload.hpp
+ * @brief Hot reload of the YAML configuration during a session
+ *
+ * A ConfigReloader re-reads the configuration file on SIGHUP (via
+ * request_reload()) or, optionally, whenever the file is rewritten
+ * (inotify). Parsing and validation run on the reloader's own thread; the
+ * encode thread only picks up an already validated config at the next
+ * frame, so a reload never stalls encoding. An invalid file is reported
+ * and the running configuration stays in effect.
+ *
+ * Parameters take effect at different points:
+ *
+ *   frame boundary: residual_near, dead_zone_T, quant_Q, decision_*,
+ *                   enable_decision_stats, detect_repeats, static_gating,
+ *                   frame_period_us, gap_policy, gap_widen_near,
+ *                   overload thresholds and step sizes,
+ *                   compute_error_stats, verbose
+ *   GOP boundary:   gop_period, keyframe_near, fp_bits, enable_12bit_mode
+ *                   (applied at the next keyframe)
+ *   restart only:   paths, dry_run, sync_writes, frame_deadline_ms,
+ *                   overload_enable, overload_ladder, enable_perf_counters,
+ *                   checkpoint_path, checkpoint_interval, encode_workers
+ *
+ * Command-line overrides are not re-applied: after a reload the file is
+ * authoritative for every reloadable parameter.
+ */
+
+/**
+ * Copy the parameters that may change between any two frames
+ */
+void apply_frame_parameters(const CompressionConfig& update, CompressionConfig& config);
+
+/**
+ * Copy the parameters that may only change at a keyframe
+ */
+void apply_gop_parameters(const CompressionConfig& update, CompressionConfig& config);
+
+/**
+ * Names of restart-only parameters that differ between the two configs
+ */
+std::vector<std::string> restart_parameter_changes(const CompressionConfig& update,
+                                                   const CompressionConfig& config);
+
+/**
+ * @brief Watches a configuration file and stages validated reloads
+ */
+class ConfigReloader {
+public:
+    /**
+     * @param yaml_path Configuration file to re-read
+     * @param profile Profile name (same as at startup, may be empty)
+     */
+    ConfigReloader(const std::string& yaml_path, const std::string& profile);
+
+    /**
+     * @brief Stops the watcher thread
+     */
+    ~ConfigReloader();
+
+    ConfigReloader(const ConfigReloader&) = delete;
+    ConfigReloader& operator=(const ConfigReloader&) = delete;
+
+    /**
+     * @brief Start the watcher thread
+     * @param watch_file Also reload when the file changes (inotify, Linux)
+     * @return false if the thread or the watch could not be set up
+     */
+    bool start(bool watch_file);
+
+    /**
+     * @brief Stop and join the watcher thread
+     */
+    void stop();
+
+    /**
+     * @brief Ask for the file to be re-read
+     *
+     * Async-signal-safe: may be called from a SIGHUP handler.
+     */
+    void request_reload();
+
+    /**
+     * @brief Take the most recent validated config, if a new one is staged
+     *
+     * Called by the encode thread at a frame boundary. Never waits: if the
+     * watcher is publishing at that instant the config is picked up at the
+     * next frame instead.
+     * @return true if config was replaced
+     */
+    bool take(CompressionConfig& config);
+
+    uint32_t reloads() const { return reloads_.load(); }     // Validated and staged
+    uint32_t rejected() const { return rejected_.load(); }   // Failed to parse/validate
+
+private:
+    std::string yaml_path_;
+    std::string profile_;
+    int wake_fds_[2];          // Self-pipe: request_reload() / stop() -> watcher
+    int inotify_fd_;
+    std::thread thread_;
+    std::atomic<bool> stopping_;
+
+    std::mutex mutex_;         // Guards staged_
+    CompressionConfig staged_;
+    std::atomic<bool> pending_;
+
+    std::atomic<uint32_t> reloads_;
+    std::atomic<uint32_t> rejected_;
+
+    void watch_loop();
+    void reload();
+};
+
+} // namespace lwir
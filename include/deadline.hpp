@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <chrono>
+
+namespace lwir {
+
+/**
+ * @file deadline.hpp
+ * @brief Real-time frame budget tracking
+ *
+ * The camera delivers a frame every 33 ms at 30 Hz. Every frame has to be
+ * loaded, decided, encoded and written within that budget or the capture
+ * queue grows. The monitor measures each frame from arrival to write
+ * completion, counts deadline misses, keeps the slack distribution, and
+ * attributes every miss to the stage that consumed the most time.
+ */
+
+/**
+ * Pipeline stages that are timed per frame
+ */
+enum class PipelineStage {
+    LOAD,       // Frame read / ingest
+    DECIDE,     // Keyframe vs residual decision
+    ENCODE,     // Residual + quantize + JPEG-LS
+    WRITE,      // Output to disk
+    COUNT
+};
+
+static constexpr size_t PIPELINE_STAGE_COUNT = static_cast<size_t>(PipelineStage::COUNT);
+
+/**
+ * Get printable name of a pipeline stage
+ */
+const char* stage_name(PipelineStage stage);
+
+/**
+ * A single missed deadline
+ */
+struct DeadlineMiss {
+    uint32_t frame_index;
+    double latency_ms;       // Arrival to write completion
+    double slack_ms;         // deadline - latency (negative on a miss)
+    PipelineStage stage;     // Stage that consumed the most time
+    double stage_ms;         // Time spent in that stage
+
+    DeadlineMiss()
+        : frame_index(0), latency_ms(0.0), slack_ms(0.0),
+          stage(PipelineStage::ENCODE), stage_ms(0.0) {}
+};
+
+/**
+ * Per-frame deadline monitor
+ *
+ * Usage per frame:
+ *   begin_frame(index, arrival);
+ *   ... load ...   mark_stage(PipelineStage::LOAD);
+ *   ... decide ... mark_stage(PipelineStage::DECIDE);
+ *   ... encode ... mark_stage(PipelineStage::ENCODE);
+ *   ... write ...  mark_stage(PipelineStage::WRITE);
+ *   end_frame();
+ *
+ * A frame that finishes after the next one has started (overlapped entropy
+ * coding) is parked with suspend_frame() and picked up again with
+ * resume_frame() before its remaining stages are marked.
+ */
+class DeadlineMonitor {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * Timing state of an unfinished frame
+     */
+    struct FrameTiming {
+        uint32_t frame_index;
+        Clock::time_point arrival;
+        Clock::time_point last_mark;
+        double stage_ms[PIPELINE_STAGE_COUNT];
+    };
+
+    /**
+     * @param deadline_ms Per-frame budget in milliseconds (0 = disabled)
+     */
+    explicit DeadlineMonitor(double deadline_ms = 0.0);
+
+    /**
+     * Start timing a frame
+     * @param frame_index Frame index (for miss logging)
+     * @param arrival Time the frame became available to the pipeline
+     */
+    void begin_frame(uint32_t frame_index, Clock::time_point arrival);
+
+    /**
+     * Close the given stage; its duration is the time since the previous mark
+     * (or since arrival for the first stage)
+     */
+    void mark_stage(PipelineStage stage);
+
+    /**
+     * Finish the frame at write completion
+     * @return Slack in milliseconds (negative if the deadline was missed)
+     */
+    double end_frame();
+
+    /**
+     * Park the frame being timed (its next stage keeps running)
+     */
+    FrameTiming suspend_frame() const;
+
+    /**
+     * Continue timing a parked frame; the next mark_stage() covers the
+     * time since its last mark
+     */
+    void resume_frame(const FrameTiming& timing);
+
+    bool enabled() const { return deadline_ms_ > 0.0; }
+    double deadline_ms() const { return deadline_ms_; }
+    uint32_t frames() const { return static_cast<uint32_t>(slack_ms_.size()); }
+    uint32_t misses() const { return static_cast<uint32_t>(misses_.size()); }
+    double last_slack_ms() const { return last_slack_ms_; }
+    double last_latency_ms() const { return last_latency_ms_; }
+    const std::vector<DeadlineMiss>& miss_log() const { return misses_; }
+
+    /**
+     * Slack percentile over all finished frames
+     * @param p Percentile in [0, 1] (0.01 = worst 1%)
+     */
+    double slack_percentile(double p) const;
+
+    /**
+     * Print deadline summary to stdout
+     */
+    void print_summary() const;
+
+    /**
+     * Export metrics as a JSON object (no trailing newline)
+     * @param indent Indentation prefix for nested lines
+     */
+    std::string to_json(const std::string& indent = "  ") const;
+
+private:
+    double deadline_ms_;
+    uint32_t frame_index_;
+    Clock::time_point arrival_;
+    Clock::time_point last_mark_;
+    double stage_ms_[PIPELINE_STAGE_COUNT];
+    double stage_total_ms_[PIPELINE_STAGE_COUNT];
+    uint32_t misses_by_stage_[PIPELINE_STAGE_COUNT];
+    double last_slack_ms_;
+    double last_latency_ms_;
+    double max_latency_ms_;
+
+    std::vector<float> slack_ms_;
+    std::vector<DeadlineMiss> misses_;
+};
+
+} // namespace lwir
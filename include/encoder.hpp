@@ -5,10 +5,26 @@
 #include <string>
 #include <memory>
 #include "frame.hpp"
+#include "kernels.hpp"
 #include "residual.hpp"
 
 namespace lwir {
 
+class PerfProfiler;
+
+/**
+ * Largest JPEG-LS payload the encoder can produce for a frame of this size
+ * (the destination capacity it hands to CharLS); 0 on CharLS error
+ */
+size_t max_payload_size(uint32_t width, uint32_t height);
+
+/**
+ * CharLS build the payloads come from ("charls-2.4.2"; "charls-unversioned"
+ * if its headers carry no version). Golden files and perf baselines record
+ * it, because payload bytes and sizes differ between CharLS releases.
+ */
+std::string jpegls_codec_version();
+
 /**
  * CharLS encoder/decoder wrapper
  * Handles JPEG-LS compression with configurable NEAR parameter
@@ -25,6 +41,7 @@ public:
      * @param height Image height
      * @param near_param NEAR parameter (0 = lossless, >0 = near-lossless)
      * @param output Encoded data (output)
+     * @param bits_per_sample Sample precision (12 for range-mapped data)
      * @return true on success
      */
     bool encode(
@@ -32,7 +49,8 @@ public:
         uint32_t width,
         uint32_t height,
         uint32_t near_param,
-        std::vector<uint8_t>& output
+        std::vector<uint8_t>& output,
+        uint32_t bits_per_sample = 16
     );
 
     /**
@@ -60,6 +78,26 @@ private:
     std::string last_error_;
 };
 
+/**
+ * A frame whose reference update is done but whose JPEG-LS payload is not
+ * yet coded (see FrameEncoder::prepare_frame)
+ */
+struct PreparedFrame {
+    CompressedFrame frame;            // All fields but compressed_data
+    std::vector<uint16_t> plane;      // Samples handed to CharLS
+    uint32_t near_lossless = 0;
+    uint32_t bits_per_sample = 16;
+};
+
+/**
+ * JPEG-LS code a prepared frame into prepared.frame.compressed_data
+ *
+ * Touches no encoder state, so several frames can be coded concurrently
+ * on worker threads while the encoder prepares the next ones.
+ * @return true on success
+ */
+bool entropy_code(PreparedFrame& prepared);
+
 /**
  * High-level frame encoder/decoder
  * Handles keyframes, residuals, and closed-loop state
@@ -72,7 +110,7 @@ public:
      * Encode intra frame (keyframe)
      */
     bool encode_intra_frame(
-        const Frame& frame,
+        const FrameView& frame,
         uint32_t near_lossless,
         CompressedFrame& output,
         bool enable_12bit_mode = false
@@ -82,7 +120,7 @@ public:
      * Encode residual frame
      */
     bool encode_residual_frame(
-        const Frame& frame,
+        const FrameView& frame,
         uint32_t near_lossless,
         const QuantizationParams& quant_params,
         CompressedFrame& output
@@ -90,7 +128,8 @@ public:
 
     /**
      * Encode a frame (keyframe or residual)
-     * @param frame Input frame
+     * @param frame Input samples, read during the call only. Packed rows are
+     *              read in place; padded rows are packed once first.
      * @param is_keyframe Force keyframe encoding
      * @param keyframe_near NEAR parameter for keyframes
      * @param residual_near NEAR parameter for residuals
@@ -100,7 +139,7 @@ public:
      * @return true on success
      */
     bool encode_frame(
-        const Frame& frame,
+        const FrameView& frame,
         bool is_keyframe,
         uint32_t keyframe_near,
         uint32_t residual_near,
@@ -109,6 +148,73 @@ public:
         bool enable_12bit_mode = false
     );
 
+    /**
+     * Whether prepare_frame() applies: the reference must not depend on the
+     * JPEG-LS output (NEAR=0 residuals, lossless keyframes without
+     * verification decode)
+     */
+    bool can_prepare(bool is_keyframe, uint32_t keyframe_near, uint32_t residual_near) const;
+
+    /**
+     * First half of encode_frame(): predict, quantize (or range map) and
+     * advance the reference. The payload is produced later by
+     * entropy_code(), possibly on another thread; the next frame can be
+     * prepared as soon as this returns. Frames must not change size
+     * between a keyframe and its residuals, as with encode_frame().
+     * @return false if can_prepare() is false or on error
+     */
+    bool prepare_frame(
+        const FrameView& frame,
+        bool is_keyframe,
+        uint32_t keyframe_near,
+        uint32_t residual_near,
+        const QuantizationParams& quant_params,
+        PreparedFrame& prepared,
+        bool enable_12bit_mode = false
+    );
+
+    /**
+     * Start a frame delivered in row bands (sensor readout order).
+     * encode_band() then takes rows top to bottom as they arrive. Residual
+     * bands are predicted, quantized and, with NEAR=0, reconstructed on
+     * arrival, so only the JPEG-LS coding of the assembled plane is left
+     * for finish_banded_frame(); JPEG-LS is not started per stripe. Keyframes are assembled and encoded at
+     * finish (the range map needs the whole frame). The record is the one
+     * encode_frame() produces for the assembled frame.
+     * @param frame Geometry, frame_index and timestamp (samples are ignored)
+     * @return false if a residual has no matching reference
+     */
+    bool begin_banded_frame(
+        const FrameView& frame,
+        bool is_keyframe,
+        uint32_t keyframe_near,
+        uint32_t residual_near,
+        const QuantizationParams& quant_params,
+        bool enable_12bit_mode = false
+    );
+
+    /**
+     * Add the next rows of the banded frame
+     * @param y0 First row of the band (must equal banded_rows())
+     * @param rows Samples of the first row of the band
+     * @param row_count Rows in the band
+     * @param stride Samples from one row to the next (0 = width)
+     * @return false if the band is out of order or out of bounds
+     */
+    bool encode_band(uint32_t y0, const uint16_t* rows, uint32_t row_count, size_t stride = 0);
+
+    /**
+     * Code the banded frame once all rows are in: JPEG-LS over the whole
+     * plane (and the closed-loop decode at NEAR>0), as for a whole frame
+     */
+    bool finish_banded_frame(CompressedFrame& output);
+
+    /**
+     * Rows of the banded frame received so far, and the assembled input
+     */
+    uint32_t banded_rows() const { return band_.rows; }
+    const Frame& banded_input() const { return band_.input; }
+
     /**
      * Decode a compressed frame
      * @param compressed Compressed frame
@@ -120,14 +226,137 @@ public:
         Frame& output
     );
 
+    /**
+     * Decode a compressed frame into caller memory
+     *
+     * The frame is reconstructed into the decoder's reference and written
+     * to pixels once, row by row.
+     * @param pixels First sample of the first destination row
+     * @param stride Samples from one destination row to the next (0 = width)
+     * @return true on success
+     */
+    bool decode_frame(const CompressedFrame& compressed, uint16_t* pixels, size_t stride);
+
     /**
      * Reset encoder state (clears reference frame)
      */
     void reset();
 
+    /**
+     * Enable/disable the verification decode of lossless keyframes.
+     * With NEAR=0 the decoded keyframe equals the (range-mapped) input, so
+     * the reference can be rebuilt without running the JPEG-LS decoder.
+     * Closed-loop decodes for NEAR>0 are always performed.
+     */
+    void set_verify_decode(bool enable) { verify_decode_ = enable; }
+    bool verify_decode() const { return verify_decode_; }
+
+    /**
+     * Replace frames that need no residual by repeat records (no payload).
+     * With detect_repeats, a frame identical to the previous input is a
+     * repeat (found by hash, confirmed against a copy of that input); with static_gating, so is a frame whose residual
+     * against the reference is entirely within the dead zone. Keyframes are
+     * never replaced. Applies to encode_frame() and prepare_frame().
+     */
+    void set_repeat_detection(bool detect_repeats, bool static_gating)
+    {
+        detect_repeats_ = detect_repeats;
+        static_gating_ = static_gating;
+    }
+
+    /**
+     * Current reconstructed reference frame (what the decoder will hold)
+     */
+    const Frame& reference_frame() const { return reference_frame_; }
+    bool has_reference() const { return reference_frame_initialized_; }
+
+    /**
+     * Attach a stage profiler (nullptr to detach); not owned
+     */
+    void set_profiler(PerfProfiler* profiler) { profiler_ = profiler; }
+
 private:
+    /**
+     * Fill the keyframe header and range map the input if enabled
+     * @return Samples to encode (frame data or mapped_data)
+     */
+    const uint16_t* begin_intra_frame(const FrameView& frame, uint32_t near_lossless, CompressedFrame& output,
+                                      bool enable_12bit_mode, std::vector<uint16_t>& mapped_data);
+
+    /**
+     * Lossless keyframe: the reference is the (range-mapped) input
+     */
+    void set_reference_from_input(const FrameView& frame, const CompressedFrame& output,
+                                  const std::vector<uint16_t>& mapped_data);
+
+    /**
+     * Header fields of a residual record
+     */
+    void fill_residual_header(const FrameView& frame, uint32_t near_lossless,
+                              const QuantizationParams& quant_params, CompressedFrame& output) const;
+
+    /**
+     * Residual, quantization and bias; fills the residual header
+     */
+    bool begin_residual_frame(const FrameView& frame, uint32_t near_lossless,
+                              const QuantizationParams& quant_params, CompressedFrame& output,
+                              std::vector<int16_t>& quantized, std::vector<uint16_t>& quantized_unsigned);
+
+    /**
+     * Closed loop: add the dequantized residual the decoder receives
+     */
+    void update_reference(const FrameView& frame, const int16_t* received, const QuantizationParams& quant_params);
+
+    /**
+     * Whether the frame can be sent as a repeat (updates the input hash)
+     * @param within_dead_zone Static gating result if already known
+     */
+    bool is_repeat_frame(const FrameView& frame, bool is_keyframe, uint32_t dead_zone_T,
+                         const bool* within_dead_zone = nullptr);
+
+    /**
+     * Repeat record: header only, the reference keeps its samples
+     */
+    void encode_repeat_frame(const FrameView& frame, CompressedFrame& output);
+
+    /**
+     * Decode a record into the reference (unchanged on failure)
+     */
+    bool decode_reference(const CompressedFrame& compressed);
+
     Frame reference_frame_;  // Previous reconstructed frame
+    std::vector<uint16_t> decode_buffer_;  // Decoded samples, swapped with the reference
+    std::vector<uint16_t> input_staging_;  // Padded input rows, packed
     bool reference_frame_initialized_;
+    bool verify_decode_;
+    PerfProfiler* profiler_;
+    KernelDispatch kernels_;  // Specialized kernels for the stream geometry
+
+    // Repeat detection: hash and copy of the previous input frame
+    bool detect_repeats_;
+    bool static_gating_;
+    uint64_t input_hash_;
+    bool input_hash_valid_;
+    std::vector<uint16_t> previous_input_;
+
+    // Frame being ingested in row bands
+    struct BandedFrame {
+        Frame input;                            // Rows received so far
+        uint32_t rows = 0;
+        bool active = false;
+        bool is_keyframe = false;
+        uint32_t keyframe_near = 0;
+        uint32_t residual_near = 0;
+        QuantizationParams quant_params;
+        bool enable_12bit_mode = false;
+        bool within_dead_zone = true;           // Static gating, bands so far
+        std::vector<int16_t> residual;          // Scratch for one band
+        std::vector<int16_t> quantized;
+        std::vector<uint16_t> plane;            // Biased residual handed to CharLS
+        std::vector<uint16_t> next_reference;   // NEAR = 0: reconstructed rows
+    };
+    BandedFrame band_;
+    KernelDispatch band_kernels_;   // Band-sized calls, kept apart from the frame-sized selection
 };
 
 } // namespace lwir
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 #include <string>
@@ -24,11 +26,66 @@ struct Frame {
     size_t pixel_count() const { return width * height; }
 
     bool is_valid() const {
-        return !data.empty() && width > 0 && height > 0
-               && data.size() == pixel_count();
+        return !data.empty() && width > 0 && height > 0 && data.size() == pixel_count();
     }
 };
 
+/**
+ * @brief Borrowed view of a 16-bit frame (encoder input, not owned)
+ *
+ * The samples are only read during the call the view is passed to. Rows
+ * may be padded (stride > width). A Frame converts to a packed view.
+ */
+struct FrameView {
+    const uint16_t* data;
+    uint32_t width;
+    uint32_t height;
+    size_t stride;          // Samples per row (0 = width)
+    uint64_t timestamp;     // Capture time, copied into the encoded frame
+    uint32_t frame_index;
+
+    FrameView()
+        : data(nullptr), width(0), height(0), stride(0), timestamp(0), frame_index(0) {}
+
+    FrameView(const uint16_t* data_, uint32_t width_, uint32_t height_,
+              size_t stride_ = 0, uint64_t timestamp_ = 0)
+        : data(data_), width(width_), height(height_), stride(stride_), timestamp(timestamp_),
+          frame_index(0) {}
+
+    FrameView(const Frame& frame)
+        : data(frame.data.empty() ? nullptr : frame.data.data()), width(frame.width),
+          height(frame.height), stride(0), timestamp(frame.timestamp),
+          frame_index(frame.frame_index) {}
+
+    size_t pixel_count() const { return static_cast<size_t>(width) * height; }
+    size_t row_stride() const { return stride ? stride : width; }
+    bool is_packed() const { return row_stride() == width; }
+
+    bool is_valid() const {
+        return data != nullptr && width > 0 && height > 0 && row_stride() >= width;
+    }
+};
+
+/**
+ * Packed view of the same frame: the view itself when its rows are
+ * already contiguous, else a copy of the rows in storage
+ */
+inline FrameView pack_rows(const FrameView& view, std::vector<uint16_t>& storage)
+{
+    if (view.is_packed() || view.data == nullptr) {
+        return view;
+    }
+    storage.resize(view.pixel_count());
+    for (uint32_t y = 0; y < view.height; ++y) {
+        std::copy(view.data + y * view.row_stride(), view.data + y * view.row_stride() + view.width,
+                  storage.begin() + static_cast<size_t>(y) * view.width);
+    }
+    FrameView packed = view;
+    packed.data = storage.data();
+    packed.stride = 0;
+    return packed;
+}
+
 /**
  * Compressed frame data with metadata
  */
@@ -39,6 +96,7 @@ struct CompressedFrame {
     uint32_t frame_index;
     uint64_t timestamp;
     bool is_keyframe;
+    bool is_repeat;              // No payload: decodes to the previous frame
 
     // Compression parameters used
     uint32_t near_lossless;      // NEAR parameter for CharLS
@@ -52,7 +110,7 @@ struct CompressedFrame {
     bool use_range_map;          // Whether range mapping was used
 
     CompressedFrame()
-        : width(0), height(0), frame_index(0), timestamp(0), is_keyframe(false),
+        : width(0), height(0), frame_index(0), timestamp(0), is_keyframe(false), is_repeat(false),
           near_lossless(0), quant_Q(0.0), dead_zone_T(0), fp_bits(0),
           range_min(0), range_max(65535), use_range_map(false) {}
 };
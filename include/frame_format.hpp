@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "frame.hpp"
+
+namespace lwir {
+
+/**
+ * @file frame_format.hpp
+ * @brief On-disk / on-wire layout of a compressed frame record
+ *
+ * A record is a fixed 50-byte header followed by the JPEG-LS payload. Fields
+ * are packed without padding in host byte order (the format written by
+ * lwir_compress since the first release):
+ *
+ *   width u32 | height u32 | timestamp u64 | frame_index u32 | type u8 |
+ *   near u32 | quant_Q f64 | dead_zone_T u32 | fp_bits u32 | range_map u8 |
+ *   range_min u16 | range_max u16 | payload_size u32 | payload...
+ *
+ * type is 0 for a residual, 1 for a keyframe and 2 for a repeat (no
+ * payload; the frame decodes to the previous one).
+ */
+
+static constexpr size_t FRAME_HEADER_SIZE = 50;
+
+/**
+ * Size of the complete record for a compressed frame
+ */
+inline size_t frame_record_size(const CompressedFrame& frame)
+{
+    return FRAME_HEADER_SIZE + frame.compressed_data.size();
+}
+
+/**
+ * File name of a frame record in an output directory ("frame_000042.lwir")
+ */
+std::string frame_file_name(uint32_t frame_index);
+
+/**
+ * Upper bound on the record size of any frame of the given dimensions
+ * (header plus the encoder's largest possible payload)
+ */
+size_t frame_record_bound(uint32_t width, uint32_t height);
+
+/**
+ * Serialize only the header of a record
+ * @param frame Compressed frame (compressed_data is not read)
+ * @param payload_size Payload length to announce
+ * @param dst Destination buffer
+ * @param capacity Size of dst in bytes
+ * @return FRAME_HEADER_SIZE, or 0 if dst is too small
+ */
+size_t write_frame_header(const CompressedFrame& frame, uint32_t payload_size, uint8_t* dst, size_t capacity);
+
+/**
+ * Serialize a frame record into a caller buffer
+ * @param frame Compressed frame
+ * @param dst Destination buffer
+ * @param capacity Size of dst in bytes
+ * @return Bytes written, or 0 if dst is too small
+ */
+size_t write_frame_record(const CompressedFrame& frame, uint8_t* dst, size_t capacity);
+
+/**
+ * Parse only the header of a record
+ * @param src Record bytes (at least FRAME_HEADER_SIZE)
+ * @param size Size of src in bytes
+ * @param frame Output: all fields except compressed_data
+ * @param payload_size Output: payload length announced by the header
+ * @return false if src is shorter than a header
+ */
+bool read_frame_header(const uint8_t* src, size_t size, CompressedFrame& frame, uint32_t& payload_size);
+
+/**
+ * Parse a complete record (header and payload)
+ * @return false if src is truncated
+ */
+bool read_frame_record(const uint8_t* src, size_t size, CompressedFrame& frame);
+
+} // namespace lwir
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "frame.hpp"
+#include "packed.hpp"
+#include "synthetic.hpp"
+
+namespace lwir {
+
+/**
+ * @file frame_source.hpp
+ * @brief Input frame sources for the compression pipeline
+ *
+ * The pipeline pulls frames by position from a FrameSource. The default is
+ * a directory of 16-bit PNG captures; packed RAW12/RAW14 dumps, benchmarks
+ * and tools feed frames through the same path.
+ */
+
+/**
+ * @brief Source of input frames for the compression pipeline
+ *
+ * Frames are addressed by sequence position; sources fill in pixel data,
+ * dimensions, frame_index and (where known) timestamp.
+ */
+class FrameSource {
+public:
+    virtual ~FrameSource() {}
+
+    /**
+     * @brief Number of frames available
+     */
+    virtual size_t frame_count() const = 0;
+
+    /**
+     * @brief Read a frame by position
+     * @param index Position in [0, frame_count())
+     * @param frame Output frame
+     * @return true if successful, false otherwise
+     */
+    virtual bool read_frame(size_t index, Frame& frame) = 0;
+
+    /**
+     * @brief Human-readable description for logs
+     */
+    virtual std::string description() const = 0;
+};
+
+/**
+ * @brief Load a single frame from a 16-bit grayscale PNG file
+ * @param png_path Path to PNG
+ * @param frame Output frame structure (pixels and dimensions; the timestamp
+ *              too if the file has a FRAME_TIMESTAMP_PNG_KEY text chunk)
+ * @return true if successful, false otherwise
+ */
+bool load_frame_from_png(const std::string& png_path, Frame& frame);
+
+/**
+ * @brief Directory of PNG frames, sorted by file name
+ *
+ * Timestamps come from each file's timestamp text chunk. Without one, a
+ * nominal frame period turns the camera sequence number at the end of the
+ * file name (jenoptik_000123.png) into a timestamp, so frames the camera
+ * dropped still show up as gaps. Otherwise timestamps are 0.
+ */
+class PngDirectorySource : public FrameSource {
+public:
+    PngDirectorySource() : frame_period_us_(0.0) {}
+
+    /**
+     * @brief Scan a directory for frames
+     * @param input_dir Directory to scan
+     * @param prefix Only files starting with this prefix (skips analysis/mask files)
+     * @return true if at least one frame was found
+     */
+    bool open(const std::string& input_dir, const std::string& prefix = "jenoptik_");
+
+    size_t frame_count() const override { return files_.size(); }
+    bool read_frame(size_t index, Frame& frame) override;
+    std::string description() const override;
+
+    const std::vector<std::string>& files() const { return files_; }
+
+    /**
+     * @brief Nominal capture period for timestamps from file names (0 = none)
+     */
+    void set_frame_period(double frame_period_us) { frame_period_us_ = frame_period_us; }
+
+private:
+    std::string input_dir_;
+    std::vector<std::string> files_;
+    double frame_period_us_;
+};
+
+/**
+ * @brief Directory of packed RAW12/RAW14 dumps, sorted by file name
+ *
+ * Each file holds one or more frames back to back with no header (the
+ * geometry comes from the configuration). Frames are read and unpacked
+ * straight into the frame buffer. A file holding a single frame gets its
+ * timestamp from the sequence number in its name, as for PNG directories.
+ */
+class PackedDirectorySource : public FrameSource {
+public:
+    PackedDirectorySource(PackedFormat format, uint32_t width, uint32_t height)
+        : format_(format), width_(width), height_(height), frame_period_us_(0.0) {}
+
+    /**
+     * @brief Scan a directory for dumps
+     * @param input_dir Directory to scan
+     * @param prefix Only files starting with this prefix
+     * @param extension Only files with this extension
+     * @return true if at least one frame was found
+     */
+    bool open(const std::string& input_dir, const std::string& prefix = "jenoptik_",
+              const std::string& extension = ".raw");
+
+    size_t frame_count() const override { return frames_.size(); }
+    bool read_frame(size_t index, Frame& frame) override;
+    std::string description() const override;
+
+    /**
+     * @brief Nominal capture period for timestamps from file names (0 = none)
+     */
+    void set_frame_period(double frame_period_us) { frame_period_us_ = frame_period_us; }
+
+private:
+    struct FrameLocation {
+        size_t file;
+        uint64_t offset;
+        bool single;   // Only frame of its file
+    };
+
+    PackedFormat format_;
+    uint32_t width_;
+    uint32_t height_;
+    double frame_period_us_;
+    std::string input_dir_;
+    std::vector<std::string> files_;
+    std::vector<FrameLocation> frames_;
+    std::vector<uint8_t> packed_;   // Packed bytes of one frame, reused
+};
+
+/**
+ * @brief Frames already held in memory (not owned)
+ */
+class MemoryFrameSource : public FrameSource {
+public:
+    explicit MemoryFrameSource(const std::vector<Frame>& frames) : frames_(frames) {}
+
+    size_t frame_count() const override { return frames_.size(); }
+    bool read_frame(size_t index, Frame& frame) override;
+    std::string description() const override;
+
+private:
+    const std::vector<Frame>& frames_;
+};
+
+/**
+ * @brief Frames rendered on demand by the synthetic generator
+ */
+class SyntheticFrameSource : public FrameSource {
+public:
+    explicit SyntheticFrameSource(const SyntheticConfig& config) : sequence_(config) {}
+
+    size_t frame_count() const override { return sequence_.frame_count(); }
+    bool read_frame(size_t index, Frame& frame) override;
+    std::string description() const override;
+
+private:
+    SyntheticSequence sequence_;
+};
+
+} // namespace lwir
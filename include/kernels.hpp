@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "residual.hpp"
+
+namespace lwir {
+
+/**
+ * @file kernels.hpp
+ * @brief Residual kernels specialized for fixed sensor geometry
+ *
+ * The fleet uses two resolutions (640x512 and 1024x768) and almost always
+ * fp_bits = 8. For those, the residual, quantize, dequantize and reconstruct
+ * kernels are instantiated with the pixel count and the fixed-point shift as
+ * compile-time constants. The compiler then drops the loop tails and emits
+ * immediate shifts. With fp_bits fixed the quantizer numerator has a known
+ * bound, so the per-pixel division by Q_fixed becomes a multiply by a
+ * reciprocal computed once per frame, and that loop vectorizes.
+ *
+ * Every variant produces exactly the output of the generic kernels in
+ * residual.hpp. If it is called with a pixel count or fp_bits it was not
+ * built for, it falls back to the generic kernel.
+ */
+
+/**
+ * Table of kernel entry points for one geometry / fixed-point setting
+ */
+struct ResidualKernels {
+    const char* name;   // "640x512/fp8", "1024x768", "fp8", "generic"
+
+    void (*compute_residual)(const uint16_t* __restrict current,
+                             const uint16_t* __restrict previous,
+                             int16_t* __restrict residual,
+                             size_t pixel_count);
+
+    void (*quantize_residual)(const int16_t* __restrict residual,
+                              int16_t* __restrict quantized,
+                              size_t pixel_count,
+                              const QuantizationParams& params);
+
+    void (*dequantize_residual)(const int16_t* __restrict quantized,
+                                int16_t* __restrict reconstructed,
+                                size_t pixel_count,
+                                const QuantizationParams& params);
+
+    void (*reconstruct_frame)(const int16_t* __restrict residual,
+                              const uint16_t* __restrict previous,
+                              uint16_t* __restrict reconstructed,
+                              size_t pixel_count);
+};
+
+/**
+ * The generic kernels from residual.hpp
+ */
+const ResidualKernels& generic_residual_kernels();
+
+/**
+ * Best kernels for a frame geometry and fixed-point setting
+ * (generic when neither the size nor fp_bits has a specialization)
+ */
+const ResidualKernels& select_residual_kernels(uint32_t width, uint32_t height, uint32_t fp_bits);
+
+/**
+ * @brief Caches the kernel selection for a stream
+ *
+ * The selection is made on the first frame and again only when the
+ * geometry or fp_bits changes (e.g. at a keyframe after a config reload).
+ */
+class KernelDispatch {
+public:
+    KernelDispatch() : kernels_(nullptr), width_(0), height_(0), fp_bits_(0) {}
+
+    const ResidualKernels& get(uint32_t width, uint32_t height, uint32_t fp_bits)
+    {
+        if (!kernels_ || width != width_ || height != height_ || fp_bits != fp_bits_) {
+            kernels_ = &select_residual_kernels(width, height, fp_bits);
+            width_ = width;
+            height_ = height;
+            fp_bits_ = fp_bits;
+        }
+        return *kernels_;
+    }
+
+private:
+    const ResidualKernels* kernels_;
+    uint32_t width_;
+    uint32_t height_;
+    uint32_t fp_bits_;
+};
+
+} // namespace lwir
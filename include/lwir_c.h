@@ -0,0 +1,197 @@
+/**
+ * @file lwir_c.h
+ * @brief Stable C ABI for the LWIR encoder and decoder
+ *
+ * For callers that cannot use the C++ API (Python via ctypes, Rust, ...).
+ * Only plain C types cross the boundary:
+ *
+ * - Encoders and decoders are opaque handles.
+ * - Every call that can fail returns an lwir_status code.
+ * - Encoded records and decoded pixels are written into caller buffers.
+ *   The library never returns memory the caller has to free.
+ * - Each handle owns its working memory. It is sized on the first frame
+ *   and reused afterwards.
+ *
+ * Copies made per frame:
+ *
+ * - Encode: rows with no padding (stride_bytes == width * 2) are read in
+ *   place. Padded rows are packed once into the encoder's working buffer,
+ *   because prediction, statistics and JPEG-LS all read packed rows. The
+ *   JPEG-LS payload is coded into the encoder's own buffer, and then copied
+ *   once into out, behind the record header.
+ * - Decode: the payload is copied out of the record into the decoder's
+ *   buffer. The frame is reconstructed into the decoder's reference, which
+ *   it keeps for the next residual frame. From there it is written to the
+ *   caller's rows once.
+ *
+ * Encoded output uses the same record layout as the .lwir files written by
+ * lwir_compress: a 50-byte header followed by the JPEG-LS payload.
+ *
+ * A handle must not be used from two threads at once; separate handles
+ * are independent.
+ *
+ *   lwir_config config;
+ *   lwir_config_init(&config);
+ *   lwir_encoder* enc = NULL;
+ *   lwir_encoder_create(&config, &enc);
+ *   size_t cap = lwir_record_bound(640, 512), used = 0;
+ *   lwir_encoder_encode(enc, pixels, 640, 512, 640 * 2, ts, buf, cap, &used, NULL);
+ *   lwir_encoder_destroy(enc);
+ */
+
+#ifndef LWIR_C_H
+#define LWIR_C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+    #define LWIR_API __declspec(dllexport)
+#else
+    #define LWIR_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Incremented on any incompatible change to this header */
+#define LWIR_C_API_VERSION 2
+
+typedef enum lwir_status {
+    LWIR_OK = 0,
+    LWIR_ERROR_INVALID_ARGUMENT = 1,   /* NULL handle/pointer, bad size or stride */
+    LWIR_ERROR_INVALID_CONFIG = 2,     /* Config struct or YAML rejected */
+    LWIR_ERROR_BUFFER_TOO_SMALL = 3,   /* Output capacity below the required size */
+    LWIR_ERROR_ENCODE_FAILED = 4,
+    LWIR_ERROR_DECODE_FAILED = 5,
+    LWIR_ERROR_NO_REFERENCE = 6,       /* Residual frame without a preceding keyframe */
+    LWIR_ERROR_TRUNCATED = 7,          /* Record shorter than its header announces */
+    LWIR_ERROR_OUT_OF_MEMORY = 8,
+    LWIR_ERROR_INTERNAL = 9
+} lwir_status;
+
+/**
+ * Encoder settings (subset of the YAML configuration)
+ *
+ * Always initialise with lwir_config_init(); struct_size lets newer
+ * libraries accept structs from older callers.
+ */
+typedef struct lwir_config {
+    uint32_t struct_size;
+    uint32_t gop_period;             /* Keyframe every N frames */
+    uint32_t keyframe_near;          /* NEAR for keyframes (0 = lossless) */
+    uint32_t residual_near;          /* NEAR for residuals */
+    uint32_t dead_zone_T;            /* Dead-zone threshold (DN) */
+    double quant_Q;                  /* Quantization step (DN) */
+    uint32_t fp_bits;                /* Fixed-point fractional bits for Q */
+    int32_t enable_12bit_mode;       /* Map keyframes to 12 bits */
+    int32_t enable_decision_stats;   /* Residual statistics drive keyframe decisions */
+    double frame_deadline_ms;        /* Per-frame budget (0 = disabled, the default; misses go to stderr) */
+    int32_t overload_enable;         /* Degrade quality when over budget */
+} lwir_config;
+
+/**
+ * Per-frame metadata returned by encode, decode and peek
+ */
+typedef struct lwir_frame_info {
+    uint32_t width;
+    uint32_t height;
+    uint32_t frame_index;
+    uint64_t timestamp;
+    int32_t is_keyframe;
+    uint32_t payload_bytes;          /* JPEG-LS payload (record = header + payload) */
+    uint32_t record_bytes;
+    int32_t is_repeat;               /* No payload: decodes to the previous frame (API 2) */
+} lwir_frame_info;
+
+typedef struct lwir_encoder lwir_encoder;
+typedef struct lwir_decoder lwir_decoder;
+
+/** Library ABI version (LWIR_C_API_VERSION the library was built with) */
+LWIR_API uint32_t lwir_api_version(void);
+
+/** Static description of a status code (never NULL) */
+LWIR_API const char* lwir_status_string(lwir_status status);
+
+/** Fill a config with the library defaults, without a frame deadline */
+LWIR_API void lwir_config_init(lwir_config* config);
+
+/** Record size that is always sufficient for a frame of this size */
+LWIR_API size_t lwir_record_bound(uint32_t width, uint32_t height);
+
+/* ------------------------------------------------------------------------ */
+/* Encoder                                                                  */
+/* ------------------------------------------------------------------------ */
+
+LWIR_API lwir_status lwir_encoder_create(const lwir_config* config, lwir_encoder** encoder);
+
+/**
+ * Create an encoder from YAML text (same keys as the configuration file;
+ * input_dir/output_dir are not needed). As in the file, frame_deadline_ms
+ * defaults to 33.3 when absent; set it to 0 to disable deadline tracking.
+ * @param profile Profile name under "profiles", or NULL for the root
+ */
+LWIR_API lwir_status lwir_encoder_create_from_yaml(const char* yaml, const char* profile,
+                                                   lwir_encoder** encoder);
+
+LWIR_API void lwir_encoder_destroy(lwir_encoder* encoder);
+
+/**
+ * Encode the next frame of the stream
+ *
+ * Frames are numbered in call order. Keyframe decisions, rate control and
+ * the overload ladder are applied as in lwir_compress.
+ * @param pixels First sample of the first row
+ * @param stride_bytes Distance between rows in bytes (>= width * 2, even)
+ * @param timestamp Capture time, stored in the record
+ * @param out Destination for the record
+ * @param capacity Size of out; lwir_record_bound() always suffices
+ * @param written Bytes written to out
+ * @param info Optional frame metadata
+ */
+LWIR_API lwir_status lwir_encoder_encode(lwir_encoder* encoder,
+                                         const uint16_t* pixels, uint32_t width, uint32_t height,
+                                         size_t stride_bytes, uint64_t timestamp,
+                                         uint8_t* out, size_t capacity, size_t* written,
+                                         lwir_frame_info* info);
+
+/** Forget the reference; the next frame is encoded as a keyframe */
+LWIR_API lwir_status lwir_encoder_reset(lwir_encoder* encoder);
+
+/* ------------------------------------------------------------------------ */
+/* Decoder                                                                  */
+/* ------------------------------------------------------------------------ */
+
+LWIR_API lwir_status lwir_decoder_create(lwir_decoder** decoder);
+
+LWIR_API void lwir_decoder_destroy(lwir_decoder* decoder);
+
+/**
+ * Read a record header without decoding (size the output buffer)
+ */
+LWIR_API lwir_status lwir_peek(const uint8_t* record, size_t size, lwir_frame_info* info);
+
+/**
+ * Decode one record into caller memory
+ *
+ * Records must be passed in stream order, starting at a keyframe.
+ * @param record Record bytes (header + payload)
+ * @param pixels Destination for the first sample of the first row
+ * @param stride_bytes Distance between destination rows in bytes
+ * @param capacity Size of the destination in bytes
+ * @param info Optional frame metadata
+ */
+LWIR_API lwir_status lwir_decoder_decode(lwir_decoder* decoder,
+                                         const uint8_t* record, size_t size,
+                                         uint16_t* pixels, size_t stride_bytes, size_t capacity,
+                                         lwir_frame_info* info);
+
+/** Forget the reference (e.g. after seeking to another keyframe) */
+LWIR_API lwir_status lwir_decoder_reset(lwir_decoder* decoder);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LWIR_C_H */
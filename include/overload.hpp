@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "config.hpp"
+
+namespace lwir {
+
+/**
+ * @file overload.hpp
+ * @brief Quality-degradation ladder for CPU overload
+ *
+ * When the flight computer is shared with other workloads the encoder can
+ * fall behind the camera. The overload controller watches deadline slack
+ * and queue depth and walks down a configured ladder of cheaper settings,
+ * then walks back up once the load has cleared. Steps are cumulative:
+ * level N applies the first N steps of the ladder.
+ */
+
+/**
+ * Degradation steps, in the order they are usually applied
+ */
+enum class OverloadStep {
+    SKIP_VERIFY,      // Skip verification decode of lossless keyframes
+    RAISE_QT,         // Q *= overload_q_scale, T += overload_t_step
+    EXTEND_GOP,       // gop_period *= overload_gop_scale
+    RAISE_NEAR,       // residual_near += overload_near_step (not from 0, see apply_level)
+    SUBSAMPLE_STATS   // Decision statistics on every Nth pixel
+};
+
+/**
+ * Get YAML name of an overload step
+ */
+const char* overload_step_name(OverloadStep step);
+
+/**
+ * Parse YAML name of an overload step
+ * @return true if name is a known step
+ */
+bool parse_overload_step(const std::string& name, OverloadStep& step);
+
+/**
+ * Encoder settings in effect at a ladder level
+ */
+struct EncodeKnobs {
+    bool verify_decode;
+    uint32_t residual_near;
+    double quant_Q;
+    uint32_t dead_zone_T;
+    uint32_t gop_period;
+    uint32_t stats_stride;
+
+    EncodeKnobs()
+        : verify_decode(true), residual_near(10), quant_Q(2.0),
+          dead_zone_T(2), gop_period(60), stats_stride(1) {}
+};
+
+/**
+ * A single ladder transition (logged in stats)
+ */
+struct OverloadEvent {
+    uint32_t frame_index;
+    uint32_t from_level;
+    uint32_t to_level;
+    OverloadStep step;       // Step applied (down) or removed (up)
+    double slack_ms;
+    uint32_t queue_depth;
+};
+
+/**
+ * Overload controller
+ *
+ * Steps down one level when slack drops below overload_slack_low_ms or the
+ * queue reaches overload_queue_high, then waits overload_cooldown_frames
+ * before stepping again so the previous step can take effect. Steps back up
+ * one level after overload_hold_frames consecutive frames with slack above
+ * overload_slack_high_ms and an empty queue.
+ */
+class OverloadController {
+public:
+    explicit OverloadController(const CompressionConfig& config);
+
+    /**
+     * Feed the outcome of a finished frame
+     * @param frame_index Frame that just completed
+     * @param slack_ms Deadline slack of that frame (ignored if no deadline)
+     * @param queue_depth Frames waiting behind it
+     * @return true if the level changed
+     */
+    bool observe(uint32_t frame_index, double slack_ms, uint32_t queue_depth);
+
+    /**
+     * Adopt new base settings and step sizes (config reload)
+     *
+     * The current level is kept; its knobs are recomputed from the new
+     * base. The ladder itself and overload_enable are not reloadable.
+     */
+    void reconfigure(const CompressionConfig& config);
+
+    bool enabled() const { return enabled_; }
+    uint32_t level() const { return level_; }
+    uint32_t max_level() const { return static_cast<uint32_t>(ladder_.size()); }
+
+    /**
+     * Settings for the current level
+     */
+    const EncodeKnobs& knobs() const { return knobs_; }
+
+    const std::vector<OverloadEvent>& events() const { return events_; }
+
+    /**
+     * Print ladder summary to stdout
+     */
+    void print_summary() const;
+
+    /**
+     * Export ladder usage and transitions as a JSON object
+     * @param indent Indentation prefix for nested lines
+     */
+    std::string to_json(const std::string& indent = "  ") const;
+
+private:
+    CompressionConfig config_;
+    std::vector<OverloadStep> ladder_;
+    bool enabled_;
+    bool use_slack_;
+    uint32_t level_;
+    uint32_t cooldown_;
+    uint32_t clear_frames_;
+    EncodeKnobs knobs_;
+    std::vector<uint64_t> frames_at_level_;
+    std::vector<OverloadEvent> events_;
+
+    void apply_level();
+};
+
+} // namespace lwir
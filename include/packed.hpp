@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace lwir {
+
+/**
+ * @file packed.hpp
+ * @brief Unpacking of MIPI CSI-2 packed RAW12 / RAW14 sensor data
+ *
+ * Packed cores send the high bits of each pixel as whole bytes, followed by
+ * a byte (or bytes) collecting the low bits of the group:
+ *
+ *   RAW12: 2 pixels in 3 bytes   P0[11:4] P1[11:4] P1[3:0]P0[3:0]
+ *   RAW14: 4 pixels in 7 bytes   P0[13:6] P1[13:6] P2[13:6] P3[13:6]
+ *                                P1[1:0]P0[5:0] P2[3:0]P1[5:2] P3[5:0]P2[5:4]
+ *
+ * Unpacking writes the 16-bit samples the encoder takes (values stay in
+ * 12 / 14 bits), one pass over the packed bytes.
+ */
+
+/**
+ * Packed pixel formats
+ */
+enum class PackedFormat {
+    RAW12,
+    RAW14
+};
+
+/**
+ * Parse a packed format name ("raw12", "raw14")
+ * @return false if the name is unknown
+ */
+bool parse_packed_format(const std::string& name, PackedFormat& format);
+
+/**
+ * Pixels per packed group (2 for RAW12, 4 for RAW14)
+ */
+size_t packed_group_pixels(PackedFormat format);
+
+/**
+ * Bytes per packed group (3 for RAW12, 7 for RAW14)
+ */
+size_t packed_group_bytes(PackedFormat format);
+
+/**
+ * Bytes of a packed frame
+ * @return 0 if width is not a whole number of groups
+ */
+size_t packed_frame_bytes(PackedFormat format, uint32_t width, uint32_t height);
+
+/**
+ * Unpack RAW12 to 16-bit samples
+ * @param src Packed bytes (pixel_count * 3 / 2)
+ * @param dst Unpacked samples
+ * @param pixel_count Number of pixels (multiple of 2)
+ */
+void unpack_raw12(const uint8_t* src, uint16_t* dst, size_t pixel_count);
+
+/**
+ * Unpack RAW14 to 16-bit samples
+ * @param src Packed bytes (pixel_count * 7 / 4)
+ * @param dst Unpacked samples
+ * @param pixel_count Number of pixels (multiple of 4)
+ */
+void unpack_raw14(const uint8_t* src, uint16_t* dst, size_t pixel_count);
+
+/**
+ * Unpack in the given format
+ */
+void unpack_pixels(PackedFormat format, const uint8_t* src, uint16_t* dst, size_t pixel_count);
+
+/**
+ * Pack 16-bit samples (captures for tests and tools; high bits are dropped)
+ * @param src Samples
+ * @param dst Packed bytes (pixel_count / group pixels * group bytes)
+ * @param pixel_count Number of pixels (whole groups)
+ */
+void pack_pixels(PackedFormat format, const uint16_t* src, uint8_t* dst, size_t pixel_count);
+
+} // namespace lwir
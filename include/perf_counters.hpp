@@ -0,0 +1,192 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <chrono>
+
+namespace lwir {
+
+/**
+ * @file perf_counters.hpp
+ * @brief Hardware performance counter sampling around hot kernels
+ *
+ * Wraps perf_event_open(2) to count cycles, instructions, cache misses and
+ * branch misses per encoder stage, split by frame type. When counters are
+ * unavailable (non-Linux, perf_event_paranoid, containers, VMs without a
+ * PMU) the profiler falls back to wall time only.
+ */
+
+/**
+ * Instrumented encoder stages
+ */
+enum class KernelStage {
+    RANGE_MAP,       // compute_range_map + map_to_12bit
+    RESIDUAL,        // compute_residual
+    QUANTIZE,        // quantize_residual + bias to unsigned
+    CHARLS_ENCODE,   // JPEG-LS encode
+    CHARLS_DECODE,   // JPEG-LS decode (closed loop / verification)
+    RECONSTRUCT,     // dequantize + add to reference / inverse map
+    COUNT
+};
+
+static constexpr size_t KERNEL_STAGE_COUNT = static_cast<size_t>(KernelStage::COUNT);
+
+/**
+ * Frame type the counters are attributed to
+ */
+enum class FrameKind {
+    KEYFRAME,
+    RESIDUAL,
+    COUNT
+};
+
+static constexpr size_t FRAME_KIND_COUNT = static_cast<size_t>(FrameKind::COUNT);
+
+/**
+ * Get printable name of a kernel stage
+ */
+const char* kernel_stage_name(KernelStage stage);
+
+/**
+ * Counter values for one or more stage invocations
+ */
+struct PerfSample {
+    uint64_t cycles;
+    uint64_t instructions;
+    uint64_t cache_misses;
+    uint64_t branch_misses;
+    double wall_ms;
+
+    PerfSample()
+        : cycles(0), instructions(0), cache_misses(0), branch_misses(0), wall_ms(0.0) {}
+
+    void add(const PerfSample& other);
+};
+
+/**
+ * Group of hardware counters for the calling thread
+ */
+class PerfCounters {
+public:
+    enum Counter { CYCLES, INSTRUCTIONS, CACHE_MISSES, BRANCH_MISSES, NUM_COUNTERS };
+
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    /**
+     * Open the counter group
+     * @return true if at least the cycle counter is available
+     */
+    bool open();
+
+    /**
+     * Close all counters
+     */
+    void close();
+
+    bool available() const { return fds_[CYCLES] >= 0; }
+    bool has_counter(Counter c) const { return fds_[c] >= 0; }
+
+    /**
+     * Reason counters are unavailable (empty if available)
+     */
+    const std::string& unavailable_reason() const { return reason_; }
+
+    /**
+     * Reset and enable the group
+     */
+    void start();
+
+    /**
+     * Disable the group and read the counts accumulated since start()
+     */
+    PerfSample stop();
+
+private:
+    int fds_[NUM_COUNTERS];
+    uint64_t ids_[NUM_COUNTERS];
+    std::string reason_;
+    std::chrono::steady_clock::time_point start_time_;
+};
+
+/**
+ * Per-stage, per-frame-type counter aggregation
+ */
+class PerfProfiler {
+public:
+    PerfProfiler();
+
+    /**
+     * Try to open hardware counters
+     * @return true if hardware counters are available (wall time is always recorded)
+     */
+    bool open();
+
+    bool hardware_available() const { return counters_.available(); }
+
+    /**
+     * Declare the type and size of the frame that following scopes belong to
+     */
+    void begin_frame(FrameKind kind, size_t pixel_count);
+
+    /**
+     * Start/stop a stage measurement (use PerfScope instead)
+     */
+    void start_stage();
+    void stop_stage(KernelStage stage);
+
+    /**
+     * Totals for one stage and frame type
+     */
+    const PerfSample& total(FrameKind kind, KernelStage stage) const {
+        return totals_[static_cast<size_t>(kind)][static_cast<size_t>(stage)];
+    }
+
+    /**
+     * Print IPC and misses per pixel table to stdout
+     */
+    void print_report() const;
+
+    /**
+     * Export counters as a JSON object
+     * @param indent Indentation prefix for nested lines
+     */
+    std::string to_json(const std::string& indent = "  ") const;
+
+private:
+    PerfCounters counters_;
+    FrameKind kind_;
+    PerfSample totals_[FRAME_KIND_COUNT][KERNEL_STAGE_COUNT];
+    uint64_t calls_[FRAME_KIND_COUNT][KERNEL_STAGE_COUNT];
+    uint64_t frames_[FRAME_KIND_COUNT];
+    uint64_t pixels_[FRAME_KIND_COUNT];
+};
+
+/**
+ * RAII stage measurement; a no-op when profiler is null
+ */
+class PerfScope {
+public:
+    PerfScope(PerfProfiler* profiler, KernelStage stage)
+        : profiler_(profiler), stage_(stage)
+    {
+        if (profiler_) profiler_->start_stage();
+    }
+
+    ~PerfScope()
+    {
+        if (profiler_) profiler_->stop_stage(stage_);
+    }
+
+    PerfScope(const PerfScope&) = delete;
+    PerfScope& operator=(const PerfScope&) = delete;
+
+private:
+    PerfProfiler* profiler_;
+    KernelStage stage_;
+};
+
+} // namespace lwir
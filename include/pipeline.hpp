@@ -3,22 +3,58 @@
 #include <string>
 #include <vector>
 #include <cstdint>
-#include <png.h>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include "config.hpp"
 #include "frame.hpp"
+#include "frame_source.hpp"
 #include "encoder.hpp"
+#include "deadline.hpp"
+#include "overload.hpp"
+#include "perf_counters.hpp"
+#include "config_reload.hpp"
+#include "worker_pool.hpp"
+#include "archive.hpp"
+#include "segment.hpp"
+#include "timeline.hpp"
 
 namespace lwir {
 
+/**
+ * @brief Destination for encoded frames in place of per-frame files
+ * @return false to abort the session
+ */
+using FrameSink = std::function<bool(const CompressedFrame& frame, const FrameStats& stats)>;
+
+/**
+ * @brief Open the input configured by input_dir and input_format
+ *        (PNG directory, packed raw12 / raw14 dumps or TIFF stacks)
+ * @param prefetch_pool Decodes compressed TIFF pages ahead (must outlive the source), or nullptr
+ * @return nullptr if the input cannot be opened
+ */
+std::unique_ptr<FrameSource> open_input_source(const CompressionConfig& config, WorkerPool* prefetch_pool = nullptr);
+
 /**
  * @brief Compression pipeline orchestrator
  *
  * Manages the complete compression workflow:
- * - Load frames from input directory
+ * - Load frames from a frame source (PNG directory by default)
  * - Apply decision logic (keyframe vs residual)
  * - Encode with CharLS
  * - Track statistics and performance metrics
+ * - Monitor the per-frame real-time deadline
  * - Write compressed output
+ *
+ * With encode_workers > 0, frames whose reference does not depend on the
+ * JPEG-LS output (NEAR=0 residuals, lossless keyframes without verification)
+ * are split: prediction, quantization and the reference update run inline,
+ * and the JPEG-LS coding runs on a worker while the next frames are
+ * prepared. Frames are still written in order. A frame's compressed size
+ * reaches the decision engine exactly encode_workers frames later, so
+ * the output does not depend on how the workers are scheduled.
  */
 class CompressionPipeline {
 public:
@@ -34,6 +70,132 @@ public:
      */
     bool run();
 
+    /**
+     * @brief Run compression on all frames of a source (or on the configured frame range)
+     * @param source Frame source (PNG directory, memory, synthetic)
+     * @return true if successful, false otherwise
+     */
+    bool run(FrameSource& source);
+
+    /**
+     * @brief Decide, encode and write one frame (live / push-driven use)
+     *
+     * Frames must be passed in capture order. The deadline is measured from
+     * arrival, so time the frame spent queued counts as load time. With
+     * encode_workers > 0 the frame may be written (or passed to the sink)
+     * during a later call or in finish().
+     * @param frame Input samples, read during the call only (frame_index and
+     *              timestamp must be set). Padded rows are packed once.
+     * @param arrival Time the frame became available to the pipeline
+     * @param queue_depth Frames waiting behind this one (overload ladder input)
+     * @return true if successful, false otherwise
+     */
+    bool process_frame(const FrameView& frame, DeadlineMonitor::Clock::time_point arrival,
+                       uint32_t queue_depth = 0);
+
+    /**
+     * @brief Start a frame that arrives in row bands (sensor readout order)
+     *
+     * The frame is decided up front, then push_rows() takes its rows top to
+     * bottom as they are read out. Residual bands are predicted, quantized
+     * and reconstructed on arrival; the JPEG-LS coding of the whole frame
+     * still runs after the last band (there are no per-stripe payloads), so
+     * only the residual stages overlap the readout. The output is identical to process_frame() on the
+     * whole frame, except that the decision cannot use residual statistics
+     * (as with enable_decision_stats off). Banded frames are never coded on
+     * encode workers.
+     * @param arrival Time the first rows became available
+     * @return false if the frame cannot start (the previous one is incomplete)
+     */
+    bool begin_frame(uint32_t width, uint32_t height, uint32_t frame_index, uint64_t timestamp,
+                     DeadlineMonitor::Clock::time_point arrival, uint32_t queue_depth = 0);
+
+    /**
+     * @brief Next rows of the frame started with begin_frame()
+     *
+     * The band completing the frame also JPEG-LS codes the whole frame and
+     * writes it.
+     * @param y0 First row of the band (bands are contiguous and in order)
+     * @param rows Samples of the first row of the band
+     * @param row_count Rows in the band
+     * @param stride Samples from one row to the next (0 = width)
+     * @return false on an out-of-order band or an encode failure
+     */
+    bool push_rows(uint32_t y0, const uint16_t* rows, uint32_t row_count, size_t stride = 0);
+
+    /**
+     * @brief Write (or pass to the sink) every frame still being entropy coded
+     *
+     * Their sizes still reach the decision engine encode_workers frames
+     * after they were passed in, so draining does not change the output.
+     * @return false if a frame failed to encode or write
+     */
+    bool drain();
+
+    /**
+     * @brief Finish a push-driven session: summary and statistics
+     * @return true if at least one frame was processed
+     */
+    bool finish();
+
+    /**
+     * @brief Deliver encoded frames to a sink instead of writing files
+     *
+     * The sink runs in the write stage, on the thread calling process_frame
+     * (or finish, for the last frames when encode_workers > 0).
+     * Statistics are still written to output_dir unless it is empty.
+     */
+    void set_frame_sink(FrameSink sink) { sink_ = std::move(sink); }
+
+    /**
+     * @brief Called as each segment of segmented output is closed
+     *
+     * Runs in the write stage, once the segment is listed as complete in
+     * the manifest (e.g. to queue it for downlink).
+     */
+    void set_segment_callback(SegmentCallback callback) { segment_writer_.set_completion_callback(std::move(callback)); }
+
+    /**
+     * @brief Pick up reloaded configurations between frames
+     *
+     * Checked at the start of every frame; see config_reload.hpp for which
+     * parameters apply immediately and which wait for the next keyframe.
+     * @param reloader Reloader to poll (must outlive the session), or nullptr
+     */
+    void set_config_reloader(ConfigReloader* reloader) { reloader_ = reloader; }
+
+    /**
+     * @brief Configuration currently in effect
+     */
+    const CompressionConfig& config() const { return config_; }
+
+    /**
+     * @brief Snapshot the encoder state after the last processed frame
+     *
+     * Written automatically to checkpoint_path when it is configured; call
+     * directly for on-demand snapshots (e.g. before a planned handover).
+     * @param path Checkpoint file (replaced atomically)
+     * @return true if successful, false otherwise
+     */
+    bool save_checkpoint(const std::string& path);
+
+    /**
+     * @brief Continue the session of a previous process from its checkpoint
+     *
+     * Restores the reference frame and decision state. When frames are
+     * written to output_dir, records written after the snapshot are decoded
+     * to bring the reference up to the last frame on disk, so the stream
+     * continues without a keyframe. Call before the first frame.
+     * @param path Checkpoint file
+     * @return false if there is no usable checkpoint (start a fresh session)
+     */
+    bool restore_checkpoint(const std::string& path);
+
+    /**
+     * @brief First frame index not yet encoded (after restore_checkpoint)
+     */
+    uint32_t resume_frame_index() const { return resume_index_; }
+
     /**
      * @brief Print compression summary statistics
      */
@@ -45,30 +207,159 @@ public:
      */
     void write_statistics(const std::string& output_path) const;
 
+    /**
+     * @brief Per-session totals and averages (valid after run)
+     */
+    const SessionStats& session_stats() const { return session_stats_; }
+
+    /**
+     * @brief Per-frame latency and deadline tracking
+     */
+    const DeadlineMonitor& deadline_monitor() const { return deadline_monitor_; }
+
 private:
     CompressionConfig config_;
 
     // Statistics
     size_t total_original_bytes_;
     size_t total_compressed_bytes_;
-    uint64_t total_encode_time_ms_;
+    double total_encode_time_ms_;
     uint32_t frames_processed_;
+    SessionStats session_stats_;
+
+    // Encoding state carried between frames
+    FrameDecisionEngine decision_engine_;
+    FrameEncoder encoder_;
+    bool session_started_;
+
+    // Capture timeline: frames dropped before each input frame
+    GapDetector gap_detector_;
+
+    // Real-time deadline tracking (arrival to write completion)
+    DeadlineMonitor deadline_monitor_;
+
+    // Overload degradation ladder
+    OverloadController overload_;
+
+    // Per-stage hardware counters (enable_perf_counters)
+    PerfProfiler profiler_;
+
+    // Optional destination replacing write_compressed_frame
+    FrameSink sink_;
+
+    // Serialized record, reused across frames
+    std::vector<uint8_t> record_buffer_;
+
+    // Header index of output_dir (index.lwidx), appended per written frame
+    ArchiveIndexWriter archive_index_;
+    bool index_enabled_;
+
+    // Rolling segment files in place of per-frame records (segmented_output)
+    SegmentWriter segment_writer_;
+
+    // Failover: scratch encoder for lossless reference snapshots, and the
+    // first frame a restored session still has to encode
+    FrameEncoder checkpoint_encoder_;
+    uint32_t resume_index_;
 
     /**
-     * @brief Load a single frame from PNG file
-     * @param png_path Path to 16-bit grayscale PNG
-     * @param frame Output frame structure
-     * @return true if successful, false otherwise
+     * @brief Write a checkpoint for the frame just encoded
+     */
+    bool write_checkpoint_after(const CompressedFrame& compressed, const std::string& path);
+
+    /**
+     * A frame between encode and write. With encode_workers > 0 its
+     * JPEG-LS payload may still be coded on a worker.
+     */
+    struct PendingFrame {
+        PreparedFrame prepared;                // prepared.frame is the record once done
+        FrameStats stats;                      // All but the compressed size
+        DeadlineMonitor::FrameTiming timing;   // Parked after the decide (or encode) stage
+        uint32_t queue_depth;
+        bool overlapped;                       // Coded on a worker
+        bool done;                             // Guarded by pending_mutex_
+        bool ok;
+    };
+
+    // Frames not yet written, oldest first; sizes of written frames not yet
+    // passed to the decision engine
+    std::deque<std::unique_ptr<PendingFrame>> pending_;
+    std::deque<std::pair<size_t, bool>> decision_updates_;
+    std::unique_ptr<PendingFrame> last_emitted_;
+    std::mutex pending_mutex_;
+    std::condition_variable pending_done_;
+
+    // Entropy coding workers; declared after the frames they code so they
+    // are joined first
+    std::unique_ptr<WorkerPool> entropy_pool_;
+
+    /**
+     * How a frame is encoded, fixed before its pixels are touched
+     */
+    struct FramePlan {
+        bool is_keyframe;
+        uint32_t residual_near;
+        QuantizationParams quant_params;
+        uint32_t frames_dropped;   // Capture gap before the frame
+        size_t original_bytes;
+    };
+
+    /**
+     * @brief Session start, config reload, gap handling and the frame decision
+     * @param frame Frame (data is null for a banded frame)
+     */
+    bool plan_frame(const FrameView& frame, DeadlineMonitor::Clock::time_point arrival, FramePlan& plan);
+
+    /**
+     * @brief Statistics, write (or hand-off to a worker) and checkpoint of an encoded frame
+     */
+    bool complete_frame(const FrameView& frame, const FramePlan& plan, std::unique_ptr<PendingFrame> pending,
+                        double encode_ms, uint32_t queue_depth);
+
+    /**
+     * @brief Write (or sink) the oldest pending frame, waiting for its payload
+     */
+    bool emit_next();
+
+    /**
+     * @brief Write frames and update the decision engine until at most `lag`
+     *        frames are unaccounted for (0 = everything, e.g. before a snapshot)
+     */
+    bool settle_pending(size_t lag);
+
+    // Hot reload: source of new configs and GOP-scoped changes still waiting
+    // for a keyframe
+    ConfigReloader* reloader_;
+    CompressionConfig gop_update_;
+    bool gop_update_pending_;
+
+    std::vector<uint16_t> input_staging_;   // Padded input rows, packed
+
+    // Frame arriving in row bands (begin_frame .. last push_rows)
+    bool band_active_;
+    FramePlan band_plan_;
+    uint32_t band_queue_depth_;
+    double band_encode_ms_;
+
+    /**
+     * @brief Apply a reloaded config's frame-scoped parameters, stage the rest
+     */
+    void poll_config_reload(uint32_t frame_index);
+
+    /**
+     * @brief Apply staged GOP-scoped parameters (called for keyframes)
      */
-    bool load_frame_from_png(const std::string& png_path, Frame& frame);
+    void apply_gop_update(uint32_t frame_index);
 
     /**
      * @brief Write compressed frame to binary file
      * @param frame Compressed frame data
      * @param output_dir Output directory path
+     * @param frames_dropped Capture gap before the frame (archive index)
      * @return true if successful, false otherwise
      */
-    bool write_compressed_frame(const CompressedFrame& frame, const std::string& output_dir);
+    bool write_compressed_frame(const CompressedFrame& frame, const std::string& output_dir,
+                                uint32_t frames_dropped);
 };
 
 } // namespace lwir
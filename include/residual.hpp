@@ -107,6 +107,26 @@ inline void add_residual_to_reference(
     reconstruct_frame(residual, reference, output, pixel_count);
 }
 
+/**
+ * 64-bit hash of a frame's samples (exact-repeat detection)
+ *
+ * Four independent multiply-rotate lanes over 64-bit words, so the loop is
+ * limited by memory bandwidth rather than by one serial dependency chain
+ */
+uint64_t hash_samples(const uint16_t* data, size_t pixel_count);
+
+/**
+ * True if |current - previous| <= dead_zone_T for every pixel, i.e. the
+ * residual quantizes to zero everywhere. Stops at the first block that
+ * leaves the dead zone.
+ */
+bool residual_within_dead_zone(
+    const uint16_t* __restrict current,
+    const uint16_t* __restrict previous,
+    size_t pixel_count,
+    uint32_t dead_zone_T
+);
+
 /**
  * Compute error statistics between original and reconstructed
  */
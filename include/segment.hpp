@@ -0,0 +1,236 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "archive.hpp"
+#include "frame.hpp"
+
+namespace lwir {
+
+/**
+ * @file segment.hpp
+ * @brief Rolling segment files in place of one record file per frame
+ *
+ * In segmented output, frame records are appended back to back to
+ * segment_NNNNNN.lwseg. The writer closes a segment and starts the next one
+ * at the first keyframe after a limit is reached (GOPs, bytes or capture
+ * time), so every segment written in one session starts with a keyframe.
+ * Each segment has its own header index, segment_NNNNNN.lwidx, in the
+ * archive index format (archive.hpp). A record's offset in the segment is
+ * the sum of the record sizes listed before it.
+ *
+ * segments.json lists the segments with their frame and time ranges:
+ *
+ *   {
+ *     "segments": [
+ *       {"sequence": 0, "file": "segment_000000.lwseg", "index": "segment_000000.lwidx",
+ *        "first_frame": 0, "last_frame": 179, "frames": 180, "keyframes": 3,
+ *        "first_timestamp": 0, "last_timestamp": 5966666, "bytes": 9437184, "complete": true},
+ *       ...
+ *     ]
+ *   }
+ *
+ * The manifest is replaced atomically when a segment starts (listed with
+ * "complete": false) and when it is closed, so a watcher on the manifest
+ * sees each finished segment without waiting for the end of the flight.
+ * Ranges of a segment still open (or cut short by a crash) are recovered
+ * from its index and records when the archive is opened.
+ *
+ * Ring storage (a disk budget) keeps the most recent segments within a
+ * fixed number of bytes. Reclaiming the oldest segment first rewrites the
+ * manifest without it (synced, then renamed), and only then deletes its
+ * files. After a power loss the manifest therefore never lists a deleted
+ * segment. Files it no longer lists are removed when the directory is
+ * opened again.
+ */
+
+static constexpr const char* SEGMENT_MANIFEST_FILE = "segments.json";
+
+/**
+ * Segment file name ("segment_000003.lwseg")
+ */
+std::string segment_file_name(uint32_t sequence);
+
+/**
+ * Header index of a segment ("segment_000003.lwidx")
+ */
+std::string segment_index_name(uint32_t sequence);
+
+/**
+ * When to start the next segment (0 = no limit of that kind)
+ */
+struct SegmentLimits {
+    uint32_t gops;           // Keyframes per segment
+    uint64_t bytes;          // Record bytes per segment
+    uint64_t duration_us;    // Capture time per segment (frame timestamps in us)
+    uint64_t budget_bytes;   // All segments together, oldest reclaimed first (0 = keep all)
+
+    SegmentLimits() : gops(0), bytes(0), duration_us(0), budget_bytes(0) {}
+
+    bool any() const { return gops > 0 || bytes > 0 || duration_us > 0; }
+};
+
+/**
+ * One segment as listed in the manifest
+ */
+struct SegmentInfo {
+    uint32_t sequence;
+    uint32_t first_frame;
+    uint32_t last_frame;
+    uint32_t frame_count;
+    uint32_t keyframes;
+    uint64_t first_timestamp;
+    uint64_t last_timestamp;
+    uint64_t bytes;
+    bool complete;
+
+    SegmentInfo() : sequence(0), first_frame(0), last_frame(0), frame_count(0), keyframes(0),
+                    first_timestamp(0), last_timestamp(0), bytes(0), complete(false) {}
+};
+
+/**
+ * Read segments.json of an archive directory
+ * @return false if the manifest is missing or malformed
+ */
+bool read_segment_manifest(const std::string& dir, std::vector<SegmentInfo>& segments);
+
+/**
+ * Write segments.json of an archive directory (synced and replaced atomically)
+ */
+bool write_segment_manifest(const std::string& dir, const std::vector<SegmentInfo>& segments);
+
+/**
+ * @brief Called with each segment once it is closed and listed as complete
+ */
+using SegmentCallback = std::function<void(const std::string& dir, const SegmentInfo& segment)>;
+
+/**
+ * @brief Appends frame records to rolling segment files
+ *
+ * Opening a directory that already has segments (a resumed session)
+ * continues the numbering after them; the first segment of the new session
+ * may then start mid-GOP, with its reference in the previous segment.
+ *
+ * With a disk budget, room for a full segment (limits.bytes) is reclaimed
+ * and preallocated when it starts. A segment that runs past that size
+ * (rollover waits for a keyframe) reclaims more as it grows. The segment
+ * being written is never reclaimed, so a budget below two segments cannot
+ * be kept.
+ */
+class SegmentWriter {
+public:
+    SegmentWriter();
+    ~SegmentWriter();
+
+    SegmentWriter(const SegmentWriter&) = delete;
+    SegmentWriter& operator=(const SegmentWriter&) = delete;
+
+    /**
+     * @brief Start writing segments into a directory (which must exist)
+     * @param sync_writes fsync each record before append() returns
+     */
+    bool open(const std::string& dir, const SegmentLimits& limits, bool sync_writes = false);
+
+    /**
+     * @brief Append a record, first rolling over if the frame is a keyframe
+     *        and the current segment has reached a limit
+     * @param frames_dropped Capture gap before the frame (segment index)
+     */
+    bool append(const CompressedFrame& frame, uint32_t frames_dropped = 0);
+
+    /**
+     * @brief Close the current segment and list it as complete
+     */
+    bool close();
+
+    bool is_open() const { return open_; }
+
+    void set_completion_callback(SegmentCallback callback) { on_complete_ = std::move(callback); }
+
+    /**
+     * @brief Every segment of the directory, the current one last
+     */
+    const std::vector<SegmentInfo>& segments() const { return segments_; }
+
+    /**
+     * @brief Segments deleted to stay within the disk budget since open()
+     */
+    uint32_t reclaimed_segments() const { return reclaimed_; }
+
+private:
+    std::string dir_;
+    SegmentLimits limits_;
+    bool sync_writes_;
+    bool open_;
+    int fd_;                            // Current segment, or -1 between segments
+    std::vector<SegmentInfo> segments_;
+    ArchiveIndexWriter index_;
+    bool index_enabled_;
+    std::vector<uint8_t> record_buffer_;
+    SegmentCallback on_complete_;
+    uint32_t reclaimed_;
+
+    bool limit_reached(const CompressedFrame& frame) const;
+    bool start_segment();
+    bool finish_segment();
+
+    /**
+     * @brief Delete the oldest closed segments until `reserve` more bytes fit the budget
+     */
+    bool reclaim(uint64_t reserve);
+
+    /**
+     * @brief Delete segment files the manifest no longer lists (crash mid-reclaim)
+     */
+    void remove_unlisted();
+};
+
+/**
+ * @brief Random access to the records of a segmented archive
+ */
+class SegmentReader {
+public:
+    SegmentReader() : cached_(NO_SEGMENT) {}
+
+    /**
+     * @brief Read the manifest (ranges of incomplete segments are recovered)
+     * @return false if the directory has no segment manifest
+     */
+    bool open(const std::string& dir);
+
+    const std::vector<SegmentInfo>& segments() const { return segments_; }
+
+    /**
+     * @brief Segments whose capture time range overlaps [begin_us, end_us]
+     */
+    std::vector<size_t> segments_between(uint64_t begin_us, uint64_t end_us) const;
+
+    /**
+     * @brief Headers of one segment's records, in write order
+     * @param offsets Optional output: byte offset of each record in the segment
+     */
+    bool read_entries(size_t segment, std::vector<ArchiveEntry>& entries,
+                      std::vector<uint64_t>* offsets = nullptr) const;
+
+    /**
+     * @brief Read one record, from the newest segment holding that frame
+     */
+    bool read_frame(uint32_t frame_index, CompressedFrame& frame);
+
+private:
+    static constexpr size_t NO_SEGMENT = static_cast<size_t>(-1);
+
+    std::string dir_;
+    std::vector<SegmentInfo> segments_;
+
+    // Headers of the segment read_frame() used last
+    size_t cached_;
+    std::vector<ArchiveEntry> cached_entries_;
+    std::vector<uint64_t> cached_offsets_;
+    std::vector<uint8_t> record_buffer_;
+};
+
+} // namespace lwir
@@ -70,6 +70,8 @@ private:
 struct FrameStats {
     uint32_t frame_index;
     bool is_keyframe;
+    bool is_repeat;              // Header-only repeat record
+    uint32_t frames_dropped;     // Frames missing before this one (timestamp gap)
 
     // Residual statistics (before quantization)
     double residual_mean;
@@ -94,7 +96,7 @@ struct FrameStats {
     double rmse;
 
     FrameStats()
-        : frame_index(0), is_keyframe(false),
+        : frame_index(0), is_keyframe(false), is_repeat(false), frames_dropped(0),
           residual_mean(0), residual_stddev(0),
           residual_p95(0), residual_p99(0), residual_max(0),
           residual_entropy(0), quantized_entropy(0),
@@ -116,6 +118,9 @@ struct SessionStats {
     uint32_t total_frames;
     uint32_t keyframes;
     uint32_t residual_frames;
+    uint32_t repeat_frames;      // Not counted in residual_frames
+    uint32_t timestamp_gaps;     // Frames that followed dropped frames
+    uint64_t frames_dropped;     // Frames missing across all gaps
 
     uint64_t total_original_bytes;
     uint64_t total_compressed_bytes;
@@ -125,13 +130,15 @@ struct SessionStats {
     double avg_residual_mean;
     double avg_max_error;
     double avg_rmse;
+    double peak_max_error;  // Worst per-frame max error
 
     SessionStats()
-        : total_frames(0), keyframes(0), residual_frames(0),
+        : total_frames(0), keyframes(0), residual_frames(0), repeat_frames(0),
+          timestamp_gaps(0), frames_dropped(0),
           total_original_bytes(0), total_compressed_bytes(0),
           overall_compression_ratio(0),
           avg_encode_time_ms(0), avg_residual_mean(0),
-          avg_max_error(0), avg_rmse(0) {}
+          avg_max_error(0), avg_rmse(0), peak_max_error(0) {}
 
     // Add frame stats
     void add_frame(const FrameStats& fs);
@@ -143,4 +150,37 @@ struct SessionStats {
     std::string to_json() const;
 };
 
+/**
+ * Compute residual statistics for decision making
+ * @param residual Raw residual (before quantization)
+ * @param pixel_count Number of pixels
+ * @param dead_zone_T Dead-zone threshold
+ * @param quantized Quantized residual (for entropy calculation)
+ * @return Statistics for decision engine
+ */
+ResidualStats compute_residual_stats(
+    const int16_t* residual,
+    size_t pixel_count,
+    uint32_t dead_zone_T,
+    const int16_t* quantized = nullptr
+);
+
+/**
+ * Compute decision statistics directly from a frame and its reference,
+ * without materializing the residual
+ * @param current Current frame
+ * @param reference Reconstructed reference frame
+ * @param pixel_count Number of pixels
+ * @param dead_zone_T Dead-zone threshold
+ * @param stride Sample every Nth pixel (1 = full frame)
+ * @return Statistics for decision engine
+ */
+ResidualStats compute_delta_stats(
+    const uint16_t* current,
+    const uint16_t* reference,
+    size_t pixel_count,
+    uint32_t dead_zone_T,
+    uint32_t stride = 1
+);
+
 } // namespace lwir
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "config.hpp"
+#include "frame.hpp"
+#include "pipeline.hpp"
+#include "stats.hpp"
+#include "worker_pool.hpp"
+
+namespace lwir {
+
+/**
+ * @file stream_encoder.hpp
+ * @brief Push-based streaming encoder for embedding
+ *
+ * Flight software hands frames to a StreamEncoder as the camera delivers
+ * them and receives encoded frames through a callback. Keyframe decisions,
+ * the overload ladder, deadline tracking and buffer reuse are the same as
+ * in CompressionPipeline; encoding runs on an internal thread so push()
+ * only copies the frame into a pooled buffer. With encode_workers > 0 the
+ * JPEG-LS coding of a frame overlaps the preparation of the next ones, and
+ * a frame may be delivered up to encode_workers pushes later; flush()
+ * delivers the rest.
+ *
+ *   lwir::StreamEncoder stream(config, [&](const lwir::CompressedFrame& f,
+ *                                          const lwir::FrameStats&) { downlink(f); });
+ *   stream.push(lwir::FrameView(pixels, 640, 512));
+ *   stream.finish();
+ */
+
+/**
+ * @brief Receives each encoded frame, in push order, on the encoder thread
+ *
+ * The frame is only valid for the duration of the call.
+ */
+using EncodedFrameCallback = std::function<void(const CompressedFrame& frame, const FrameStats& stats)>;
+
+/**
+ * @brief Streaming encoder: push frames in, get encoded frames back
+ *
+ * Frames are numbered in push order (frame_index 0, 1, 2, ...); dropped
+ * frames do not consume a number. At most queue_depth frames are buffered
+ * or being encoded; push() either drops the frame or blocks when all
+ * buffers are busy. Errors are sticky: after a failed encode every push
+ * returns false.
+ */
+class StreamEncoder {
+public:
+    /**
+     * @param config Compression configuration (output_dir may be empty)
+     * @param on_encoded Called for every encoded frame
+     * @param queue_depth Frame buffers (frames in flight)
+     */
+    StreamEncoder(const CompressionConfig& config, EncodedFrameCallback on_encoded,
+                  uint32_t queue_depth = 4);
+
+    /**
+     * @brief Finish the session if finish() was not called
+     */
+    ~StreamEncoder();
+
+    StreamEncoder(const StreamEncoder&) = delete;
+    StreamEncoder& operator=(const StreamEncoder&) = delete;
+
+    /**
+     * @brief Queue a frame for encoding
+     * @param frame Frame to encode (copied before returning)
+     * @param block Wait for a free buffer instead of dropping the frame
+     * @return true if queued, false if dropped, invalid or after an error
+     */
+    bool push(const FrameView& frame, bool block = false);
+
+    /**
+     * @brief Block until every queued frame has been delivered
+     * @return false if any frame failed to encode
+     */
+    bool flush();
+
+    /**
+     * @brief Deliver every queued frame and end the session
+     *
+     * Statistics are finalized and compression_stats.json is written to
+     * output_dir (unless it is empty). Only the first call does anything;
+     * later pushes return false. Not to be called concurrently with push().
+     * @return false if any frame failed to encode or the session could not be closed
+     */
+    bool finish();
+
+    /**
+     * @brief false once an encode has failed
+     */
+    bool ok() const;
+
+    uint32_t frames_pushed() const;
+    uint32_t frames_dropped() const;
+
+    /**
+     * @brief Session totals and averages (call after flush or finish)
+     */
+    SessionStats stats() const;
+
+    /**
+     * @brief Latency and deadline tracking (call after flush)
+     */
+    const DeadlineMonitor& deadline_monitor() const { return pipeline_.deadline_monitor(); }
+
+private:
+    CompressionPipeline pipeline_;
+    EncodedFrameCallback on_encoded_;
+    uint32_t capacity_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable slot_free_;
+    std::vector<std::unique_ptr<Frame>> free_buffers_;
+    uint32_t in_flight_;
+    uint32_t next_index_;
+    uint32_t dropped_;
+    bool failed_;
+    bool finished_;
+
+    // Single worker: frames are encoded strictly in order (temporal reference)
+    // Declared last so it is joined before the state above is destroyed
+    WorkerPool worker_;
+
+    void encode(Frame* buffer, DeadlineMonitor::Clock::time_point arrival);
+};
+
+} // namespace lwir
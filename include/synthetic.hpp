@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "frame.hpp"
+
+namespace lwir {
+
+/**
+ * @file synthetic.hpp
+ * @brief Deterministic synthetic LWIR sequence generator
+ *
+ * Produces thermal-like sequences for benchmarks, tests and development
+ * without flight data:
+ * - Smooth temperature field (low-frequency periodic scene + hot spots)
+ * - Global translation and rotation (aircraft motion)
+ * - Slow global drift
+ * - Fixed-pattern noise (per-pixel and per-column offsets)
+ * - Temporal noise floor (~10 DN Gaussian)
+ * - Periodic FFC events (shutter frames, then a re-estimated FPN offset)
+ * - A few dead pixels
+ *
+ * Every frame is a pure function of (config, frame index), so frames can be
+ * generated out of order or in parallel and are identical across runs.
+ */
+
+/**
+ * Synthetic sequence parameters
+ */
+struct SyntheticConfig {
+    uint32_t width = 640;
+    uint32_t height = 512;
+    uint32_t frame_count = 300;
+    uint64_t seed = 1;
+
+    double frame_period_us = 33333.0;   // Timestamp step (30 Hz)
+
+    // Scene
+    double base_dn = 30000.0;           // Mean scene level
+    double field_amplitude_dn = 1500.0; // Smooth temperature variation
+    uint32_t hot_spots = 6;             // Warm blobs (buildings, engines)
+    double hot_spot_dn = 800.0;
+
+    // Noise
+    double temporal_noise_dn = 10.0;    // Per-frame Gaussian noise (sigma)
+    double fpn_dn = 15.0;               // Per-pixel fixed-pattern noise (sigma)
+    double column_fpn_dn = 5.0;         // Per-column offset (sigma)
+
+    // Motion and drift
+    double velocity_x = 0.6;            // Pixels per frame
+    double velocity_y = 0.15;
+    double rotation_deg_per_frame = 0.01;
+    double drift_dn_per_frame = 0.3;    // Slow global level change
+
+    // Flat-field correction events
+    uint32_t ffc_period = 900;          // Frames between FFC events (0 = none)
+    uint32_t ffc_duration = 3;          // Shutter frames per event
+    double ffc_offset_dn = 25.0;        // Global offset step after each FFC
+
+    // Sensor defects
+    uint32_t dead_pixels = 12;
+};
+
+/**
+ * Synthetic thermal sequence
+ */
+class SyntheticSequence {
+public:
+    explicit SyntheticSequence(const SyntheticConfig& config);
+
+    const SyntheticConfig& config() const { return config_; }
+    uint32_t frame_count() const { return config_.frame_count; }
+
+    /**
+     * Generate frame by index (deterministic, thread-safe)
+     * @param index Frame index in [0, frame_count)
+     * @param frame Output frame (resized as needed)
+     */
+    void generate(uint32_t index, Frame& frame) const;
+
+    /**
+     * True if the frame falls inside an FFC shutter event
+     */
+    bool is_ffc_frame(uint32_t index) const;
+
+private:
+    SyntheticConfig config_;
+    uint32_t texture_width_;
+    uint32_t texture_height_;
+    std::vector<float> texture_;     // Periodic world scene (wraps)
+    std::vector<float> fpn_;         // Per-pixel + per-column offsets
+    std::vector<uint32_t> dead_;     // Dead pixel positions
+    std::vector<uint16_t> dead_values_;
+
+    float sample_scene(double u, double v) const;
+};
+
+/**
+ * PNG text chunk holding the capture timestamp in microseconds
+ */
+static constexpr const char* FRAME_TIMESTAMP_PNG_KEY = "timestamp_us";
+
+/**
+ * Write frame as 16-bit grayscale PNG (timestamp in a FRAME_TIMESTAMP_PNG_KEY text chunk)
+ * @return true on success
+ */
+bool write_frame_png(const Frame& frame, const std::string& path);
+
+/**
+ * Write frame as raw little-endian uint16 samples (no header)
+ * @return true on success
+ */
+bool write_frame_raw(const Frame& frame, const std::string& path);
+
+} // namespace lwir
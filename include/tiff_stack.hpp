@@ -0,0 +1,177 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "frame.hpp"
+#include "frame_source.hpp"
+#include "worker_pool.hpp"
+
+namespace lwir {
+
+/**
+ * @file tiff_stack.hpp
+ * @brief Multi-page 16-bit TIFF stacks as a frame source
+ *
+ * Flight exports from upstream tools hold every frame of a flight as one
+ * page of a TIFF file. The reader memory-maps the file and walks the IFD
+ * chain once at open, recording where each page's strips are. Pages must
+ * be 16-bit, single-sample grayscale in strips (not tiles). Strips may be
+ * uncompressed, PackBits, LZW or Deflate coded, with or without the
+ * horizontal predictor, in either byte order. Classic TIFF only (no
+ * BigTIFF), so a stack is limited to 4 GB.
+ */
+
+/**
+ * Strip coding written by TiffStackWriter
+ */
+enum class TiffCompression {
+    NONE,
+    PACKBITS,
+    LZW,
+    DEFLATE     // With the horizontal predictor
+};
+
+/**
+ * @brief Multi-page TIFF stack (or a directory of them) as a frame source
+ *
+ * Uncompressed pages are copied straight out of the mapping, and the kernel
+ * is asked to read the next page ahead. Compressed pages are decoded ahead
+ * of the reader on a prefetch pool when one is set. Frames are numbered by
+ * position across all pages; timestamps are 0 (TIFF pages carry no
+ * sub-second capture time).
+ */
+class TiffStackSource : public FrameSource {
+public:
+    TiffStackSource();
+    ~TiffStackSource() override;
+
+    TiffStackSource(const TiffStackSource&) = delete;
+    TiffStackSource& operator=(const TiffStackSource&) = delete;
+
+    /**
+     * @brief Map a TIFF stack, or every .tif/.tiff file of a directory in name order
+     * @return true if at least one usable page was found
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief Decode compressed pages ahead of read_frame()
+     * @param pool Pool to decode on (must outlive the source), or nullptr
+     * @param depth Pages decoded ahead of the last one read
+     */
+    void set_prefetch_pool(WorkerPool* pool, size_t depth = 4);
+
+    size_t frame_count() const override { return pages_.size(); }
+    bool read_frame(size_t index, Frame& frame) override;
+    std::string description() const override;
+
+    /**
+     * @brief Samples of an uncompressed page inside the mapping (zero copy)
+     *
+     * Valid while the source is open. Usable directly as a FrameView for
+     * StreamEncoder / AsyncEncoder.
+     * @return nullptr unless the page is one contiguous uncompressed run in
+     *         host byte order
+     */
+    const uint16_t* mapped_samples(size_t index) const;
+
+private:
+    struct MappedFile {
+        std::string path;
+        const uint8_t* data;
+        size_t size;
+        bool big_endian;
+    };
+
+    struct Page {
+        size_t file;
+        uint32_t width;
+        uint32_t height;
+        uint32_t rows_per_strip;
+        uint16_t compression;
+        uint16_t predictor;
+        std::vector<uint32_t> strip_offsets;
+        std::vector<uint32_t> strip_bytes;
+    };
+
+    // A page decoded (or being decoded) on the prefetch pool
+    struct Prefetched {
+        size_t index;
+        Frame frame;
+        bool done;
+        bool ok;
+    };
+
+    std::string path_;
+    std::vector<MappedFile> files_;
+    std::vector<Page> pages_;
+
+    WorkerPool* prefetch_pool_;
+    size_t prefetch_depth_;
+    std::deque<std::shared_ptr<Prefetched>> ahead_;   // Ascending page order
+    size_t in_flight_;                                // Guarded by prefetch_mutex_
+    std::mutex prefetch_mutex_;
+    std::condition_variable prefetch_done_;
+
+    bool map_file(const std::string& path);
+    bool read_pages(size_t file);
+    bool decode_page(const Page& page, Frame& frame) const;
+    bool is_compressed(const Page& page) const;
+
+    /**
+     * @brief Queue the pages after `index` that are not decoded or queued yet
+     */
+    void schedule_prefetch(size_t index);
+
+    /**
+     * @brief Wait for every queued decode (they reference the mappings)
+     */
+    void drain_prefetch();
+};
+
+/**
+ * @brief Writes frames as pages of a TIFF stack, one at a time
+ */
+class TiffStackWriter {
+public:
+    TiffStackWriter() : compression_(TiffCompression::NONE), rows_per_strip_(0), big_endian_(false),
+                        last_ifd_next_(0), pages_(0) {}
+    ~TiffStackWriter() { close(); }
+
+    /**
+     * @brief Create the file
+     * @param rows_per_strip Rows per strip (0 = one strip per page)
+     * @param big_endian Write "MM" (Motorola) byte order
+     */
+    bool open(const std::string& path, TiffCompression compression = TiffCompression::NONE,
+              uint32_t rows_per_strip = 0, bool big_endian = false);
+
+    /**
+     * @brief Append a frame as the next page
+     */
+    bool append(const Frame& frame);
+
+    /**
+     * @brief Flush and close the file
+     * @return false if any write failed
+     */
+    bool close();
+
+    uint32_t page_count() const { return pages_; }
+
+private:
+    std::ofstream out_;
+    TiffCompression compression_;
+    uint32_t rows_per_strip_;
+    bool big_endian_;
+    uint64_t last_ifd_next_;   // File offset of the previous IFD's next-IFD pointer
+    uint32_t pages_;
+};
+
+} // namespace lwir
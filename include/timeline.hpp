@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace lwir {
+
+/**
+ * @file timeline.hpp
+ * @brief Dropped-frame detection from capture timestamps
+ *
+ * The camera delivers frames at a nominal period (33333 us at 30 Hz). When
+ * the capture chain drops frames, the next frame arrives one or more periods
+ * late, and predicting it from the last frame that was kept spans the gap.
+ * The detector compares consecutive timestamps against the nominal period.
+ * A step of more than 1.5 periods counts as a gap, and the number of missing
+ * frames is the step rounded to whole periods, minus one.
+ */
+
+/**
+ * What the pipeline does with the first frame after a gap
+ */
+enum class GapPolicy {
+    KEYFRAME,   // Encode it as a keyframe
+    WIDEN,      // Residual with residual_near raised by gap_widen_near
+    IGNORE      // Only record the gap
+};
+
+/**
+ * Parse a gap policy name ("keyframe", "widen", "ignore")
+ * @return false if the name is unknown
+ */
+bool parse_gap_policy(const std::string& name, GapPolicy& policy);
+
+/**
+ * Frames missing between two capture timestamps
+ * @param previous Timestamp of the last frame seen (us)
+ * @param current Timestamp of this frame (us)
+ * @param frame_period_us Nominal capture period (0 = unknown, never a gap)
+ * @return 0 when the frames are adjacent, or when time went backwards
+ */
+uint32_t count_dropped_frames(uint64_t previous, uint64_t current, double frame_period_us);
+
+/**
+ * @brief Tracks the capture timeline of one stream
+ */
+class GapDetector {
+public:
+    explicit GapDetector(double frame_period_us = 0.0)
+        : frame_period_us_(frame_period_us), last_timestamp_(0), has_last_(false) {}
+
+    /**
+     * @brief Change the nominal period (config reload)
+     */
+    void set_frame_period(double frame_period_us) { frame_period_us_ = frame_period_us; }
+
+    /**
+     * @brief Account for the next frame
+     * @param timestamp Capture timestamp (us)
+     * @return Frames missing before it (0 for the first frame)
+     */
+    uint32_t observe(uint64_t timestamp);
+
+    /**
+     * @brief Continue after a frame seen by an earlier process (resume)
+     */
+    void seed(uint64_t timestamp);
+
+    /**
+     * @brief Forget the last timestamp (the next frame starts a new timeline)
+     */
+    void reset() { has_last_ = false; }
+
+private:
+    double frame_period_us_;
+    uint64_t last_timestamp_;
+    bool has_last_;
+};
+
+} // namespace lwir
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lwir {
+
+/**
+ * @file worker_pool.hpp
+ * @brief Fixed-size pool of worker threads
+ *
+ * Tasks are run in submission order by whichever worker is free. wait()
+ * blocks until every submitted task has finished, so a pool can be reused
+ * for several batches. Tasks must not throw.
+ */
+class WorkerPool {
+public:
+    /**
+     * @brief Start worker threads
+     * @param threads Number of workers (0 = hardware concurrency)
+     */
+    explicit WorkerPool(size_t threads = 0);
+
+    /**
+     * @brief Finish queued tasks and join all workers
+     */
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    /**
+     * @brief Queue a task
+     */
+    void submit(std::function<void()> task);
+
+    /**
+     * @brief Block until all submitted tasks have finished
+     */
+    void wait();
+
+    size_t size() const { return workers_.size(); }
+
+private:
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable task_ready_;
+    std::condition_variable all_done_;
+    size_t active_;
+    bool stopping_;
+
+    void worker_loop();
+};
+
+} // namespace lwir
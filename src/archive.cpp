@@ -0,0 +1,291 @@
+/**
+ * @file archive.cpp
+ * @brief Archive index and header scanning
+ */
+
+#include "archive.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+namespace lwir {
+
+namespace {
+
+constexpr char ARCHIVE_INDEX_MAGIC[ARCHIVE_INDEX_MAGIC_SIZE] = { 'L', 'W', 'I', 'R', 'I', 'D', 'X', '2' };
+constexpr char ARCHIVE_INDEX_MAGIC_V1[ARCHIVE_INDEX_MAGIC_SIZE] = { 'L', 'W', 'I', 'R', 'I', 'D', 'X', '1' };
+
+void write_index_entry(const CompressedFrame& header, uint32_t payload_size, uint32_t frames_dropped, uint8_t* dst)
+{
+    write_frame_header(header, payload_size, dst, FRAME_HEADER_SIZE);
+    std::memcpy(dst + FRAME_HEADER_SIZE, &frames_dropped, sizeof(frames_dropped));
+}
+
+bool is_frame_record_name(const char* name)
+{
+    const size_t length = std::strlen(name);
+    return length > 11 && std::strncmp(name, "frame_", 6) == 0 &&
+           std::strcmp(name + length - 5, ".lwir") == 0;
+}
+
+/**
+ * Sort by frame index; of several entries for one frame keep the last written
+ */
+void normalize_entries(std::vector<ArchiveEntry>& entries)
+{
+    std::stable_sort(entries.begin(), entries.end(), [](const ArchiveEntry& a, const ArchiveEntry& b) {
+        return a.header.frame_index < b.header.frame_index;
+    });
+
+    size_t out = 0;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const bool superseded = (i + 1 < entries.size()) &&
+                                entries[i + 1].header.frame_index == entries[i].header.frame_index;
+        if (!superseded) {
+            if (out != i) {
+                entries[out] = std::move(entries[i]);
+            }
+            out++;
+        }
+    }
+    entries.resize(out);
+}
+
+} // anonymous namespace
+
+bool read_archive_index(const std::string& path, std::vector<ArchiveEntry>& entries)
+{
+    entries.clear();
+
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < ARCHIVE_INDEX_MAGIC_SIZE) {
+        ::close(fd);
+        std::cerr << "Not an archive index: " << path << std::endl;
+        return false;
+    }
+
+    const size_t size = static_cast<size_t>(st.st_size);
+    void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        std::cerr << "Failed to map archive index: " << path << std::endl;
+        return false;
+    }
+    ::madvise(mapping, size, MADV_SEQUENTIAL);
+
+    const uint8_t* bytes = static_cast<const uint8_t*>(mapping);
+    size_t entry_size = 0;
+    if (std::memcmp(bytes, ARCHIVE_INDEX_MAGIC, ARCHIVE_INDEX_MAGIC_SIZE) == 0) {
+        entry_size = ARCHIVE_INDEX_ENTRY_SIZE;
+    }
+    else if (std::memcmp(bytes, ARCHIVE_INDEX_MAGIC_V1, ARCHIVE_INDEX_MAGIC_SIZE) == 0) {
+        entry_size = FRAME_HEADER_SIZE;   // Headers only
+    }
+    else {
+        ::munmap(mapping, size);
+        std::cerr << "Not an archive index: " << path << std::endl;
+        return false;
+    }
+
+    // A trailing partial entry (crash mid-append) is ignored
+    const size_t count = (size - ARCHIVE_INDEX_MAGIC_SIZE) / entry_size;
+    entries.resize(count);
+    const uint8_t* p = bytes + ARCHIVE_INDEX_MAGIC_SIZE;
+    for (size_t i = 0; i < count; ++i, p += entry_size) {
+        read_frame_header(p, FRAME_HEADER_SIZE, entries[i].header, entries[i].payload_size);
+        if (entry_size == ARCHIVE_INDEX_ENTRY_SIZE) {
+            std::memcpy(&entries[i].frames_dropped, p + FRAME_HEADER_SIZE, sizeof(uint32_t));
+        }
+    }
+    ::munmap(mapping, size);
+
+    normalize_entries(entries);
+    return true;
+}
+
+bool scan_archive_headers(const std::string& dir, std::vector<ArchiveEntry>& entries)
+{
+    entries.clear();
+
+    DIR* directory = opendir(dir.c_str());
+    if (!directory) {
+        std::cerr << "Failed to open archive directory: " << dir << std::endl;
+        return false;
+    }
+
+    uint8_t header[FRAME_HEADER_SIZE];
+    struct dirent* entry;
+    while ((entry = readdir(directory)) != nullptr) {
+        if (!is_frame_record_name(entry->d_name)) {
+            continue;
+        }
+
+        const std::string path = dir + "/" + entry->d_name;
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "Failed to open record: " << path << std::endl;
+            continue;
+        }
+        const ssize_t got = ::pread(fd, header, FRAME_HEADER_SIZE, 0);
+        ::close(fd);
+
+        ArchiveEntry parsed;
+        if (got != static_cast<ssize_t>(FRAME_HEADER_SIZE) ||
+            !read_frame_header(header, FRAME_HEADER_SIZE, parsed.header, parsed.payload_size))
+        {
+            std::cerr << "Truncated record header: " << path << std::endl;
+            continue;
+        }
+        entries.push_back(std::move(parsed));
+    }
+    closedir(directory);
+
+    normalize_entries(entries);
+    return true;
+}
+
+size_t count_frame_records(const std::string& dir)
+{
+    DIR* directory = opendir(dir.c_str());
+    if (!directory) {
+        return 0;
+    }
+
+    size_t count = 0;
+    struct dirent* entry;
+    while ((entry = readdir(directory)) != nullptr) {
+        if (is_frame_record_name(entry->d_name)) {
+            count++;
+        }
+    }
+    closedir(directory);
+    return count;
+}
+
+bool write_archive_index(const std::string& path, const std::vector<ArchiveEntry>& entries)
+{
+    std::vector<uint8_t> buffer(ARCHIVE_INDEX_MAGIC_SIZE + entries.size() * ARCHIVE_INDEX_ENTRY_SIZE);
+    std::memcpy(buffer.data(), ARCHIVE_INDEX_MAGIC, ARCHIVE_INDEX_MAGIC_SIZE);
+    uint8_t* p = buffer.data() + ARCHIVE_INDEX_MAGIC_SIZE;
+    for (const ArchiveEntry& entry : entries) {
+        write_index_entry(entry.header, entry.payload_size, entry.frames_dropped, p);
+        p += ARCHIVE_INDEX_ENTRY_SIZE;
+    }
+
+    const std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream ofs(tmp_path, std::ios::binary);
+        ofs.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+        ofs.close();
+        if (!ofs) {
+            std::cerr << "Failed to write archive index: " << tmp_path << std::endl;
+            std::remove(tmp_path.c_str());
+            return false;
+        }
+    }
+
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        std::cerr << "Failed to replace archive index: " << path << std::endl;
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// ArchiveIndexWriter
+// ============================================================================
+
+bool ArchiveIndexWriter::open(const std::string& path)
+{
+    close();
+
+    const int fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    size_t size = static_cast<size_t>(st.st_size);
+    char magic[ARCHIVE_INDEX_MAGIC_SIZE];
+    if (size >= ARCHIVE_INDEX_MAGIC_SIZE &&
+        ::pread(fd, magic, sizeof(magic), 0) == static_cast<ssize_t>(sizeof(magic)) &&
+        std::memcmp(magic, ARCHIVE_INDEX_MAGIC_V1, sizeof(magic)) == 0)
+    {
+        // Version 1 index from an earlier session: rewrite with gap counts
+        ::close(fd);
+        std::vector<ArchiveEntry> entries;
+        if (!read_archive_index(path, entries) || !write_archive_index(path, entries)) {
+            return false;
+        }
+        return open(path);
+    }
+
+    if (size < ARCHIVE_INDEX_MAGIC_SIZE) {
+        // New index (or one cut short inside the magic)
+        if (::ftruncate(fd, 0) != 0 ||
+            ::pwrite(fd, ARCHIVE_INDEX_MAGIC, ARCHIVE_INDEX_MAGIC_SIZE, 0) !=
+                static_cast<ssize_t>(ARCHIVE_INDEX_MAGIC_SIZE))
+        {
+            ::close(fd);
+            return false;
+        }
+        size = ARCHIVE_INDEX_MAGIC_SIZE;
+    }
+
+    // Trim a partial entry so appended entries stay aligned
+    const size_t whole = ARCHIVE_INDEX_MAGIC_SIZE +
+                         (size - ARCHIVE_INDEX_MAGIC_SIZE) / ARCHIVE_INDEX_ENTRY_SIZE * ARCHIVE_INDEX_ENTRY_SIZE;
+    if (whole != size && ::ftruncate(fd, static_cast<off_t>(whole)) != 0) {
+        ::close(fd);
+        return false;
+    }
+    if (::lseek(fd, 0, SEEK_END) < 0) {
+        ::close(fd);
+        return false;
+    }
+
+    fd_ = fd;
+    path_ = path;
+    return true;
+}
+
+bool ArchiveIndexWriter::append(const std::string& path, const CompressedFrame& frame, uint32_t frames_dropped)
+{
+    if ((fd_ < 0 || path != path_) && !open(path)) {
+        return false;
+    }
+
+    uint8_t entry[ARCHIVE_INDEX_ENTRY_SIZE];
+    write_index_entry(frame, static_cast<uint32_t>(frame.compressed_data.size()), frames_dropped, entry);
+    return ::write(fd_, entry, sizeof(entry)) == static_cast<ssize_t>(sizeof(entry));
+}
+
+void ArchiveIndexWriter::close()
+{
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    path_.clear();
+}
+
+} // namespace lwir
@@ -0,0 +1,253 @@
+/**
+ * @file async_encoder.cpp
+ * @brief Submit/poll encoding API implementation
+ */
+
+#include "async_encoder.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace lwir {
+
+// ============================================================================
+// CompletionQueue
+// ============================================================================
+
+bool CompletionQueue::poll(Completion& completion)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (completions_.empty()) {
+        return false;
+    }
+    completion = std::move(completions_.front());
+    completions_.pop_front();
+    return true;
+}
+
+void CompletionQueue::wait(Completion& completion)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    ready_.wait(lock, [this]() { return !completions_.empty(); });
+    completion = std::move(completions_.front());
+    completions_.pop_front();
+}
+
+bool CompletionQueue::wait_for(Completion& completion, std::chrono::milliseconds timeout)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!ready_.wait_for(lock, timeout, [this]() { return !completions_.empty(); })) {
+        return false;
+    }
+    completion = std::move(completions_.front());
+    completions_.pop_front();
+    return true;
+}
+
+size_t CompletionQueue::size() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return completions_.size();
+}
+
+void CompletionQueue::post(Completion&& completion)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        completions_.push_back(std::move(completion));
+    }
+    ready_.notify_one();
+}
+
+// ============================================================================
+// AsyncEncoder
+// ============================================================================
+
+namespace {
+
+CompressionConfig async_config(const CompressionConfig& config)
+{
+    CompressionConfig async = config;
+    async.verbose = false;   // The embedding application owns stdout
+    async.encode_workers = 0;  // One completion per submitted frame
+    return async;
+}
+
+} // anonymous namespace
+
+AsyncEncoder::AsyncEncoder(WorkerPool& executor, CompletionQueue& completions,
+                           const CompressionConfig& config, uint32_t stream_id,
+                           uint32_t max_in_flight)
+    : executor_(executor)
+    , completions_(completions)
+    , pipeline_(async_config(config))
+    , stream_id_(stream_id)
+    , capacity_(std::max(1u, max_in_flight))
+    , current_(nullptr)
+    , in_flight_(0)
+    , next_ticket_(0)
+    , scheduled_(false)
+    , failed_(false)
+{
+    pipeline_.set_frame_sink([this](const CompressedFrame& frame, const FrameStats& stats) {
+        current_->frame = frame;
+        current_->stats = stats;
+        return true;
+    });
+}
+
+AsyncEncoder::~AsyncEncoder()
+{
+    drain();
+}
+
+bool AsyncEncoder::submit(const FrameView& view, uint64_t& ticket)
+{
+    // Arrival is when the caller hands the frame over
+    const DeadlineMonitor::Clock::time_point arrival = DeadlineMonitor::Clock::now();
+
+    const size_t stride = view.stride ? view.stride : view.width;
+    if (!view.data || view.width == 0 || view.height == 0 || stride < view.width) {
+        std::cerr << "AsyncEncoder: invalid frame view" << std::endl;
+        return false;
+    }
+
+    std::unique_ptr<Frame> buffer;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (failed_ || in_flight_ >= capacity_) {
+            return false;
+        }
+        if (!free_buffers_.empty()) {
+            buffer = std::move(free_buffers_.back());
+            free_buffers_.pop_back();
+        }
+        in_flight_++;   // Reserve the slot before packing outside the lock
+    }
+    if (!buffer) {
+        buffer.reset(new Frame());
+    }
+
+    // Pack rows outside the lock; the encode of an earlier frame may be running
+    Frame& frame = *buffer;
+    frame.width = view.width;
+    frame.height = view.height;
+    frame.timestamp = view.timestamp;
+    frame.data.resize(static_cast<size_t>(view.width) * view.height);
+    if (stride == view.width) {
+        std::memcpy(frame.data.data(), view.data, frame.data.size() * sizeof(uint16_t));
+    } else {
+        for (uint32_t y = 0; y < view.height; ++y) {
+            std::memcpy(frame.data.data() + static_cast<size_t>(y) * view.width,
+                        view.data + y * stride, view.width * sizeof(uint16_t));
+        }
+    }
+
+    bool schedule = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        frame.frame_index = static_cast<uint32_t>(next_ticket_);
+
+        Pending job;
+        job.frame = std::move(buffer);
+        job.arrival = arrival;
+        job.ticket = next_ticket_++;
+        ticket = job.ticket;
+        pending_.push_back(std::move(job));
+
+        // At most one task per stream on the executor keeps frames in order
+        if (!scheduled_) {
+            scheduled_ = true;
+            schedule = true;
+        }
+    }
+    if (schedule) {
+        executor_.submit([this]() { run(); });
+    }
+    return true;
+}
+
+void AsyncEncoder::run()
+{
+    Pending job;
+    uint32_t queued_behind = 0;
+    bool skip = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job = std::move(pending_.front());
+        pending_.pop_front();
+        queued_behind = static_cast<uint32_t>(pending_.size());
+        skip = failed_;
+    }
+
+    Completion completion;
+    completion.stream_id = stream_id_;
+    completion.ticket = job.ticket;
+    current_ = &completion;
+    const bool ok = !skip && pipeline_.process_frame(*job.frame, job.arrival, queued_behind);
+    current_ = nullptr;
+    completion.ok = ok;
+    if (!ok) {
+        completion.frame = CompressedFrame();
+    }
+
+    // Whoever takes the completion must already see its effect on the stream
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!ok) {
+            failed_ = true;
+        }
+        in_flight_--;
+        free_buffers_.push_back(std::move(job.frame));
+        stats_ = pipeline_.session_stats();
+    }
+    completions_.post(std::move(completion));
+
+    bool reschedule = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        // Yield the worker between frames so other streams get a turn
+        if (pending_.empty()) {
+            scheduled_ = false;
+            idle_.notify_all();
+        } else {
+            reschedule = true;
+        }
+    }
+    if (reschedule) {
+        executor_.submit([this]() { run(); });
+    }
+}
+
+bool AsyncEncoder::drain()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_.wait(lock, [this]() { return !scheduled_; });
+    return !failed_;
+}
+
+uint32_t AsyncEncoder::in_flight() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return in_flight_;
+}
+
+bool AsyncEncoder::ok() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return !failed_;
+}
+
+SessionStats AsyncEncoder::stats() const
+{
+    SessionStats stats;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats = stats_;
+    }
+    stats.finalize();
+    return stats;
+}
+
+} // namespace lwir
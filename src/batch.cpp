@@ -0,0 +1,380 @@
+/**
+ * @file batch.cpp
+ * @brief Shard planning, worker processes and archive merge
+ */
+
+#include "batch.hpp"
+#include "archive.hpp"
+#include "frame_format.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <thread>
+#include <fcntl.h>
+#include <ftw.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace lwir {
+
+namespace {
+
+int remove_entry(const char* path, const struct stat*, int, struct FTW*)
+{
+    return std::remove(path);
+}
+
+/**
+ * "exit 1" / "signal 11", for logs
+ */
+std::string describe_status(int status)
+{
+    if (WIFSIGNALED(status)) {
+        return "signal " + std::to_string(WTERMSIG(status));
+    }
+    return "exit " + std::to_string(WEXITSTATUS(status));
+}
+
+std::string describe_range(const ShardRange& range)
+{
+    return "frames " + std::to_string(range.first) + "-" + std::to_string(range.first + range.count - 1);
+}
+
+bool read_file(const std::string& path, std::vector<uint8_t>& data)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return false;
+    }
+    data.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size())));
+}
+
+/**
+ * Headers of a per-frame archive: the index when it covers every record,
+ * else the records, with dropped-frame counts taken from the index
+ */
+bool load_record_entries(const std::string& dir, std::vector<ArchiveEntry>& entries)
+{
+    std::vector<ArchiveEntry> indexed;
+    read_archive_index(dir + "/" + ARCHIVE_INDEX_FILE, indexed);
+    if (!indexed.empty() && indexed.size() == count_frame_records(dir)) {
+        entries.swap(indexed);
+        return true;
+    }
+
+    if (!scan_archive_headers(dir, entries)) {
+        return false;
+    }
+    size_t j = 0;
+    for (ArchiveEntry& entry : entries) {
+        while (j < indexed.size() && indexed[j].header.frame_index < entry.header.frame_index) {
+            ++j;
+        }
+        if (j < indexed.size() && indexed[j].header.frame_index == entry.header.frame_index) {
+            entry.frames_dropped = indexed[j].frames_dropped;
+        }
+    }
+    return true;
+}
+
+/**
+ * Headers of a segmented archive by frame index, newest copy of each frame
+ */
+bool load_segment_entries(const SegmentReader& reader, std::vector<ArchiveEntry>& entries)
+{
+    entries.clear();
+    std::vector<ArchiveEntry> part;
+    for (size_t i = 0; i < reader.segments().size(); ++i) {
+        if (!reader.read_entries(i, part)) {
+            return false;
+        }
+        entries.insert(entries.end(), part.begin(), part.end());
+    }
+
+    std::stable_sort(entries.begin(), entries.end(), [](const ArchiveEntry& a, const ArchiveEntry& b) {
+        return a.header.frame_index < b.header.frame_index;
+    });
+    std::vector<ArchiveEntry> latest;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (i + 1 == entries.size() || entries[i + 1].header.frame_index != entries[i].header.frame_index) {
+            latest.push_back(entries[i]);
+        }
+    }
+    entries.swap(latest);
+    return true;
+}
+
+} // anonymous namespace
+
+std::vector<ShardRange> plan_shards(size_t frame_count, uint32_t gop_period, uint32_t shards)
+{
+    std::vector<ShardRange> plan;
+    if (frame_count == 0) {
+        return plan;
+    }
+    const size_t gop = std::max<size_t>(gop_period, 1);
+    const size_t count = std::max<uint32_t>(shards, 1);
+
+    // Whole GOPs per shard, rounded up so that no more than `shards` are needed
+    const size_t gops = (frame_count + gop - 1) / gop;
+    const size_t shard_frames = ((gops + count - 1) / count) * gop;
+
+    for (size_t first = 0; first < frame_count; first += shard_frames) {
+        const size_t frames = std::min(shard_frames, frame_count - first);
+        plan.emplace_back(static_cast<uint32_t>(first), static_cast<uint32_t>(frames));
+    }
+    return plan;
+}
+
+// ============================================================================
+// ShardCoordinator
+// ============================================================================
+
+ShardCoordinator::ShardCoordinator(const std::vector<std::string>& command, const std::string& shard_root,
+                                   uint32_t jobs, uint32_t retries)
+    : command_(command), shard_root_(shard_root), jobs_(jobs), retries_(retries)
+{
+    if (jobs_ == 0) {
+        jobs_ = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+std::string ShardCoordinator::shard_dir(size_t shard) const
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "/shard_%03zu", shard);
+    return shard_root_ + name;
+}
+
+int ShardCoordinator::launch(const ShardRange& range, const std::string& dir) const
+{
+    // Everything the child needs is built before fork()
+    std::vector<std::string> args = command_;
+    args.push_back("--frame-range");
+    args.push_back(std::to_string(range.first) + ":" + std::to_string(range.count));
+    args.push_back("--shard-output");
+    args.push_back(dir);
+    std::vector<char*> argv;
+    for (std::string& arg : args) {
+        argv.push_back(&arg[0]);
+    }
+    argv.push_back(nullptr);
+    const std::string log_path = dir + ".log";
+
+    const pid_t pid = ::fork();
+    if (pid < 0) {
+        std::cerr << "Failed to start worker: " << std::strerror(errno) << std::endl;
+        return -1;
+    }
+    if (pid == 0) {
+        const int log = ::open(log_path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (log >= 0) {
+            ::dup2(log, STDOUT_FILENO);
+            ::dup2(log, STDERR_FILENO);
+            ::close(log);
+        }
+        ::execv(argv[0], argv.data());
+        _exit(127);
+    }
+    return static_cast<int>(pid);
+}
+
+bool ShardCoordinator::run(const std::vector<ShardRange>& shards, std::vector<ShardResult>& results,
+                           const std::atomic<bool>* stop)
+{
+    results.assign(shards.size(), ShardResult());
+    if (command_.empty()) {
+        std::cerr << "No worker command" << std::endl;
+        return false;
+    }
+
+    struct stat st;
+    if (::stat(shard_root_.c_str(), &st) != 0 && ::mkdir(shard_root_.c_str(), 0755) != 0) {
+        std::cerr << "Failed to create shard directory: " << shard_root_ << std::endl;
+        return false;
+    }
+
+    std::deque<size_t> pending;
+    for (size_t i = 0; i < shards.size(); ++i) {
+        results[i].range = shards[i];
+        results[i].output_dir = shard_dir(i);
+        pending.push_back(i);
+    }
+
+    using Clock = std::chrono::steady_clock;
+    struct Running {
+        size_t shard;
+        Clock::time_point start;
+    };
+    std::map<pid_t, Running> running;
+    bool stopping = false;
+
+    while (!pending.empty() || !running.empty()) {
+        if (!stopping && stop && stop->load()) {
+            stopping = true;
+            for (const auto& worker : running) {
+                ::kill(worker.first, SIGTERM);
+            }
+        }
+
+        while (!stopping && !pending.empty() && running.size() < jobs_) {
+            const size_t shard = pending.front();
+            pending.pop_front();
+            ShardResult& result = results[shard];
+
+            // A retry starts from an empty directory
+            remove_directory_tree(result.output_dir);
+            ++result.attempts;
+            const int pid = launch(result.range, result.output_dir);
+            if (pid < 0) {
+                stopping = true;
+                break;
+            }
+            running[static_cast<pid_t>(pid)] = Running{shard, Clock::now()};
+        }
+        if (stopping) {
+            pending.clear();
+        }
+        if (running.empty()) {
+            continue;
+        }
+
+        int status = 0;
+        const pid_t pid = ::waitpid(-1, &status, WNOHANG);
+        if (pid == 0 || (pid < 0 && errno == EINTR)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            continue;
+        }
+        if (pid < 0) {
+            std::cerr << "waitpid failed: " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        const auto found = running.find(pid);
+        if (found == running.end()) {
+            continue;
+        }
+
+        const size_t shard = found->second.shard;
+        ShardResult& result = results[shard];
+        result.seconds = std::chrono::duration<double>(Clock::now() - found->second.start).count();
+        running.erase(found);
+
+        if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+            result.ok = true;
+            std::cout << "Shard " << shard << " (" << describe_range(result.range) << ") done in "
+                      << result.seconds << " s" << std::endl;
+            continue;
+        }
+
+        std::cerr << "Shard " << shard << " (" << describe_range(result.range) << ") failed ("
+                  << describe_status(status) << "), see " << result.output_dir << ".log" << std::endl;
+        if (!stopping && result.attempts <= retries_) {
+            std::cerr << "  retry " << result.attempts << " of " << retries_ << std::endl;
+            pending.push_front(shard);
+        }
+    }
+
+    for (const ShardResult& result : results) {
+        if (!result.ok) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ============================================================================
+// Merge
+// ============================================================================
+
+bool merge_archives(const std::vector<std::string>& input_dirs, const std::string& output_dir,
+                    const SegmentLimits& limits, uint64_t* frames_written)
+{
+    if (frames_written) {
+        *frames_written = 0;
+    }
+
+    std::vector<SegmentInfo> existing;
+    if (read_segment_manifest(output_dir, existing)) {
+        std::cerr << "Output already holds a segmented archive: " << output_dir << std::endl;
+        return false;
+    }
+
+    SegmentWriter writer;
+    if (!writer.open(output_dir, limits)) {
+        return false;
+    }
+
+    uint64_t written = 0;
+    bool have_last = false;
+    uint32_t last_index = 0;
+    std::vector<ArchiveEntry> entries;
+    std::vector<uint8_t> record;
+    CompressedFrame frame;
+
+    for (const std::string& dir : input_dirs) {
+        SegmentReader segments;
+        const bool segmented = segments.open(dir);
+        if (segmented ? !load_segment_entries(segments, entries) : !load_record_entries(dir, entries)) {
+            std::cerr << "Failed to read archive: " << dir << std::endl;
+            return false;
+        }
+
+        if (!entries.empty() && have_last && entries.front().header.frame_index <= last_index) {
+            std::cerr << "Archive " << dir << " starts at frame " << entries.front().header.frame_index
+                      << ", not after frame " << last_index << std::endl;
+            return false;
+        }
+
+        for (const ArchiveEntry& entry : entries) {
+            const uint32_t index = entry.header.frame_index;
+            bool read = false;
+            if (segmented) {
+                read = segments.read_frame(index, frame);
+            }
+            else {
+                read = read_file(dir + "/" + frame_file_name(index), record) &&
+                       read_frame_record(record.data(), record.size(), frame);
+            }
+            if (!read) {
+                std::cerr << "Failed to read frame " << index << " from " << dir << std::endl;
+                return false;
+            }
+            if (!writer.append(frame, entry.frames_dropped)) {
+                return false;
+            }
+            ++written;
+            have_last = true;
+            last_index = index;
+        }
+    }
+
+    if (!writer.close()) {
+        return false;
+    }
+    if (frames_written) {
+        *frames_written = written;
+    }
+    return true;
+}
+
+bool remove_directory_tree(const std::string& path)
+{
+    struct stat st;
+    if (::lstat(path.c_str(), &st) != 0) {
+        return true;
+    }
+    return ::nftw(path.c_str(), remove_entry, 16, FTW_DEPTH | FTW_PHYS) == 0;
+}
+
+} // namespace lwir
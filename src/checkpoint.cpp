@@ -0,0 +1,122 @@
+/**
+ * @file checkpoint.cpp
+ * @brief Encoder checkpoint serialization
+ */
+
+#include "checkpoint.hpp"
+#include "frame_format.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+namespace lwir {
+
+namespace {
+
+constexpr char CHECKPOINT_MAGIC[4] = { 'L', 'W', 'C', 'K' };
+constexpr uint32_t CHECKPOINT_VERSION = 1;
+constexpr size_t CHECKPOINT_HEADER_SIZE = 4 + 4 + 4 + 4 + 1 + 1 + 8 + 8;
+
+template <typename T>
+uint8_t* put(uint8_t* dst, const T& value)
+{
+    std::memcpy(dst, &value, sizeof(T));
+    return dst + sizeof(T);
+}
+
+template <typename T>
+const uint8_t* get(const uint8_t* src, T& value)
+{
+    std::memcpy(&value, src, sizeof(T));
+    return src + sizeof(T);
+}
+
+} // anonymous namespace
+
+bool write_checkpoint(const std::string& path, const EncoderCheckpoint& checkpoint)
+{
+    const DecisionEngineState& decision = checkpoint.decision;
+    const uint8_t last_decision = (decision.last_decision == FrameMode::USE_INTRA) ? 0 : 1;
+    const uint8_t ema_initialized = decision.ema_initialized ? 1 : 0;
+
+    std::vector<uint8_t> buffer(CHECKPOINT_HEADER_SIZE + frame_record_size(checkpoint.reference));
+    uint8_t* p = buffer.data();
+    std::memcpy(p, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+    p += sizeof(CHECKPOINT_MAGIC);
+    p = put(p, CHECKPOINT_VERSION);
+    p = put(p, decision.frames_since_keyframe);
+    p = put(p, decision.last_keyframe_index);
+    p = put(p, last_decision);
+    p = put(p, ema_initialized);
+    p = put(p, decision.ema_residual_bpp);
+    p = put(p, decision.ema_keyframe_bpp);
+    write_frame_record(checkpoint.reference, p, buffer.size() - CHECKPOINT_HEADER_SIZE);
+
+    const std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream ofs(tmp_path, std::ios::binary);
+        ofs.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+        ofs.close();
+        if (!ofs) {
+            std::cerr << "Failed to write checkpoint: " << tmp_path << std::endl;
+            std::remove(tmp_path.c_str());
+            return false;
+        }
+    }
+
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        std::cerr << "Failed to replace checkpoint: " << path << std::endl;
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool read_checkpoint(const std::string& path, EncoderCheckpoint& checkpoint)
+{
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs) {
+        return false;
+    }
+    const std::vector<uint8_t> buffer((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+
+    if (buffer.size() < CHECKPOINT_HEADER_SIZE ||
+        std::memcmp(buffer.data(), CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) != 0)
+    {
+        std::cerr << "Not a checkpoint file: " << path << std::endl;
+        return false;
+    }
+
+    uint32_t version = 0;
+    uint8_t last_decision = 0;
+    uint8_t ema_initialized = 0;
+    DecisionEngineState& decision = checkpoint.decision;
+
+    const uint8_t* p = buffer.data() + sizeof(CHECKPOINT_MAGIC);
+    p = get(p, version);
+    if (version != CHECKPOINT_VERSION) {
+        std::cerr << "Unsupported checkpoint version " << version << ": " << path << std::endl;
+        return false;
+    }
+    p = get(p, decision.frames_since_keyframe);
+    p = get(p, decision.last_keyframe_index);
+    p = get(p, last_decision);
+    p = get(p, ema_initialized);
+    p = get(p, decision.ema_residual_bpp);
+    p = get(p, decision.ema_keyframe_bpp);
+    decision.last_decision = (last_decision == 0) ? FrameMode::USE_INTRA : FrameMode::USE_RESIDUAL;
+    decision.ema_initialized = (ema_initialized != 0);
+
+    if (!read_frame_record(p, buffer.size() - CHECKPOINT_HEADER_SIZE, checkpoint.reference) ||
+        !checkpoint.reference.is_keyframe)
+    {
+        std::cerr << "Truncated checkpoint: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace lwir
@@ -7,6 +7,9 @@
  */
 
 #include "config.hpp"
+#include "overload.hpp"
+#include "packed.hpp"
+#include "timeline.hpp"
 #include <yaml-cpp/yaml.h>
 #include <iostream>
 #include <fstream>
@@ -61,6 +64,44 @@ bool CompressionConfig::load_from_node(const YAML::Node& node)
     input_dir = node["input_dir"].as<std::string>();
     output_dir = node["output_dir"].as<std::string>();
 
+    load_parameters(node);
+
+    // Validate parameters
+    return validate();
+}
+
+bool CompressionConfig::load_from_string(const std::string& yaml_text, const std::string& profile_name)
+{
+    try {
+        const YAML::Node root = YAML::Load(yaml_text);
+        const YAML::Node node = (root["profiles"] && root["profiles"][profile_name])
+                              ? root["profiles"][profile_name] : root;
+
+        // Paths are optional when the encoder is embedded
+        if (node["input_dir"]) input_dir = node["input_dir"].as<std::string>();
+        if (node["output_dir"]) output_dir = node["output_dir"].as<std::string>();
+
+        load_parameters(node);
+        return validate_parameters();
+    }
+    catch (const YAML::Exception& e) {
+        std::cerr << "YAML parsing error: " << e.what() << std::endl;
+        return false;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Configuration error: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+void CompressionConfig::load_parameters(const YAML::Node& node)
+{
+    // Input format
+    input_format = get_yaml_value(node, "input_format", std::string("png"));
+    input_width = get_yaml_value(node, "input_width", 0u);
+    input_height = get_yaml_value(node, "input_height", 0u);
+    prefetch_workers = get_yaml_value(node, "prefetch_workers", 0u);
+
     // Optional parameters with defaults
     gop_period = get_yaml_value(node, "gop_period", 60u);
     keyframe_near = get_yaml_value(node, "keyframe_near", 0u);
@@ -77,13 +118,57 @@ bool CompressionConfig::load_from_node(const YAML::Node& node)
     decision_p99_threshold = get_yaml_value(node, "decision_p99_threshold", 100.0);
     decision_entropy_threshold = get_yaml_value(node, "decision_entropy_threshold", 6.0);
     decision_hysteresis_bpp = get_yaml_value(node, "decision_hysteresis_bpp", 0.15);
+    enable_decision_stats = get_yaml_value(node, "enable_decision_stats", false);
+
+    // Repeat frames
+    detect_repeats = get_yaml_value(node, "detect_repeats", false);
+    static_gating = get_yaml_value(node, "static_gating", false);
+
+    // Capture timeline
+    frame_period_us = get_yaml_value(node, "frame_period_us", 0.0);
+    gap_policy = get_yaml_value(node, "gap_policy", std::string("keyframe"));
+    gap_widen_near = get_yaml_value(node, "gap_widen_near", 5u);
+
+    // Real-time budget
+    frame_deadline_ms = get_yaml_value(node, "frame_deadline_ms", 33.3);
+
+    // Overlapped encoding
+    encode_workers = get_yaml_value(node, "encode_workers", 0u);
+
+    // Overload degradation ladder
+    overload_enable = get_yaml_value(node, "overload_enable", false);
+    overload_ladder = get_yaml_value(node, "overload_ladder", overload_ladder);
+    overload_slack_low_ms = get_yaml_value(node, "overload_slack_low_ms", 3.0);
+    overload_slack_high_ms = get_yaml_value(node, "overload_slack_high_ms", 10.0);
+    overload_queue_high = get_yaml_value(node, "overload_queue_high", 2u);
+    overload_cooldown_frames = get_yaml_value(node, "overload_cooldown_frames", 5u);
+    overload_hold_frames = get_yaml_value(node, "overload_hold_frames", 60u);
+    overload_near_step = get_yaml_value(node, "overload_near_step", 5u);
+    overload_q_scale = get_yaml_value(node, "overload_q_scale", 1.5);
+    overload_t_step = get_yaml_value(node, "overload_t_step", 2u);
+    overload_gop_scale = get_yaml_value(node, "overload_gop_scale", 2u);
+    overload_stats_stride = get_yaml_value(node, "overload_stats_stride", 4u);
+
+    // Profiling
+    enable_perf_counters = get_yaml_value(node, "enable_perf_counters", false);
 
     // Output options
     write_residual_histograms = get_yaml_value(node, "write_residual_histograms", false);
     write_decoded_frames = get_yaml_value(node, "write_decoded_frames", false);
-
-    // Validate parameters
-    return validate();
+    compute_error_stats = get_yaml_value(node, "compute_error_stats", false);
+    verbose = get_yaml_value(node, "verbose", true);
+    dry_run = get_yaml_value(node, "dry_run", false);
+    sync_writes = get_yaml_value(node, "sync_writes", false);
+
+    // Segmented output
+    segment_gops = get_yaml_value(node, "segment_gops", 0u);
+    segment_mb = get_yaml_value(node, "segment_mb", 0u);
+    segment_minutes = get_yaml_value(node, "segment_minutes", 0.0);
+    storage_budget_mb = get_yaml_value(node, "storage_budget_mb", 0u);
+
+    // Failover checkpoints
+    checkpoint_path = get_yaml_value(node, "checkpoint_path", std::string());
+    checkpoint_interval = get_yaml_value(node, "checkpoint_interval", 0u);
 }
 
 bool CompressionConfig::validate() const
@@ -93,6 +178,24 @@ bool CompressionConfig::validate() const
         return false;
     }
 
+    return validate_parameters();
+}
+
+bool CompressionConfig::validate_parameters() const
+{
+    if (input_format != "png" && input_format != "tiff") {
+        PackedFormat format;
+        if (!parse_packed_format(input_format, format)) {
+            std::cerr << "Unknown input format: " << input_format << std::endl;
+            return false;
+        }
+        if (input_height == 0 || packed_frame_bytes(format, input_width, input_height) == 0) {
+            std::cerr << "Packed input needs input_width (a multiple of " << packed_group_pixels(format)
+                      << ") and input_height" << std::endl;
+            return false;
+        }
+    }
+
     if (gop_period == 0) {
         std::cerr << "GOP period must be > 0" << std::endl;
         return false;
@@ -118,13 +221,70 @@ bool CompressionConfig::validate() const
         return false;
     }
 
+    if (frame_period_us < 0.0) {
+        std::cerr << "Frame period must be >= 0" << std::endl;
+        return false;
+    }
+
+    if (segment_minutes < 0.0) {
+        std::cerr << "Segment minutes must be >= 0" << std::endl;
+        return false;
+    }
+
+    // Room for the segment being written plus at least one closed segment
+    if (storage_budget_mb > 0 && (segment_mb == 0 || storage_budget_mb < 2 * segment_mb)) {
+        std::cerr << "Storage budget needs segment_mb, and at least two segments (2 x segment_mb)" << std::endl;
+        return false;
+    }
+
+    GapPolicy policy;
+    if (!parse_gap_policy(gap_policy, policy)) {
+        std::cerr << "Unknown gap policy: " << gap_policy << std::endl;
+        return false;
+    }
+
+    if (frame_deadline_ms < 0.0) {
+        std::cerr << "Frame deadline must be >= 0" << std::endl;
+        return false;
+    }
+
+    if (overload_enable) {
+        for (const std::string& name : overload_ladder) {
+            OverloadStep step;
+            if (!parse_overload_step(name, step)) {
+                std::cerr << "Unknown overload ladder step: " << name << std::endl;
+                return false;
+            }
+        }
+
+        if (overload_slack_high_ms < overload_slack_low_ms) {
+            std::cerr << "Overload slack high must be >= slack low" << std::endl;
+            return false;
+        }
+
+        if (overload_q_scale < 1.0 || overload_gop_scale < 1 || overload_stats_stride < 1) {
+            std::cerr << "Overload Q scale, GOP scale and stats stride must be >= 1" << std::endl;
+            return false;
+        }
+    }
+
     return true;
 }
 
 void CompressionConfig::print() const
 {
     std::cout << "Configuration:" << std::endl;
-    std::cout << "  Input: " << input_dir << std::endl;
+    std::cout << "  Input: " << input_dir;
+    if (input_format == "tiff") {
+        std::cout << " (TIFF stack)";
+    }
+    else if (input_format != "png") {
+        std::cout << " (" << input_format << " " << input_width << "x" << input_height << ")";
+    }
+    if (frame_range_count > 0) {
+        std::cout << ", frames " << frame_range_first << "-" << (frame_range_first + frame_range_count - 1);
+    }
+    std::cout << std::endl;
     std::cout << "  Output: " << output_dir << std::endl;
     std::cout << "  GOP Period: " << gop_period << std::endl;
     std::cout << "  Keyframe NEAR: " << keyframe_near << std::endl;
@@ -134,6 +294,52 @@ void CompressionConfig::print() const
     std::cout << "  Decision P99 threshold: " << decision_p99_threshold << std::endl;
     std::cout << "  Decision entropy threshold: " << decision_entropy_threshold << std::endl;
     std::cout << "  Decision hysteresis: " << decision_hysteresis_bpp << " bpp" << std::endl;
+    std::cout << "  Frame deadline: " << frame_deadline_ms << " ms" << std::endl;
+    if (detect_repeats || static_gating) {
+        std::cout << "  Repeat frames:" << (detect_repeats ? " exact" : "")
+                  << (static_gating ? " static" : "") << std::endl;
+    }
+    if (frame_period_us > 0.0) {
+        std::cout << "  Frame period: " << frame_period_us << " us (gap policy: " << gap_policy;
+        if (gap_policy == "widen") {
+            std::cout << ", NEAR +" << gap_widen_near;
+        }
+        std::cout << ")" << std::endl;
+    }
+    if (encode_workers > 0) {
+        std::cout << "  Encode workers: " << encode_workers << " (NEAR=0 frames)" << std::endl;
+    }
+    if (segmented_output()) {
+        const char* separator = " ";
+        std::cout << "  Segments: roll over at the keyframe after";
+        if (segment_gops > 0) {
+            std::cout << separator << segment_gops << " GOPs";
+            separator = " / ";
+        }
+        if (segment_mb > 0) {
+            std::cout << separator << segment_mb << " MB";
+            separator = " / ";
+        }
+        if (segment_minutes > 0.0) {
+            std::cout << separator << segment_minutes << " min";
+        }
+        if (storage_budget_mb > 0) {
+            std::cout << ", ring of " << storage_budget_mb << " MB";
+        }
+        std::cout << std::endl;
+    }
+    if (!checkpoint_path.empty()) {
+        std::cout << "  Checkpoint: " << checkpoint_path << " (every "
+                  << (checkpoint_interval ? std::to_string(checkpoint_interval) + " frames" : std::string("keyframe"))
+                  << ")" << std::endl;
+    }
+    if (overload_enable) {
+        std::cout << "  Overload ladder:";
+        for (const std::string& name : overload_ladder) {
+            std::cout << " " << name;
+        }
+        std::cout << std::endl;
+    }
 }
 
 
@@ -195,8 +401,56 @@ FrameMode FrameDecisionEngine::decide_mode(const ResidualStats& stats, uint32_t
     return FrameMode::USE_RESIDUAL;
 }
 
+void FrameDecisionEngine::force_keyframe(uint32_t frame_index)
+{
+    frames_since_keyframe_ = 0;
+    last_keyframe_index_ = frame_index;
+    last_decision_ = FrameMode::USE_INTRA;
+}
+
+DecisionEngineState FrameDecisionEngine::state() const
+{
+    DecisionEngineState state;
+    state.last_keyframe_index = last_keyframe_index_;
+    state.frames_since_keyframe = frames_since_keyframe_;
+    state.last_decision = last_decision_;
+    state.ema_residual_bpp = ema_residual_bpp_;
+    state.ema_keyframe_bpp = ema_keyframe_bpp_;
+    state.ema_initialized = ema_initialized_;
+    return state;
+}
+
+void FrameDecisionEngine::restore_state(const DecisionEngineState& state)
+{
+    last_keyframe_index_ = state.last_keyframe_index;
+    frames_since_keyframe_ = state.frames_since_keyframe;
+    last_decision_ = state.last_decision;
+    ema_residual_bpp_ = state.ema_residual_bpp;
+    ema_keyframe_bpp_ = state.ema_keyframe_bpp;
+    ema_initialized_ = state.ema_initialized;
+}
+
+void FrameDecisionEngine::record_frame(uint32_t frame_index, bool was_keyframe, size_t compressed_bytes)
+{
+    // Same bookkeeping as decide_mode() followed by update_stats()
+    if (was_keyframe) {
+        frames_since_keyframe_ = 0;
+        last_keyframe_index_ = frame_index;
+        last_decision_ = FrameMode::USE_INTRA;
+    }
+    else {
+        frames_since_keyframe_++;
+        last_decision_ = FrameMode::USE_RESIDUAL;
+    }
+    update_stats(compressed_bytes, was_keyframe);
+}
+
 void FrameDecisionEngine::update_stats(size_t compressed_bytes, bool was_keyframe)
 {
+    if (!was_keyframe && compressed_bytes == 0) {
+        return;   // Repeat record
+    }
+
     // Compute bits per pixel (assuming 640x512 for now; should be configurable)
     const double bits_per_pixel = (compressed_bytes * 8.0) / (640.0 * 512.0);
 
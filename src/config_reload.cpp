@@ -0,0 +1,275 @@
+/**
+ * @file config_reload.cpp
+ * @brief Hot configuration reload implementation
+ */
+
+#include "config_reload.hpp"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+namespace lwir {
+
+void apply_frame_parameters(const CompressionConfig& update, CompressionConfig& config)
+{
+    config.residual_near = update.residual_near;
+    config.dead_zone_T = update.dead_zone_T;
+    config.quant_Q = update.quant_Q;
+
+    config.decision_p95_threshold = update.decision_p95_threshold;
+    config.decision_p99_threshold = update.decision_p99_threshold;
+    config.decision_entropy_threshold = update.decision_entropy_threshold;
+    config.decision_hysteresis_bpp = update.decision_hysteresis_bpp;
+    config.enable_decision_stats = update.enable_decision_stats;
+
+    config.detect_repeats = update.detect_repeats;
+    config.static_gating = update.static_gating;
+
+    config.frame_period_us = update.frame_period_us;
+    config.gap_policy = update.gap_policy;
+    config.gap_widen_near = update.gap_widen_near;
+
+    config.overload_slack_low_ms = update.overload_slack_low_ms;
+    config.overload_slack_high_ms = update.overload_slack_high_ms;
+    config.overload_queue_high = update.overload_queue_high;
+    config.overload_cooldown_frames = update.overload_cooldown_frames;
+    config.overload_hold_frames = update.overload_hold_frames;
+    config.overload_near_step = update.overload_near_step;
+    config.overload_q_scale = update.overload_q_scale;
+    config.overload_t_step = update.overload_t_step;
+    config.overload_gop_scale = update.overload_gop_scale;
+    config.overload_stats_stride = update.overload_stats_stride;
+
+    config.compute_error_stats = update.compute_error_stats;
+    config.verbose = update.verbose;
+}
+
+void apply_gop_parameters(const CompressionConfig& update, CompressionConfig& config)
+{
+    config.gop_period = update.gop_period;
+    config.keyframe_near = update.keyframe_near;
+    config.fp_bits = update.fp_bits;
+    config.enable_12bit_mode = update.enable_12bit_mode;
+}
+
+std::vector<std::string> restart_parameter_changes(const CompressionConfig& update,
+                                                   const CompressionConfig& config)
+{
+    std::vector<std::string> changed;
+    if (update.input_dir != config.input_dir) changed.push_back("input_dir");
+    if (update.input_format != config.input_format) changed.push_back("input_format");
+    if (update.input_width != config.input_width || update.input_height != config.input_height) {
+        changed.push_back("input_width/input_height");
+    }
+    if (update.prefetch_workers != config.prefetch_workers) changed.push_back("prefetch_workers");
+    if (update.output_dir != config.output_dir) changed.push_back("output_dir");
+    if (update.dry_run != config.dry_run) changed.push_back("dry_run");
+    if (update.sync_writes != config.sync_writes) changed.push_back("sync_writes");
+    if (update.segment_gops != config.segment_gops || update.segment_mb != config.segment_mb ||
+        update.segment_minutes != config.segment_minutes)
+    {
+        changed.push_back("segment_gops/segment_mb/segment_minutes");
+    }
+    if (update.storage_budget_mb != config.storage_budget_mb) changed.push_back("storage_budget_mb");
+    if (update.frame_deadline_ms != config.frame_deadline_ms) changed.push_back("frame_deadline_ms");
+    if (update.overload_enable != config.overload_enable) changed.push_back("overload_enable");
+    if (update.overload_ladder != config.overload_ladder) changed.push_back("overload_ladder");
+    if (update.enable_perf_counters != config.enable_perf_counters) changed.push_back("enable_perf_counters");
+    if (update.encode_workers != config.encode_workers) changed.push_back("encode_workers");
+    if (update.checkpoint_path != config.checkpoint_path) changed.push_back("checkpoint_path");
+    if (update.checkpoint_interval != config.checkpoint_interval) changed.push_back("checkpoint_interval");
+    return changed;
+}
+
+ConfigReloader::ConfigReloader(const std::string& yaml_path, const std::string& profile)
+    : yaml_path_(yaml_path)
+    , profile_(profile)
+    , inotify_fd_(-1)
+    , stopping_(false)
+    , pending_(false)
+    , reloads_(0)
+    , rejected_(0)
+{
+    wake_fds_[0] = -1;
+    wake_fds_[1] = -1;
+}
+
+ConfigReloader::~ConfigReloader()
+{
+    stop();
+}
+
+bool ConfigReloader::start(bool watch_file)
+{
+    if (thread_.joinable()) {
+        return true;
+    }
+
+    if (::pipe(wake_fds_) != 0) {
+        std::cerr << "Config reload: pipe failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    // A full pipe means a reload is already requested; never block the signal handler
+    ::fcntl(wake_fds_[1], F_SETFL, O_NONBLOCK);
+
+    if (watch_file) {
+#ifdef __linux__
+        // Watch the directory: editors replace the file rather than rewrite it
+        const size_t slash = yaml_path_.find_last_of('/');
+        const std::string dir = (slash == std::string::npos) ? "." : yaml_path_.substr(0, slash);
+        inotify_fd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotify_fd_ < 0 ||
+            ::inotify_add_watch(inotify_fd_, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+        {
+            std::cerr << "Config reload: cannot watch " << dir << ": " << std::strerror(errno) << std::endl;
+            stop();
+            return false;
+        }
+#else
+        std::cerr << "Config reload: file watching is only supported on Linux, use SIGHUP" << std::endl;
+#endif
+    }
+
+    stopping_ = false;
+    thread_ = std::thread(&ConfigReloader::watch_loop, this);
+    return true;
+}
+
+void ConfigReloader::stop()
+{
+    if (thread_.joinable()) {
+        stopping_ = true;
+        const char byte = 0;
+        (void)!::write(wake_fds_[1], &byte, 1);
+        thread_.join();
+    }
+
+    for (int& fd : wake_fds_) {
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+    if (inotify_fd_ >= 0) {
+        ::close(inotify_fd_);
+        inotify_fd_ = -1;
+    }
+}
+
+void ConfigReloader::request_reload()
+{
+    // Only write(2): safe in a signal handler
+    if (wake_fds_[1] >= 0) {
+        const char byte = 1;
+        (void)!::write(wake_fds_[1], &byte, 1);
+    }
+}
+
+bool ConfigReloader::take(CompressionConfig& config)
+{
+    if (!pending_.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        return false;
+    }
+
+    config = staged_;
+    pending_.store(false, std::memory_order_release);
+    return true;
+}
+
+void ConfigReloader::watch_loop()
+{
+    const size_t slash = yaml_path_.find_last_of('/');
+    const std::string file_name = (slash == std::string::npos) ? yaml_path_ : yaml_path_.substr(slash + 1);
+
+    while (!stopping_) {
+        pollfd fds[2];
+        nfds_t count = 0;
+        fds[count].fd = wake_fds_[0];
+        fds[count].events = POLLIN;
+        count++;
+        if (inotify_fd_ >= 0) {
+            fds[count].fd = inotify_fd_;
+            fds[count].events = POLLIN;
+            count++;
+        }
+
+        if (::poll(fds, count, -1) < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "Config reload: poll failed: " << std::strerror(errno) << std::endl;
+            return;
+        }
+
+        bool wanted = false;
+
+        if (fds[0].revents & POLLIN) {
+            // Drain: several SIGHUPs in a row collapse into one reload
+            char bytes[64];
+            const ssize_t n = ::read(wake_fds_[0], bytes, sizeof(bytes));
+            for (ssize_t i = 0; i < n; ++i) {
+                wanted = wanted || (bytes[i] != 0);
+            }
+        }
+
+#ifdef __linux__
+        if (count > 1 && (fds[1].revents & POLLIN)) {
+            alignas(inotify_event) char events[4096];
+            ssize_t n;
+            while ((n = ::read(inotify_fd_, events, sizeof(events))) > 0) {
+                for (char* p = events; p < events + n; ) {
+                    const inotify_event* event = reinterpret_cast<const inotify_event*>(p);
+                    if (event->len > 0 && file_name == event->name) {
+                        wanted = true;
+                    }
+                    p += sizeof(inotify_event) + event->len;
+                }
+            }
+        }
+#endif
+
+        if (wanted && !stopping_) {
+            reload();
+        }
+    }
+}
+
+void ConfigReloader::reload()
+{
+    std::ifstream ifs(yaml_path_);
+    if (!ifs) {
+        std::cerr << "Config reload: cannot read " << yaml_path_ << ", keeping current configuration" << std::endl;
+        rejected_++;
+        return;
+    }
+    std::ostringstream text;
+    text << ifs.rdbuf();
+
+    CompressionConfig update;
+    if (!update.load_from_string(text.str(), profile_)) {
+        std::cerr << "Config reload: " << yaml_path_ << " rejected, keeping current configuration" << std::endl;
+        rejected_++;
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        staged_ = update;
+        pending_.store(true, std::memory_order_release);
+    }
+    reloads_++;
+}
+
+} // namespace lwir
@@ -0,0 +1,207 @@
+/**
+ * @file deadline.cpp
+ * @brief Real-time frame budget tracking implementation
+ */
+
+#include "deadline.hpp"
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+
+namespace lwir {
+
+const char* stage_name(PipelineStage stage)
+{
+    switch (stage) {
+        case PipelineStage::LOAD:   return "load";
+        case PipelineStage::DECIDE: return "decide";
+        case PipelineStage::ENCODE: return "encode";
+        case PipelineStage::WRITE:  return "write";
+        default:                    return "unknown";
+    }
+}
+
+DeadlineMonitor::DeadlineMonitor(double deadline_ms)
+    : deadline_ms_(deadline_ms)
+    , frame_index_(0)
+    , last_slack_ms_(0.0)
+    , last_latency_ms_(0.0)
+    , max_latency_ms_(0.0)
+{
+    std::fill(stage_ms_, stage_ms_ + PIPELINE_STAGE_COUNT, 0.0);
+    std::fill(stage_total_ms_, stage_total_ms_ + PIPELINE_STAGE_COUNT, 0.0);
+    std::fill(misses_by_stage_, misses_by_stage_ + PIPELINE_STAGE_COUNT, 0u);
+}
+
+void DeadlineMonitor::begin_frame(uint32_t frame_index, Clock::time_point arrival)
+{
+    frame_index_ = frame_index;
+    arrival_ = arrival;
+    last_mark_ = arrival;
+    std::fill(stage_ms_, stage_ms_ + PIPELINE_STAGE_COUNT, 0.0);
+}
+
+void DeadlineMonitor::mark_stage(PipelineStage stage)
+{
+    const Clock::time_point now = Clock::now();
+    const double ms = std::chrono::duration<double, std::milli>(now - last_mark_).count();
+    stage_ms_[static_cast<size_t>(stage)] += ms;
+    last_mark_ = now;
+}
+
+double DeadlineMonitor::end_frame()
+{
+    const double latency_ms = std::chrono::duration<double, std::milli>(last_mark_ - arrival_).count();
+
+    last_latency_ms_ = latency_ms;
+    max_latency_ms_ = std::max(max_latency_ms_, latency_ms);
+    for (size_t s = 0; s < PIPELINE_STAGE_COUNT; ++s) {
+        stage_total_ms_[s] += stage_ms_[s];
+    }
+
+    if (!enabled()) {
+        last_slack_ms_ = 0.0;
+        slack_ms_.push_back(0.0f);
+        return 0.0;
+    }
+
+    last_slack_ms_ = deadline_ms_ - latency_ms;
+    slack_ms_.push_back(static_cast<float>(last_slack_ms_));
+
+    if (last_slack_ms_ < 0.0) {
+        // Attribute the miss to the most expensive stage
+        size_t worst = 0;
+        for (size_t s = 1; s < PIPELINE_STAGE_COUNT; ++s) {
+            if (stage_ms_[s] > stage_ms_[worst]) {
+                worst = s;
+            }
+        }
+
+        DeadlineMiss miss;
+        miss.frame_index = frame_index_;
+        miss.latency_ms = latency_ms;
+        miss.slack_ms = last_slack_ms_;
+        miss.stage = static_cast<PipelineStage>(worst);
+        miss.stage_ms = stage_ms_[worst];
+        misses_.push_back(miss);
+        misses_by_stage_[worst]++;
+
+        std::cerr << "Deadline miss: frame " << frame_index_
+                  << " took " << std::fixed << std::setprecision(2) << latency_ms << " ms"
+                  << " (budget " << deadline_ms_ << " ms), "
+                  << stage_name(miss.stage) << " stage " << miss.stage_ms << " ms"
+                  << std::endl;
+    }
+
+    return last_slack_ms_;
+}
+
+DeadlineMonitor::FrameTiming DeadlineMonitor::suspend_frame() const
+{
+    FrameTiming timing;
+    timing.frame_index = frame_index_;
+    timing.arrival = arrival_;
+    timing.last_mark = last_mark_;
+    std::copy(stage_ms_, stage_ms_ + PIPELINE_STAGE_COUNT, timing.stage_ms);
+    return timing;
+}
+
+void DeadlineMonitor::resume_frame(const FrameTiming& timing)
+{
+    frame_index_ = timing.frame_index;
+    arrival_ = timing.arrival;
+    last_mark_ = timing.last_mark;
+    std::copy(timing.stage_ms, timing.stage_ms + PIPELINE_STAGE_COUNT, stage_ms_);
+}
+
+double DeadlineMonitor::slack_percentile(double p) const
+{
+    if (slack_ms_.empty() || p < 0.0 || p > 1.0) return 0.0;
+
+    std::vector<float> sorted(slack_ms_);
+    const size_t k = std::min(sorted.size() - 1,
+                              static_cast<size_t>(p * (sorted.size() - 1) + 0.5));
+    std::nth_element(sorted.begin(), sorted.begin() + k, sorted.end());
+    return static_cast<double>(sorted[k]);
+}
+
+void DeadlineMonitor::print_summary() const
+{
+    if (!enabled() || slack_ms_.empty()) return;
+
+    const uint32_t n = frames();
+    std::cout << "Deadline: " << std::fixed << std::setprecision(2) << deadline_ms_ << " ms/frame"
+              << " | misses " << misses() << "/" << n
+              << " (" << std::setprecision(2) << (100.0 * misses() / n) << "%)" << std::endl;
+    std::cout << "  Slack p1/p5/p50: "
+              << std::setprecision(2) << slack_percentile(0.01) << " / "
+              << slack_percentile(0.05) << " / "
+              << slack_percentile(0.50) << " ms"
+              << " | worst latency " << max_latency_ms_ << " ms" << std::endl;
+
+    std::cout << "  Avg stage time:";
+    for (size_t s = 0; s < PIPELINE_STAGE_COUNT; ++s) {
+        std::cout << " " << stage_name(static_cast<PipelineStage>(s)) << "="
+                  << std::setprecision(2) << (stage_total_ms_[s] / n) << "ms";
+    }
+    std::cout << std::endl;
+
+    if (misses() > 0) {
+        std::cout << "  Misses by stage:";
+        for (size_t s = 0; s < PIPELINE_STAGE_COUNT; ++s) {
+            std::cout << " " << stage_name(static_cast<PipelineStage>(s)) << "=" << misses_by_stage_[s];
+        }
+        std::cout << std::endl;
+    }
+}
+
+std::string DeadlineMonitor::to_json(const std::string& indent) const
+{
+    const uint32_t n = frames();
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(3);
+
+    oss << "{\n";
+    oss << indent << "  \"deadline_ms\": " << deadline_ms_ << ",\n";
+    oss << indent << "  \"frames\": " << n << ",\n";
+    oss << indent << "  \"misses\": " << misses() << ",\n";
+    oss << indent << "  \"miss_rate\": " << (n > 0 ? static_cast<double>(misses()) / n : 0.0) << ",\n";
+    oss << indent << "  \"max_latency_ms\": " << max_latency_ms_ << ",\n";
+    oss << indent << "  \"slack_ms\": {"
+        << "\"p1\": " << slack_percentile(0.01) << ", "
+        << "\"p5\": " << slack_percentile(0.05) << ", "
+        << "\"p50\": " << slack_percentile(0.50) << ", "
+        << "\"p95\": " << slack_percentile(0.95) << "},\n";
+
+    oss << indent << "  \"avg_stage_ms\": {";
+    for (size_t s = 0; s < PIPELINE_STAGE_COUNT; ++s) {
+        oss << (s ? ", " : "") << "\"" << stage_name(static_cast<PipelineStage>(s)) << "\": "
+            << (n > 0 ? stage_total_ms_[s] / n : 0.0);
+    }
+    oss << "},\n";
+
+    oss << indent << "  \"misses_by_stage\": {";
+    for (size_t s = 0; s < PIPELINE_STAGE_COUNT; ++s) {
+        oss << (s ? ", " : "") << "\"" << stage_name(static_cast<PipelineStage>(s)) << "\": "
+            << misses_by_stage_[s];
+    }
+    oss << "},\n";
+
+    oss << indent << "  \"miss_log\": [";
+    for (size_t i = 0; i < misses_.size(); ++i) {
+        const DeadlineMiss& m = misses_[i];
+        oss << (i ? "," : "") << "\n" << indent << "    {"
+            << "\"frame\": " << m.frame_index << ", "
+            << "\"latency_ms\": " << m.latency_ms << ", "
+            << "\"slack_ms\": " << m.slack_ms << ", "
+            << "\"stage\": \"" << stage_name(m.stage) << "\", "
+            << "\"stage_ms\": " << m.stage_ms << "}";
+    }
+    oss << (misses_.empty() ? "]\n" : "\n" + indent + "  ]\n");
+    oss << indent << "}";
+
+    return oss.str();
+}
+
+} // namespace lwir
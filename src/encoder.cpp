@@ -3,14 +3,21 @@
  * @brief CharLS encoder/decoder wrapper with closed-loop support
  *
  * Implements frame encoding with temporal residual compression using CharLS JPEG-LS.
- * Maintains reference frame state for closed-loop encoding when NEAR > 0.
+ * Maintains the decoder-side reference frame (closed loop) so residuals never
+ * drift, whatever the NEAR and quantization settings.
  */
 
 #include "encoder.hpp"
 #include "bitdepth.hpp"
+#include "perf_counters.hpp"
 #include <charls/charls_jpegls_encoder.h>
 #include <charls/charls_jpegls_decoder.h>
 #include <charls/public_types.h>
+#if defined(__has_include)
+#if __has_include(<charls/version.h>)
+#include <charls/version.h>
+#endif
+#endif
 #include <cstring>
 #include <stdexcept>
 #include <iostream>
@@ -20,6 +27,47 @@ namespace lwir {
 // CharLS success code
 static constexpr int CHARLS_SUCCESS = 0;
 
+// Destination buffer handed to CharLS: its estimate plus a safety margin
+static size_t destination_capacity(size_t estimated_size)
+{
+    return estimated_size + (estimated_size / 10) + 1024;
+}
+
+std::string jpegls_codec_version()
+{
+#if defined(CHARLS_VERSION_MAJOR) && defined(CHARLS_VERSION_MINOR) && defined(CHARLS_VERSION_PATCH)
+    return "charls-" + std::to_string(CHARLS_VERSION_MAJOR) + "." + std::to_string(CHARLS_VERSION_MINOR) + "." +
+           std::to_string(CHARLS_VERSION_PATCH);
+#else
+    return "charls-unversioned";
+#endif
+}
+
+size_t max_payload_size(uint32_t width, uint32_t height)
+{
+    charls_jpegls_encoder* encoder = charls_jpegls_encoder_create();
+    if (!encoder) {
+        return 0;
+    }
+
+    // 16-bit samples give the largest estimate (12-bit keyframes are smaller)
+    charls_frame_info frame_info = {};
+    frame_info.width = width;
+    frame_info.height = height;
+    frame_info.bits_per_sample = 16;
+    frame_info.component_count = 1;
+
+    size_t estimated_size = 0;
+    if (static_cast<int>(charls_jpegls_encoder_set_frame_info(encoder, &frame_info)) != CHARLS_SUCCESS ||
+        static_cast<int>(charls_jpegls_encoder_get_estimated_destination_size(encoder, &estimated_size)) != CHARLS_SUCCESS)
+    {
+        estimated_size = 0;
+    }
+    charls_jpegls_encoder_destroy(encoder);
+
+    return estimated_size > 0 ? destination_capacity(estimated_size) : 0;
+}
+
 // Helper function to encode 16-bit data with CharLS (C API)
 static bool encode_charls_16bit(
     const uint16_t* data,
@@ -68,7 +116,7 @@ static bool encode_charls_16bit(
     }
 
     // Add 10% safety margin to estimated size
-    output.resize(estimated_size + (estimated_size / 10) + 1024);
+    output.resize(destination_capacity(estimated_size));
 
     // Set destination
     err = charls_jpegls_encoder_set_destination_buffer(encoder, output.data(), output.size());
@@ -177,16 +225,108 @@ static bool decode_charls_16bit(
 }
 
 
+// Helper function to read image dimensions from a JPEG-LS header
+static bool read_charls_dimensions(
+    const uint8_t* compressed_data,
+    size_t compressed_size,
+    uint32_t& width,
+    uint32_t& height)
+{
+    charls_jpegls_decoder* decoder = charls_jpegls_decoder_create();
+    if (!decoder) {
+        return false;
+    }
+
+    charls_frame_info frame_info;
+    const bool ok =
+        static_cast<int>(charls_jpegls_decoder_set_source_buffer(decoder, compressed_data, compressed_size)) == CHARLS_SUCCESS &&
+        static_cast<int>(charls_jpegls_decoder_read_header(decoder)) == CHARLS_SUCCESS &&
+        static_cast<int>(charls_jpegls_decoder_get_frame_info(decoder, &frame_info)) == CHARLS_SUCCESS;
+
+    charls_jpegls_decoder_destroy(decoder);
+
+    if (ok) {
+        width = frame_info.width;
+        height = frame_info.height;
+    }
+    return ok;
+}
+
+
+CharlsEncoder::CharlsEncoder()
+{
+}
+
+CharlsEncoder::~CharlsEncoder()
+{
+}
+
+bool CharlsEncoder::encode(
+    const uint16_t* data,
+    uint32_t width,
+    uint32_t height,
+    uint32_t near_param,
+    std::vector<uint8_t>& output,
+    uint32_t bits_per_sample)
+{
+    if (!encode_charls_16bit(data, width, height, near_param, output, bits_per_sample)) {
+        last_error_ = "JPEG-LS encode failed";
+        return false;
+    }
+    last_error_.clear();
+    return true;
+}
+
+bool CharlsEncoder::decode(
+    const uint8_t* encoded,
+    size_t encoded_size,
+    std::vector<uint16_t>& output,
+    uint32_t& width,
+    uint32_t& height)
+{
+    if (!read_charls_dimensions(encoded, encoded_size, width, height)) {
+        last_error_ = "Invalid JPEG-LS header";
+        return false;
+    }
+    if (!decode_charls_16bit(encoded, encoded_size, width, height, output)) {
+        last_error_ = "JPEG-LS decode failed";
+        return false;
+    }
+    last_error_.clear();
+    return true;
+}
+
+
+bool entropy_code(PreparedFrame& prepared)
+{
+    if (prepared.frame.is_repeat) {
+        return true;   // Header only
+    }
+    return encode_charls_16bit(
+        prepared.plane.data(),
+        prepared.frame.width, prepared.frame.height,
+        prepared.near_lossless,
+        prepared.frame.compressed_data,
+        prepared.bits_per_sample);
+}
+
 FrameEncoder::FrameEncoder()
     : reference_frame_initialized_(false)
+    , verify_decode_(true)
+    , profiler_(nullptr)
+    , detect_repeats_(false)
+    , static_gating_(false)
+    , input_hash_(0)
+    , input_hash_valid_(false)
 {
 }
 
-bool FrameEncoder::encode_intra_frame(
-    const Frame& frame,
+const uint16_t* FrameEncoder::begin_intra_frame(
+    const FrameView& frame,
     uint32_t near_lossless,
     CompressedFrame& output,
-    bool enable_12bit_mode)
+    bool enable_12bit_mode,
+    std::vector<uint16_t>& mapped_data)
 {
     // Encode original frame directly (keyframe)
     output.width = frame.width;
@@ -194,6 +334,7 @@ bool FrameEncoder::encode_intra_frame(
     output.timestamp = frame.timestamp;
     output.frame_index = frame.frame_index;
     output.is_keyframe = true;
+    output.is_repeat = false;
     output.near_lossless = near_lossless;
 
     // Clear quantization params for intra frames
@@ -202,16 +343,19 @@ bool FrameEncoder::encode_intra_frame(
     output.fp_bits = 0;
 
     const size_t pixel_count = frame.width * frame.height;
-    const uint16_t* data_to_encode = frame.data.data();
-    std::vector<uint16_t> mapped_data;
+    const uint16_t* data_to_encode = frame.data;
+    mapped_data.clear();
+
+    if (profiler_) profiler_->begin_frame(FrameKind::KEYFRAME, pixel_count);
 
     // Apply 12-bit range mapping if enabled
     if (enable_12bit_mode) {
-        RangeMap range_map = compute_range_map(frame.data.data(), pixel_count);
+        PerfScope scope(profiler_, KernelStage::RANGE_MAP);
+        RangeMap range_map = compute_range_map(frame.data, pixel_count);
 
         if (range_map.is_beneficial()) {
             mapped_data.resize(pixel_count);
-            map_to_12bit(frame.data.data(), mapped_data.data(), pixel_count, range_map);
+            map_to_12bit(frame.data, mapped_data.data(), pixel_count, range_map);
             data_to_encode = mapped_data.data();
 
             output.use_range_map = true;
@@ -228,28 +372,75 @@ bool FrameEncoder::encode_intra_frame(
         output.range_max = 65535;
     }
 
+    return data_to_encode;
+}
+
+void FrameEncoder::set_reference_from_input(
+    const FrameView& frame,
+    const CompressedFrame& output,
+    const std::vector<uint16_t>& mapped_data)
+{
+    // The decoder will reproduce exactly what a lossless keyframe encoded
+    PerfScope scope(profiler_, KernelStage::RECONSTRUCT);
+    if (output.use_range_map) {
+        reference_frame_.data.resize(mapped_data.size());
+        RangeMap range_map(output.range_min, output.range_max);
+        map_from_12bit(mapped_data.data(), reference_frame_.data.data(), mapped_data.size(), range_map);
+    } else {
+        reference_frame_.data.assign(frame.data, frame.data + frame.pixel_count());
+    }
+    reference_frame_.width = frame.width;
+    reference_frame_.height = frame.height;
+    reference_frame_.timestamp = frame.timestamp;
+    reference_frame_.frame_index = frame.frame_index;
+    reference_frame_initialized_ = true;
+}
+
+bool FrameEncoder::encode_intra_frame(
+    const FrameView& input,
+    uint32_t near_lossless,
+    CompressedFrame& output,
+    bool enable_12bit_mode)
+{
+    const FrameView frame = pack_rows(input, input_staging_);
+    const size_t pixel_count = frame.width * frame.height;
+    std::vector<uint16_t> mapped_data;
+    const uint16_t* data_to_encode = begin_intra_frame(frame, near_lossless, output, enable_12bit_mode, mapped_data);
+
     // Encode with CharLS (use 12-bit if range mapping is enabled)
     const uint32_t bits_per_sample = output.use_range_map ? 12 : 16;
-    if (!encode_charls_16bit(data_to_encode, frame.width, frame.height, near_lossless, output.compressed_data, bits_per_sample)) {
-        return false;
+    {
+        PerfScope scope(profiler_, KernelStage::CHARLS_ENCODE);
+        if (!encode_charls_16bit(data_to_encode, frame.width, frame.height, near_lossless, output.compressed_data, bits_per_sample)) {
+            return false;
+        }
     }
 
+    // Lossless keyframe without verification: the decoder will reproduce
+    // exactly what was encoded, so rebuild the reference from the input
+    if (near_lossless == 0 && !verify_decode_) {
+        set_reference_from_input(frame, output, mapped_data);
+    }
     // If this is a keyframe with NEAR=0, decode immediately for reference
     // If NEAR>0, we must decode for closed-loop
-    if (near_lossless == 0 || near_lossless > 0) {
+    else {
         std::vector<uint16_t> decoded;
-        if (!decode_charls_16bit(
-            output.compressed_data.data(),
-            output.compressed_data.size(),
-            frame.width, frame.height,
-            decoded))
         {
-            std::cerr << "Failed to decode keyframe for reference" << std::endl;
-            return false;
+            PerfScope scope(profiler_, KernelStage::CHARLS_DECODE);
+            if (!decode_charls_16bit(
+                output.compressed_data.data(),
+                output.compressed_data.size(),
+                frame.width, frame.height,
+                decoded))
+            {
+                std::cerr << "Failed to decode keyframe for reference" << std::endl;
+                return false;
+            }
         }
 
         // If 12-bit mode was used, inverse map back to 16-bit
         if (output.use_range_map) {
+            PerfScope scope(profiler_, KernelStage::RECONSTRUCT);
             std::vector<uint16_t> unmapped(pixel_count);
             RangeMap range_map(output.range_min, output.range_max);
             map_from_12bit(decoded.data(), unmapped.data(), pixel_count, range_map);
@@ -268,11 +459,13 @@ bool FrameEncoder::encode_intra_frame(
     return true;
 }
 
-bool FrameEncoder::encode_residual_frame(
-    const Frame& frame,
+bool FrameEncoder::begin_residual_frame(
+    const FrameView& frame,
     uint32_t near_lossless,
     const QuantizationParams& quant_params,
-    CompressedFrame& output)
+    CompressedFrame& output,
+    std::vector<int16_t>& quantized,
+    std::vector<uint16_t>& quantized_unsigned)
 {
     if (!reference_frame_initialized_) {
         std::cerr << "Cannot encode residual frame: no reference frame" << std::endl;
@@ -285,103 +478,276 @@ bool FrameEncoder::encode_residual_frame(
     }
 
     const size_t pixel_count = frame.width * frame.height;
+    const ResidualKernels& kernels = kernels_.get(frame.width, frame.height, quant_params.fp_bits);
+
+    if (profiler_) profiler_->begin_frame(FrameKind::RESIDUAL, pixel_count);
 
     // Step 1: Compute temporal residual
     std::vector<int16_t> residual(pixel_count);
-    compute_residual(
-        frame.data.data(),
-        reference_frame_.data.data(),
-        residual.data(),
-        pixel_count);
+    {
+        PerfScope scope(profiler_, KernelStage::RESIDUAL);
+        kernels.compute_residual(
+            frame.data,
+            reference_frame_.data.data(),
+            residual.data(),
+            pixel_count);
+    }
 
     // Step 2: Quantize residual
-    std::vector<int16_t> quantized(pixel_count);
-    quantize_residual(
-        residual.data(),
-        quantized.data(),
-        pixel_count,
-        quant_params);
+    quantized.resize(pixel_count);
+    quantized_unsigned.resize(pixel_count);
+    {
+        PerfScope scope(profiler_, KernelStage::QUANTIZE);
+        kernels.quantize_residual(
+            residual.data(),
+            quantized.data(),
+            pixel_count,
+            quant_params);
 
-    // Step 3: Convert to unsigned for CharLS (bias by 32768)
-    // CharLS expects unsigned data, so we shift signed int16 to uint16
-    std::vector<uint16_t> quantized_unsigned(pixel_count);
-    for (size_t i = 0; i < pixel_count; ++i) {
-        quantized_unsigned[i] = static_cast<uint16_t>(quantized[i] + 32768);
+        // Step 3: Convert to unsigned for CharLS (bias by 32768)
+        // CharLS expects unsigned data, so we shift signed int16 to uint16
+        for (size_t i = 0; i < pixel_count; ++i) {
+            quantized_unsigned[i] = static_cast<uint16_t>(quantized[i] + 32768);
+        }
     }
 
-    // Step 4: Encode quantized residual with CharLS
+    fill_residual_header(frame, near_lossless, quant_params, output);
+    return true;
+}
+
+void FrameEncoder::fill_residual_header(
+    const FrameView& frame,
+    uint32_t near_lossless,
+    const QuantizationParams& quant_params,
+    CompressedFrame& output) const
+{
     output.width = frame.width;
     output.height = frame.height;
     output.timestamp = frame.timestamp;
     output.frame_index = frame.frame_index;
     output.is_keyframe = false;
+    output.is_repeat = false;
     output.near_lossless = near_lossless;
     output.quant_Q = quant_params.get_Q();
     output.dead_zone_T = quant_params.dead_zone_T;
     output.fp_bits = quant_params.fp_bits;
+}
 
-    if (!encode_charls_16bit(
-        quantized_unsigned.data(),
-        frame.width, frame.height,
-        near_lossless,
-        output.compressed_data))
-    {
+void FrameEncoder::update_reference(
+    const FrameView& frame,
+    const int16_t* received,
+    const QuantizationParams& quant_params)
+{
+    PerfScope scope(profiler_, KernelStage::RECONSTRUCT);
+    const size_t pixel_count = frame.width * frame.height;
+    const ResidualKernels& kernels = kernels_.get(frame.width, frame.height, quant_params.fp_bits);
+
+    // Dequantize
+    std::vector<int16_t> reconstructed_residual(pixel_count);
+    kernels.dequantize_residual(
+        received,
+        reconstructed_residual.data(),
+        pixel_count,
+        quant_params);
+
+    // Add back to reference frame
+    std::vector<uint16_t> reconstructed_frame(pixel_count);
+    kernels.reconstruct_frame(
+        reconstructed_residual.data(),
+        reference_frame_.data.data(),
+        reconstructed_frame.data(),
+        pixel_count);
+
+    // Update reference frame for next iteration
+    reference_frame_.data = std::move(reconstructed_frame);
+    reference_frame_.timestamp = frame.timestamp;
+    reference_frame_.frame_index = frame.frame_index;
+}
+
+bool FrameEncoder::encode_residual_frame(
+    const FrameView& input,
+    uint32_t near_lossless,
+    const QuantizationParams& quant_params,
+    CompressedFrame& output)
+{
+    const FrameView frame = pack_rows(input, input_staging_);
+    // Steps 1-3: residual, quantization, bias
+    std::vector<int16_t> quantized;
+    std::vector<uint16_t> quantized_unsigned;
+    if (!begin_residual_frame(frame, near_lossless, quant_params, output, quantized, quantized_unsigned)) {
         return false;
     }
+    const size_t pixel_count = quantized.size();
 
-    // Step 5: Closed-loop reconstruction if NEAR > 0
+    // Step 4: Encode quantized residual with CharLS
+    {
+        PerfScope scope(profiler_, KernelStage::CHARLS_ENCODE);
+        if (!encode_charls_16bit(
+            quantized_unsigned.data(),
+            frame.width, frame.height,
+            near_lossless,
+            output.compressed_data))
+        {
+            return false;
+        }
+    }
+
+    // Step 5: Closed-loop reconstruction. The decoder adds the dequantized
+    // residual to its reference, so the encoder must do the same even when
+    // quantization alone made the frame lossy. With NEAR > 0 the decoder sees
+    // CharLS's near-lossless approximation of the quantized residual; with
+    // NEAR = 0 it sees exactly `quantized`, so no decode is needed.
+    std::vector<int16_t> decoded_quantized;
     if (near_lossless > 0) {
         // Decode the compressed quantized residual
         std::vector<uint16_t> decoded_unsigned;
-        if (!decode_charls_16bit(
-            output.compressed_data.data(),
-            output.compressed_data.size(),
-            frame.width, frame.height,
-            decoded_unsigned))
         {
-            std::cerr << "Failed to decode residual for closed-loop" << std::endl;
-            return false;
+            PerfScope scope(profiler_, KernelStage::CHARLS_DECODE);
+            if (!decode_charls_16bit(
+                output.compressed_data.data(),
+                output.compressed_data.size(),
+                frame.width, frame.height,
+                decoded_unsigned))
+            {
+                std::cerr << "Failed to decode residual for closed-loop" << std::endl;
+                return false;
+            }
         }
 
         // Convert back to signed
-        std::vector<int16_t> decoded_quantized(pixel_count);
+        decoded_quantized.resize(pixel_count);
         for (size_t i = 0; i < pixel_count; ++i) {
             decoded_quantized[i] = static_cast<int16_t>(decoded_unsigned[i] - 32768);
         }
+    }
 
-        // Dequantize
-        std::vector<int16_t> reconstructed_residual(pixel_count);
-        dequantize_residual(
-            decoded_quantized.data(),
-            reconstructed_residual.data(),
-            pixel_count,
-            quant_params);
+    update_reference(frame, (near_lossless > 0) ? decoded_quantized.data() : quantized.data(), quant_params);
+    return true;
+}
 
-        // Add back to reference frame
-        std::vector<uint16_t> reconstructed_frame(pixel_count);
-        add_residual_to_reference(
-            reference_frame_.data.data(),
-            reconstructed_residual.data(),
-            reconstructed_frame.data(),
-            pixel_count);
+bool FrameEncoder::is_repeat_frame(const FrameView& frame, bool is_keyframe, uint32_t dead_zone_T,
+                                   const bool* within_dead_zone)
+{
+    // Every input is kept, keyframes included, so the frame after a
+    // keyframe can already be a repeat. A hash match is confirmed sample by
+    // sample: a collision must not turn a changed frame into a repeat.
+    bool identical = false;
+    if (detect_repeats_) {
+        const size_t pixel_count = frame.pixel_count();
+        const uint64_t hash = hash_samples(frame.data, pixel_count);
+        identical = input_hash_valid_ && hash == input_hash_ &&
+                    previous_input_.size() == pixel_count &&
+                    std::memcmp(previous_input_.data(), frame.data, pixel_count * sizeof(uint16_t)) == 0;
+        input_hash_ = hash;
+        input_hash_valid_ = true;
+        if (!identical) {
+            previous_input_.assign(frame.data, frame.data + pixel_count);
+        }
+    }
 
-        // Update reference frame for next iteration
-        reference_frame_.data = std::move(reconstructed_frame);
-        reference_frame_.timestamp = frame.timestamp;
-        reference_frame_.frame_index = frame.frame_index;
+    if (is_keyframe || !reference_frame_initialized_ ||
+        frame.width != reference_frame_.width || frame.height != reference_frame_.height)
+    {
+        return false;
     }
-    else {
-        // NEAR=0: Open-loop, just update reference to current frame
-        reference_frame_.data = frame.data;
-        reference_frame_.timestamp = frame.timestamp;
-        reference_frame_.frame_index = frame.frame_index;
+    if (identical) {
+        return true;
     }
+    if (!static_gating_) {
+        return false;
+    }
+    return within_dead_zone ? *within_dead_zone
+                            : residual_within_dead_zone(frame.data, reference_frame_.data.data(),
+                                                        frame.pixel_count(), dead_zone_T);
+}
+
+void FrameEncoder::encode_repeat_frame(const FrameView& frame, CompressedFrame& output)
+{
+    output.compressed_data.clear();
+    output.width = frame.width;
+    output.height = frame.height;
+    output.timestamp = frame.timestamp;
+    output.frame_index = frame.frame_index;
+    output.is_keyframe = false;
+    output.is_repeat = true;
+    output.near_lossless = 0;
+    output.quant_Q = 0.0;
+    output.dead_zone_T = 0;
+    output.fp_bits = 0;
+    output.use_range_map = false;
+    output.range_min = 0;
+    output.range_max = 65535;
 
+    // The decoder shows its reference again; only the timeline advances
+    reference_frame_.timestamp = frame.timestamp;
+    reference_frame_.frame_index = frame.frame_index;
+}
+
+bool FrameEncoder::can_prepare(bool is_keyframe, uint32_t keyframe_near, uint32_t residual_near) const
+{
+    if (is_keyframe) {
+        return keyframe_near == 0 && !verify_decode_;
+    }
+    return residual_near == 0 && reference_frame_initialized_;
+}
+
+bool FrameEncoder::prepare_frame(
+    const FrameView& input,
+    bool is_keyframe,
+    uint32_t keyframe_near,
+    uint32_t residual_near,
+    const QuantizationParams& quant_params,
+    PreparedFrame& prepared,
+    bool enable_12bit_mode)
+{
+    const FrameView frame = pack_rows(input, input_staging_);
+    if (!frame.is_valid()) {
+        std::cerr << "Frame " << frame.frame_index << " has no samples" << std::endl;
+        return false;
+    }
+    if (!can_prepare(is_keyframe, keyframe_near, residual_near)) {
+        std::cerr << "Frame " << frame.frame_index << " needs its JPEG-LS output for the reference" << std::endl;
+        return false;
+    }
+
+    prepared.frame.compressed_data.clear();
+
+    if (is_repeat_frame(frame, is_keyframe, quant_params.dead_zone_T)) {
+        encode_repeat_frame(frame, prepared.frame);
+        prepared.plane.clear();
+        return true;
+    }
+
+    if (is_keyframe) {
+        std::vector<uint16_t> mapped_data;
+        begin_intra_frame(frame, keyframe_near, prepared.frame, enable_12bit_mode, mapped_data);
+        set_reference_from_input(frame, prepared.frame, mapped_data);
+
+        prepared.near_lossless = keyframe_near;
+        prepared.bits_per_sample = prepared.frame.use_range_map ? 12 : 16;
+        if (prepared.frame.use_range_map) {
+            prepared.plane = std::move(mapped_data);
+        } else {
+            prepared.plane.assign(frame.data, frame.data + frame.pixel_count());
+        }
+        return true;
+    }
+
+    // NEAR = 0: the decoder will see exactly `quantized`, so the reference
+    // advances before the residual is entropy coded
+    std::vector<int16_t> quantized;
+    if (!begin_residual_frame(frame, residual_near, quant_params, prepared.frame, quantized, prepared.plane)) {
+        return false;
+    }
+    update_reference(frame, quantized.data(), quant_params);
+
+    prepared.near_lossless = residual_near;
+    prepared.bits_per_sample = 16;
     return true;
 }
 
 bool FrameEncoder::encode_frame(
-    const Frame& frame,
+    const FrameView& input,
     bool is_keyframe,
     uint32_t keyframe_near,
     uint32_t residual_near,
@@ -389,6 +755,17 @@ bool FrameEncoder::encode_frame(
     CompressedFrame& output,
     bool enable_12bit_mode)
 {
+    const FrameView frame = pack_rows(input, input_staging_);
+    if (!frame.is_valid()) {
+        std::cerr << "Frame " << frame.frame_index << " has no samples" << std::endl;
+        return false;
+    }
+
+    if (is_repeat_frame(frame, is_keyframe, quant_params.dead_zone_T)) {
+        encode_repeat_frame(frame, output);
+        return true;
+    }
+
     if (is_keyframe) {
         return encode_intra_frame(frame, keyframe_near, output, enable_12bit_mode);
     }
@@ -397,33 +774,255 @@ bool FrameEncoder::encode_frame(
     }
 }
 
+bool FrameEncoder::begin_banded_frame(
+    const FrameView& frame,
+    bool is_keyframe,
+    uint32_t keyframe_near,
+    uint32_t residual_near,
+    const QuantizationParams& quant_params,
+    bool enable_12bit_mode)
+{
+    band_.active = false;
+    if (frame.width == 0 || frame.height == 0) {
+        std::cerr << "Banded frame needs a size" << std::endl;
+        return false;
+    }
+    if (!is_keyframe) {
+        if (!reference_frame_initialized_) {
+            std::cerr << "Cannot encode residual frame: no reference frame" << std::endl;
+            return false;
+        }
+        if (frame.width != reference_frame_.width || frame.height != reference_frame_.height) {
+            std::cerr << "Frame size mismatch with reference" << std::endl;
+            return false;
+        }
+    }
+
+    const size_t pixel_count = frame.pixel_count();
+    band_.input.width = frame.width;
+    band_.input.height = frame.height;
+    band_.input.timestamp = frame.timestamp;
+    band_.input.frame_index = frame.frame_index;
+    band_.input.data.resize(pixel_count);
+    band_.rows = 0;
+    band_.is_keyframe = is_keyframe;
+    band_.keyframe_near = keyframe_near;
+    band_.residual_near = residual_near;
+    band_.quant_params = quant_params;
+    band_.enable_12bit_mode = enable_12bit_mode;
+    band_.within_dead_zone = true;
+    if (!is_keyframe) {
+        band_.quantized.resize(pixel_count);
+        band_.plane.resize(pixel_count);
+        band_.next_reference.resize(residual_near == 0 ? pixel_count : 0);
+        if (profiler_) profiler_->begin_frame(FrameKind::RESIDUAL, pixel_count);
+    }
+    band_.active = true;
+    return true;
+}
+
+bool FrameEncoder::encode_band(uint32_t y0, const uint16_t* rows, uint32_t row_count, size_t stride)
+{
+    if (!band_.active || y0 != band_.rows || row_count == 0 || row_count > band_.input.height - y0) {
+        std::cerr << "Band of rows " << y0 << "+" << row_count << " does not continue frame "
+                  << band_.input.frame_index << " (" << band_.rows << " of " << band_.input.height
+                  << " rows received)" << std::endl;
+        return false;
+    }
+
+    const uint32_t width = band_.input.width;
+    if (stride == 0) {
+        stride = width;
+    }
+    const size_t offset = static_cast<size_t>(y0) * width;
+    const size_t count = static_cast<size_t>(row_count) * width;
+    uint16_t* current = band_.input.data.data() + offset;
+    for (uint32_t y = 0; y < row_count; ++y) {
+        std::memcpy(current + static_cast<size_t>(y) * width, rows + y * stride, width * sizeof(uint16_t));
+    }
+    band_.rows += row_count;
+
+    if (band_.is_keyframe) {
+        return true;   // Encoded whole at finish
+    }
+
+    // Steps 1-3 of encode_residual_frame() for these rows
+    const QuantizationParams& quant_params = band_.quant_params;
+    const ResidualKernels& kernels = band_kernels_.get(width, row_count, quant_params.fp_bits);
+    const uint16_t* previous = reference_frame_.data.data() + offset;
+    int16_t* quantized = band_.quantized.data() + offset;
+    band_.residual.resize(count);
+
+    if (static_gating_ && band_.within_dead_zone) {
+        band_.within_dead_zone = residual_within_dead_zone(current, previous, count, quant_params.dead_zone_T);
+    }
+    {
+        PerfScope scope(profiler_, KernelStage::RESIDUAL);
+        kernels.compute_residual(current, previous, band_.residual.data(), count);
+    }
+    {
+        PerfScope scope(profiler_, KernelStage::QUANTIZE);
+        kernels.quantize_residual(band_.residual.data(), quantized, count, quant_params);
+        uint16_t* plane = band_.plane.data() + offset;
+        for (size_t i = 0; i < count; ++i) {
+            plane[i] = static_cast<uint16_t>(quantized[i] + 32768);
+        }
+    }
+
+    // NEAR = 0: the decoder will see exactly `quantized`, so these rows of
+    // the next reference are final (the current reference stays intact for
+    // the rows still to come, and in case the frame becomes a repeat)
+    if (band_.residual_near == 0) {
+        PerfScope scope(profiler_, KernelStage::RECONSTRUCT);
+        kernels.dequantize_residual(quantized, band_.residual.data(), count, quant_params);
+        kernels.reconstruct_frame(band_.residual.data(), previous, band_.next_reference.data() + offset, count);
+    }
+    return true;
+}
+
+bool FrameEncoder::finish_banded_frame(CompressedFrame& output)
+{
+    if (!band_.active || band_.rows != band_.input.height) {
+        std::cerr << "Banded frame " << band_.input.frame_index << " is incomplete (" << band_.rows
+                  << " of " << band_.input.height << " rows)" << std::endl;
+        return false;
+    }
+    band_.active = false;
+
+    const Frame& frame = band_.input;
+    if (band_.is_keyframe) {
+        return encode_frame(frame, true, band_.keyframe_near, band_.residual_near, band_.quant_params,
+                            output, band_.enable_12bit_mode);
+    }
+
+    const QuantizationParams& quant_params = band_.quant_params;
+    if (is_repeat_frame(frame, false, quant_params.dead_zone_T, &band_.within_dead_zone)) {
+        encode_repeat_frame(frame, output);
+        return true;
+    }
+
+    // Step 4: Encode quantized residual with CharLS
+    fill_residual_header(frame, band_.residual_near, quant_params, output);
+    {
+        PerfScope scope(profiler_, KernelStage::CHARLS_ENCODE);
+        if (!encode_charls_16bit(band_.plane.data(), frame.width, frame.height, band_.residual_near,
+                                 output.compressed_data))
+        {
+            return false;
+        }
+    }
+
+    // Step 5: Closed loop, as in encode_residual_frame()
+    if (band_.residual_near == 0) {
+        reference_frame_.data.swap(band_.next_reference);
+        reference_frame_.timestamp = frame.timestamp;
+        reference_frame_.frame_index = frame.frame_index;
+        return true;
+    }
+
+    std::vector<uint16_t> decoded_unsigned;
+    {
+        PerfScope scope(profiler_, KernelStage::CHARLS_DECODE);
+        if (!decode_charls_16bit(output.compressed_data.data(), output.compressed_data.size(),
+                                 frame.width, frame.height, decoded_unsigned))
+        {
+            std::cerr << "Failed to decode residual for closed-loop" << std::endl;
+            return false;
+        }
+    }
+    int16_t* decoded_quantized = band_.quantized.data();
+    for (size_t i = 0; i < decoded_unsigned.size(); ++i) {
+        decoded_quantized[i] = static_cast<int16_t>(decoded_unsigned[i] - 32768);
+    }
+    update_reference(frame, decoded_quantized, quant_params);
+    return true;
+}
+
 bool FrameEncoder::decode_frame(
     const CompressedFrame& compressed,
     Frame& output)
 {
+    if (!decode_reference(compressed)) {
+        return false;
+    }
     output.width = compressed.width;
     output.height = compressed.height;
     output.timestamp = compressed.timestamp;
     output.frame_index = compressed.frame_index;
+    output.data = reference_frame_.data;
+    return true;
+}
+
+bool FrameEncoder::decode_frame(const CompressedFrame& compressed, uint16_t* pixels, size_t stride)
+{
+    if (!decode_reference(compressed)) {
+        return false;
+    }
+
+    const size_t width = compressed.width;
+    const uint16_t* decoded = reference_frame_.data.data();
+    if (stride == 0 || stride == width) {
+        std::memcpy(pixels, decoded, reference_frame_.data.size() * sizeof(uint16_t));
+        return true;
+    }
+    for (uint32_t y = 0; y < compressed.height; ++y) {
+        std::memcpy(pixels + y * stride, decoded + y * width, width * sizeof(uint16_t));
+    }
+    return true;
+}
+
+bool FrameEncoder::decode_reference(const CompressedFrame& compressed)
+{
+    if (compressed.is_repeat) {
+        // Same picture as the previous frame
+        if (!reference_frame_initialized_ ||
+            compressed.width != reference_frame_.width || compressed.height != reference_frame_.height)
+        {
+            std::cerr << "Cannot decode repeat frame: no matching reference frame" << std::endl;
+            return false;
+        }
+        reference_frame_.timestamp = compressed.timestamp;
+        reference_frame_.frame_index = compressed.frame_index;
+        return true;
+    }
+
+    // Decoded into a spare buffer that is swapped in on success, so a
+    // failed decode leaves the reference intact
+    std::vector<uint16_t>& decoded = decode_buffer_;
 
     if (compressed.is_keyframe) {
         // Decode intra frame directly
-        return decode_charls_16bit(
+        if (!decode_charls_16bit(
             compressed.compressed_data.data(),
             compressed.compressed_data.size(),
             compressed.width,
             compressed.height,
-            output.data);
+            decoded))
+        {
+            return false;
+        }
+
+        // Undo 12-bit range mapping
+        if (compressed.use_range_map) {
+            std::vector<uint16_t> unmapped(decoded.size());
+            RangeMap range_map(compressed.range_min, compressed.range_max);
+            map_from_12bit(decoded.data(), unmapped.data(), unmapped.size(), range_map);
+            decoded.swap(unmapped);
+        }
+
+        // Keyframe becomes the reference for the following residuals
+        reference_frame_.width = compressed.width;
+        reference_frame_.height = compressed.height;
+        reference_frame_initialized_ = true;
     }
     else {
         // Decode residual frame
-        if (!reference_frame_initialized_) {
-            std::cerr << "Cannot decode residual frame: no reference frame" << std::endl;
+        const size_t pixel_count = compressed.width * compressed.height;
+        if (!reference_frame_initialized_ || reference_frame_.data.size() != pixel_count) {
+            std::cerr << "Cannot decode residual frame: no matching reference frame" << std::endl;
             return false;
         }
 
-        const size_t pixel_count = compressed.width * compressed.height;
-
         // Decode quantized residual
         std::vector<uint16_t> decoded_unsigned;
         if (!decode_charls_16bit(
@@ -447,35 +1046,37 @@ bool FrameEncoder::decode_frame(
             compressed.dead_zone_T,
             compressed.quant_Q,
             compressed.fp_bits);
+        const ResidualKernels& kernels = kernels_.get(compressed.width, compressed.height, compressed.fp_bits);
 
         std::vector<int16_t> reconstructed_residual(pixel_count);
-        dequantize_residual(
+        kernels.dequantize_residual(
             decoded_quantized.data(),
             reconstructed_residual.data(),
             pixel_count,
             quant_params);
 
         // Add back to reference frame
-        output.data.resize(pixel_count);
-        add_residual_to_reference(
-            reference_frame_.data.data(),
+        decoded.resize(pixel_count);
+        kernels.reconstruct_frame(
             reconstructed_residual.data(),
-            output.data.data(),
+            reference_frame_.data.data(),
+            decoded.data(),
             pixel_count);
-
-        // Update reference for next frame
-        reference_frame_.data = output.data;
-        reference_frame_.timestamp = compressed.timestamp;
-        reference_frame_.frame_index = compressed.frame_index;
-
-        return true;
     }
+
+    // The decoded frame is the reference for the next one
+    reference_frame_.data.swap(decoded);
+    reference_frame_.timestamp = compressed.timestamp;
+    reference_frame_.frame_index = compressed.frame_index;
+    return true;
 }
 
 void FrameEncoder::reset()
 {
     reference_frame_initialized_ = false;
     reference_frame_.data.clear();
+    input_hash_valid_ = false;
+    band_.active = false;
 }
 
 } // namespace lwir
@@ -0,0 +1,137 @@
+/**
+ * @file frame_format.cpp
+ * @brief Compressed frame record serialization
+ */
+
+#include "frame_format.hpp"
+#include "encoder.hpp"
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+namespace lwir {
+
+namespace {
+
+constexpr uint8_t FRAME_TYPE_RESIDUAL = 0;
+constexpr uint8_t FRAME_TYPE_KEYFRAME = 1;
+constexpr uint8_t FRAME_TYPE_REPEAT = 2;
+
+template <typename T>
+uint8_t* put(uint8_t* dst, const T& value)
+{
+    std::memcpy(dst, &value, sizeof(T));
+    return dst + sizeof(T);
+}
+
+template <typename T>
+const uint8_t* get(const uint8_t* src, T& value)
+{
+    std::memcpy(&value, src, sizeof(T));
+    return src + sizeof(T);
+}
+
+} // anonymous namespace
+
+std::string frame_file_name(uint32_t frame_index)
+{
+    std::ostringstream name;
+    name << "frame_" << std::setw(6) << std::setfill('0') << frame_index << ".lwir";
+    return name.str();
+}
+
+size_t frame_record_bound(uint32_t width, uint32_t height)
+{
+    return FRAME_HEADER_SIZE + max_payload_size(width, height);
+}
+
+size_t write_frame_header(const CompressedFrame& frame, uint32_t payload_size, uint8_t* dst, size_t capacity)
+{
+    if (!dst || capacity < FRAME_HEADER_SIZE) {
+        return 0;
+    }
+
+    const uint8_t type = frame.is_keyframe ? FRAME_TYPE_KEYFRAME
+                       : frame.is_repeat ? FRAME_TYPE_REPEAT
+                       : FRAME_TYPE_RESIDUAL;
+    const uint8_t use_range_map = frame.use_range_map ? 1 : 0;
+
+    uint8_t* p = dst;
+    p = put(p, frame.width);
+    p = put(p, frame.height);
+    p = put(p, frame.timestamp);
+    p = put(p, frame.frame_index);
+    p = put(p, type);
+    p = put(p, frame.near_lossless);
+    p = put(p, frame.quant_Q);
+    p = put(p, frame.dead_zone_T);
+    p = put(p, frame.fp_bits);
+    p = put(p, use_range_map);
+    p = put(p, frame.range_min);
+    p = put(p, frame.range_max);
+    put(p, payload_size);
+
+    return FRAME_HEADER_SIZE;
+}
+
+size_t write_frame_record(const CompressedFrame& frame, uint8_t* dst, size_t capacity)
+{
+    const size_t total = frame_record_size(frame);
+    if (!dst || capacity < total) {
+        return 0;
+    }
+
+    const uint32_t payload_size = static_cast<uint32_t>(frame.compressed_data.size());
+    write_frame_header(frame, payload_size, dst, capacity);
+    if (payload_size > 0) {
+        std::memcpy(dst + FRAME_HEADER_SIZE, frame.compressed_data.data(), payload_size);
+    }
+
+    return total;
+}
+
+bool read_frame_header(const uint8_t* src, size_t size, CompressedFrame& frame, uint32_t& payload_size)
+{
+    if (!src || size < FRAME_HEADER_SIZE) {
+        return false;
+    }
+
+    uint8_t type = FRAME_TYPE_RESIDUAL;
+    uint8_t use_range_map = 0;
+
+    const uint8_t* p = src;
+    p = get(p, frame.width);
+    p = get(p, frame.height);
+    p = get(p, frame.timestamp);
+    p = get(p, frame.frame_index);
+    p = get(p, type);
+    p = get(p, frame.near_lossless);
+    p = get(p, frame.quant_Q);
+    p = get(p, frame.dead_zone_T);
+    p = get(p, frame.fp_bits);
+    p = get(p, use_range_map);
+    p = get(p, frame.range_min);
+    p = get(p, frame.range_max);
+    get(p, payload_size);
+
+    frame.is_keyframe = (type == FRAME_TYPE_KEYFRAME);
+    frame.is_repeat = (type == FRAME_TYPE_REPEAT);
+    frame.use_range_map = (use_range_map != 0);
+    return true;
+}
+
+bool read_frame_record(const uint8_t* src, size_t size, CompressedFrame& frame)
+{
+    uint32_t payload_size = 0;
+    if (!read_frame_header(src, size, frame, payload_size)) {
+        return false;
+    }
+    if (size - FRAME_HEADER_SIZE < payload_size) {
+        return false;
+    }
+
+    frame.compressed_data.assign(src + FRAME_HEADER_SIZE, src + FRAME_HEADER_SIZE + payload_size);
+    return true;
+}
+
+} // namespace lwir
@@ -0,0 +1,328 @@
+/**
+ * @file frame_source.cpp
+ * @brief Input frame sources (PNG directory, packed dumps, memory, synthetic)
+ */
+
+#include "frame_source.hpp"
+#include <png.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <dirent.h>
+#include <sys/stat.h>
+
+namespace lwir {
+
+namespace {
+
+/**
+ * Camera sequence number at the end of a frame file name ("..._000123.png")
+ */
+bool file_sequence_number(const std::string& path, uint64_t& number)
+{
+    const size_t dot = path.rfind('.');
+    size_t begin = (dot == std::string::npos) ? path.size() : dot;
+    const size_t end = begin;
+    while (begin > 0 && std::isdigit(static_cast<unsigned char>(path[begin - 1]))) {
+        begin--;
+    }
+    if (begin == end) {
+        return false;
+    }
+    number = std::strtoull(path.substr(begin, end - begin).c_str(), nullptr, 10);
+    return true;
+}
+
+} // anonymous namespace
+
+bool load_frame_from_png(const std::string& png_path, Frame& frame)
+{
+    // Use libpng to load 16-bit grayscale PNG
+    FILE* fp = fopen(png_path.c_str(), "rb");
+    if (!fp) {
+        std::cerr << "Failed to open PNG: " << png_path << std::endl;
+        return false;
+    }
+
+    png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+    if (!png) {
+        fclose(fp);
+        return false;
+    }
+
+    png_infop info = png_create_info_struct(png);
+    if (!info) {
+        png_destroy_read_struct(&png, nullptr, nullptr);
+        fclose(fp);
+        return false;
+    }
+
+    if (setjmp(png_jmpbuf(png))) {
+        png_destroy_read_struct(&png, &info, nullptr);
+        fclose(fp);
+        return false;
+    }
+
+    png_init_io(png, fp);
+    png_read_info(png, info);
+
+    // Capture time, if the camera (or lwir_synth) recorded one
+    png_textp text = nullptr;
+    int text_count = 0;
+    png_get_text(png, info, &text, &text_count);
+    for (int i = 0; i < text_count; ++i) {
+        if (std::strcmp(text[i].key, FRAME_TIMESTAMP_PNG_KEY) == 0 && text[i].text) {
+            frame.timestamp = std::strtoull(text[i].text, nullptr, 10);
+        }
+    }
+
+    frame.width = png_get_image_width(png, info);
+    frame.height = png_get_image_height(png, info);
+    const int bit_depth = png_get_bit_depth(png, info);
+    const int color_type = png_get_color_type(png, info);
+
+    // Convert PNG's big-endian 16-bit to native byte order
+    if (bit_depth == 16) {
+        png_set_swap(png);
+    }
+
+    // Verify it's 16-bit grayscale
+    if (bit_depth != 16 || color_type != PNG_COLOR_TYPE_GRAY) {
+        std::cerr << "PNG must be 16-bit grayscale: " << png_path << std::endl;
+        png_destroy_read_struct(&png, &info, nullptr);
+        fclose(fp);
+        return false;
+    }
+
+    // Allocate row pointers
+    std::vector<png_bytep> row_pointers(frame.height);
+    frame.data.resize(frame.width * frame.height);
+
+    for (uint32_t y = 0; y < frame.height; ++y) {
+        row_pointers[y] = reinterpret_cast<png_bytep>(&frame.data[y * frame.width]);
+    }
+
+    png_read_image(png, row_pointers.data());
+    png_read_end(png, nullptr);
+
+    png_destroy_read_struct(&png, &info, nullptr);
+    fclose(fp);
+
+    return true;
+}
+
+// ============================================================================
+// PngDirectorySource
+// ============================================================================
+
+bool PngDirectorySource::open(const std::string& input_dir, const std::string& prefix)
+{
+    input_dir_ = input_dir;
+    files_.clear();
+
+    // Scan input directory for PNG files (C++14 compatible)
+    DIR* dir = opendir(input_dir.c_str());
+    if (!dir) {
+        std::cerr << "Failed to open input directory: " << input_dir << std::endl;
+        return false;
+    }
+
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        std::string filename = entry->d_name;
+        // Check if filename ends with .png and starts with the frame prefix
+        if (filename.length() > 4 && filename.substr(filename.length() - 4) == ".png") {
+            if (filename.find(prefix) == 0) {
+                files_.push_back(input_dir + "/" + filename);
+            }
+        }
+    }
+    closedir(dir);
+
+    if (files_.empty()) {
+        std::cerr << "No PNG files found in input directory" << std::endl;
+        return false;
+    }
+
+    // Sort files by name
+    std::sort(files_.begin(), files_.end());
+    return true;
+}
+
+bool PngDirectorySource::read_frame(size_t index, Frame& frame)
+{
+    if (index >= files_.size()) {
+        return false;
+    }
+
+    frame.frame_index = static_cast<uint32_t>(index);
+
+    // Fallback when the file has no timestamp chunk
+    uint64_t sequence = 0;
+    frame.timestamp = (frame_period_us_ > 0.0 && file_sequence_number(files_[index], sequence))
+                    ? static_cast<uint64_t>(sequence * frame_period_us_ + 0.5)
+                    : 0;
+    return load_frame_from_png(files_[index], frame);
+}
+
+std::string PngDirectorySource::description() const
+{
+    std::ostringstream oss;
+    oss << input_dir_ << " (" << files_.size() << " PNG files)";
+    return oss.str();
+}
+
+// ============================================================================
+// PackedDirectorySource
+// ============================================================================
+
+bool PackedDirectorySource::open(const std::string& input_dir, const std::string& prefix,
+                                 const std::string& extension)
+{
+    input_dir_ = input_dir;
+    files_.clear();
+    frames_.clear();
+
+    const size_t frame_bytes = packed_frame_bytes(format_, width_, height_);
+    if (frame_bytes == 0) {
+        std::cerr << "Packed frame width must be a multiple of " << packed_group_pixels(format_)
+                  << " pixels: " << width_ << "x" << height_ << std::endl;
+        return false;
+    }
+
+    DIR* dir = opendir(input_dir.c_str());
+    if (!dir) {
+        std::cerr << "Failed to open input directory: " << input_dir << std::endl;
+        return false;
+    }
+
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        const std::string filename = entry->d_name;
+        if (filename.length() > extension.length() && filename.find(prefix) == 0 &&
+            filename.compare(filename.length() - extension.length(), extension.length(), extension) == 0)
+        {
+            files_.push_back(input_dir + "/" + filename);
+        }
+    }
+    closedir(dir);
+    std::sort(files_.begin(), files_.end());
+
+    for (size_t f = 0; f < files_.size(); ++f) {
+        struct stat st;
+        if (::stat(files_[f].c_str(), &st) != 0) {
+            std::cerr << "Failed to stat " << files_[f] << std::endl;
+            return false;
+        }
+        const uint64_t size = static_cast<uint64_t>(st.st_size);
+        if (size % frame_bytes != 0) {
+            std::cerr << "Warning: " << files_[f] << " ends in a partial frame ("
+                      << size % frame_bytes << " bytes ignored)" << std::endl;
+        }
+        const uint64_t count = size / frame_bytes;
+        for (uint64_t i = 0; i < count; ++i) {
+            frames_.push_back(FrameLocation{f, i * frame_bytes, count == 1});
+        }
+    }
+
+    if (frames_.empty()) {
+        std::cerr << "No packed frames found in input directory" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool PackedDirectorySource::read_frame(size_t index, Frame& frame)
+{
+    if (index >= frames_.size()) {
+        return false;
+    }
+
+    const FrameLocation& location = frames_[index];
+    const std::string& path = files_[location.file];
+    packed_.resize(packed_frame_bytes(format_, width_, height_));
+
+    FILE* fp = fopen(path.c_str(), "rb");
+    if (!fp) {
+        std::cerr << "Failed to open packed frame file: " << path << std::endl;
+        return false;
+    }
+    const bool ok = fseeko(fp, static_cast<off_t>(location.offset), SEEK_SET) == 0 &&
+                    fread(packed_.data(), 1, packed_.size(), fp) == packed_.size();
+    fclose(fp);
+    if (!ok) {
+        std::cerr << "Failed to read frame " << index << " from " << path << std::endl;
+        return false;
+    }
+
+    frame.width = width_;
+    frame.height = height_;
+    frame.frame_index = static_cast<uint32_t>(index);
+    frame.data.resize(frame.pixel_count());
+    unpack_pixels(format_, packed_.data(), frame.data.data(), frame.data.size());
+
+    uint64_t sequence = 0;
+    frame.timestamp = (location.single && frame_period_us_ > 0.0 && file_sequence_number(path, sequence))
+                    ? static_cast<uint64_t>(sequence * frame_period_us_ + 0.5)
+                    : 0;
+    return true;
+}
+
+std::string PackedDirectorySource::description() const
+{
+    std::ostringstream oss;
+    oss << input_dir_ << " (" << frames_.size() << " " << (format_ == PackedFormat::RAW12 ? "RAW12" : "RAW14")
+        << " frames in " << files_.size() << " files)";
+    return oss.str();
+}
+
+// ============================================================================
+// MemoryFrameSource
+// ============================================================================
+
+bool MemoryFrameSource::read_frame(size_t index, Frame& frame)
+{
+    if (index >= frames_.size()) {
+        return false;
+    }
+
+    frame = frames_[index];
+    frame.frame_index = static_cast<uint32_t>(index);
+    return true;
+}
+
+std::string MemoryFrameSource::description() const
+{
+    std::ostringstream oss;
+    oss << "memory (" << frames_.size() << " frames)";
+    return oss.str();
+}
+
+// ============================================================================
+// SyntheticFrameSource
+// ============================================================================
+
+bool SyntheticFrameSource::read_frame(size_t index, Frame& frame)
+{
+    if (index >= sequence_.frame_count()) {
+        return false;
+    }
+
+    sequence_.generate(static_cast<uint32_t>(index), frame);
+    return true;
+}
+
+std::string SyntheticFrameSource::description() const
+{
+    const SyntheticConfig& c = sequence_.config();
+    std::ostringstream oss;
+    oss << "synthetic " << c.width << "x" << c.height
+        << " (" << c.frame_count << " frames, seed " << c.seed << ")";
+    return oss.str();
+}
+
+} // namespace lwir
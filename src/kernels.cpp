@@ -0,0 +1,206 @@
+/**
+ * @file kernels.cpp
+ * @brief Size- and fixed-point-specialized residual kernels
+ */
+
+#include "kernels.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+// Enable SIMD hints only on ARM with NEON
+#ifdef ENABLE_NEON
+    #define SIMD_HINT _Pragma("omp simd")
+#else
+    #define SIMD_HINT
+#endif
+
+namespace lwir {
+
+namespace {
+
+// Fleet sensor geometries
+constexpr size_t PIXELS_640x512 = 640 * 512;
+constexpr size_t PIXELS_1024x768 = 1024 * 768;
+
+// N is the pixel count the kernel is built for; 0 means any count
+
+template <size_t N>
+void compute_residual_fixed(
+    const uint16_t* __restrict current,
+    const uint16_t* __restrict previous,
+    int16_t* __restrict residual,
+    size_t pixel_count)
+{
+    if (pixel_count != N) {
+        compute_residual(current, previous, residual, pixel_count);
+        return;
+    }
+
+    SIMD_HINT
+    for (size_t i = 0; i < N; ++i) {
+        residual[i] = static_cast<int16_t>(current[i]) - static_cast<int16_t>(previous[i]);
+    }
+}
+
+template <size_t N, uint32_t FP>
+void quantize_residual_fixed(
+    const int16_t* __restrict residual,
+    int16_t* __restrict quantized,
+    size_t pixel_count,
+    const QuantizationParams& params)
+{
+    static_assert(FP <= 14, "reciprocal must fit in 32 bits");
+
+    // |R| <= 2^15, so with Q_fixed < 2^(16 + FP) every numerator
+    // (a2 << FP) + Q_fixed / 2 is below 2^(16 + FP)
+    constexpr uint32_t NUMERATOR_BITS = 16 + FP;
+
+    const uint32_t T = params.dead_zone_T;
+    const uint32_t Q_fixed = params.quant_Q_fixed;
+    if ((N != 0 && pixel_count != N) || params.fp_bits != FP ||
+        Q_fixed == 0 || Q_fixed >= (1u << NUMERATOR_BITS))
+    {
+        quantize_residual(residual, quantized, pixel_count, params);
+        return;
+    }
+
+    // n / Q_fixed == (n * m) >> shift for every n < 2^NUMERATOR_BITS with
+    // shift = NUMERATOR_BITS + ceil(log2(Q_fixed)), m = 2^shift / Q_fixed + 1
+    uint32_t log2_q = 0;
+    while ((1u << log2_q) < Q_fixed) {
+        log2_q++;
+    }
+    const uint32_t shift = NUMERATOR_BITS + log2_q;
+    const uint64_t reciprocal = ((uint64_t(1) << shift) / Q_fixed) + 1;
+    const uint32_t rounding = Q_fixed / 2;
+    const size_t count = (N != 0) ? N : pixel_count;
+
+    SIMD_HINT
+    for (size_t i = 0; i < count; ++i) {
+        const int32_t R = residual[i];
+        const uint32_t abs_R = static_cast<uint32_t>(R >= 0 ? R : -R);
+        const uint32_t a2 = (abs_R > T) ? (abs_R - T) : 0;
+        const uint32_t numerator = (a2 << FP) + rounding;
+        const uint32_t q_abs = static_cast<uint32_t>((numerator * reciprocal) >> shift);
+        quantized[i] = static_cast<int16_t>(R >= 0 ? q_abs : 0u - q_abs);
+    }
+}
+
+template <size_t N, uint32_t FP>
+void dequantize_residual_fixed(
+    const int16_t* __restrict quantized,
+    int16_t* __restrict reconstructed,
+    size_t pixel_count,
+    const QuantizationParams& params)
+{
+    if ((N != 0 && pixel_count != N) || params.fp_bits != FP) {
+        dequantize_residual(quantized, reconstructed, pixel_count, params);
+        return;
+    }
+
+    const uint32_t Q_fixed = params.quant_Q_fixed;
+    const uint32_t T_half = params.dead_zone_T / 2;
+    const size_t count = (N != 0) ? N : pixel_count;
+
+    SIMD_HINT
+    for (size_t i = 0; i < count; ++i) {
+        const int16_t q = quantized[i];
+
+        if (q == 0) {
+            reconstructed[i] = 0;
+        } else {
+            const int32_t sign = (q >= 0) ? 1 : -1;
+            const uint32_t abs_q = static_cast<uint32_t>(std::abs(static_cast<int32_t>(q)));
+            const uint32_t recon_abs = ((abs_q * Q_fixed) >> FP) + T_half;
+            reconstructed[i] = static_cast<int16_t>(sign * static_cast<int32_t>(recon_abs));
+        }
+    }
+}
+
+template <size_t N>
+void reconstruct_frame_fixed(
+    const int16_t* __restrict residual,
+    const uint16_t* __restrict previous,
+    uint16_t* __restrict reconstructed,
+    size_t pixel_count)
+{
+    if (pixel_count != N) {
+        reconstruct_frame(residual, previous, reconstructed, pixel_count);
+        return;
+    }
+
+    SIMD_HINT
+    for (size_t i = 0; i < N; ++i) {
+        const int32_t val = static_cast<int32_t>(previous[i]) + static_cast<int32_t>(residual[i]);
+        reconstructed[i] = static_cast<uint16_t>(std::min(std::max(val, 0), 65535));
+    }
+}
+
+const ResidualKernels GENERIC_KERNELS = {
+    "generic",
+    compute_residual,
+    quantize_residual,
+    dequantize_residual,
+    reconstruct_frame,
+};
+
+const ResidualKernels FP8_KERNELS = {
+    "fp8",
+    compute_residual,
+    quantize_residual_fixed<0, 8>,
+    dequantize_residual_fixed<0, 8>,
+    reconstruct_frame,
+};
+
+const ResidualKernels KERNELS_640x512 = {
+    "640x512",
+    compute_residual_fixed<PIXELS_640x512>,
+    quantize_residual,
+    dequantize_residual,
+    reconstruct_frame_fixed<PIXELS_640x512>,
+};
+
+const ResidualKernels KERNELS_640x512_FP8 = {
+    "640x512/fp8",
+    compute_residual_fixed<PIXELS_640x512>,
+    quantize_residual_fixed<PIXELS_640x512, 8>,
+    dequantize_residual_fixed<PIXELS_640x512, 8>,
+    reconstruct_frame_fixed<PIXELS_640x512>,
+};
+
+const ResidualKernels KERNELS_1024x768 = {
+    "1024x768",
+    compute_residual_fixed<PIXELS_1024x768>,
+    quantize_residual,
+    dequantize_residual,
+    reconstruct_frame_fixed<PIXELS_1024x768>,
+};
+
+const ResidualKernels KERNELS_1024x768_FP8 = {
+    "1024x768/fp8",
+    compute_residual_fixed<PIXELS_1024x768>,
+    quantize_residual_fixed<PIXELS_1024x768, 8>,
+    dequantize_residual_fixed<PIXELS_1024x768, 8>,
+    reconstruct_frame_fixed<PIXELS_1024x768>,
+};
+
+} // anonymous namespace
+
+const ResidualKernels& generic_residual_kernels()
+{
+    return GENERIC_KERNELS;
+}
+
+const ResidualKernels& select_residual_kernels(uint32_t width, uint32_t height, uint32_t fp_bits)
+{
+    const bool fp8 = (fp_bits == 8);
+    if (width == 640 && height == 512) {
+        return fp8 ? KERNELS_640x512_FP8 : KERNELS_640x512;
+    }
+    if (width == 1024 && height == 768) {
+        return fp8 ? KERNELS_1024x768_FP8 : KERNELS_1024x768;
+    }
+    return fp8 ? FP8_KERNELS : GENERIC_KERNELS;
+}
+
+} // namespace lwir
@@ -0,0 +1,341 @@
+/**
+ * @file lwir_c.cpp
+ * @brief C ABI over CompressionPipeline and FrameEncoder
+ *
+ * No C++ exception or type crosses the boundary: every entry point catches
+ * and maps to an lwir_status.
+ */
+
+#include "lwir_c.h"
+#include "config.hpp"
+#include "encoder.hpp"
+#include "frame_format.hpp"
+#include "pipeline.hpp"
+#include <cstring>
+#include <memory>
+#include <new>
+
+struct lwir_encoder {
+    lwir::CompressionConfig config;
+    std::unique_ptr<lwir::CompressionPipeline> pipeline;
+    uint32_t next_index;
+
+    // Destination of the frame being encoded (set per call)
+    uint8_t* out;
+    size_t capacity;
+    size_t written;
+    lwir_frame_info info;
+};
+
+struct lwir_decoder {
+    lwir::FrameEncoder decoder;
+    lwir::CompressedFrame record;   // Payload buffer, reused across frames
+};
+
+namespace {
+
+void fill_info(const lwir::CompressedFrame& frame, lwir_frame_info* info)
+{
+    if (!info) return;
+    info->width = frame.width;
+    info->height = frame.height;
+    info->frame_index = frame.frame_index;
+    info->timestamp = frame.timestamp;
+    info->is_keyframe = frame.is_keyframe ? 1 : 0;
+    info->payload_bytes = static_cast<uint32_t>(frame.compressed_data.size());
+    info->record_bytes = static_cast<uint32_t>(lwir::frame_record_size(frame));
+    info->is_repeat = frame.is_repeat ? 1 : 0;
+}
+
+void start_session(lwir_encoder* enc)
+{
+    enc->pipeline.reset(new lwir::CompressionPipeline(enc->config));
+    enc->next_index = 0;
+    enc->pipeline->set_frame_sink([enc](const lwir::CompressedFrame& frame, const lwir::FrameStats&) {
+        enc->written = lwir::write_frame_record(frame, enc->out, enc->capacity);
+        fill_info(frame, &enc->info);
+        return enc->written > 0;
+    });
+}
+
+lwir_status create_encoder(const lwir::CompressionConfig& config, lwir_encoder** encoder)
+{
+    if (!config.validate_parameters()) {
+        return LWIR_ERROR_INVALID_CONFIG;
+    }
+
+    std::unique_ptr<lwir_encoder> enc(new lwir_encoder());
+    enc->config = config;
+    enc->config.verbose = false;     // The caller owns stdout
+    enc->config.dry_run = true;      // Records go to the caller, not to files
+    enc->config.output_dir.clear();
+    enc->config.encode_workers = 0;  // One record per lwir_encoder_encode call
+    start_session(enc.get());
+
+    *encoder = enc.release();
+    return LWIR_OK;
+}
+
+} // anonymous namespace
+
+extern "C" {
+
+uint32_t lwir_api_version(void)
+{
+    return LWIR_C_API_VERSION;
+}
+
+const char* lwir_status_string(lwir_status status)
+{
+    switch (status) {
+        case LWIR_OK:                      return "ok";
+        case LWIR_ERROR_INVALID_ARGUMENT:  return "invalid argument";
+        case LWIR_ERROR_INVALID_CONFIG:    return "invalid configuration";
+        case LWIR_ERROR_BUFFER_TOO_SMALL:  return "buffer too small";
+        case LWIR_ERROR_ENCODE_FAILED:     return "encode failed";
+        case LWIR_ERROR_DECODE_FAILED:     return "decode failed";
+        case LWIR_ERROR_NO_REFERENCE:      return "residual frame without reference";
+        case LWIR_ERROR_TRUNCATED:         return "truncated record";
+        case LWIR_ERROR_OUT_OF_MEMORY:     return "out of memory";
+        case LWIR_ERROR_INTERNAL:          return "internal error";
+        default:                           return "unknown status";
+    }
+}
+
+void lwir_config_init(lwir_config* config)
+{
+    if (!config) return;
+
+    const lwir::CompressionConfig defaults;
+    std::memset(config, 0, sizeof(*config));
+    config->struct_size = sizeof(lwir_config);
+    config->gop_period = defaults.gop_period;
+    config->keyframe_near = defaults.keyframe_near;
+    config->residual_near = defaults.residual_near;
+    config->dead_zone_T = defaults.dead_zone_T;
+    config->quant_Q = defaults.quant_Q;
+    config->fp_bits = defaults.fp_bits;
+    config->enable_12bit_mode = defaults.enable_12bit_mode ? 1 : 0;
+    config->enable_decision_stats = defaults.enable_decision_stats ? 1 : 0;
+    config->frame_deadline_ms = 0.0;   // Deadline misses would be reported on stderr
+    config->overload_enable = defaults.overload_enable ? 1 : 0;
+}
+
+size_t lwir_record_bound(uint32_t width, uint32_t height)
+{
+    return lwir::frame_record_bound(width, height);
+}
+
+lwir_status lwir_encoder_create(const lwir_config* config, lwir_encoder** encoder)
+{
+    if (!config || !encoder || config->struct_size < sizeof(lwir_config)) {
+        return LWIR_ERROR_INVALID_ARGUMENT;
+    }
+    *encoder = nullptr;
+
+    try {
+        lwir::CompressionConfig cfg;
+        cfg.gop_period = config->gop_period;
+        cfg.keyframe_near = config->keyframe_near;
+        cfg.residual_near = config->residual_near;
+        cfg.dead_zone_T = config->dead_zone_T;
+        cfg.quant_Q = config->quant_Q;
+        cfg.fp_bits = config->fp_bits;
+        cfg.enable_12bit_mode = (config->enable_12bit_mode != 0);
+        cfg.enable_decision_stats = (config->enable_decision_stats != 0);
+        cfg.frame_deadline_ms = config->frame_deadline_ms;
+        cfg.overload_enable = (config->overload_enable != 0);
+        return create_encoder(cfg, encoder);
+    }
+    catch (const std::bad_alloc&) {
+        return LWIR_ERROR_OUT_OF_MEMORY;
+    }
+    catch (...) {
+        return LWIR_ERROR_INTERNAL;
+    }
+}
+
+lwir_status lwir_encoder_create_from_yaml(const char* yaml, const char* profile, lwir_encoder** encoder)
+{
+    if (!yaml || !encoder) {
+        return LWIR_ERROR_INVALID_ARGUMENT;
+    }
+    *encoder = nullptr;
+
+    try {
+        lwir::CompressionConfig cfg;
+        if (!cfg.load_from_string(yaml, profile ? profile : "")) {
+            return LWIR_ERROR_INVALID_CONFIG;
+        }
+        return create_encoder(cfg, encoder);
+    }
+    catch (const std::bad_alloc&) {
+        return LWIR_ERROR_OUT_OF_MEMORY;
+    }
+    catch (...) {
+        return LWIR_ERROR_INTERNAL;
+    }
+}
+
+void lwir_encoder_destroy(lwir_encoder* encoder)
+{
+    delete encoder;
+}
+
+lwir_status lwir_encoder_encode(lwir_encoder* encoder,
+                                const uint16_t* pixels, uint32_t width, uint32_t height,
+                                size_t stride_bytes, uint64_t timestamp,
+                                uint8_t* out, size_t capacity, size_t* written,
+                                lwir_frame_info* info)
+{
+    if (!encoder || !pixels || !out || !written || width == 0 || height == 0 ||
+        stride_bytes < width * sizeof(uint16_t) || stride_bytes % sizeof(uint16_t) != 0)
+    {
+        return LWIR_ERROR_INVALID_ARGUMENT;
+    }
+    *written = 0;
+
+    // Checked up front: once encoded, the frame is part of the reference chain
+    if (capacity < lwir::frame_record_bound(width, height)) {
+        return LWIR_ERROR_BUFFER_TOO_SMALL;
+    }
+
+    try {
+        const lwir::DeadlineMonitor::Clock::time_point arrival = lwir::DeadlineMonitor::Clock::now();
+
+        // Read in place; the pipeline packs padded rows
+        lwir::FrameView frame(pixels, width, height, stride_bytes / sizeof(uint16_t), timestamp);
+        frame.frame_index = encoder->next_index;
+
+        encoder->out = out;
+        encoder->capacity = capacity;
+        encoder->written = 0;
+        if (!encoder->pipeline->process_frame(frame, arrival, 0)) {
+            return LWIR_ERROR_ENCODE_FAILED;
+        }
+        encoder->next_index++;
+
+        *written = encoder->written;
+        if (info) {
+            *info = encoder->info;
+        }
+        return LWIR_OK;
+    }
+    catch (const std::bad_alloc&) {
+        return LWIR_ERROR_OUT_OF_MEMORY;
+    }
+    catch (...) {
+        return LWIR_ERROR_INTERNAL;
+    }
+}
+
+lwir_status lwir_encoder_reset(lwir_encoder* encoder)
+{
+    if (!encoder) {
+        return LWIR_ERROR_INVALID_ARGUMENT;
+    }
+
+    try {
+        start_session(encoder);
+        return LWIR_OK;
+    }
+    catch (const std::bad_alloc&) {
+        return LWIR_ERROR_OUT_OF_MEMORY;
+    }
+    catch (...) {
+        return LWIR_ERROR_INTERNAL;
+    }
+}
+
+lwir_status lwir_decoder_create(lwir_decoder** decoder)
+{
+    if (!decoder) {
+        return LWIR_ERROR_INVALID_ARGUMENT;
+    }
+
+    try {
+        *decoder = new lwir_decoder();
+        return LWIR_OK;
+    }
+    catch (const std::bad_alloc&) {
+        *decoder = nullptr;
+        return LWIR_ERROR_OUT_OF_MEMORY;
+    }
+}
+
+void lwir_decoder_destroy(lwir_decoder* decoder)
+{
+    delete decoder;
+}
+
+lwir_status lwir_peek(const uint8_t* record, size_t size, lwir_frame_info* info)
+{
+    if (!record || !info) {
+        return LWIR_ERROR_INVALID_ARGUMENT;
+    }
+
+    lwir::CompressedFrame header;
+    uint32_t payload_size = 0;
+    if (!lwir::read_frame_header(record, size, header, payload_size)) {
+        return LWIR_ERROR_TRUNCATED;
+    }
+
+    fill_info(header, info);
+    info->payload_bytes = payload_size;
+    info->record_bytes = static_cast<uint32_t>(lwir::FRAME_HEADER_SIZE + payload_size);
+    return LWIR_OK;
+}
+
+lwir_status lwir_decoder_decode(lwir_decoder* decoder,
+                                const uint8_t* record, size_t size,
+                                uint16_t* pixels, size_t stride_bytes, size_t capacity,
+                                lwir_frame_info* info)
+{
+    if (!decoder || !record || !pixels || stride_bytes % sizeof(uint16_t) != 0) {
+        return LWIR_ERROR_INVALID_ARGUMENT;
+    }
+
+    try {
+        lwir::CompressedFrame& compressed = decoder->record;
+        if (!lwir::read_frame_record(record, size, compressed)) {
+            return LWIR_ERROR_TRUNCATED;
+        }
+
+        const uint32_t width = compressed.width;
+        const uint32_t height = compressed.height;
+        if (width == 0 || height == 0 || stride_bytes < width * sizeof(uint16_t)) {
+            return LWIR_ERROR_INVALID_ARGUMENT;
+        }
+        if (capacity < (height - 1) * stride_bytes + width * sizeof(uint16_t)) {
+            return LWIR_ERROR_BUFFER_TOO_SMALL;
+        }
+        if (!compressed.is_keyframe && !decoder->decoder.has_reference()) {
+            return LWIR_ERROR_NO_REFERENCE;
+        }
+
+        // Reconstructed into the decoder's reference, written to the caller's rows once
+        if (!decoder->decoder.decode_frame(compressed, pixels, stride_bytes / sizeof(uint16_t))) {
+            return LWIR_ERROR_DECODE_FAILED;
+        }
+
+        fill_info(compressed, info);
+        return LWIR_OK;
+    }
+    catch (const std::bad_alloc&) {
+        return LWIR_ERROR_OUT_OF_MEMORY;
+    }
+    catch (...) {
+        return LWIR_ERROR_INTERNAL;
+    }
+}
+
+lwir_status lwir_decoder_reset(lwir_decoder* decoder)
+{
+    if (!decoder) {
+        return LWIR_ERROR_INVALID_ARGUMENT;
+    }
+    decoder->decoder.reset();
+    return LWIR_OK;
+}
+
+} // extern "C"
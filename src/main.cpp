@@ -8,19 +8,45 @@
  * Usage:
  *   lwir_compress --config example_config.yaml
  *   lwir_compress --input frames/ --output compressed/ --gop 60
+ *
+ * With --config, SIGHUP re-reads the configuration file between frames
+ * (--watch-config also reloads whenever the file is saved).
+ *
+ * With --shards, the tool is a batch coordinator: it runs itself once per
+ * GOP-aligned shard of the input (see batch.hpp) and merges the shard
+ * outputs into one segmented archive.
  */
 
 #include "pipeline.hpp"
 #include "config.hpp"
+#include "config_reload.hpp"
+#include "batch.hpp"
 #include <iostream>
 #include <string>
+#include <cstdio>
 #include <cstring>
 #include <csignal>
 #include <atomic>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace {
 
 std::atomic<bool> g_interrupted(false);
+lwir::ConfigReloader* g_reloader = nullptr;
+
+/**
+ * Batch coordinator (--shards) and shard worker (--shard-output) settings
+ */
+struct BatchOptions {
+    uint32_t shards = 0;         // 0 = a single process encodes the input
+    uint32_t jobs = 0;           // Workers at once (0 = hardware concurrency)
+    uint32_t retries = 2;        // Extra attempts for a failed shard
+    std::string shard_output;    // Worker: output directory, overriding the config file
+};
 
 void signal_handler(int signal)
 {
@@ -28,6 +54,9 @@ void signal_handler(int signal)
         std::cout << "\nInterrupt received, stopping..." << std::endl;
         g_interrupted = true;
     }
+    else if (signal == SIGHUP && g_reloader) {
+        g_reloader->request_reload();
+    }
 }
 
 void print_usage(const char* program_name)
@@ -42,23 +71,47 @@ void print_usage(const char* program_name)
     std::cout << "  --config <path>        Load configuration from YAML file" << std::endl;
     std::cout << "  --profile <name>       Use specific profile from config file" << std::endl;
     std::cout << "  --input <dir>          Input directory containing PNG frames" << std::endl;
+    std::cout << "  --input-format <name>  png (default), packed raw12 / raw14 dumps (*.raw), or tiff stacks" << std::endl;
+    std::cout << "  --input-size <WxH>     Frame geometry of packed input" << std::endl;
+    std::cout << "  --prefetch-workers <N> Decode compressed TIFF pages on N threads ahead of the encoder" << std::endl;
     std::cout << "  --output <dir>         Output directory for compressed frames" << std::endl;
+    std::cout << "  --segment-gops <N>     Write rolling segment files of N GOPs instead of one file per frame" << std::endl;
+    std::cout << "  --segment-mb <N>       Start the next segment at the keyframe after N MB" << std::endl;
+    std::cout << "  --segment-minutes <M>  Start the next segment at the keyframe after M capture minutes" << std::endl;
+    std::cout << "  --storage-budget-mb <N> Keep only the newest segments within N MB (needs --segment-mb)" << std::endl;
     std::cout << "  --gop <N>              GOP period (frames between keyframes)" << std::endl;
     std::cout << "  --keyframe-near <N>    NEAR parameter for keyframes (0=lossless)" << std::endl;
     std::cout << "  --residual-near <N>    NEAR parameter for residual frames" << std::endl;
     std::cout << "  --quant-q <Q>          Quantization parameter Q" << std::endl;
     std::cout << "  --dead-zone <T>        Dead zone threshold T" << std::endl;
     std::cout << "  --fp-bits <N>          Fixed-point fractional bits" << std::endl;
+    std::cout << "  --deadline-ms <ms>     Per-frame real-time budget (0 = disabled)" << std::endl;
+    std::cout << "  --encode-workers <N>   JPEG-LS code NEAR=0 frames on N threads behind the next frame" << std::endl;
+    std::cout << "  --detect-repeats       Send frames identical to the previous one as repeat records" << std::endl;
+    std::cout << "  --static-gating        Also send repeats when the residual is within the dead zone" << std::endl;
+    std::cout << "  --frame-period <us>    Nominal capture period; detects dropped frames (0 = disabled)" << std::endl;
+    std::cout << "  --gap-policy <name>    After dropped frames: keyframe, widen or ignore (default: keyframe)" << std::endl;
+    std::cout << "  --perf-counters        Sample hardware counters per encoder stage" << std::endl;
+    std::cout << "  --watch-config         Reload the config file when it changes (SIGHUP always reloads)" << std::endl;
+    std::cout << "  --checkpoint <path>    Snapshot encoder state at every keyframe (use tmpfs)" << std::endl;
+    std::cout << "  --resume               Continue from the checkpoint instead of starting a new GOP" << std::endl;
+    std::cout << "  --frame-range <F:N>    Encode only the N frames starting at input frame F" << std::endl;
+    std::cout << "  --shards <N>           Split the input into N GOP-aligned shards, one worker process each," << std::endl;
+    std::cout << "                         and merge them into one segmented archive" << std::endl;
+    std::cout << "  --jobs <N>             Shard workers running at once (default: one per core)" << std::endl;
+    std::cout << "  --shard-retries <N>    Run a failed shard up to N more times (default: 2)" << std::endl;
     std::cout << "  --help                 Show this help message" << std::endl;
     std::cout << std::endl;
     std::cout << "Examples:" << std::endl;
     std::cout << "  " << program_name << " --config example_config.yaml" << std::endl;
     std::cout << "  " << program_name << " --config config.yaml --profile high_quality" << std::endl;
     std::cout << "  " << program_name << " --input frames/ --output compressed/ --gop 60" << std::endl;
+    std::cout << "  " << program_name << " --input flight.tif --input-format tiff --output archive/ --shards 32" << std::endl;
     std::cout << std::endl;
 }
 
-bool parse_command_line(int argc, char** argv, lwir::CompressionConfig& config, std::string& config_file, std::string& profile)
+bool parse_command_line(int argc, char** argv, lwir::CompressionConfig& config, std::string& config_file, std::string& profile,
+                        bool& watch_config, bool& resume, BatchOptions& batch)
 {
     if (argc < 2) {
         return false;
@@ -146,6 +199,152 @@ bool parse_command_line(int argc, char** argv, lwir::CompressionConfig& config,
             }
             config.fp_bits = static_cast<uint32_t>(std::stoul(argv[++i]));
         }
+        else if (arg == "--detect-repeats") {
+            config.detect_repeats = true;
+        }
+        else if (arg == "--static-gating") {
+            config.static_gating = true;
+        }
+        else if (arg == "--input-format") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --input-format requires an argument" << std::endl;
+                return false;
+            }
+            config.input_format = argv[++i];
+        }
+        else if (arg == "--input-size") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --input-size requires an argument" << std::endl;
+                return false;
+            }
+            unsigned width = 0, height = 0;
+            if (std::sscanf(argv[++i], "%ux%u", &width, &height) != 2) {
+                std::cerr << "Error: --input-size expects WxH, e.g. 640x512" << std::endl;
+                return false;
+            }
+            config.input_width = width;
+            config.input_height = height;
+        }
+        else if (arg == "--prefetch-workers") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --prefetch-workers requires an argument" << std::endl;
+                return false;
+            }
+            config.prefetch_workers = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--segment-gops") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --segment-gops requires an argument" << std::endl;
+                return false;
+            }
+            config.segment_gops = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--segment-mb") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --segment-mb requires an argument" << std::endl;
+                return false;
+            }
+            config.segment_mb = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--segment-minutes") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --segment-minutes requires an argument" << std::endl;
+                return false;
+            }
+            config.segment_minutes = std::stod(argv[++i]);
+        }
+        else if (arg == "--storage-budget-mb") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --storage-budget-mb requires an argument" << std::endl;
+                return false;
+            }
+            config.storage_budget_mb = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--frame-period") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --frame-period requires an argument" << std::endl;
+                return false;
+            }
+            config.frame_period_us = std::stod(argv[++i]);
+        }
+        else if (arg == "--gap-policy") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --gap-policy requires an argument" << std::endl;
+                return false;
+            }
+            config.gap_policy = argv[++i];
+        }
+        else if (arg == "--perf-counters") {
+            config.enable_perf_counters = true;
+        }
+        else if (arg == "--watch-config") {
+            watch_config = true;
+        }
+        else if (arg == "--checkpoint") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --checkpoint requires an argument" << std::endl;
+                return false;
+            }
+            config.checkpoint_path = argv[++i];
+        }
+        else if (arg == "--resume") {
+            resume = true;
+        }
+        else if (arg == "--deadline-ms") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --deadline-ms requires an argument" << std::endl;
+                return false;
+            }
+            config.frame_deadline_ms = std::stod(argv[++i]);
+        }
+        else if (arg == "--encode-workers") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --encode-workers requires an argument" << std::endl;
+                return false;
+            }
+            config.encode_workers = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--frame-range") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --frame-range requires an argument" << std::endl;
+                return false;
+            }
+            unsigned first = 0, count = 0;
+            if (std::sscanf(argv[++i], "%u:%u", &first, &count) != 2 || count == 0) {
+                std::cerr << "Error: --frame-range expects FIRST:COUNT, e.g. 600:300" << std::endl;
+                return false;
+            }
+            config.frame_range_first = first;
+            config.frame_range_count = count;
+        }
+        else if (arg == "--shards") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --shards requires an argument" << std::endl;
+                return false;
+            }
+            batch.shards = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--jobs") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --jobs requires an argument" << std::endl;
+                return false;
+            }
+            batch.jobs = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--shard-retries") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --shard-retries requires an argument" << std::endl;
+                return false;
+            }
+            batch.retries = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--shard-output") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --shard-output requires an argument" << std::endl;
+                return false;
+            }
+            batch.shard_output = argv[++i];
+        }
         else {
             std::cerr << "Error: Unknown argument: " << arg << std::endl;
             return false;
@@ -161,6 +360,127 @@ bool parse_command_line(int argc, char** argv, lwir::CompressionConfig& config,
     return true;
 }
 
+/**
+ * This executable, for the shard workers
+ */
+std::string self_executable(const char* argv0)
+{
+    char path[4096];
+    const ssize_t length = ::readlink("/proc/self/exe", path, sizeof(path) - 1);
+    if (length <= 0) {
+        return argv0;
+    }
+    path[length] = '\0';
+    return path;
+}
+
+/**
+ * Coordinator: encode the shards in worker processes, then merge them
+ */
+int run_batch(int argc, char** argv, const lwir::CompressionConfig& config, const BatchOptions& batch)
+{
+    if (!config.checkpoint_path.empty() || config.storage_budget_mb > 0 || config.dry_run) {
+        std::cerr << "--shards cannot be combined with checkpoints, ring storage or dry runs" << std::endl;
+        return 1;
+    }
+
+    std::vector<lwir::SegmentInfo> existing;
+    if (lwir::read_segment_manifest(config.output_dir, existing)) {
+        std::cerr << "Output already holds a segmented archive: " << config.output_dir << std::endl;
+        return 1;
+    }
+
+    std::unique_ptr<lwir::FrameSource> source = lwir::open_input_source(config);
+    if (!source) {
+        return 1;
+    }
+    size_t first = 0;
+    size_t frames = source->frame_count();
+    if (config.frame_range_count > 0) {
+        first = std::min<size_t>(config.frame_range_first, frames);
+        frames = std::min<size_t>(config.frame_range_count, frames - first);
+    }
+    std::vector<lwir::ShardRange> shards = lwir::plan_shards(frames, config.gop_period, batch.shards);
+    if (shards.empty()) {
+        std::cerr << "No frames to encode in " << source->description() << std::endl;
+        return 1;
+    }
+    for (lwir::ShardRange& shard : shards) {
+        shard.first += static_cast<uint32_t>(first);
+    }
+    std::cout << "Found " << source->description() << std::endl;
+    std::cout << "Encoding " << frames << " frames as " << shards.size() << " shards of up to "
+              << shards.front().count << " frames" << std::endl;
+    source.reset();
+
+    struct stat st;
+    if (stat(config.output_dir.c_str(), &st) != 0 && mkdir(config.output_dir.c_str(), 0755) != 0) {
+        std::cerr << "Failed to create output directory: " << config.output_dir << std::endl;
+        return 1;
+    }
+
+    // Workers get the same command line, less the coordinator's own options
+    std::vector<std::string> command = {self_executable(argv[0])};
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--shards" || arg == "--jobs" || arg == "--shard-retries" || arg == "--frame-range") {
+            ++i;
+        }
+        else if (arg != "--watch-config" && arg != "--resume") {
+            command.push_back(arg);
+        }
+    }
+
+    const std::string shard_root = config.output_dir + "/shards";
+    lwir::ShardCoordinator coordinator(command, shard_root, batch.jobs, batch.retries);
+    std::vector<lwir::ShardResult> results;
+    const bool ok = coordinator.run(shards, results, &g_interrupted);
+    if (g_interrupted) {
+        std::cout << "Batch interrupted by user" << std::endl;
+        return 130;
+    }
+    if (!ok) {
+        size_t failed = 0;
+        for (const lwir::ShardResult& result : results) {
+            failed += result.ok ? 0 : 1;
+        }
+        std::cerr << failed << " of " << results.size() << " shards failed; shard outputs and logs kept in "
+                  << shard_root << std::endl;
+        return 1;
+    }
+
+    // Segment limits apply to the merged archive (none: a single segment)
+    lwir::SegmentLimits limits;
+    limits.gops = config.segment_gops;
+    limits.bytes = static_cast<uint64_t>(config.segment_mb) * 1024 * 1024;
+    limits.duration_us = static_cast<uint64_t>(config.segment_minutes * 60.0e6);
+
+    std::vector<std::string> shard_dirs;
+    for (const lwir::ShardResult& result : results) {
+        shard_dirs.push_back(result.output_dir);
+    }
+    uint64_t merged = 0;
+    if (!lwir::merge_archives(shard_dirs, config.output_dir, limits, &merged)) {
+        std::cerr << "Merge failed; shard outputs kept in " << shard_root << std::endl;
+        return 1;
+    }
+    if (merged != frames) {
+        std::cerr << "Merged " << merged << " frames, expected " << frames << "; shard outputs kept in "
+                  << shard_root << std::endl;
+        return 1;
+    }
+    lwir::remove_directory_tree(shard_root);
+
+    uint32_t retried = 0;
+    for (const lwir::ShardResult& result : results) {
+        retried += result.attempts - 1;
+    }
+    std::cout << std::endl;
+    std::cout << "Merged " << merged << " frames from " << results.size() << " shards into "
+              << config.output_dir << " (" << retried << " retries)" << std::endl;
+    return 0;
+}
+
 } // anonymous namespace
 
 int main(int argc, char** argv)
@@ -173,8 +493,11 @@ int main(int argc, char** argv)
     lwir::CompressionConfig config;
     std::string config_file;
     std::string profile;
+    bool watch_config = false;
+    bool resume = false;
+    BatchOptions batch;
 
-    if (!parse_command_line(argc, argv, config, config_file, profile)) {
+    if (!parse_command_line(argc, argv, config, config_file, profile, watch_config, resume, batch)) {
         print_usage(argv[0]);
         return 1;
     }
@@ -192,6 +515,11 @@ int main(int argc, char** argv)
         }
     }
 
+    // A shard worker writes where the coordinator tells it to
+    if (!batch.shard_output.empty()) {
+        config.output_dir = batch.shard_output;
+    }
+
     // Validate configuration
     if (!config.validate()) {
         std::cerr << "Invalid configuration" << std::endl;
@@ -203,9 +531,38 @@ int main(int argc, char** argv)
     config.print();
     std::cout << std::endl;
 
+    if (batch.shards > 0) {
+        return run_batch(argc, argv, config, batch);
+    }
+
     // Create and run pipeline
     lwir::CompressionPipeline pipeline(config);
 
+    // Failover: continue the previous process's GOP from its checkpoint
+    if (resume) {
+        if (config.checkpoint_path.empty()) {
+            std::cerr << "Warning: --resume requires checkpoint_path (or --checkpoint)" << std::endl;
+        }
+        else if (!pipeline.restore_checkpoint(config.checkpoint_path)) {
+            std::cerr << "No usable checkpoint, starting a new session" << std::endl;
+        }
+    }
+
+    // Hot reload: SIGHUP (and optionally file changes) re-read the config file
+    lwir::ConfigReloader reloader(config_file, profile);
+    if (!config_file.empty()) {
+        if (!reloader.start(watch_config)) {
+            std::cerr << "Configuration reload unavailable" << std::endl;
+        } else {
+            g_reloader = &reloader;
+            std::signal(SIGHUP, signal_handler);
+            pipeline.set_config_reloader(&reloader);
+        }
+    }
+    else if (watch_config) {
+        std::cerr << "Warning: --watch-config requires --config" << std::endl;
+    }
+
     try {
         if (!pipeline.run()) {
             std::cerr << "Compression pipeline failed" << std::endl;
@@ -0,0 +1,231 @@
+/**
+ * @file overload.cpp
+ * @brief Quality-degradation ladder implementation
+ */
+
+#include "overload.hpp"
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+
+namespace lwir {
+
+const char* overload_step_name(OverloadStep step)
+{
+    switch (step) {
+        case OverloadStep::SKIP_VERIFY:     return "skip_verify";
+        case OverloadStep::RAISE_NEAR:      return "raise_near";
+        case OverloadStep::RAISE_QT:        return "raise_qt";
+        case OverloadStep::EXTEND_GOP:      return "extend_gop";
+        case OverloadStep::SUBSAMPLE_STATS: return "subsample_stats";
+        default:                            return "unknown";
+    }
+}
+
+bool parse_overload_step(const std::string& name, OverloadStep& step)
+{
+    static const OverloadStep all_steps[] = {
+        OverloadStep::SKIP_VERIFY,
+        OverloadStep::RAISE_QT,
+        OverloadStep::EXTEND_GOP,
+        OverloadStep::RAISE_NEAR,
+        OverloadStep::SUBSAMPLE_STATS
+    };
+
+    for (OverloadStep candidate : all_steps) {
+        if (name == overload_step_name(candidate)) {
+            step = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+OverloadController::OverloadController(const CompressionConfig& config)
+    : config_(config)
+    , enabled_(config.overload_enable)
+    , use_slack_(config.frame_deadline_ms > 0.0)
+    , level_(0)
+    , cooldown_(0)
+    , clear_frames_(0)
+{
+    for (const std::string& name : config.overload_ladder) {
+        OverloadStep step;
+        if (parse_overload_step(name, step)) {
+            ladder_.push_back(step);
+        }
+    }
+
+    frames_at_level_.assign(ladder_.size() + 1, 0);
+    apply_level();
+}
+
+void OverloadController::reconfigure(const CompressionConfig& config)
+{
+    const std::vector<std::string> ladder = config_.overload_ladder;
+    const bool enable = config_.overload_enable;
+    config_ = config;
+    config_.overload_ladder = ladder;
+    config_.overload_enable = enable;
+    apply_level();
+}
+
+void OverloadController::apply_level()
+{
+    knobs_ = EncodeKnobs();
+    knobs_.residual_near = config_.residual_near;
+    knobs_.quant_Q = config_.quant_Q;
+    knobs_.dead_zone_T = config_.dead_zone_T;
+    knobs_.gop_period = config_.gop_period;
+
+    for (uint32_t i = 0; i < level_; ++i) {
+        switch (ladder_[i]) {
+            case OverloadStep::SKIP_VERIFY:
+                knobs_.verify_decode = false;
+                break;
+            case OverloadStep::RAISE_QT:
+                knobs_.quant_Q *= config_.overload_q_scale;
+                knobs_.dead_zone_T += config_.overload_t_step;
+                break;
+            case OverloadStep::EXTEND_GOP:
+                knobs_.gop_period *= config_.overload_gop_scale;
+                break;
+            case OverloadStep::RAISE_NEAR:
+                // NEAR > 0 residuals need a closed-loop decode per frame (and
+                // cannot be coded on encode_workers), so leaving NEAR = 0
+                // would make an overloaded encoder slower
+                if (config_.residual_near > 0) {
+                    knobs_.residual_near += config_.overload_near_step;
+                }
+                break;
+            case OverloadStep::SUBSAMPLE_STATS:
+                knobs_.stats_stride = config_.overload_stats_stride;
+                break;
+        }
+    }
+}
+
+bool OverloadController::observe(uint32_t frame_index, double slack_ms, uint32_t queue_depth)
+{
+    frames_at_level_[level_]++;
+
+    if (!enabled_ || ladder_.empty()) {
+        return false;
+    }
+
+    const bool behind = (use_slack_ && slack_ms < config_.overload_slack_low_ms) ||
+                        (queue_depth >= config_.overload_queue_high);
+    const bool clear = (!use_slack_ || slack_ms > config_.overload_slack_high_ms) &&
+                       (queue_depth == 0);
+
+    if (cooldown_ > 0) {
+        cooldown_--;
+    }
+
+    const uint32_t from = level_;
+    OverloadStep step = OverloadStep::SKIP_VERIFY;
+
+    if (behind) {
+        clear_frames_ = 0;
+        if (cooldown_ == 0 && level_ < max_level()) {
+            step = ladder_[level_];
+            level_++;
+            cooldown_ = config_.overload_cooldown_frames;
+        }
+    }
+    else if (clear) {
+        clear_frames_++;
+        if (clear_frames_ >= config_.overload_hold_frames && level_ > 0) {
+            level_--;
+            step = ladder_[level_];
+            clear_frames_ = 0;
+        }
+    }
+    else {
+        clear_frames_ = 0;
+    }
+
+    if (level_ == from) {
+        return false;
+    }
+
+    OverloadEvent event;
+    event.frame_index = frame_index;
+    event.from_level = from;
+    event.to_level = level_;
+    event.step = step;
+    event.slack_ms = slack_ms;
+    event.queue_depth = queue_depth;
+    events_.push_back(event);
+
+    apply_level();
+
+    std::cout << "Overload: level " << from << " -> " << level_
+              << (level_ > from ? " (apply " : " (release ") << overload_step_name(step) << ")"
+              << " at frame " << frame_index
+              << ", slack " << std::fixed << std::setprecision(1) << slack_ms << " ms"
+              << ", queue " << queue_depth << std::endl;
+
+    return true;
+}
+
+void OverloadController::print_summary() const
+{
+    if (!enabled_) return;
+
+    uint32_t deepest = 0;
+    for (const OverloadEvent& e : events_) {
+        deepest = std::max(deepest, e.to_level);
+    }
+
+    std::cout << "Overload: " << events_.size() << " transitions"
+              << ", deepest level " << deepest << "/" << max_level()
+              << ", final level " << level_ << std::endl;
+    std::cout << "  Frames per level:";
+    for (size_t l = 0; l < frames_at_level_.size(); ++l) {
+        std::cout << " L" << l << "=" << frames_at_level_[l];
+    }
+    std::cout << std::endl;
+}
+
+std::string OverloadController::to_json(const std::string& indent) const
+{
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(3);
+
+    oss << "{\n";
+    oss << indent << "  \"enabled\": " << (enabled_ ? "true" : "false") << ",\n";
+
+    oss << indent << "  \"ladder\": [";
+    for (size_t i = 0; i < ladder_.size(); ++i) {
+        oss << (i ? ", " : "") << "\"" << overload_step_name(ladder_[i]) << "\"";
+    }
+    oss << "],\n";
+
+    oss << indent << "  \"final_level\": " << level_ << ",\n";
+
+    oss << indent << "  \"frames_at_level\": [";
+    for (size_t l = 0; l < frames_at_level_.size(); ++l) {
+        oss << (l ? ", " : "") << frames_at_level_[l];
+    }
+    oss << "],\n";
+
+    oss << indent << "  \"events\": [";
+    for (size_t i = 0; i < events_.size(); ++i) {
+        const OverloadEvent& e = events_[i];
+        oss << (i ? "," : "") << "\n" << indent << "    {"
+            << "\"frame\": " << e.frame_index << ", "
+            << "\"from\": " << e.from_level << ", "
+            << "\"to\": " << e.to_level << ", "
+            << "\"step\": \"" << overload_step_name(e.step) << "\", "
+            << "\"slack_ms\": " << e.slack_ms << ", "
+            << "\"queue_depth\": " << e.queue_depth << "}";
+    }
+    oss << (events_.empty() ? "]\n" : "\n" + indent + "  ]\n");
+    oss << indent << "}";
+
+    return oss.str();
+}
+
+} // namespace lwir
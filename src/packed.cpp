@@ -0,0 +1,145 @@
+/**
+ * @file packed.cpp
+ * @brief MIPI CSI-2 RAW12 / RAW14 unpacking
+ */
+
+#include "packed.hpp"
+#include <cstring>
+
+// Enable SIMD hints only on ARM with NEON
+#ifdef ENABLE_NEON
+    #define SIMD_HINT _Pragma("omp simd")
+#else
+    #define SIMD_HINT
+#endif
+
+// RAW14 groups are loaded as little-endian 64-bit words only where the host
+// is known to be little-endian; elsewhere they are unpacked bytewise
+#if (defined(__BYTE_ORDER__) && defined(__ORDER_LITTLE_ENDIAN__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) || \
+    defined(_WIN32)
+    #define RAW14_WORD_LOAD 1
+#else
+    #define RAW14_WORD_LOAD 0
+#endif
+
+namespace lwir {
+
+bool parse_packed_format(const std::string& name, PackedFormat& format)
+{
+    if (name == "raw12") {
+        format = PackedFormat::RAW12;
+    }
+    else if (name == "raw14") {
+        format = PackedFormat::RAW14;
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+size_t packed_group_pixels(PackedFormat format)
+{
+    return (format == PackedFormat::RAW12) ? 2 : 4;
+}
+
+size_t packed_group_bytes(PackedFormat format)
+{
+    return (format == PackedFormat::RAW12) ? 3 : 7;
+}
+
+size_t packed_frame_bytes(PackedFormat format, uint32_t width, uint32_t height)
+{
+    const size_t group = packed_group_pixels(format);
+    if (width == 0 || width % group != 0) {
+        return 0;
+    }
+    return static_cast<size_t>(width) / group * packed_group_bytes(format) * height;
+}
+
+void unpack_raw12(const uint8_t* __restrict src, uint16_t* __restrict dst, size_t pixel_count)
+{
+    // Fixed-stride groups without branches: vectorized as 3-way
+    // de-interleaving loads (ld3 on NEON)
+    const size_t groups = pixel_count / 2;
+    SIMD_HINT
+    for (size_t g = 0; g < groups; ++g) {
+        const uint32_t b0 = src[3 * g];
+        const uint32_t b1 = src[3 * g + 1];
+        const uint32_t low = src[3 * g + 2];
+        dst[2 * g] = static_cast<uint16_t>((b0 << 4) | (low & 0x0F));
+        dst[2 * g + 1] = static_cast<uint16_t>((b1 << 4) | (low >> 4));
+    }
+}
+
+void unpack_raw14(const uint8_t* __restrict src, uint16_t* __restrict dst, size_t pixel_count)
+{
+    // Each 7-byte group is loaded as one 8-byte word (little-endian host):
+    // high bytes in bits 0-31, the low bits of P0..P3 in 6-bit fields from
+    // bit 32 on. The last group is read bytewise so the load never runs
+    // past the end of the frame; on big-endian hosts every group is.
+    const size_t groups = pixel_count / 4;
+#if RAW14_WORD_LOAD
+    const size_t word_groups = (groups > 0) ? groups - 1 : 0;
+#else
+    const size_t word_groups = 0;
+#endif
+    for (size_t g = 0; g < word_groups; ++g) {
+        uint64_t w;
+        std::memcpy(&w, src + 7 * g, sizeof(w));
+        uint16_t* d = dst + 4 * g;
+        d[0] = static_cast<uint16_t>(((w & 0xFF) << 6) | ((w >> 32) & 0x3F));
+        d[1] = static_cast<uint16_t>((((w >> 8) & 0xFF) << 6) | ((w >> 38) & 0x3F));
+        d[2] = static_cast<uint16_t>((((w >> 16) & 0xFF) << 6) | ((w >> 44) & 0x3F));
+        d[3] = static_cast<uint16_t>((((w >> 24) & 0xFF) << 6) | ((w >> 50) & 0x3F));
+    }
+
+    for (size_t g = word_groups; g < groups; ++g) {
+        const uint8_t* s = src + 7 * g;
+        const uint32_t low = static_cast<uint32_t>(s[4]) |
+                             (static_cast<uint32_t>(s[5]) << 8) |
+                             (static_cast<uint32_t>(s[6]) << 16);
+        uint16_t* d = dst + 4 * g;
+        for (size_t i = 0; i < 4; ++i) {
+            d[i] = static_cast<uint16_t>((static_cast<uint32_t>(s[i]) << 6) | ((low >> (6 * i)) & 0x3F));
+        }
+    }
+}
+
+void unpack_pixels(PackedFormat format, const uint8_t* src, uint16_t* dst, size_t pixel_count)
+{
+    if (format == PackedFormat::RAW12) {
+        unpack_raw12(src, dst, pixel_count);
+    }
+    else {
+        unpack_raw14(src, dst, pixel_count);
+    }
+}
+
+void pack_pixels(PackedFormat format, const uint16_t* src, uint8_t* dst, size_t pixel_count)
+{
+    if (format == PackedFormat::RAW12) {
+        for (size_t g = 0; g < pixel_count / 2; ++g) {
+            const uint32_t p0 = src[2 * g] & 0x0FFF;
+            const uint32_t p1 = src[2 * g + 1] & 0x0FFF;
+            dst[3 * g] = static_cast<uint8_t>(p0 >> 4);
+            dst[3 * g + 1] = static_cast<uint8_t>(p1 >> 4);
+            dst[3 * g + 2] = static_cast<uint8_t>(((p1 & 0x0F) << 4) | (p0 & 0x0F));
+        }
+        return;
+    }
+
+    for (size_t g = 0; g < pixel_count / 4; ++g) {
+        uint32_t low = 0;
+        for (size_t i = 0; i < 4; ++i) {
+            const uint32_t p = src[4 * g + i] & 0x3FFF;
+            dst[7 * g + i] = static_cast<uint8_t>(p >> 6);
+            low |= (p & 0x3F) << (6 * i);
+        }
+        dst[7 * g + 4] = static_cast<uint8_t>(low);
+        dst[7 * g + 5] = static_cast<uint8_t>(low >> 8);
+        dst[7 * g + 6] = static_cast<uint8_t>(low >> 16);
+    }
+}
+
+} // namespace lwir
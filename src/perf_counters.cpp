@@ -0,0 +1,321 @@
+/**
+ * @file perf_counters.cpp
+ * @brief perf_event_open based stage profiler
+ */
+
+#include "perf_counters.hpp"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <cstring>
+#include <cerrno>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace lwir {
+
+const char* kernel_stage_name(KernelStage stage)
+{
+    switch (stage) {
+        case KernelStage::RANGE_MAP:     return "range_map";
+        case KernelStage::RESIDUAL:      return "residual";
+        case KernelStage::QUANTIZE:      return "quantize";
+        case KernelStage::CHARLS_ENCODE: return "charls_encode";
+        case KernelStage::CHARLS_DECODE: return "charls_decode";
+        case KernelStage::RECONSTRUCT:   return "reconstruct";
+        default:                         return "unknown";
+    }
+}
+
+static const char* frame_kind_name(FrameKind kind)
+{
+    return kind == FrameKind::KEYFRAME ? "keyframe" : "residual";
+}
+
+void PerfSample::add(const PerfSample& other)
+{
+    cycles += other.cycles;
+    instructions += other.instructions;
+    cache_misses += other.cache_misses;
+    branch_misses += other.branch_misses;
+    wall_ms += other.wall_ms;
+}
+
+// ============================================================================
+// PerfCounters
+// ============================================================================
+
+PerfCounters::PerfCounters()
+{
+    for (int i = 0; i < NUM_COUNTERS; ++i) {
+        fds_[i] = -1;
+        ids_[i] = 0;
+    }
+}
+
+PerfCounters::~PerfCounters()
+{
+    close();
+}
+
+#ifdef __linux__
+
+static int perf_event_open_counter(uint64_t config, int group_fd)
+{
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = config;
+    attr.disabled = (group_fd == -1) ? 1 : 0;  // Leader gates the group
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID;
+
+    return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0));
+}
+
+bool PerfCounters::open()
+{
+    close();
+
+    static const uint64_t configs[NUM_COUNTERS] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES
+    };
+
+    fds_[CYCLES] = perf_event_open_counter(configs[CYCLES], -1);
+    if (fds_[CYCLES] < 0) {
+        reason_ = std::string("perf_event_open failed: ") + std::strerror(errno);
+        if (errno == EACCES || errno == EPERM) {
+            reason_ += " (check /proc/sys/kernel/perf_event_paranoid)";
+        }
+        return false;
+    }
+
+    // Optional members: a PMU without e.g. cache-miss events still gives IPC
+    for (int i = INSTRUCTIONS; i < NUM_COUNTERS; ++i) {
+        fds_[i] = perf_event_open_counter(configs[i], fds_[CYCLES]);
+    }
+
+    for (int i = 0; i < NUM_COUNTERS; ++i) {
+        if (fds_[i] >= 0) {
+            ioctl(fds_[i], PERF_EVENT_IOC_ID, &ids_[i]);
+        }
+    }
+
+    reason_.clear();
+    return true;
+}
+
+void PerfCounters::close()
+{
+    for (int i = 0; i < NUM_COUNTERS; ++i) {
+        if (fds_[i] >= 0) {
+            ::close(fds_[i]);
+            fds_[i] = -1;
+        }
+    }
+}
+
+void PerfCounters::start()
+{
+    start_time_ = std::chrono::steady_clock::now();
+    if (!available()) return;
+
+    ioctl(fds_[CYCLES], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(fds_[CYCLES], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+PerfSample PerfCounters::stop()
+{
+    PerfSample sample;
+
+    if (available()) {
+        ioctl(fds_[CYCLES], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+        // Group read format: nr, then {value, id} per counter
+        uint64_t buffer[1 + 2 * NUM_COUNTERS] = {0};
+        const ssize_t n = read(fds_[CYCLES], buffer, sizeof(buffer));
+        if (n > 0) {
+            const uint64_t nr = buffer[0];
+            for (uint64_t k = 0; k < nr && k < NUM_COUNTERS; ++k) {
+                const uint64_t value = buffer[1 + 2 * k];
+                const uint64_t id = buffer[2 + 2 * k];
+                if (fds_[CYCLES] >= 0 && id == ids_[CYCLES]) sample.cycles = value;
+                else if (fds_[INSTRUCTIONS] >= 0 && id == ids_[INSTRUCTIONS]) sample.instructions = value;
+                else if (fds_[CACHE_MISSES] >= 0 && id == ids_[CACHE_MISSES]) sample.cache_misses = value;
+                else if (fds_[BRANCH_MISSES] >= 0 && id == ids_[BRANCH_MISSES]) sample.branch_misses = value;
+            }
+        }
+    }
+
+    sample.wall_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start_time_).count();
+    return sample;
+}
+
+#else // !__linux__
+
+bool PerfCounters::open()
+{
+    reason_ = "hardware counters require Linux perf_event_open";
+    return false;
+}
+
+void PerfCounters::close()
+{
+}
+
+void PerfCounters::start()
+{
+    start_time_ = std::chrono::steady_clock::now();
+}
+
+PerfSample PerfCounters::stop()
+{
+    PerfSample sample;
+    sample.wall_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start_time_).count();
+    return sample;
+}
+
+#endif // __linux__
+
+// ============================================================================
+// PerfProfiler
+// ============================================================================
+
+PerfProfiler::PerfProfiler()
+    : kind_(FrameKind::KEYFRAME)
+{
+    for (size_t k = 0; k < FRAME_KIND_COUNT; ++k) {
+        frames_[k] = 0;
+        pixels_[k] = 0;
+        for (size_t s = 0; s < KERNEL_STAGE_COUNT; ++s) {
+            calls_[k][s] = 0;
+        }
+    }
+}
+
+bool PerfProfiler::open()
+{
+    if (!counters_.open()) {
+        std::cerr << "Hardware counters unavailable, recording wall time only: "
+                  << counters_.unavailable_reason() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void PerfProfiler::begin_frame(FrameKind kind, size_t pixel_count)
+{
+    kind_ = kind;
+    frames_[static_cast<size_t>(kind)]++;
+    pixels_[static_cast<size_t>(kind)] += pixel_count;
+}
+
+void PerfProfiler::start_stage()
+{
+    counters_.start();
+}
+
+void PerfProfiler::stop_stage(KernelStage stage)
+{
+    const PerfSample sample = counters_.stop();
+    const size_t k = static_cast<size_t>(kind_);
+    const size_t s = static_cast<size_t>(stage);
+    totals_[k][s].add(sample);
+    calls_[k][s]++;
+}
+
+void PerfProfiler::print_report() const
+{
+    std::cout << "=== Stage Counters ===" << std::endl;
+    if (!counters_.available()) {
+        std::cout << "(hardware counters unavailable: " << counters_.unavailable_reason()
+                  << "; wall time only)" << std::endl;
+    }
+
+    std::cout << std::left << std::setw(10) << "type"
+              << std::setw(15) << "stage"
+              << std::right << std::setw(10) << "ms/frame"
+              << std::setw(10) << "cyc/px"
+              << std::setw(8) << "IPC"
+              << std::setw(12) << "cmiss/kpx"
+              << std::setw(12) << "bmiss/kpx" << std::endl;
+
+    for (size_t k = 0; k < FRAME_KIND_COUNT; ++k) {
+        if (frames_[k] == 0) continue;
+        const double px = static_cast<double>(pixels_[k]);
+
+        for (size_t s = 0; s < KERNEL_STAGE_COUNT; ++s) {
+            if (calls_[k][s] == 0) continue;
+            const PerfSample& t = totals_[k][s];
+
+            std::cout << std::left << std::setw(10) << frame_kind_name(static_cast<FrameKind>(k))
+                      << std::setw(15) << kernel_stage_name(static_cast<KernelStage>(s))
+                      << std::right << std::fixed
+                      << std::setw(10) << std::setprecision(3) << (t.wall_ms / frames_[k]);
+            if (counters_.available()) {
+                std::cout << std::setw(10) << std::setprecision(2) << (t.cycles / px)
+                          << std::setw(8) << std::setprecision(2)
+                          << (t.cycles > 0 ? static_cast<double>(t.instructions) / t.cycles : 0.0)
+                          << std::setw(12) << std::setprecision(2) << (1000.0 * t.cache_misses / px)
+                          << std::setw(12) << std::setprecision(2) << (1000.0 * t.branch_misses / px);
+            }
+            std::cout << std::endl;
+        }
+    }
+}
+
+std::string PerfProfiler::to_json(const std::string& indent) const
+{
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(4);
+
+    oss << "{\n";
+    oss << indent << "  \"hardware_counters\": " << (counters_.available() ? "true" : "false") << ",\n";
+    oss << indent << "  \"stages\": [";
+
+    bool first = true;
+    for (size_t k = 0; k < FRAME_KIND_COUNT; ++k) {
+        if (frames_[k] == 0) continue;
+        const double px = static_cast<double>(pixels_[k]);
+
+        for (size_t s = 0; s < KERNEL_STAGE_COUNT; ++s) {
+            if (calls_[k][s] == 0) continue;
+            const PerfSample& t = totals_[k][s];
+
+            oss << (first ? "" : ",") << "\n" << indent << "    {"
+                << "\"frame_type\": \"" << frame_kind_name(static_cast<FrameKind>(k)) << "\", "
+                << "\"stage\": \"" << kernel_stage_name(static_cast<KernelStage>(s)) << "\", "
+                << "\"frames\": " << frames_[k] << ", "
+                << "\"calls\": " << calls_[k][s] << ", "
+                << "\"wall_ms\": " << t.wall_ms << ", "
+                << "\"cycles\": " << t.cycles << ", "
+                << "\"instructions\": " << t.instructions << ", "
+                << "\"cache_misses\": " << t.cache_misses << ", "
+                << "\"branch_misses\": " << t.branch_misses << ", "
+                << "\"ipc\": " << (t.cycles > 0 ? static_cast<double>(t.instructions) / t.cycles : 0.0) << ", "
+                << "\"cycles_per_pixel\": " << (t.cycles / px) << ", "
+                << "\"cache_misses_per_pixel\": " << (t.cache_misses / px) << ", "
+                << "\"branch_misses_per_pixel\": " << (t.branch_misses / px) << "}";
+            first = false;
+        }
+    }
+
+    oss << (first ? "]\n" : "\n" + indent + "  ]\n");
+    oss << indent << "}";
+
+    return oss.str();
+}
+
+} // namespace lwir
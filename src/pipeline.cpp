@@ -3,7 +3,7 @@
  * @brief Main compression pipeline orchestration
  *
  * Manages the complete compression workflow:
- * - Load frames from input directory
+ * - Load frames from a frame source (PNG directory by default)
  * - Apply decision logic (keyframe vs residual)
  * - Encode with CharLS
  * - Track statistics and performance metrics
@@ -11,15 +11,21 @@
  */
 
 #include "pipeline.hpp"
+#include "frame_format.hpp"
+#include "checkpoint.hpp"
+#include "tiff_stack.hpp"
 #include <iostream>
 #include <fstream>
 #include <algorithm>
 #include <iomanip>
 #include <chrono>
 #include <cstring>
-#include <dirent.h>
+#include <iterator>
+#include <sstream>
+#include <fcntl.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <unistd.h>
 
 namespace lwir {
 
@@ -27,78 +33,61 @@ CompressionPipeline::CompressionPipeline(const CompressionConfig& config)
     : config_(config)
     , total_original_bytes_(0)
     , total_compressed_bytes_(0)
-    , total_encode_time_ms_(0)
+    , total_encode_time_ms_(0.0)
     , frames_processed_(0)
+    , decision_engine_(config)
+    , session_started_(false)
+    , gap_detector_(config.frame_period_us)
+    , deadline_monitor_(config.frame_deadline_ms)
+    , overload_(config)
+    , index_enabled_(true)
+    , resume_index_(0)
+    , reloader_(nullptr)
+    , gop_update_pending_(false)
+    , band_active_(false)
+    , band_queue_depth_(0)
+    , band_encode_ms_(0.0)
 {
 }
 
-bool CompressionPipeline::load_frame_from_png(const std::string& png_path, Frame& frame)
+void CompressionPipeline::poll_config_reload(uint32_t frame_index)
 {
-    // Use libpng to load 16-bit grayscale PNG
-    FILE* fp = fopen(png_path.c_str(), "rb");
-    if (!fp) {
-        std::cerr << "Failed to open PNG: " << png_path << std::endl;
-        return false;
-    }
-
-    png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
-    if (!png) {
-        fclose(fp);
-        return false;
-    }
-
-    png_infop info = png_create_info_struct(png);
-    if (!info) {
-        png_destroy_read_struct(&png, nullptr, nullptr);
-        fclose(fp);
-        return false;
+    CompressionConfig update;
+    if (!reloader_ || !reloader_->take(update)) {
+        return;
     }
 
-    if (setjmp(png_jmpbuf(png))) {
-        png_destroy_read_struct(&png, &info, nullptr);
-        fclose(fp);
-        return false;
+    for (const std::string& name : restart_parameter_changes(update, config_)) {
+        std::cerr << "Config reload: " << name << " changed, takes effect after restart" << std::endl;
     }
 
-    png_init_io(png, fp);
-    png_read_info(png, info);
-
-    frame.width = png_get_image_width(png, info);
-    frame.height = png_get_image_height(png, info);
-    const int bit_depth = png_get_bit_depth(png, info);
-    const int color_type = png_get_color_type(png, info);
+    apply_frame_parameters(update, config_);
+    decision_engine_.reconfigure(config_);
+    overload_.reconfigure(config_);
 
-    // Convert PNG's big-endian 16-bit to native byte order
-    if (bit_depth == 16) {
-        png_set_swap(png);
-    }
+    gop_update_ = update;
+    gop_update_pending_ = true;
 
-    // Verify it's 16-bit grayscale
-    if (bit_depth != 16 || color_type != PNG_COLOR_TYPE_GRAY) {
-        std::cerr << "PNG must be 16-bit grayscale: " << png_path << std::endl;
-        png_destroy_read_struct(&png, &info, nullptr);
-        fclose(fp);
-        return false;
+    if (config_.verbose) {
+        std::cout << "Configuration reloaded at frame " << frame_index
+                  << " (GOP parameters from the next keyframe)" << std::endl;
     }
+}
 
-    // Allocate row pointers
-    std::vector<png_bytep> row_pointers(frame.height);
-    frame.data.resize(frame.width * frame.height);
+void CompressionPipeline::apply_gop_update(uint32_t frame_index)
+{
+    apply_gop_parameters(gop_update_, config_);
+    decision_engine_.reconfigure(config_);
+    overload_.reconfigure(config_);
+    gop_update_pending_ = false;
 
-    for (uint32_t y = 0; y < frame.height; ++y) {
-        row_pointers[y] = reinterpret_cast<png_bytep>(&frame.data[y * frame.width]);
+    if (config_.verbose) {
+        std::cout << "GOP parameters reloaded at keyframe " << frame_index << std::endl;
     }
-
-    png_read_image(png, row_pointers.data());
-    png_read_end(png, nullptr);
-
-    png_destroy_read_struct(&png, &info, nullptr);
-    fclose(fp);
-
-    return true;
 }
 
-bool CompressionPipeline::write_compressed_frame(const CompressedFrame& frame, const std::string& output_dir)
+bool CompressionPipeline::write_compressed_frame(const CompressedFrame& frame, const std::string& output_dir,
+                                                 uint32_t frames_dropped)
 {
     // Create output directory if it doesn't exist (C++14 compatible)
     struct stat st;
@@ -110,10 +99,22 @@ bool CompressionPipeline::write_compressed_frame(const CompressedFrame& frame, c
         }
     }
 
+    if (config_.segmented_output()) {
+        if (!segment_writer_.is_open()) {
+            SegmentLimits limits;
+            limits.gops = config_.segment_gops;
+            limits.bytes = static_cast<uint64_t>(config_.segment_mb) * 1024 * 1024;
+            limits.duration_us = static_cast<uint64_t>(config_.segment_minutes * 60.0e6);
+            limits.budget_bytes = static_cast<uint64_t>(config_.storage_budget_mb) * 1024 * 1024;
+            if (!segment_writer_.open(output_dir, limits, config_.sync_writes)) {
+                return false;
+            }
+        }
+        return segment_writer_.append(frame, frames_dropped);
+    }
+
     // Write binary compressed frame
-    std::ostringstream filename;
-    filename << "frame_" << std::setw(6) << std::setfill('0') << frame.frame_index << ".lwir";
-    const std::string output_path = output_dir + "/" + filename.str();
+    const std::string output_path = output_dir + "/" + frame_file_name(frame.frame_index);
 
     std::ofstream ofs(output_path, std::ios::binary);
     if (!ofs) {
@@ -121,34 +122,72 @@ bool CompressionPipeline::write_compressed_frame(const CompressedFrame& frame, c
         return false;
     }
 
-    // Write header
-    ofs.write(reinterpret_cast<const char*>(&frame.width), sizeof(frame.width));
-    ofs.write(reinterpret_cast<const char*>(&frame.height), sizeof(frame.height));
-    ofs.write(reinterpret_cast<const char*>(&frame.timestamp), sizeof(frame.timestamp));
-    ofs.write(reinterpret_cast<const char*>(&frame.frame_index), sizeof(frame.frame_index));
+    // Header and payload in one write
+    record_buffer_.resize(frame_record_size(frame));
+    const size_t record_size = write_frame_record(frame, record_buffer_.data(), record_buffer_.size());
+    ofs.write(reinterpret_cast<const char*>(record_buffer_.data()), record_size);
 
-    uint8_t is_keyframe_byte = frame.is_keyframe ? 1 : 0;
-    ofs.write(reinterpret_cast<const char*>(&is_keyframe_byte), sizeof(is_keyframe_byte));
-
-    ofs.write(reinterpret_cast<const char*>(&frame.near_lossless), sizeof(frame.near_lossless));
-    ofs.write(reinterpret_cast<const char*>(&frame.quant_Q), sizeof(frame.quant_Q));
-    ofs.write(reinterpret_cast<const char*>(&frame.dead_zone_T), sizeof(frame.dead_zone_T));
-    ofs.write(reinterpret_cast<const char*>(&frame.fp_bits), sizeof(frame.fp_bits));
+    ofs.close();
+    if (!ofs) {
+        std::cerr << "Failed to write compressed frame: " << output_path << std::endl;
+        return false;
+    }
 
-    // Write range mapping metadata
-    uint8_t use_range_map_byte = frame.use_range_map ? 1 : 0;
-    ofs.write(reinterpret_cast<const char*>(&use_range_map_byte), sizeof(use_range_map_byte));
-    ofs.write(reinterpret_cast<const char*>(&frame.range_min), sizeof(frame.range_min));
-    ofs.write(reinterpret_cast<const char*>(&frame.range_max), sizeof(frame.range_max));
+    // Durable: the frame is on stable storage before the write stage ends
+    if (config_.sync_writes) {
+        const int fd = ::open(output_path.c_str(), O_RDONLY);
+        if (fd < 0 || ::fsync(fd) != 0) {
+            std::cerr << "Failed to sync compressed frame: " << output_path << std::endl;
+            if (fd >= 0) ::close(fd);
+            return false;
+        }
+        ::close(fd);
+    }
 
-    // Write compressed data size and data
-    const uint32_t data_size = static_cast<uint32_t>(frame.compressed_data.size());
-    ofs.write(reinterpret_cast<const char*>(&data_size), sizeof(data_size));
-    ofs.write(reinterpret_cast<const char*>(frame.compressed_data.data()), data_size);
+    // Header copy for lwir_inspect; the index is advisory (not synced, and
+    // rebuilt from the records if it is lost), so a failure only warns
+    if (index_enabled_ && !archive_index_.append(output_dir + "/" + ARCHIVE_INDEX_FILE, frame, frames_dropped)) {
+        std::cerr << "Failed to update archive index in " << output_dir
+                  << ", continuing without it" << std::endl;
+        archive_index_.close();
+        index_enabled_ = false;
+    }
 
     return true;
 }
 
+std::unique_ptr<FrameSource> open_input_source(const CompressionConfig& config, WorkerPool* prefetch_pool)
+{
+    if (config.input_format == "tiff") {
+        std::unique_ptr<TiffStackSource> source(new TiffStackSource());
+        if (prefetch_pool) {
+            source->set_prefetch_pool(prefetch_pool, 2 * config.prefetch_workers);
+        }
+        if (!source->open(config.input_dir)) {
+            return nullptr;
+        }
+        return source;
+    }
+
+    PackedFormat packed_format;
+    if (parse_packed_format(config.input_format, packed_format)) {
+        std::unique_ptr<PackedDirectorySource> source(
+            new PackedDirectorySource(packed_format, config.input_width, config.input_height));
+        source->set_frame_period(config.frame_period_us);
+        if (!source->open(config.input_dir)) {
+            return nullptr;
+        }
+        return source;
+    }
+
+    std::unique_ptr<PngDirectorySource> source(new PngDirectorySource());
+    source->set_frame_period(config.frame_period_us);
+    if (!source->open(config.input_dir)) {
+        return nullptr;
+    }
+    return source;
+}
+
 bool CompressionPipeline::run()
 {
     std::cout << "=== LWIR Compression Pipeline ===" << std::endl;
@@ -160,128 +199,619 @@ bool CompressionPipeline::run()
     std::cout << "Quantization Q: " << config_.quant_Q << ", T: " << config_.dead_zone_T << std::endl;
     std::cout << std::endl;
 
-    // Scan input directory for PNG files (C++14 compatible)
-    std::vector<std::string> input_files;
-    DIR* dir = opendir(config_.input_dir.c_str());
-    if (!dir) {
-        std::cerr << "Failed to open input directory: " << config_.input_dir << std::endl;
+    std::unique_ptr<WorkerPool> prefetch_pool;
+    if (config_.input_format == "tiff" && config_.prefetch_workers > 0) {
+        prefetch_pool.reset(new WorkerPool(config_.prefetch_workers));
+    }
+    std::unique_ptr<FrameSource> source = open_input_source(config_, prefetch_pool.get());
+    if (!source) {
         return false;
     }
 
-    struct dirent* entry;
-    while ((entry = readdir(dir)) != nullptr) {
-        std::string filename = entry->d_name;
-        // Check if filename ends with .png and starts with "jenoptik_"
-        if (filename.length() > 4 && filename.substr(filename.length() - 4) == ".png") {
-            // Filter for jenoptik frames only (skip analysis/mask files)
-            if (filename.find("jenoptik_") == 0) {
-                input_files.push_back(config_.input_dir + "/" + filename);
-            }
-        }
-    }
-    closedir(dir);
+    std::cout << "Found " << source->description() << std::endl;
 
-    if (input_files.empty()) {
-        std::cerr << "No PNG files found in input directory" << std::endl;
+    // The source waits for its decodes before the pool is joined
+    return run(*source);
+}
+
+bool CompressionPipeline::run(FrameSource& source)
+{
+    if (source.frame_count() == 0) {
+        std::cerr << "Frame source is empty: " << source.description() << std::endl;
         return false;
     }
 
-    // Sort files by name
-    std::sort(input_files.begin(), input_files.end());
-
-    std::cout << "Found " << input_files.size() << " PNG files" << std::endl;
+    // A frame range (one shard of a batch) encodes part of the source
+    size_t begin = 0;
+    size_t end = source.frame_count();
+    if (config_.frame_range_count > 0) {
+        begin = config_.frame_range_first;
+        end = std::min(end, begin + config_.frame_range_count);
+        if (begin >= end) {
+            std::cerr << "Frame range starts at " << begin << ", past the " << source.frame_count()
+                      << " frames of " << source.description() << std::endl;
+            return false;
+        }
+    }
 
-    // Initialize decision engine
-    FrameDecisionEngine decision_engine(config_);
+    // A restored session continues after the last frame it wrote
+    if (resume_index_ > 0 && resume_index_ >= end) {
+        std::cout << "All " << (end - begin) << " frames were already encoded" << std::endl;
+        return true;
+    }
 
-    // Initialize encoder
-    FrameEncoder encoder;
+    // A shard continues the timeline of the frame before it, so a capture
+    // gap at the boundary is counted as in a single run
+    if (begin > 0 && resume_index_ <= begin) {
+        Frame previous;
+        if (!source.read_frame(begin - 1, previous)) {
+            std::cerr << "Failed to load frame " << (begin - 1) << std::endl;
+            return false;
+        }
+        gap_detector_.seed(previous.timestamp);
+    }
 
-    // Process each frame
-    for (size_t i = 0; i < input_files.size(); ++i) {
-        const std::string& input_path = input_files[i];
+    for (size_t i = std::max<size_t>(begin, resume_index_); i < end; ++i) {
+        // Frames are pulled from the source, so arrival is when we start reading
+        const DeadlineMonitor::Clock::time_point arrival = DeadlineMonitor::Clock::now();
 
-        // Load frame
         Frame frame;
-        frame.frame_index = static_cast<uint32_t>(i);
-        frame.timestamp = 0; // Could extract from filename if needed
-
-        if (!load_frame_from_png(input_path, frame)) {
+        if (!source.read_frame(i, frame)) {
             std::cerr << "Failed to load frame " << i << std::endl;
             return false;
         }
 
-        const size_t original_bytes = frame.width * frame.height * sizeof(uint16_t);
-        total_original_bytes_ += original_bytes;
+        // Queue is empty: frames are pulled from disk
+        if (!process_frame(frame, arrival, 0)) {
+            return false;
+        }
+    }
 
-        // Decide encoding mode
-        FrameMode mode = FrameMode::USE_INTRA;
-        ResidualStats stats;
+    return finish();
+}
+
+bool CompressionPipeline::plan_frame(const FrameView& frame, DeadlineMonitor::Clock::time_point arrival,
+                                     FramePlan& plan)
+{
+    if (!session_started_) {
+        if (config_.enable_perf_counters) {
+            profiler_.open();
+            encoder_.set_profiler(&profiler_);
+        }
+        if (config_.encode_workers > 0) {
+            entropy_pool_.reset(new WorkerPool(config_.encode_workers));
+        }
+        session_started_ = true;
+    }
+
+    // Frame boundary: adopt a reloaded config (never blocks)
+    poll_config_reload(frame.frame_index);
+
+    // Frames the capture dropped since the previous input
+    gap_detector_.set_frame_period(config_.frame_period_us);
+    plan.frames_dropped = gap_detector_.observe(frame.timestamp);
+    GapPolicy gap_policy = GapPolicy::IGNORE;
+    if (plan.frames_dropped > 0) {
+        parse_gap_policy(config_.gap_policy, gap_policy);
+    }
+
+    // The decision sees the sizes of all frames but the last encode_workers,
+    // whenever their payloads happen to finish (waiting counts as load time)
+    if (!settle_pending(entropy_pool_ ? config_.encode_workers : 0)) {
+        return false;
+    }
+
+    const EncodeKnobs& knobs = overload_.knobs();
+
+    deadline_monitor_.begin_frame(frame.frame_index, arrival);
+    deadline_monitor_.mark_stage(PipelineStage::LOAD);
+
+    plan.original_bytes = frame.pixel_count() * sizeof(uint16_t);
+    total_original_bytes_ += plan.original_bytes;
 
-        // For first frame, always use intra
-        if (i > 0) {
-            // Compute statistics for decision engine
-            // Note: This requires reference frame from encoder, but for decision we can use previous original frame
-            // In a real system, we'd maintain separate state or compute stats differently
-            // For now, use simple heuristics based on frame index
-            mode = decision_engine.decide_mode(stats, frame.frame_index);
+    // Decide encoding mode
+    FrameMode mode = FrameMode::USE_INTRA;
+    ResidualStats stats;
+
+    // First frame (or new frame size): intra; a restored reference counts
+    const bool reference_matches = encoder_.has_reference() &&
+                                   encoder_.reference_frame().data.size() == frame.pixel_count();
+    if (reference_matches && gap_policy == GapPolicy::KEYFRAME) {
+        // The scene moved on during the gap: predicting across it costs more than a keyframe
+        decision_engine_.force_keyframe(frame.frame_index);
+    }
+    else if (reference_matches) {
+        // Statistics of the residual against the reconstructed reference
+        // (optionally subsampled when the encoder is overloaded); a frame
+        // arriving in row bands is decided before its pixels exist
+        if (config_.enable_decision_stats && frame.data != nullptr) {
+            stats = compute_delta_stats(
+                frame.data,
+                encoder_.reference_frame().data.data(),
+                frame.pixel_count(),
+                knobs.dead_zone_T,
+                knobs.stats_stride);
         }
+        decision_engine_.set_gop_period(knobs.gop_period);
+        mode = decision_engine_.decide_mode(stats, frame.frame_index);
+    }
+
+    plan.is_keyframe = (mode == FrameMode::USE_INTRA);
+    if (plan.is_keyframe && gop_update_pending_) {
+        apply_gop_update(frame.frame_index);
+    }
+    deadline_monitor_.mark_stage(PipelineStage::DECIDE);
+
+    plan.quant_params = QuantizationParams(
+        knobs.dead_zone_T,
+        knobs.quant_Q,
+        config_.fp_bits);
+
+    // A residual across a gap gets a wider NEAR tolerance
+    plan.residual_near = (gap_policy == GapPolicy::WIDEN)
+                       ? knobs.residual_near + config_.gap_widen_near
+                       : knobs.residual_near;
+
+    encoder_.set_verify_decode(knobs.verify_decode);
+    encoder_.set_repeat_detection(config_.detect_repeats, config_.static_gating);
+    return true;
+}
+
+bool CompressionPipeline::process_frame(const FrameView& input, DeadlineMonitor::Clock::time_point arrival,
+                                        uint32_t queue_depth)
+{
+    // Decision statistics, encoder and error statistics all read packed rows
+    const FrameView frame = pack_rows(input, input_staging_);
+    if (!frame.is_valid()) {
+        std::cerr << "Frame " << frame.frame_index << " has no samples" << std::endl;
+        return false;
+    }
+
+    if (band_active_) {
+        std::cerr << "Frame " << frame.frame_index << " passed while a banded frame is incomplete" << std::endl;
+        return false;
+    }
 
-        const bool is_keyframe = (mode == FrameMode::USE_INTRA);
+    FramePlan plan;
+    if (!plan_frame(frame, arrival, plan)) {
+        return false;
+    }
 
-        // Encode frame
-        CompressedFrame compressed;
-        QuantizationParams quant_params(
-            config_.dead_zone_T,
-            config_.quant_Q,
-            config_.fp_bits);
+    // Encode frame, or only prepare it and leave the JPEG-LS coding to a worker
+    std::unique_ptr<PendingFrame> pending(new PendingFrame());
+    pending->overlapped = entropy_pool_ &&
+        encoder_.can_prepare(plan.is_keyframe, config_.keyframe_near, plan.residual_near);
 
-        const auto encode_start = std::chrono::high_resolution_clock::now();
+    const auto encode_start = std::chrono::high_resolution_clock::now();
 
-        const bool encode_success = encoder.encode_frame(
+    bool encode_success = false;
+    if (pending->overlapped) {
+        encode_success = encoder_.prepare_frame(
+            frame,
+            plan.is_keyframe,
+            config_.keyframe_near,
+            plan.residual_near,
+            plan.quant_params,
+            pending->prepared,
+            config_.enable_12bit_mode);
+    }
+    else {
+        encode_success = encoder_.encode_frame(
             frame,
-            is_keyframe,
+            plan.is_keyframe,
             config_.keyframe_near,
-            config_.residual_near,
-            quant_params,
-            compressed,
+            plan.residual_near,
+            plan.quant_params,
+            pending->prepared.frame,
             config_.enable_12bit_mode);
+    }
+
+    const auto encode_end = std::chrono::high_resolution_clock::now();
+    const double encode_ms = std::chrono::duration<double, std::milli>(encode_end - encode_start).count();
+    if (pending->overlapped && pending->prepared.frame.is_repeat) {
+        pending->overlapped = false;   // Header only: nothing left to code
+    }
+    if (!pending->overlapped) {
+        deadline_monitor_.mark_stage(PipelineStage::ENCODE);
+    }
+
+    if (!encode_success) {
+        std::cerr << "Failed to encode frame " << frame.frame_index << std::endl;
+        return false;
+    }
+
+    return complete_frame(frame, plan, std::move(pending), encode_ms, queue_depth);
+}
+
+bool CompressionPipeline::begin_frame(uint32_t width, uint32_t height, uint32_t frame_index, uint64_t timestamp,
+                                      DeadlineMonitor::Clock::time_point arrival, uint32_t queue_depth)
+{
+    if (band_active_) {
+        std::cerr << "Frame " << frame_index << " started while a banded frame is incomplete" << std::endl;
+        return false;
+    }
+
+    FrameView header(nullptr, width, height, 0, timestamp);
+    header.frame_index = frame_index;
+    if (!plan_frame(header, arrival, band_plan_)) {
+        return false;
+    }
+
+    if (!encoder_.begin_banded_frame(header, band_plan_.is_keyframe, config_.keyframe_near,
+                                     band_plan_.residual_near, band_plan_.quant_params,
+                                     config_.enable_12bit_mode))
+    {
+        std::cerr << "Failed to encode frame " << frame_index << std::endl;
+        return false;
+    }
+    band_active_ = true;
+    band_queue_depth_ = queue_depth;
+    band_encode_ms_ = 0.0;
+    return true;
+}
+
+bool CompressionPipeline::push_rows(uint32_t y0, const uint16_t* rows, uint32_t row_count, size_t stride)
+{
+    if (!band_active_) {
+        std::cerr << "Rows passed without begin_frame" << std::endl;
+        return false;
+    }
+
+    // Encode time counts the work done per band, not the wait for the sensor
+    auto start = std::chrono::high_resolution_clock::now();
+    if (!encoder_.encode_band(y0, rows, row_count, stride)) {
+        band_active_ = false;
+        return false;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    band_encode_ms_ += std::chrono::duration<double, std::milli>(end - start).count();
+
+    const FrameView frame(encoder_.banded_input());
+    if (encoder_.banded_rows() < frame.height) {
+        return true;
+    }
+    band_active_ = false;
+
+    // Last band: only the JPEG-LS coding is left, done inline (banded
+    // frames are not overlapped: the rows arrived at sensor speed already)
+    std::unique_ptr<PendingFrame> pending(new PendingFrame());
+    pending->overlapped = false;
+    start = std::chrono::high_resolution_clock::now();
+    const bool encode_success = encoder_.finish_banded_frame(pending->prepared.frame);
+    end = std::chrono::high_resolution_clock::now();
+    band_encode_ms_ += std::chrono::duration<double, std::milli>(end - start).count();
+    deadline_monitor_.mark_stage(PipelineStage::ENCODE);
+
+    if (!encode_success) {
+        std::cerr << "Failed to encode frame " << frame.frame_index << std::endl;
+        return false;
+    }
+
+    return complete_frame(frame, band_plan_, std::move(pending), band_encode_ms_, band_queue_depth_);
+}
 
-        const auto encode_end = std::chrono::high_resolution_clock::now();
-        const auto encode_duration = std::chrono::duration_cast<std::chrono::milliseconds>(encode_end - encode_start);
+bool CompressionPipeline::complete_frame(const FrameView& frame, const FramePlan& plan,
+                                         std::unique_ptr<PendingFrame> pending, double encode_ms,
+                                         uint32_t queue_depth)
+{
+    frames_processed_++;
+
+    FrameStats& frame_stats = pending->stats;
+    frame_stats.frame_index = frame.frame_index;
+    frame_stats.is_keyframe = plan.is_keyframe;
+    frame_stats.is_repeat = pending->prepared.frame.is_repeat;
+    frame_stats.frames_dropped = plan.frames_dropped;
+    frame_stats.original_bytes = static_cast<uint32_t>(plan.original_bytes);
+    frame_stats.encode_time_ms = encode_ms;
+
+    // Reconstruction error against the encoder's closed-loop reference
+    if (config_.compute_error_stats && encoder_.has_reference()) {
+        const ErrorStats error = compute_error_stats(
+            frame.data, encoder_.reference_frame().data.data(), frame.pixel_count());
+        frame_stats.max_error = error.max_error;
+        frame_stats.mean_error = error.mean_error;
+        frame_stats.rmse = error.rmse;
+    }
 
-        if (!encode_success) {
-            std::cerr << "Failed to encode frame " << i << std::endl;
+    pending->timing = deadline_monitor_.suspend_frame();
+    pending->queue_depth = queue_depth;
+    pending->done = !pending->overlapped;
+    pending->ok = true;
+
+    PendingFrame* job = pending.get();
+    pending_.push_back(std::move(pending));
+
+    if (job->overlapped) {
+        entropy_pool_->submit([this, job]() {
+            const auto start = std::chrono::high_resolution_clock::now();
+            const bool ok = entropy_code(job->prepared);
+            const auto end = std::chrono::high_resolution_clock::now();
+            {
+                std::lock_guard<std::mutex> lock(pending_mutex_);
+                job->stats.encode_time_ms += std::chrono::duration<double, std::milli>(end - start).count();
+                job->ok = ok;
+                job->done = true;
+            }
+            pending_done_.notify_all();
+        });
+    }
+
+    // Write every frame that is ready, in order, without waiting
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> lock(pending_mutex_);
+            if (pending_.empty() || !pending_.front()->done) {
+                break;
+            }
+        }
+        if (!emit_next()) {
             return false;
         }
+    }
 
-        total_compressed_bytes_ += compressed.compressed_data.size();
-        total_encode_time_ms_ += encode_duration.count();
-        frames_processed_++;
+    // Failover snapshot, outside the frame's deadline (a failure is not fatal)
+    if (!config_.checkpoint_path.empty()) {
+        const bool due = (config_.checkpoint_interval == 0)
+                       ? plan.is_keyframe
+                       : (frames_processed_ % config_.checkpoint_interval == 0);
+        if (due) {
+            // The snapshot is of the state after this frame: finish the frames in flight
+            if (!settle_pending(0)) {
+                return false;
+            }
+            write_checkpoint_after(last_emitted_->prepared.frame, config_.checkpoint_path);
+        }
+    }
 
-        // Write compressed frame
-        if (!write_compressed_frame(compressed, config_.output_dir)) {
+    return true;
+}
+
+bool CompressionPipeline::emit_next()
+{
+    {
+        std::unique_lock<std::mutex> lock(pending_mutex_);
+        pending_done_.wait(lock, [this]() { return pending_.front()->done; });
+    }
+    std::unique_ptr<PendingFrame> pending = std::move(pending_.front());
+    pending_.pop_front();
+
+    const CompressedFrame& compressed = pending->prepared.frame;
+    FrameStats& frame_stats = pending->stats;
+
+    // Overlapped frames: the encode stage ends when the payload is ready
+    deadline_monitor_.resume_frame(pending->timing);
+    if (pending->overlapped) {
+        deadline_monitor_.mark_stage(PipelineStage::ENCODE);
+    }
+
+    if (!pending->ok) {
+        std::cerr << "Failed to encode frame " << compressed.frame_index << std::endl;
+        return false;
+    }
+
+    total_compressed_bytes_ += compressed.compressed_data.size();
+    total_encode_time_ms_ += frame_stats.encode_time_ms;
+
+    frame_stats.compressed_bytes = static_cast<uint32_t>(compressed.compressed_data.size());
+    frame_stats.compression_ratio = compressed.is_repeat ? 0.0   // No payload
+                                  : static_cast<double>(frame_stats.original_bytes) / compressed.compressed_data.size();
+    session_stats_.add_frame(frame_stats);
+
+    // Write compressed frame (or hand it to the embedding application)
+    if (sink_) {
+        if (!sink_(compressed, frame_stats)) {
+            std::cerr << "Frame sink rejected frame " << compressed.frame_index << std::endl;
             return false;
         }
+    }
+    else if (!config_.dry_run &&
+             !write_compressed_frame(compressed, config_.output_dir, frame_stats.frames_dropped))
+    {
+        return false;
+    }
+    deadline_monitor_.mark_stage(PipelineStage::WRITE);
+    const double slack_ms = deadline_monitor_.end_frame();
 
-        // Update decision engine stats
-        const double compression_ratio = static_cast<double>(original_bytes) / compressed.compressed_data.size();
-        decision_engine.update_stats(compressed.compressed_data.size(), is_keyframe);
+    // Decision engine stats are applied by settle_pending()
+    decision_updates_.emplace_back(compressed.compressed_data.size(), compressed.is_keyframe);
 
-        // Print progress
-        std::cout << "Frame " << std::setw(6) << i
-                  << " [" << (is_keyframe ? "KEYFRAME" : "RESIDUAL") << "]"
+    // Print progress
+    if (config_.verbose) {
+        std::cout << "Frame " << std::setw(6) << compressed.frame_index
+                  << " [" << (compressed.is_keyframe ? "KEYFRAME" : compressed.is_repeat ? "REPEAT  " : "RESIDUAL") << "]"
                   << " | " << compressed.compressed_data.size() << " bytes"
-                  << " | " << std::fixed << std::setprecision(2) << compression_ratio << "x"
-                  << " | " << encode_duration.count() << " ms"
-                  << std::endl;
+                  << " | " << std::fixed << std::setprecision(2) << frame_stats.compression_ratio << "x"
+                  << " | " << frame_stats.encode_time_ms << " ms";
+        if (config_.compute_error_stats) {
+            std::cout << " | rmse " << frame_stats.rmse;
+        }
+        if (frame_stats.frames_dropped > 0) {
+            std::cout << " | " << frame_stats.frames_dropped << " dropped before";
+        }
+        if (deadline_monitor_.enabled()) {
+            std::cout << " | slack " << std::setprecision(1) << slack_ms << " ms";
+        }
+        std::cout << std::endl;
+    }
+
+    // Adapt the ladder to this frame's slack and the backlog behind it
+    overload_.observe(compressed.frame_index, slack_ms, pending->queue_depth);
+
+    // Keep the record (for keyframe snapshots), not the CharLS input
+    std::vector<uint16_t>().swap(pending->prepared.plane);
+    last_emitted_ = std::move(pending);
+    return true;
+}
+
+bool CompressionPipeline::drain()
+{
+    while (!pending_.empty()) {
+        if (!emit_next()) {
+            return false;
+        }
     }
+    return true;
+}
+
+bool CompressionPipeline::settle_pending(size_t lag)
+{
+    while (pending_.size() + decision_updates_.size() > lag) {
+        if (decision_updates_.empty()) {
+            if (!emit_next()) {
+                return false;
+            }
+            continue;
+        }
+        decision_engine_.update_stats(decision_updates_.front().first, decision_updates_.front().second);
+        decision_updates_.pop_front();
+    }
+    return true;
+}
+
+bool CompressionPipeline::write_checkpoint_after(const CompressedFrame& compressed, const std::string& path)
+{
+    EncoderCheckpoint checkpoint;
+    checkpoint.decision = decision_engine_.state();
+
+    if (compressed.is_keyframe) {
+        // The keyframe decodes to the reference: no extra encode
+        checkpoint.reference = compressed;
+    }
+    else {
+        // Mid-GOP: store the reconstructed reference losslessly
+        checkpoint_encoder_.reset();
+        checkpoint_encoder_.set_verify_decode(false);
+        if (!checkpoint_encoder_.encode_intra_frame(encoder_.reference_frame(), 0, checkpoint.reference, false)) {
+            std::cerr << "Failed to encode checkpoint reference" << std::endl;
+            return false;
+        }
+        checkpoint.reference.frame_index = compressed.frame_index;
+        checkpoint.reference.timestamp = compressed.timestamp;
+    }
+
+    return write_checkpoint(path, checkpoint);
+}
+
+bool CompressionPipeline::save_checkpoint(const std::string& path)
+{
+    if (!encoder_.has_reference()) {
+        std::cerr << "No frame encoded yet, nothing to checkpoint" << std::endl;
+        return false;
+    }
+
+    // Snapshot the state after the last frame passed in
+    if (!settle_pending(0)) {
+        return false;
+    }
+    if (last_emitted_) {
+        return write_checkpoint_after(last_emitted_->prepared.frame, path);
+    }
+
+    // Restored session with no frame encoded yet: re-encode the reference
+    CompressedFrame last;
+    last.frame_index = encoder_.reference_frame().frame_index;
+    last.timestamp = encoder_.reference_frame().timestamp;
+    last.is_keyframe = false;
+    return write_checkpoint_after(last, path);
+}
+
+bool CompressionPipeline::restore_checkpoint(const std::string& path)
+{
+    EncoderCheckpoint checkpoint;
+    if (!read_checkpoint(path, checkpoint)) {
+        return false;
+    }
+
+    Frame reference;
+    encoder_.reset();
+    if (!encoder_.decode_frame(checkpoint.reference, reference)) {
+        std::cerr << "Failed to decode checkpoint reference: " << path << std::endl;
+        encoder_.reset();
+        return false;
+    }
+    decision_engine_.restore_state(checkpoint.decision);
+
+    // Roll forward over frames the previous process wrote after the snapshot
+    uint32_t next = checkpoint.reference.frame_index + 1;
+    uint32_t rolled = 0;
+    if (!config_.dry_run && !config_.output_dir.empty() && !sink_) {
+        CompressedFrame record;
+        std::vector<uint8_t> bytes;
+        SegmentReader segments;
+        const bool segmented = config_.segmented_output() && segments.open(config_.output_dir);
+        for (;; ++next) {
+            if (segmented) {
+                // Segment reads skip a partial record at the end
+                if (!segments.read_frame(next, record)) {
+                    break;
+                }
+            }
+            else {
+                std::ifstream ifs(config_.output_dir + "/" + frame_file_name(next), std::ios::binary);
+                if (!ifs) {
+                    break;
+                }
+                bytes.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+
+                // A record cut short by the crash is encoded again
+                if (!read_frame_record(bytes.data(), bytes.size(), record) || record.frame_index != next) {
+                    break;
+                }
+            }
+            if (!encoder_.decode_frame(record, reference)) {
+                std::cerr << "Failed to roll forward through frame " << next
+                          << ", next frame will be a keyframe" << std::endl;
+                encoder_.reset();
+                break;
+            }
+            decision_engine_.record_frame(next, record.is_keyframe, record.compressed_data.size());
+            rolled++;
+        }
+    }
+    resume_index_ = next;
+    if (encoder_.has_reference()) {
+        gap_detector_.seed(encoder_.reference_frame().timestamp);
+    }
+
+    if (config_.verbose) {
+        std::cout << "Restored checkpoint of frame " << checkpoint.reference.frame_index;
+        if (rolled > 0) {
+            std::cout << ", rolled forward " << rolled << " frames";
+        }
+        std::cout << "; resuming at frame " << resume_index_ << std::endl;
+    }
+    return true;
+}
+
+bool CompressionPipeline::finish()
+{
+    if (frames_processed_ == 0) {
+        std::cerr << "No frames were processed" << std::endl;
+        return false;
+    }
+
+    // Write the frames still being entropy coded
+    if (!settle_pending(0)) {
+        return false;
+    }
+
+    // The last segment ends with the session
+    if (segment_writer_.is_open() && !segment_writer_.close()) {
+        return false;
+    }
+
+    session_stats_.finalize();
 
     // Print summary
-    print_summary();
+    if (config_.verbose) {
+        print_summary();
+        overload_.print_summary();
+    }
 
     // Write statistics to JSON
-    write_statistics(config_.output_dir + "/compression_stats.json");
+    if (!config_.dry_run && !config_.output_dir.empty()) {
+        write_statistics(config_.output_dir + "/compression_stats.json");
+    }
 
     return true;
 }
@@ -291,6 +821,17 @@ void CompressionPipeline::print_summary() const
     std::cout << std::endl;
     std::cout << "=== Compression Summary ===" << std::endl;
     std::cout << "Frames processed: " << frames_processed_ << std::endl;
+    if (session_stats_.repeat_frames > 0) {
+        std::cout << "Repeat frames: " << session_stats_.repeat_frames << std::endl;
+    }
+    if (session_stats_.timestamp_gaps > 0) {
+        std::cout << "Timestamp gaps: " << session_stats_.timestamp_gaps
+                  << " (" << session_stats_.frames_dropped << " frames dropped)" << std::endl;
+    }
+    if (segment_writer_.reclaimed_segments() > 0) {
+        std::cout << "Segments reclaimed: " << segment_writer_.reclaimed_segments()
+                  << " (storage budget " << config_.storage_budget_mb << " MB)" << std::endl;
+    }
     std::cout << "Original size: " << (total_original_bytes_ / 1024.0 / 1024.0) << " MB" << std::endl;
     std::cout << "Compressed size: " << (total_compressed_bytes_ / 1024.0 / 1024.0) << " MB" << std::endl;
 
@@ -300,8 +841,19 @@ void CompressionPipeline::print_summary() const
     const double avg_encode_time = static_cast<double>(total_encode_time_ms_) / frames_processed_;
     std::cout << "Average encode time: " << std::fixed << std::setprecision(2) << avg_encode_time << " ms/frame" << std::endl;
 
-    const double throughput = 1000.0 / avg_encode_time;
+    const double throughput = avg_encode_time > 0.0 ? 1000.0 / avg_encode_time : 0.0;
     std::cout << "Throughput: " << std::fixed << std::setprecision(1) << throughput << " fps" << std::endl;
+
+    if (config_.compute_error_stats) {
+        std::cout << "Average RMSE: " << std::setprecision(3) << session_stats_.avg_rmse
+                  << " DN (avg max error " << session_stats_.avg_max_error << " DN)" << std::endl;
+    }
+
+    deadline_monitor_.print_summary();
+
+    if (config_.enable_perf_counters) {
+        profiler_.print_report();
+    }
 }
 
 void CompressionPipeline::write_statistics(const std::string& output_path) const
@@ -314,15 +866,22 @@ void CompressionPipeline::write_statistics(const std::string& output_path) const
 
     const double overall_ratio = static_cast<double>(total_original_bytes_) / total_compressed_bytes_;
     const double avg_encode_time = static_cast<double>(total_encode_time_ms_) / frames_processed_;
-    const double throughput = 1000.0 / avg_encode_time;
+    const double throughput = avg_encode_time > 0.0 ? 1000.0 / avg_encode_time : 0.0;
 
     ofs << "{\n";
     ofs << "  \"frames_processed\": " << frames_processed_ << ",\n";
+    ofs << "  \"repeat_frames\": " << session_stats_.repeat_frames << ",\n";
+    ofs << "  \"timestamp_gaps\": " << session_stats_.timestamp_gaps << ",\n";
+    ofs << "  \"frames_dropped\": " << session_stats_.frames_dropped << ",\n";
     ofs << "  \"total_original_bytes\": " << total_original_bytes_ << ",\n";
     ofs << "  \"total_compressed_bytes\": " << total_compressed_bytes_ << ",\n";
     ofs << "  \"compression_ratio\": " << overall_ratio << ",\n";
     ofs << "  \"avg_encode_time_ms\": " << avg_encode_time << ",\n";
     ofs << "  \"throughput_fps\": " << throughput << ",\n";
+    if (config_.compute_error_stats) {
+        ofs << "  \"avg_rmse\": " << session_stats_.avg_rmse << ",\n";
+        ofs << "  \"avg_max_error\": " << session_stats_.avg_max_error << ",\n";
+    }
     ofs << "  \"config\": {\n";
     ofs << "    \"gop_period\": " << config_.gop_period << ",\n";
     ofs << "    \"keyframe_near\": " << config_.keyframe_near << ",\n";
@@ -330,10 +889,15 @@ void CompressionPipeline::write_statistics(const std::string& output_path) const
     ofs << "    \"quant_Q\": " << config_.quant_Q << ",\n";
     ofs << "    \"dead_zone_T\": " << config_.dead_zone_T << ",\n";
     ofs << "    \"fp_bits\": " << config_.fp_bits << "\n";
-    ofs << "  }\n";
+    ofs << "  },\n";
+    ofs << "  \"deadline\": " << deadline_monitor_.to_json("  ") << ",\n";
+    ofs << "  \"overload\": " << overload_.to_json("  ") << ",\n";
+    ofs << "  \"perf_counters\": " << (config_.enable_perf_counters ? profiler_.to_json("  ") : "null") << "\n";
     ofs << "}\n";
 
-    std::cout << "Statistics written to " << output_path << std::endl;
+    if (config_.verbose) {
+        std::cout << "Statistics written to " << output_path << std::endl;
+    }
 }
 
 } // namespace lwir
@@ -1,6 +1,7 @@
 #include "residual.hpp"
 #include <cmath>
 #include <algorithm>
+#include <cstdlib>
 #include <cstring>
 
 // Enable SIMD hints only on ARM with NEON
@@ -35,7 +36,7 @@ void quantize_residual(
     const uint32_t T = params.dead_zone_T;
     const uint32_t Q_fixed = params.quant_Q_fixed;
     const uint32_t fp_bits = params.fp_bits;
-    const uint32_t rounding = (1u << (fp_bits - 1));  // For round-half-up
+    const uint32_t rounding = Q_fixed / 2;  // Round half up in the Q_fixed domain
 
     SIMD_HINT
     for (size_t i = 0; i < pixel_count; ++i) {
@@ -47,9 +48,7 @@ void quantize_residual(
         const uint32_t a2 = (abs_R > T) ? (abs_R - T) : 0;
 
         // Quantize: q = round(a2 / Q) using fixed-point arithmetic
-        // q = (a2 * invQ + 2^(fp_bits-1)) >> fp_bits
-        // where invQ = 2^fp_bits / Q_fixed (computed as: (1 << fp_bits) / Q)
-        // But we can simplify: a2/Q ~= (a2 << fp_bits) / Q_fixed
+        // a2/Q = (a2 << fp_bits) / Q_fixed, rounded by adding Q_fixed/2
         const uint32_t numerator = (a2 << fp_bits) + rounding;
         const uint32_t q_abs = numerator / Q_fixed;
 
@@ -122,10 +121,67 @@ void reconstruct_frame(
     for (size_t i = 0; i < pixel_count; ++i) {
         // I_t = R_t + I_{t-1}, with clamping to [0, 65535]
         const int32_t val = static_cast<int32_t>(previous[i]) + static_cast<int32_t>(residual[i]);
-        reconstructed[i] = static_cast<uint16_t>(std::clamp(val, 0, 65535));
+        reconstructed[i] = static_cast<uint16_t>(std::min(std::max(val, 0), 65535));
     }
 }
 
+uint64_t hash_samples(const uint16_t* data, size_t pixel_count)
+{
+    constexpr uint64_t PRIME_1 = 0x9E3779B185EBCA87ull;
+    constexpr uint64_t PRIME_2 = 0xC2B2AE3D27D4EB4Full;
+    constexpr size_t LANES = 4;
+    constexpr size_t BLOCK = LANES * sizeof(uint64_t) / sizeof(uint16_t);   // Samples per round
+
+    uint64_t lane[LANES] = { PRIME_1 + PRIME_2, PRIME_2, 0, 0 - PRIME_1 };
+    const size_t blocks = pixel_count / BLOCK;
+    for (size_t b = 0; b < blocks; ++b) {
+        uint64_t words[LANES];
+        std::memcpy(words, data + b * BLOCK, sizeof(words));
+        for (size_t l = 0; l < LANES; ++l) {
+            const uint64_t acc = lane[l] + words[l] * PRIME_2;
+            lane[l] = ((acc << 31) | (acc >> 33)) * PRIME_1;
+        }
+    }
+
+    uint64_t hash = lane[0] ^ ((lane[1] << 7) | (lane[1] >> 57)) ^
+                    ((lane[2] << 12) | (lane[2] >> 52)) ^ ((lane[3] << 18) | (lane[3] >> 46));
+    hash += pixel_count;
+    for (size_t i = blocks * BLOCK; i < pixel_count; ++i) {
+        hash = ((hash ^ data[i]) * PRIME_1);
+    }
+
+    // Final avalanche (every input bit affects every output bit)
+    hash ^= hash >> 33;
+    hash *= PRIME_2;
+    hash ^= hash >> 29;
+    hash *= PRIME_1;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+bool residual_within_dead_zone(
+    const uint16_t* __restrict current,
+    const uint16_t* __restrict previous,
+    size_t pixel_count,
+    uint32_t dead_zone_T)
+{
+    // Blocks keep the early exit cheap; the max reduction inside vectorizes
+    constexpr size_t BLOCK = 4096;
+
+    for (size_t start = 0; start < pixel_count; start += BLOCK) {
+        const size_t end = std::min(pixel_count, start + BLOCK);
+        int32_t worst = 0;
+        for (size_t i = start; i < end; ++i) {
+            const int32_t diff = static_cast<int32_t>(current[i]) - static_cast<int32_t>(previous[i]);
+            worst = std::max(worst, std::abs(diff));
+        }
+        if (static_cast<uint32_t>(worst) > dead_zone_T) {
+            return false;
+        }
+    }
+    return true;
+}
+
 ErrorStats compute_error_stats(
     const uint16_t* __restrict original,
     const uint16_t* __restrict reconstructed,
@@ -0,0 +1,581 @@
+/**
+ * @file segment.cpp
+ * @brief Rolling segment writer, manifest and segment reader
+ */
+
+#include "segment.hpp"
+#include "frame_format.hpp"
+#include <yaml-cpp/yaml.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+namespace lwir {
+
+namespace {
+
+std::string numbered_name(const char* prefix, uint32_t sequence, const char* extension)
+{
+    char name[64];
+    std::snprintf(name, sizeof(name), "%s%06u%s", prefix, sequence, extension);
+    return name;
+}
+
+bool write_all(int fd, const uint8_t* data, size_t size)
+{
+    while (size > 0) {
+        const ssize_t written = ::write(fd, data, size);
+        if (written <= 0) {
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+bool sync_path(const std::string& path)
+{
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    const bool ok = (::fsync(fd) == 0);
+    ::close(fd);
+    return ok;
+}
+
+/**
+ * Disk space of a segment: records plus its index
+ */
+uint64_t segment_disk_bytes(const SegmentInfo& segment)
+{
+    return segment.bytes + ARCHIVE_INDEX_MAGIC_SIZE + uint64_t(segment.frame_count) * ARCHIVE_INDEX_ENTRY_SIZE;
+}
+
+/**
+ * Sequence number of a segment or segment index file name, if it is one
+ */
+bool parse_segment_name(const char* name, uint32_t& sequence)
+{
+    unsigned value = 0;
+    char extension[8] = {};
+    if (std::sscanf(name, "segment_%u.%7s", &value, extension) != 2 ||
+        (std::strcmp(extension, "lwseg") != 0 && std::strcmp(extension, "lwidx") != 0))
+    {
+        return false;
+    }
+    sequence = value;
+    return true;
+}
+
+/**
+ * Frame and time ranges of a segment from its records
+ */
+void summarize(const std::vector<ArchiveEntry>& entries, SegmentInfo& info)
+{
+    info.frame_count = static_cast<uint32_t>(entries.size());
+    info.keyframes = 0;
+    info.bytes = 0;
+    for (const ArchiveEntry& entry : entries) {
+        info.keyframes += entry.header.is_keyframe ? 1 : 0;
+        info.bytes += entry.record_size();
+    }
+    if (!entries.empty()) {
+        info.first_frame = entries.front().header.frame_index;
+        info.last_frame = entries.back().header.frame_index;
+        info.first_timestamp = entries.front().header.timestamp;
+        info.last_timestamp = entries.back().header.timestamp;
+    }
+}
+
+} // anonymous namespace
+
+std::string segment_file_name(uint32_t sequence)
+{
+    return numbered_name("segment_", sequence, ".lwseg");
+}
+
+std::string segment_index_name(uint32_t sequence)
+{
+    return numbered_name("segment_", sequence, ".lwidx");
+}
+
+bool read_segment_manifest(const std::string& dir, std::vector<SegmentInfo>& segments)
+{
+    segments.clear();
+
+    const std::string path = dir + "/" + SEGMENT_MANIFEST_FILE;
+    std::ifstream probe(path);
+    if (!probe) {
+        return false;
+    }
+
+    // JSON is a subset of YAML
+    try {
+        const YAML::Node root = YAML::LoadFile(path);
+        const YAML::Node list = root["segments"];
+        if (!list || !list.IsSequence()) {
+            std::cerr << "Segment manifest has no segment list: " << path << std::endl;
+            return false;
+        }
+        for (const YAML::Node& node : list) {
+            SegmentInfo info;
+            info.sequence = node["sequence"].as<uint32_t>();
+            info.first_frame = node["first_frame"].as<uint32_t>();
+            info.last_frame = node["last_frame"].as<uint32_t>();
+            info.frame_count = node["frames"].as<uint32_t>();
+            info.keyframes = node["keyframes"].as<uint32_t>();
+            info.first_timestamp = node["first_timestamp"].as<uint64_t>();
+            info.last_timestamp = node["last_timestamp"].as<uint64_t>();
+            info.bytes = node["bytes"].as<uint64_t>();
+            info.complete = node["complete"].as<bool>();
+            segments.push_back(info);
+        }
+    }
+    catch (const YAML::Exception& e) {
+        std::cerr << "Malformed segment manifest " << path << ": " << e.what() << std::endl;
+        segments.clear();
+        return false;
+    }
+    return true;
+}
+
+bool write_segment_manifest(const std::string& dir, const std::vector<SegmentInfo>& segments)
+{
+    const std::string path = dir + "/" + SEGMENT_MANIFEST_FILE;
+    const std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream ofs(tmp_path);
+        ofs << "{\n";
+        ofs << "  \"segments\": [";
+        for (size_t i = 0; i < segments.size(); ++i) {
+            const SegmentInfo& s = segments[i];
+            ofs << (i ? ",\n" : "\n")
+                << "    {\"sequence\": " << s.sequence
+                << ", \"file\": \"" << segment_file_name(s.sequence) << "\""
+                << ", \"index\": \"" << segment_index_name(s.sequence) << "\""
+                << ", \"first_frame\": " << s.first_frame
+                << ", \"last_frame\": " << s.last_frame
+                << ", \"frames\": " << s.frame_count
+                << ", \"keyframes\": " << s.keyframes
+                << ", \"first_timestamp\": " << s.first_timestamp
+                << ", \"last_timestamp\": " << s.last_timestamp
+                << ", \"bytes\": " << s.bytes
+                << ", \"complete\": " << (s.complete ? "true" : "false") << "}";
+        }
+        ofs << (segments.empty() ? "]\n" : "\n  ]\n");
+        ofs << "}\n";
+        ofs.close();
+
+        // On disk before the rename: after a power loss the manifest is
+        // either the old one or the complete new one
+        if (!ofs || !sync_path(tmp_path)) {
+            std::cerr << "Failed to write segment manifest: " << tmp_path << std::endl;
+            std::remove(tmp_path.c_str());
+            return false;
+        }
+    }
+
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        std::cerr << "Failed to replace segment manifest: " << path << std::endl;
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+
+    // The rename itself is durable once the directory is synced
+    if (!sync_path(dir)) {
+        std::cerr << "Failed to sync segment directory: " << dir << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// SegmentWriter
+// ============================================================================
+
+SegmentWriter::SegmentWriter()
+    : sync_writes_(false)
+    , open_(false)
+    , fd_(-1)
+    , index_enabled_(true)
+    , reclaimed_(0)
+{
+}
+
+SegmentWriter::~SegmentWriter()
+{
+    close();
+}
+
+bool SegmentWriter::open(const std::string& dir, const SegmentLimits& limits, bool sync_writes)
+{
+    close();
+    dir_ = dir;
+    limits_ = limits;
+    sync_writes_ = sync_writes;
+    segments_.clear();
+    reclaimed_ = 0;
+
+    // Resumed session: keep the earlier segments, closing any left open
+    SegmentReader existing;
+    if (existing.open(dir)) {
+        segments_ = existing.segments();
+        for (SegmentInfo& segment : segments_) {
+            segment.complete = true;
+        }
+        if (limits_.budget_bytes > 0) {
+            remove_unlisted();
+        }
+    }
+
+    open_ = true;
+    return true;
+}
+
+void SegmentWriter::remove_unlisted()
+{
+    std::set<uint32_t> listed;
+    for (const SegmentInfo& segment : segments_) {
+        listed.insert(segment.sequence);
+    }
+    const uint32_t next = segments_.empty() ? 0 : segments_.back().sequence + 1;
+
+    DIR* directory = opendir(dir_.c_str());
+    if (!directory) {
+        return;
+    }
+    std::vector<std::string> orphans;
+    struct dirent* entry;
+    while ((entry = readdir(directory)) != nullptr) {
+        uint32_t sequence;
+        if (parse_segment_name(entry->d_name, sequence) && sequence < next && !listed.count(sequence)) {
+            orphans.push_back(dir_ + "/" + entry->d_name);
+        }
+    }
+    closedir(directory);
+
+    for (const std::string& path : orphans) {
+        std::remove(path.c_str());
+    }
+}
+
+bool SegmentWriter::reclaim(uint64_t reserve)
+{
+    if (limits_.budget_bytes == 0) {
+        return true;
+    }
+
+    uint64_t used = 0;
+    for (const SegmentInfo& segment : segments_) {
+        used += segment_disk_bytes(segment);
+    }
+
+    // Never the segment being written (last); the oldest segment first
+    const size_t keep = (fd_ >= 0) ? 1 : 0;
+    while (used + reserve > limits_.budget_bytes && segments_.size() > keep) {
+        const SegmentInfo oldest = segments_.front();
+        segments_.erase(segments_.begin());
+
+        // Unlisted before it is deleted: a crash in between leaves an
+        // orphan file, never a listed segment without its records
+        if (!write_segment_manifest(dir_, segments_)) {
+            segments_.insert(segments_.begin(), oldest);
+            return false;
+        }
+        std::remove((dir_ + "/" + segment_file_name(oldest.sequence)).c_str());
+        std::remove((dir_ + "/" + segment_index_name(oldest.sequence)).c_str());
+        used -= segment_disk_bytes(oldest);
+        reclaimed_++;
+    }
+    return true;
+}
+
+bool SegmentWriter::limit_reached(const CompressedFrame& frame) const
+{
+    const SegmentInfo& current = segments_.back();
+    if (current.frame_count == 0) {
+        return false;
+    }
+    return (limits_.gops > 0 && current.keyframes >= limits_.gops) ||
+           (limits_.bytes > 0 && current.bytes >= limits_.bytes) ||
+           (limits_.duration_us > 0 && frame.timestamp >= current.first_timestamp &&
+            frame.timestamp - current.first_timestamp >= limits_.duration_us);
+}
+
+bool SegmentWriter::start_segment()
+{
+    SegmentInfo info;
+    info.sequence = segments_.empty() ? 0 : segments_.back().sequence + 1;
+
+    // Ring storage: room for a full segment before it starts
+    if (!reclaim(limits_.bytes)) {
+        return false;
+    }
+
+    // The index writer appends: drop one left by an earlier session
+    std::remove((dir_ + "/" + segment_index_name(info.sequence)).c_str());
+
+    const std::string path = dir_ + "/" + segment_file_name(info.sequence);
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0) {
+        std::cerr << "Failed to create segment: " << path << std::endl;
+        return false;
+    }
+    index_enabled_ = true;
+
+#ifdef __linux__
+    // Reserve the space just reclaimed (in few extents) without changing the
+    // file size readers see; best effort, the records are written regardless
+    if (limits_.budget_bytes > 0 && limits_.bytes > 0) {
+        ::fallocate(fd_, FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(limits_.bytes));
+    }
+#endif
+
+    segments_.push_back(info);
+    return write_segment_manifest(dir_, segments_);
+}
+
+bool SegmentWriter::finish_segment()
+{
+#ifdef __linux__
+    // Give back the preallocated space the segment did not use
+    const uint64_t written = segments_.back().bytes;
+    if (limits_.budget_bytes > 0 && limits_.bytes > written) {
+        ::fallocate(fd_, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, static_cast<off_t>(written),
+                    static_cast<off_t>(limits_.bytes - written));
+    }
+#endif
+
+    const bool closed = (::close(fd_) == 0);
+    fd_ = -1;
+    index_.close();
+    if (!closed) {
+        std::cerr << "Failed to close segment: " << dir_ << "/" << segment_file_name(segments_.back().sequence)
+                  << std::endl;
+        return false;
+    }
+
+    segments_.back().complete = true;
+    if (!write_segment_manifest(dir_, segments_)) {
+        return false;
+    }
+    if (on_complete_) {
+        on_complete_(dir_, segments_.back());
+    }
+    return true;
+}
+
+bool SegmentWriter::append(const CompressedFrame& frame, uint32_t frames_dropped)
+{
+    if (!open_) {
+        return false;
+    }
+
+    // Roll over only where a decoder can start: at a keyframe
+    if (fd_ >= 0 && frame.is_keyframe && limit_reached(frame) && !finish_segment()) {
+        return false;
+    }
+    if (fd_ < 0 && !start_segment()) {
+        return false;
+    }
+
+    SegmentInfo& current = segments_.back();
+    const std::string path = dir_ + "/" + segment_file_name(current.sequence);
+
+    record_buffer_.resize(frame_record_size(frame));
+    const size_t record_size = write_frame_record(frame, record_buffer_.data(), record_buffer_.size());
+    if (!write_all(fd_, record_buffer_.data(), record_size)) {
+        std::cerr << "Failed to write frame " << frame.frame_index << " to segment: " << path << std::endl;
+        return false;
+    }
+
+    // Durable: the record is on stable storage before the write stage ends
+    if (sync_writes_ && ::fsync(fd_) != 0) {
+        std::cerr << "Failed to sync segment: " << path << std::endl;
+        return false;
+    }
+
+    if (current.frame_count == 0) {
+        current.first_frame = frame.frame_index;
+        current.first_timestamp = frame.timestamp;
+    }
+    current.last_frame = frame.frame_index;
+    current.last_timestamp = frame.timestamp;
+    current.frame_count++;
+    current.keyframes += frame.is_keyframe ? 1 : 0;
+    current.bytes += record_size;
+
+    // Advisory, as the directory index is: readers scan past its end
+    if (index_enabled_ &&
+        !index_.append(dir_ + "/" + segment_index_name(current.sequence), frame, frames_dropped))
+    {
+        std::cerr << "Failed to update segment index in " << dir_ << ", continuing without it" << std::endl;
+        index_.close();
+        index_enabled_ = false;
+    }
+
+    // A segment running past its reserve (waiting for a keyframe)
+    return reclaim(0);
+}
+
+bool SegmentWriter::close()
+{
+    bool ok = true;
+    if (fd_ >= 0) {
+        ok = finish_segment();
+    }
+    open_ = false;
+    return ok;
+}
+
+// ============================================================================
+// SegmentReader
+// ============================================================================
+
+bool SegmentReader::open(const std::string& dir)
+{
+    dir_ = dir;
+    cached_ = NO_SEGMENT;
+    if (!read_segment_manifest(dir, segments_)) {
+        return false;
+    }
+
+    // Ranges in the manifest are final only once a segment is complete
+    std::vector<ArchiveEntry> entries;
+    for (size_t i = 0; i < segments_.size(); ++i) {
+        if (!segments_[i].complete && read_entries(i, entries)) {
+            summarize(entries, segments_[i]);
+        }
+    }
+
+    // A segment the crash left before its first record holds nothing
+    segments_.erase(std::remove_if(segments_.begin(), segments_.end(),
+                                   [](const SegmentInfo& s) { return !s.complete && s.frame_count == 0; }),
+                    segments_.end());
+    return true;
+}
+
+std::vector<size_t> SegmentReader::segments_between(uint64_t begin_us, uint64_t end_us) const
+{
+    std::vector<size_t> matches;
+    for (size_t i = 0; i < segments_.size(); ++i) {
+        const SegmentInfo& s = segments_[i];
+        if (s.frame_count > 0 && s.first_timestamp <= end_us && s.last_timestamp >= begin_us) {
+            matches.push_back(i);
+        }
+    }
+    return matches;
+}
+
+bool SegmentReader::read_entries(size_t segment, std::vector<ArchiveEntry>& entries,
+                                 std::vector<uint64_t>* offsets) const
+{
+    entries.clear();
+    if (offsets) {
+        offsets->clear();
+    }
+    if (segment >= segments_.size()) {
+        return false;
+    }
+
+    const uint32_t sequence = segments_[segment].sequence;
+    const std::string path = dir_ + "/" + segment_file_name(sequence);
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || ::fstat(fd, &st) != 0) {
+        if (fd >= 0) ::close(fd);
+        std::cerr << "Failed to open segment: " << path << std::endl;
+        return false;
+    }
+    const uint64_t size = static_cast<uint64_t>(st.st_size);
+
+    // Records are back to back in index order
+    std::vector<ArchiveEntry> indexed;
+    read_archive_index(dir_ + "/" + segment_index_name(sequence), indexed);
+    uint64_t offset = 0;
+    for (ArchiveEntry& entry : indexed) {
+        if (offset + entry.record_size() > size) {
+            break;
+        }
+        if (offsets) {
+            offsets->push_back(offset);
+        }
+        offset += entry.record_size();
+        entries.push_back(std::move(entry));
+    }
+
+    // Records the index missed (lost with a crash, or no index at all)
+    uint8_t header[FRAME_HEADER_SIZE];
+    while (offset + FRAME_HEADER_SIZE <= size) {
+        ArchiveEntry entry;
+        if (::pread(fd, header, FRAME_HEADER_SIZE, static_cast<off_t>(offset)) !=
+                static_cast<ssize_t>(FRAME_HEADER_SIZE) ||
+            !read_frame_header(header, FRAME_HEADER_SIZE, entry.header, entry.payload_size) ||
+            entry.header.width == 0 || entry.header.height == 0 ||
+            offset + entry.record_size() > size)
+        {
+            break;   // Partial (or never written, after a power loss) record at the end
+        }
+        if (offsets) {
+            offsets->push_back(offset);
+        }
+        offset += entry.record_size();
+        entries.push_back(std::move(entry));
+    }
+
+    ::close(fd);
+    return true;
+}
+
+bool SegmentReader::read_frame(uint32_t frame_index, CompressedFrame& frame)
+{
+    // Newest first: a frame encoded again after a resume is in a later segment
+    for (size_t i = segments_.size(); i-- > 0;) {
+        const SegmentInfo& s = segments_[i];
+        if (s.frame_count == 0 || frame_index < s.first_frame || frame_index > s.last_frame) {
+            continue;
+        }
+
+        if (cached_ != i) {
+            if (!read_entries(i, cached_entries_, &cached_offsets_)) {
+                cached_ = NO_SEGMENT;
+                return false;
+            }
+            cached_ = i;
+        }
+
+        const auto found = std::lower_bound(cached_entries_.begin(), cached_entries_.end(), frame_index,
+                                            [](const ArchiveEntry& entry, uint32_t index) {
+                                                return entry.header.frame_index < index;
+                                            });
+        if (found == cached_entries_.end() || found->header.frame_index != frame_index) {
+            continue;
+        }
+        const uint64_t offset = cached_offsets_[static_cast<size_t>(found - cached_entries_.begin())];
+
+        const std::string path = dir_ + "/" + segment_file_name(s.sequence);
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "Failed to open segment: " << path << std::endl;
+            return false;
+        }
+        record_buffer_.resize(found->record_size());
+        const ssize_t got = ::pread(fd, record_buffer_.data(), record_buffer_.size(), static_cast<off_t>(offset));
+        ::close(fd);
+        return got == static_cast<ssize_t>(record_buffer_.size()) &&
+               read_frame_record(record_buffer_.data(), record_buffer_.size(), frame);
+    }
+    return false;
+}
+
+} // namespace lwir
@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <sstream>
 #include <iomanip>
+#include <unordered_map>
 
 namespace lwir {
 
@@ -108,7 +109,8 @@ std::string FrameStats::csv_header() {
            "quantized_entropy,"
            "original_bytes,compressed_bytes,compression_ratio,"
            "encode_time_ms,"
-           "max_error,mean_error,rmse";
+           "max_error,mean_error,rmse,"
+           "is_repeat,frames_dropped";
 }
 
 std::string FrameStats::to_csv() const {
@@ -130,7 +132,9 @@ std::string FrameStats::to_csv() const {
         << encode_time_ms << ","
         << max_error << ","
         << mean_error << ","
-        << rmse;
+        << rmse << ","
+        << (is_repeat ? "1" : "0") << ","
+        << frames_dropped;
 
     return oss.str();
 }
@@ -144,10 +148,17 @@ void SessionStats::add_frame(const FrameStats& fs) {
 
     if (fs.is_keyframe) {
         keyframes++;
+    } else if (fs.is_repeat) {
+        repeat_frames++;
     } else {
         residual_frames++;
     }
 
+    if (fs.frames_dropped > 0) {
+        timestamp_gaps++;
+        frames_dropped += fs.frames_dropped;
+    }
+
     total_original_bytes += fs.original_bytes;
     total_compressed_bytes += fs.compressed_bytes;
 
@@ -156,6 +167,7 @@ void SessionStats::add_frame(const FrameStats& fs) {
     avg_residual_mean += fs.residual_mean;
     avg_max_error += fs.max_error;
     avg_rmse += fs.rmse;
+    peak_max_error = std::max(peak_max_error, fs.max_error);
 }
 
 void SessionStats::finalize() {
@@ -180,6 +192,9 @@ std::string SessionStats::to_json() const {
     oss << "  \"total_frames\": " << total_frames << ",\n";
     oss << "  \"keyframes\": " << keyframes << ",\n";
     oss << "  \"residual_frames\": " << residual_frames << ",\n";
+    oss << "  \"repeat_frames\": " << repeat_frames << ",\n";
+    oss << "  \"timestamp_gaps\": " << timestamp_gaps << ",\n";
+    oss << "  \"frames_dropped\": " << frames_dropped << ",\n";
     oss << "  \"total_original_bytes\": " << total_original_bytes << ",\n";
     oss << "  \"total_compressed_bytes\": " << total_compressed_bytes << ",\n";
     oss << "  \"overall_compression_ratio\": " << overall_compression_ratio << ",\n";
@@ -187,6 +202,7 @@ std::string SessionStats::to_json() const {
     oss << "  \"avg_residual_mean\": " << avg_residual_mean << ",\n";
     oss << "  \"avg_max_error\": " << avg_max_error << ",\n";
     oss << "  \"avg_rmse\": " << avg_rmse << ",\n";
+    oss << "  \"peak_max_error\": " << peak_max_error << ",\n";
     oss << "  \"avg_size_per_frame_kb\": "
         << (total_compressed_bytes / 1024.0) / total_frames << "\n";
     oss << "}";
@@ -194,4 +210,162 @@ std::string SessionStats::to_json() const {
     return oss.str();
 }
 
+// ============================================================================
+// Residual Statistics Computation
+// ============================================================================
+
+namespace {
+
+constexpr size_t STATS_NUM_BINS = 1024;
+
+// Fill zero mass, mean |R|, percentiles and the raw entropy estimate from a
+// histogram of |R| built over sample_count samples
+ResidualStats stats_from_abs_histogram(
+    const std::vector<uint64_t>& hist_abs,
+    uint64_t zero_count,
+    double sum_abs,
+    size_t sample_count)
+{
+    ResidualStats stats;
+
+    // Zero mass (fraction within dead-zone)
+    stats.zero_mass = static_cast<double>(zero_count) / sample_count;
+
+    // Mean absolute residual
+    stats.mean_abs = sum_abs / sample_count;
+
+    // Percentiles
+    uint64_t p95_count = static_cast<uint64_t>(0.95 * sample_count);
+    uint64_t p99_count = static_cast<uint64_t>(0.99 * sample_count);
+    uint64_t cumulative = 0;
+    bool found_p95 = false;
+
+    for (size_t i = 0; i < STATS_NUM_BINS; ++i) {
+        cumulative += hist_abs[i];
+        if (!found_p95 && cumulative >= p95_count) {
+            stats.p95 = static_cast<double>(i);
+            found_p95 = true;
+        }
+        if (cumulative >= p99_count) {
+            stats.p99 = static_cast<double>(i);
+            break;
+        }
+    }
+
+    // Estimate rate from raw residual histogram (less accurate than quantized)
+    double H = 0.0;
+    for (size_t i = 0; i < STATS_NUM_BINS; ++i) {
+        if (hist_abs[i] > 0) {
+            double p = static_cast<double>(hist_abs[i]) / sample_count;
+            H -= p * std::log2(p);
+        }
+    }
+    // Account for sign bit
+    stats.bps_res = H + 1.0;
+
+    return stats;
+}
+
+} // anonymous namespace
+
+ResidualStats compute_residual_stats(
+    const int16_t* residual,
+    size_t pixel_count,
+    uint32_t dead_zone_T,
+    const int16_t* quantized)
+{
+    if (pixel_count == 0) {
+        return ResidualStats();
+    }
+
+    // Build histogram of |R| for basic statistics
+    std::vector<uint64_t> hist_abs(STATS_NUM_BINS, 0);
+    uint64_t zero_count = 0;
+    double sum_abs = 0.0;
+
+    for (size_t i = 0; i < pixel_count; ++i) {
+        int32_t mag = std::abs(static_cast<int32_t>(residual[i]));
+
+        // Count samples within dead-zone
+        if (mag <= static_cast<int32_t>(dead_zone_T)) {
+            zero_count++;
+        }
+
+        sum_abs += mag;
+
+        // Accumulate histogram
+        if (mag >= static_cast<int32_t>(STATS_NUM_BINS)) {
+            mag = STATS_NUM_BINS - 1;
+        }
+        hist_abs[mag]++;
+    }
+
+    ResidualStats stats = stats_from_abs_histogram(hist_abs, zero_count, sum_abs, pixel_count);
+
+    // Entropy of quantized symbols (if provided)
+    if (quantized != nullptr) {
+        // Build histogram of quantized values
+        // Use a map since quantized values can be sparse
+        std::unordered_map<int16_t, uint64_t> quant_hist;
+
+        for (size_t i = 0; i < pixel_count; ++i) {
+            quant_hist[quantized[i]]++;
+        }
+
+        // Compute entropy
+        double H = 0.0;
+        for (const auto& pair : quant_hist) {
+            if (pair.second > 0) {
+                double p = static_cast<double>(pair.second) / pixel_count;
+                H -= p * std::log2(p);
+            }
+        }
+
+        stats.bps_res = H;
+    }
+
+    return stats;
+}
+
+ResidualStats compute_delta_stats(
+    const uint16_t* current,
+    const uint16_t* reference,
+    size_t pixel_count,
+    uint32_t dead_zone_T,
+    uint32_t stride)
+{
+    if (pixel_count == 0) {
+        return ResidualStats();
+    }
+    if (stride == 0) {
+        stride = 1;
+    }
+
+    std::vector<uint64_t> hist_abs(STATS_NUM_BINS, 0);
+    uint64_t zero_count = 0;
+    double sum_abs = 0.0;
+    size_t sample_count = 0;
+
+    for (size_t i = 0; i < pixel_count; i += stride) {
+        // Same wrap-around difference as compute_residual()
+        const int16_t r = static_cast<int16_t>(static_cast<int16_t>(current[i]) -
+                                               static_cast<int16_t>(reference[i]));
+        int32_t mag = std::abs(static_cast<int32_t>(r));
+
+        if (mag <= static_cast<int32_t>(dead_zone_T)) {
+            zero_count++;
+        }
+
+        sum_abs += mag;
+
+        if (mag >= static_cast<int32_t>(STATS_NUM_BINS)) {
+            mag = STATS_NUM_BINS - 1;
+        }
+        hist_abs[mag]++;
+        sample_count++;
+    }
+
+    return stats_from_abs_histogram(hist_abs, zero_count, sum_abs, sample_count);
+}
+
 } // namespace lwir
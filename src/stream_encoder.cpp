@@ -0,0 +1,201 @@
+/**
+ * @file stream_encoder.cpp
+ * @brief Push-based streaming encoder implementation
+ */
+
+#include "stream_encoder.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace lwir {
+
+namespace {
+
+CompressionConfig stream_config(const CompressionConfig& config)
+{
+    CompressionConfig stream = config;
+    stream.verbose = false;   // The embedding application owns stdout
+    return stream;
+}
+
+} // anonymous namespace
+
+StreamEncoder::StreamEncoder(const CompressionConfig& config, EncodedFrameCallback on_encoded,
+                             uint32_t queue_depth)
+    : pipeline_(stream_config(config))
+    , on_encoded_(std::move(on_encoded))
+    , capacity_(std::max(1u, queue_depth))
+    , in_flight_(0)
+    , next_index_(0)
+    , dropped_(0)
+    , failed_(false)
+    , finished_(false)
+    , worker_(1)
+{
+    pipeline_.set_frame_sink([this](const CompressedFrame& frame, const FrameStats& stats) {
+        if (on_encoded_) {
+            on_encoded_(frame, stats);
+        }
+        return true;
+    });
+}
+
+StreamEncoder::~StreamEncoder()
+{
+    finish();
+}
+
+bool StreamEncoder::push(const FrameView& view, bool block)
+{
+    // Arrival is when the camera hands the frame over
+    const DeadlineMonitor::Clock::time_point arrival = DeadlineMonitor::Clock::now();
+
+    const size_t stride = view.stride ? view.stride : view.width;
+    if (!view.data || view.width == 0 || view.height == 0 || stride < view.width) {
+        std::cerr << "StreamEncoder: invalid frame view" << std::endl;
+        return false;
+    }
+
+    std::unique_ptr<Frame> buffer;
+    uint32_t index = 0;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (failed_ || finished_) {
+            return false;
+        }
+        if (in_flight_ >= capacity_) {
+            if (!block) {
+                dropped_++;
+                return false;
+            }
+            slot_free_.wait(lock, [this] { return in_flight_ < capacity_ || failed_; });
+            if (failed_) {
+                return false;
+            }
+        }
+
+        // Reuse a buffer from an earlier frame when one is free
+        if (!free_buffers_.empty()) {
+            buffer = std::move(free_buffers_.back());
+            free_buffers_.pop_back();
+        } else {
+            buffer.reset(new Frame());
+        }
+        in_flight_++;
+        index = next_index_++;
+    }
+
+    // Pack rows; no reallocation once the buffer has seen this frame size
+    Frame& frame = *buffer;
+    frame.width = view.width;
+    frame.height = view.height;
+    frame.timestamp = view.timestamp;
+    frame.frame_index = index;
+    frame.data.resize(static_cast<size_t>(view.width) * view.height);
+    if (stride == view.width) {
+        std::memcpy(frame.data.data(), view.data, frame.data.size() * sizeof(uint16_t));
+    } else {
+        for (uint32_t y = 0; y < view.height; ++y) {
+            std::memcpy(frame.data.data() + static_cast<size_t>(y) * view.width,
+                        view.data + y * stride, view.width * sizeof(uint16_t));
+        }
+    }
+
+    Frame* raw = buffer.release();
+    worker_.submit([this, raw, arrival]() { encode(raw, arrival); });
+    return true;
+}
+
+void StreamEncoder::encode(Frame* raw, DeadlineMonitor::Clock::time_point arrival)
+{
+    std::unique_ptr<Frame> buffer(raw);
+
+    uint32_t queued_behind = 0;
+    bool skip = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queued_behind = in_flight_ - 1;
+        skip = failed_;
+    }
+
+    const bool ok = skip || pipeline_.process_frame(*buffer, arrival, queued_behind);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!ok) {
+            failed_ = true;
+        }
+        in_flight_--;
+        free_buffers_.push_back(std::move(buffer));
+    }
+    slot_free_.notify_all();
+}
+
+bool StreamEncoder::flush()
+{
+    // Frames still being entropy coded are delivered on the encoder thread too
+    worker_.submit([this]() {
+        if (!pipeline_.drain()) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            failed_ = true;
+        }
+    });
+    worker_.wait();
+    return ok();
+}
+
+bool StreamEncoder::finish()
+{
+    uint32_t pushed = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (finished_) {
+            return !failed_;
+        }
+        finished_ = true;
+        pushed = next_index_;
+    }
+
+    // No frame: no session to close
+    if (pushed > 0) {
+        worker_.submit([this]() {
+            if (!pipeline_.finish()) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                failed_ = true;
+            }
+        });
+    }
+    worker_.wait();
+    return ok();
+}
+
+bool StreamEncoder::ok() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return !failed_;
+}
+
+uint32_t StreamEncoder::frames_pushed() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return next_index_;
+}
+
+uint32_t StreamEncoder::frames_dropped() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dropped_;
+}
+
+SessionStats StreamEncoder::stats() const
+{
+    SessionStats stats = pipeline_.session_stats();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!finished_) {
+        stats.finalize();   // finish() has already finalized the pipeline's totals
+    }
+    return stats;
+}
+
+} // namespace lwir
@@ -0,0 +1,329 @@
+/**
+ * @file synthetic.cpp
+ * @brief Deterministic synthetic LWIR sequence generator
+ */
+
+#include "synthetic.hpp"
+#include <png.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace lwir {
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+
+// SplitMix64: small, fast, and good enough for reproducible test data
+inline uint64_t splitmix64(uint64_t& state)
+{
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Uniform in [0, 1)
+inline double uniform(uint64_t& state)
+{
+    return static_cast<double>(splitmix64(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Standard normal pair via Box-Muller
+inline void gaussian_pair(uint64_t& state, double& g0, double& g1)
+{
+    double u1 = uniform(state);
+    const double u2 = uniform(state);
+    if (u1 < 1e-300) u1 = 1e-300;
+    const double r = std::sqrt(-2.0 * std::log(u1));
+    g0 = r * std::cos(2.0 * PI * u2);
+    g1 = r * std::sin(2.0 * PI * u2);
+}
+
+inline uint64_t stream_seed(uint64_t seed, uint64_t stream)
+{
+    uint64_t s = seed ^ (stream * 0xD1B54A32D192ED03ull);
+    return splitmix64(s);
+}
+
+// Independent random streams derived from the user seed
+enum Stream : uint64_t {
+    STREAM_SCENE = 1,
+    STREAM_FPN = 2,
+    STREAM_DEAD = 3,
+    STREAM_FFC = 4,
+    STREAM_NOISE_BASE = 1000
+};
+
+} // anonymous namespace
+
+SyntheticSequence::SyntheticSequence(const SyntheticConfig& config)
+    : config_(config)
+    , texture_width_(config.width * 2)
+    , texture_height_(config.height * 2)
+{
+    const uint32_t tw = texture_width_;
+    const uint32_t th = texture_height_;
+    const size_t pixel_count = static_cast<size_t>(config_.width) * config_.height;
+
+    // Smooth periodic scene: integer frequencies so the texture wraps seamlessly
+    uint64_t rng = stream_seed(config_.seed, STREAM_SCENE);
+    constexpr int NUM_WAVES = 5;
+    double amp[NUM_WAVES], fx[NUM_WAVES], fy[NUM_WAVES], phase[NUM_WAVES];
+    double amp_sum = 0.0;
+    for (int k = 0; k < NUM_WAVES; ++k) {
+        amp[k] = 0.3 + uniform(rng);
+        fx[k] = 1.0 + std::floor(uniform(rng) * 4.0);
+        fy[k] = std::floor(uniform(rng) * 4.0) * (uniform(rng) < 0.5 ? -1.0 : 1.0);
+        phase[k] = 2.0 * PI * uniform(rng);
+        amp_sum += amp[k];
+    }
+
+    texture_.resize(static_cast<size_t>(tw) * th);
+    std::vector<double> row_phase(NUM_WAVES);
+    for (uint32_t v = 0; v < th; ++v) {
+        for (int k = 0; k < NUM_WAVES; ++k) {
+            row_phase[k] = 2.0 * PI * fy[k] * v / th + phase[k];
+        }
+        for (uint32_t u = 0; u < tw; ++u) {
+            double value = 0.0;
+            for (int k = 0; k < NUM_WAVES; ++k) {
+                value += amp[k] * std::sin(2.0 * PI * fx[k] * u / tw + row_phase[k]);
+            }
+            texture_[static_cast<size_t>(v) * tw + u] =
+                static_cast<float>(config_.base_dn + config_.field_amplitude_dn * value / amp_sum);
+        }
+    }
+
+    // Warm blobs with periodic distance
+    for (uint32_t s = 0; s < config_.hot_spots; ++s) {
+        const double cx = uniform(rng) * tw;
+        const double cy = uniform(rng) * th;
+        const double sigma = 6.0 + uniform(rng) * 24.0;
+        const double peak = config_.hot_spot_dn * (0.5 + uniform(rng));
+        const int reach = static_cast<int>(3.0 * sigma);
+
+        for (int dy = -reach; dy <= reach; ++dy) {
+            // Blob reach can exceed the texture size on small frames
+            const uint32_t v = static_cast<uint32_t>(
+                ((static_cast<int64_t>(cy) + dy) % th + th) % th);
+            for (int dx = -reach; dx <= reach; ++dx) {
+                const uint32_t u = static_cast<uint32_t>(
+                    ((static_cast<int64_t>(cx) + dx) % tw + tw) % tw);
+                const double d2 = static_cast<double>(dx * dx + dy * dy);
+                texture_[static_cast<size_t>(v) * tw + u] +=
+                    static_cast<float>(peak * std::exp(-d2 / (2.0 * sigma * sigma)));
+            }
+        }
+    }
+
+    // Fixed-pattern noise: per-pixel + per-column offsets
+    rng = stream_seed(config_.seed, STREAM_FPN);
+    std::vector<double> column(config_.width);
+    for (uint32_t x = 0; x < config_.width; ++x) {
+        double g0, g1;
+        gaussian_pair(rng, g0, g1);
+        column[x] = g0 * config_.column_fpn_dn;
+    }
+    fpn_.resize(pixel_count);
+    for (size_t i = 0; i < pixel_count; i += 2) {
+        double g0, g1;
+        gaussian_pair(rng, g0, g1);
+        fpn_[i] = static_cast<float>(g0 * config_.fpn_dn + column[i % config_.width]);
+        if (i + 1 < pixel_count) {
+            fpn_[i + 1] = static_cast<float>(g1 * config_.fpn_dn + column[(i + 1) % config_.width]);
+        }
+    }
+
+    // Dead pixels: stuck low or stuck high
+    rng = stream_seed(config_.seed, STREAM_DEAD);
+    for (uint32_t d = 0; d < config_.dead_pixels && pixel_count > 0; ++d) {
+        dead_.push_back(static_cast<uint32_t>(uniform(rng) * pixel_count));
+        dead_values_.push_back(uniform(rng) < 0.5 ? 0 : 65535);
+    }
+}
+
+bool SyntheticSequence::is_ffc_frame(uint32_t index) const
+{
+    return config_.ffc_period > 0 && index >= config_.ffc_period &&
+           (index % config_.ffc_period) < config_.ffc_duration;
+}
+
+float SyntheticSequence::sample_scene(double u, double v) const
+{
+    // Bilinear sample with wrap-around
+    const double fu = std::floor(u);
+    const double fv = std::floor(v);
+    const double au = u - fu;
+    const double av = v - fv;
+
+    const int64_t tw = texture_width_;
+    const int64_t th = texture_height_;
+    const int64_t u0 = ((static_cast<int64_t>(fu) % tw) + tw) % tw;
+    const int64_t v0 = ((static_cast<int64_t>(fv) % th) + th) % th;
+    const int64_t u1 = (u0 + 1) % tw;
+    const int64_t v1 = (v0 + 1) % th;
+
+    const float* row0 = &texture_[static_cast<size_t>(v0) * tw];
+    const float* row1 = &texture_[static_cast<size_t>(v1) * tw];
+
+    const double top = row0[u0] + au * (row0[u1] - row0[u0]);
+    const double bottom = row1[u0] + au * (row1[u1] - row1[u0]);
+    return static_cast<float>(top + av * (bottom - top));
+}
+
+void SyntheticSequence::generate(uint32_t index, Frame& frame) const
+{
+    const uint32_t w = config_.width;
+    const uint32_t h = config_.height;
+    const size_t pixel_count = static_cast<size_t>(w) * h;
+
+    frame.width = w;
+    frame.height = h;
+    frame.frame_index = index;
+    frame.timestamp = static_cast<uint64_t>(index * config_.frame_period_us + 0.5);
+    frame.data.resize(pixel_count);
+
+    // Global level: drift plus accumulated FFC offset steps
+    double level = config_.drift_dn_per_frame * index;
+    if (config_.ffc_period > 0) {
+        uint32_t completed = index / config_.ffc_period;
+        if (is_ffc_frame(index)) {
+            completed--;
+        }
+        for (uint32_t k = 1; k <= completed; ++k) {
+            uint64_t rng = stream_seed(config_.seed, STREAM_FFC + 16 * k);
+            level += config_.ffc_offset_dn * (2.0 * uniform(rng) - 1.0);
+        }
+    }
+
+    const bool shutter = is_ffc_frame(index);
+    const double theta = config_.rotation_deg_per_frame * index * PI / 180.0;
+    const double cos_t = std::cos(theta);
+    const double sin_t = std::sin(theta);
+    const double cx = 0.5 * w;
+    const double cy = 0.5 * h;
+    const double tx = config_.velocity_x * index;
+    const double ty = config_.velocity_y * index;
+
+    uint64_t rng = stream_seed(config_.seed, STREAM_NOISE_BASE + index);
+    double spare = 0.0;
+    bool have_spare = false;
+
+    for (uint32_t y = 0; y < h; ++y) {
+        const double dy = y - cy;
+        for (uint32_t x = 0; x < w; ++x) {
+            const size_t i = static_cast<size_t>(y) * w + x;
+
+            double scene;
+            if (shutter) {
+                // Shutter closed: uniform paddle temperature
+                scene = config_.base_dn;
+            } else {
+                const double dx = x - cx;
+                const double u = cos_t * dx - sin_t * dy + cx + tx;
+                const double v = sin_t * dx + cos_t * dy + cy + ty;
+                scene = sample_scene(u, v);
+            }
+
+            double noise;
+            if (have_spare) {
+                noise = spare;
+                have_spare = false;
+            } else {
+                gaussian_pair(rng, noise, spare);
+                have_spare = true;
+            }
+
+            const double value = scene + level + fpn_[i] + noise * config_.temporal_noise_dn;
+            frame.data[i] = static_cast<uint16_t>(std::min(65535.0, std::max(0.0, value + 0.5)));
+        }
+    }
+
+    for (size_t d = 0; d < dead_.size(); ++d) {
+        frame.data[dead_[d]] = dead_values_[d];
+    }
+}
+
+bool write_frame_png(const Frame& frame, const std::string& path)
+{
+    FILE* fp = fopen(path.c_str(), "wb");
+    if (!fp) {
+        std::cerr << "Failed to open PNG for writing: " << path << std::endl;
+        return false;
+    }
+
+    png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+    if (!png) {
+        fclose(fp);
+        return false;
+    }
+
+    png_infop info = png_create_info_struct(png);
+    if (!info) {
+        png_destroy_write_struct(&png, nullptr);
+        fclose(fp);
+        return false;
+    }
+
+    if (setjmp(png_jmpbuf(png))) {
+        png_destroy_write_struct(&png, &info);
+        fclose(fp);
+        return false;
+    }
+
+    png_init_io(png, fp);
+    png_set_IHDR(png, info, frame.width, frame.height, 16, PNG_COLOR_TYPE_GRAY,
+                 PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+
+    // Capture time, read back by load_frame_from_png()
+    std::string timestamp = std::to_string(frame.timestamp);
+    png_text text;
+    std::memset(&text, 0, sizeof(text));
+    text.compression = PNG_TEXT_COMPRESSION_NONE;
+    text.key = const_cast<png_charp>(FRAME_TIMESTAMP_PNG_KEY);
+    text.text = &timestamp[0];
+    text.text_length = timestamp.size();
+    png_set_text(png, info, &text, 1);
+
+    png_write_info(png, info);
+
+    // PNG stores 16-bit samples big-endian
+    png_set_swap(png);
+
+    std::vector<png_bytep> row_pointers(frame.height);
+    for (uint32_t y = 0; y < frame.height; ++y) {
+        row_pointers[y] = reinterpret_cast<png_bytep>(
+            const_cast<uint16_t*>(&frame.data[static_cast<size_t>(y) * frame.width]));
+    }
+
+    png_write_image(png, row_pointers.data());
+    png_write_end(png, nullptr);
+
+    png_destroy_write_struct(&png, &info);
+    fclose(fp);
+    return true;
+}
+
+bool write_frame_raw(const Frame& frame, const std::string& path)
+{
+    std::ofstream ofs(path, std::ios::binary);
+    if (!ofs) {
+        std::cerr << "Failed to open raw file for writing: " << path << std::endl;
+        return false;
+    }
+
+    std::vector<uint8_t> bytes(frame.data.size() * 2);
+    for (size_t i = 0; i < frame.data.size(); ++i) {
+        bytes[2 * i] = static_cast<uint8_t>(frame.data[i] & 0xFF);
+        bytes[2 * i + 1] = static_cast<uint8_t>(frame.data[i] >> 8);
+    }
+    ofs.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    return static_cast<bool>(ofs);
+}
+
+} // namespace lwir
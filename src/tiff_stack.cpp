@@ -0,0 +1,973 @@
+/**
+ * @file tiff_stack.cpp
+ * @brief Multi-page TIFF stack reader (memory-mapped) and writer
+ */
+
+#include "tiff_stack.hpp"
+#include <zlib.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <unordered_map>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace lwir {
+
+namespace {
+
+// Tags and values used by 16-bit grayscale stacks
+constexpr uint16_t TAG_NEW_SUBFILE_TYPE = 254;
+constexpr uint16_t TAG_IMAGE_WIDTH = 256;
+constexpr uint16_t TAG_IMAGE_LENGTH = 257;
+constexpr uint16_t TAG_BITS_PER_SAMPLE = 258;
+constexpr uint16_t TAG_COMPRESSION = 259;
+constexpr uint16_t TAG_PHOTOMETRIC = 262;
+constexpr uint16_t TAG_STRIP_OFFSETS = 273;
+constexpr uint16_t TAG_SAMPLES_PER_PIXEL = 277;
+constexpr uint16_t TAG_ROWS_PER_STRIP = 278;
+constexpr uint16_t TAG_STRIP_BYTE_COUNTS = 279;
+constexpr uint16_t TAG_PREDICTOR = 317;
+constexpr uint16_t TAG_TILE_WIDTH = 322;
+constexpr uint16_t TAG_SAMPLE_FORMAT = 339;
+
+constexpr uint16_t TYPE_SHORT = 3;
+constexpr uint16_t TYPE_LONG = 4;
+
+constexpr uint16_t COMPRESSION_NONE = 1;
+constexpr uint16_t COMPRESSION_LZW = 5;
+constexpr uint16_t COMPRESSION_DEFLATE = 8;
+constexpr uint16_t COMPRESSION_DEFLATE_OLD = 32946;
+constexpr uint16_t COMPRESSION_PACKBITS = 32773;
+
+constexpr uint16_t PREDICTOR_HORIZONTAL = 2;
+
+constexpr size_t IFD_ENTRY_SIZE = 12;
+
+bool host_is_big_endian()
+{
+    const uint16_t probe = 1;
+    uint8_t first;
+    std::memcpy(&first, &probe, 1);
+    return first == 0;
+}
+
+/**
+ * Bounds-checked reads in the file's byte order
+ */
+class TiffBytes {
+public:
+    TiffBytes(const uint8_t* data, size_t size, bool big_endian)
+        : data_(data), size_(size), big_endian_(big_endian) {}
+
+    bool u16(uint64_t offset, uint16_t& value) const
+    {
+        if (offset + 2 > size_) return false;
+        const uint8_t* p = data_ + offset;
+        value = big_endian_ ? static_cast<uint16_t>((p[0] << 8) | p[1])
+                            : static_cast<uint16_t>((p[1] << 8) | p[0]);
+        return true;
+    }
+
+    bool u32(uint64_t offset, uint32_t& value) const
+    {
+        if (offset + 4 > size_) return false;
+        const uint8_t* p = data_ + offset;
+        value = big_endian_
+              ? (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3]
+              : (uint32_t(p[3]) << 24) | (uint32_t(p[2]) << 16) | (uint32_t(p[1]) << 8) | p[0];
+        return true;
+    }
+
+    /**
+     * SHORT or LONG values of an IFD entry (inline when they fit in 4 bytes)
+     */
+    bool values(uint64_t entry, std::vector<uint32_t>& out) const
+    {
+        uint16_t type;
+        uint32_t count;
+        if (!u16(entry + 2, type) || !u32(entry + 4, count)) return false;
+        if (type != TYPE_SHORT && type != TYPE_LONG) return false;
+
+        const uint64_t element = (type == TYPE_SHORT) ? 2 : 4;
+        uint64_t offset = entry + 8;
+        if (element * count > 4) {
+            uint32_t pointer;
+            if (!u32(entry + 8, pointer)) return false;
+            offset = pointer;
+        }
+        if (offset + element * count > size_) return false;
+
+        out.resize(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            if (type == TYPE_SHORT) {
+                uint16_t v = 0;
+                u16(offset + 2 * i, v);
+                out[i] = v;
+            }
+            else {
+                u32(offset + 4 * i, out[i]);
+            }
+        }
+        return true;
+    }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    bool big_endian_;
+};
+
+bool packbits_decode(const uint8_t* src, size_t size, uint8_t* dst, size_t expected)
+{
+    size_t in = 0;
+    size_t out = 0;
+    while (out < expected && in < size) {
+        const int8_t n = static_cast<int8_t>(src[in++]);
+        if (n >= 0) {
+            const size_t count = static_cast<size_t>(n) + 1;
+            if (in + count > size || out + count > expected) return false;
+            std::memcpy(dst + out, src + in, count);
+            in += count;
+            out += count;
+        }
+        else if (n != -128) {
+            const size_t count = static_cast<size_t>(1 - n);
+            if (in >= size || out + count > expected) return false;
+            std::memset(dst + out, src[in++], count);
+            out += count;
+        }
+    }
+    return out == expected;
+}
+
+/**
+ * TIFF LZW: MSB-first codes of 9-12 bits, Clear = 256, EOI = 257, code
+ * width growing one code early
+ */
+bool lzw_decode(const uint8_t* src, size_t size, uint8_t* dst, size_t expected)
+{
+    constexpr uint32_t CLEAR = 256;
+    constexpr uint32_t END = 257;
+    constexpr uint32_t FIRST_FREE = 258;
+    constexpr uint32_t TABLE_SIZE = 4096;
+    constexpr uint32_t NONE = TABLE_SIZE;
+
+    std::vector<uint16_t> prefix(TABLE_SIZE);
+    std::vector<uint8_t> suffix(TABLE_SIZE);
+    std::vector<uint8_t> first(TABLE_SIZE);
+    std::vector<uint16_t> length(TABLE_SIZE);
+    for (uint32_t i = 0; i < 256; ++i) {
+        suffix[i] = static_cast<uint8_t>(i);
+        first[i] = static_cast<uint8_t>(i);
+        length[i] = 1;
+    }
+
+    uint32_t next = FIRST_FREE;
+    uint32_t width = 9;
+    uint32_t old = NONE;
+    uint64_t bits = 0;
+    uint32_t bit_count = 0;
+    size_t in = 0;
+    size_t out = 0;
+
+    while (out < expected) {
+        while (bit_count < width) {
+            if (in >= size) return false;
+            bits = (bits << 8) | src[in++];
+            bit_count += 8;
+        }
+        const uint32_t code = static_cast<uint32_t>(bits >> (bit_count - width)) & ((1u << width) - 1);
+        bit_count -= width;
+
+        if (code == END) break;
+        if (code == CLEAR) {
+            next = FIRST_FREE;
+            width = 9;
+            old = NONE;
+            continue;
+        }
+
+        if (old != NONE) {
+            if (code > next) return false;
+            // New entry: previous string plus the first byte of this one (for
+            // code == next, the entry being defined, that is its own first byte)
+            if (next < TABLE_SIZE) {
+                prefix[next] = static_cast<uint16_t>(old);
+                suffix[next] = (code == next) ? first[old] : first[code];
+                first[next] = first[old];
+                length[next] = static_cast<uint16_t>(length[old] + 1);
+                next++;
+                if (next >= (1u << width) - 1 && width < 12) {
+                    width++;
+                }
+            }
+        }
+        else if (code >= FIRST_FREE) {
+            return false;
+        }
+
+        const size_t count = length[code];
+        if (out + count > expected) return false;
+        uint32_t c = code;
+        for (size_t i = count; i > 0; --i) {
+            dst[out + i - 1] = suffix[c];
+            c = prefix[c];
+        }
+        out += count;
+        old = code;
+    }
+    return out == expected;
+}
+
+bool deflate_decode(const uint8_t* src, size_t size, uint8_t* dst, size_t expected)
+{
+    z_stream zs;
+    std::memset(&zs, 0, sizeof(zs));
+    if (inflateInit(&zs) != Z_OK) {
+        return false;
+    }
+    zs.next_in = const_cast<Bytef*>(src);
+    zs.avail_in = static_cast<uInt>(size);
+    zs.next_out = dst;
+    zs.avail_out = static_cast<uInt>(expected);
+    const int result = inflate(&zs, Z_FINISH);
+    const bool ok = (result == Z_STREAM_END || result == Z_BUF_ERROR || result == Z_OK) &&
+                    zs.total_out == expected;
+    inflateEnd(&zs);
+    return ok;
+}
+
+void packbits_encode(const uint8_t* src, size_t size, std::vector<uint8_t>& out)
+{
+    size_t i = 0;
+    while (i < size) {
+        size_t run = 1;
+        while (i + run < size && run < 128 && src[i + run] == src[i]) {
+            run++;
+        }
+        if (run >= 2) {
+            out.push_back(static_cast<uint8_t>(static_cast<int8_t>(1 - static_cast<int>(run))));
+            out.push_back(src[i]);
+            i += run;
+            continue;
+        }
+        // Literal until the next run of two or 128 bytes
+        size_t literal = 1;
+        while (i + literal < size && literal < 128 &&
+               !(i + literal + 1 < size && src[i + literal] == src[i + literal + 1]))
+        {
+            literal++;
+        }
+        out.push_back(static_cast<uint8_t>(literal - 1));
+        out.insert(out.end(), src + i, src + i + literal);
+        i += literal;
+    }
+}
+
+/**
+ * LZW encoder matching lzw_decode()
+ */
+void lzw_encode(const uint8_t* src, size_t size, std::vector<uint8_t>& out)
+{
+    constexpr uint32_t CLEAR = 256;
+    constexpr uint32_t END = 257;
+    constexpr uint32_t FIRST_FREE = 258;
+    constexpr uint32_t LAST_ENTRY = 4092;   // Clear before the decoder's table fills
+
+    uint64_t bits = 0;
+    uint32_t bit_count = 0;
+    auto put = [&](uint32_t code, uint32_t width) {
+        bits = (bits << width) | code;
+        bit_count += width;
+        while (bit_count >= 8) {
+            out.push_back(static_cast<uint8_t>(bits >> (bit_count - 8)));
+            bit_count -= 8;
+        }
+    };
+
+    std::unordered_map<uint32_t, uint32_t> table;
+    uint32_t next = FIRST_FREE;
+    uint32_t width = 9;
+    put(CLEAR, width);
+
+    // The decoder adds each entry one code later, so it widens at
+    // 2^width - 1 entries where the encoder has 2^width
+    if (size > 0) {
+        uint32_t current = src[0];
+        for (size_t i = 1; i < size; ++i) {
+            const uint32_t key = (current << 8) | src[i];
+            const auto found = table.find(key);
+            if (found != table.end()) {
+                current = found->second;
+                continue;
+            }
+            put(current, width);
+            table[key] = next++;
+            if (next >= (1u << width) && width < 12) {
+                width++;
+            }
+            if (next > LAST_ENTRY) {
+                put(CLEAR, width);
+                table.clear();
+                next = FIRST_FREE;
+                width = 9;
+            }
+            current = src[i];
+        }
+        put(current, width);
+        if (next + 1 >= (1u << width) && width < 12) {
+            width++;   // Entry the decoder adds for the last code
+        }
+    }
+    put(END, width);
+    if (bit_count > 0) {
+        out.push_back(static_cast<uint8_t>(bits << (8 - bit_count)));
+    }
+}
+
+void put16(std::vector<uint8_t>& out, uint16_t value, bool big_endian)
+{
+    if (big_endian) {
+        out.push_back(static_cast<uint8_t>(value >> 8));
+        out.push_back(static_cast<uint8_t>(value));
+    }
+    else {
+        out.push_back(static_cast<uint8_t>(value));
+        out.push_back(static_cast<uint8_t>(value >> 8));
+    }
+}
+
+void put32(std::vector<uint8_t>& out, uint32_t value, bool big_endian)
+{
+    if (big_endian) {
+        put16(out, static_cast<uint16_t>(value >> 16), true);
+        put16(out, static_cast<uint16_t>(value), true);
+    }
+    else {
+        put16(out, static_cast<uint16_t>(value), false);
+        put16(out, static_cast<uint16_t>(value >> 16), false);
+    }
+}
+
+bool has_extension(const std::string& name, const std::string& extension)
+{
+    return name.size() > extension.size() &&
+           name.compare(name.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+} // anonymous namespace
+
+// ============================================================================
+// TiffStackSource
+// ============================================================================
+
+TiffStackSource::TiffStackSource()
+    : prefetch_pool_(nullptr)
+    , prefetch_depth_(0)
+    , in_flight_(0)
+{
+}
+
+TiffStackSource::~TiffStackSource()
+{
+    drain_prefetch();
+    for (const MappedFile& file : files_) {
+        ::munmap(const_cast<uint8_t*>(file.data), file.size);
+    }
+}
+
+bool TiffStackSource::open(const std::string& path)
+{
+    drain_prefetch();
+    for (const MappedFile& file : files_) {
+        ::munmap(const_cast<uint8_t*>(file.data), file.size);
+    }
+    files_.clear();
+    pages_.clear();
+    path_ = path;
+
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0) {
+        std::cerr << "TIFF input not found: " << path << std::endl;
+        return false;
+    }
+
+    std::vector<std::string> paths;
+    if (S_ISDIR(st.st_mode)) {
+        DIR* dir = opendir(path.c_str());
+        if (!dir) {
+            std::cerr << "Failed to open input directory: " << path << std::endl;
+            return false;
+        }
+        struct dirent* entry;
+        while ((entry = readdir(dir)) != nullptr) {
+            const std::string filename = entry->d_name;
+            if (has_extension(filename, ".tif") || has_extension(filename, ".tiff")) {
+                paths.push_back(path + "/" + filename);
+            }
+        }
+        closedir(dir);
+        std::sort(paths.begin(), paths.end());
+    }
+    else {
+        paths.push_back(path);
+    }
+
+    for (const std::string& file_path : paths) {
+        if (!map_file(file_path) || !read_pages(files_.size() - 1)) {
+            return false;
+        }
+    }
+
+    if (pages_.empty()) {
+        std::cerr << "No TIFF pages found: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool TiffStackSource::map_file(const std::string& path)
+{
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Failed to open TIFF: " << path << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size < 8) {
+        std::cerr << "Not a TIFF file: " << path << std::endl;
+        ::close(fd);
+        return false;
+    }
+    const size_t size = static_cast<size_t>(st.st_size);
+    void* data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        std::cerr << "Failed to map TIFF: " << path << std::endl;
+        return false;
+    }
+
+    MappedFile file;
+    file.path = path;
+    file.data = static_cast<const uint8_t*>(data);
+    file.size = size;
+    file.big_endian = (file.data[0] == 'M');
+    files_.push_back(file);
+
+    const bool little = (file.data[0] == 'I' && file.data[1] == 'I');
+    const bool big = (file.data[0] == 'M' && file.data[1] == 'M');
+    uint16_t magic = 0;
+    TiffBytes(file.data, file.size, file.big_endian).u16(2, magic);
+    if ((!little && !big) || magic != 42) {
+        std::cerr << "Not a classic TIFF file" << (magic == 43 ? " (BigTIFF is not supported)" : "")
+                  << ": " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool TiffStackSource::read_pages(size_t file_index)
+{
+    const MappedFile& file = files_[file_index];
+    const TiffBytes bytes(file.data, file.size, file.big_endian);
+
+    uint32_t ifd = 0;
+    bytes.u32(4, ifd);
+    std::set<uint32_t> visited;
+    uint32_t page_number = 0;
+
+    while (ifd != 0) {
+        if (!visited.insert(ifd).second) {
+            std::cerr << "TIFF IFD chain loops: " << file.path << std::endl;
+            return false;
+        }
+        uint16_t entry_count;
+        if (!bytes.u16(ifd, entry_count) || ifd + 2 + uint64_t(entry_count) * IFD_ENTRY_SIZE + 4 > file.size) {
+            std::cerr << "Truncated TIFF IFD " << page_number << ": " << file.path << std::endl;
+            return false;
+        }
+
+        Page page;
+        page.file = file_index;
+        page.width = 0;
+        page.height = 0;
+        page.rows_per_strip = 0;
+        page.compression = COMPRESSION_NONE;
+        page.predictor = 1;
+        uint32_t bits = 1;
+        uint32_t samples = 1;
+        uint32_t photometric = 1;
+        uint32_t sample_format = 1;
+        uint32_t subfile_type = 0;
+        bool tiled = false;
+        bool ok = true;
+
+        std::vector<uint32_t> values;
+        for (uint16_t e = 0; e < entry_count && ok; ++e) {
+            const uint64_t entry = ifd + 2 + uint64_t(e) * IFD_ENTRY_SIZE;
+            uint16_t tag = 0;
+            bytes.u16(entry, tag);
+            switch (tag) {
+            case TAG_NEW_SUBFILE_TYPE:
+            case TAG_IMAGE_WIDTH:
+            case TAG_IMAGE_LENGTH:
+            case TAG_BITS_PER_SAMPLE:
+            case TAG_COMPRESSION:
+            case TAG_PHOTOMETRIC:
+            case TAG_SAMPLES_PER_PIXEL:
+            case TAG_ROWS_PER_STRIP:
+            case TAG_PREDICTOR:
+            case TAG_SAMPLE_FORMAT:
+                ok = bytes.values(entry, values) && !values.empty();
+                if (!ok) break;
+                if (tag == TAG_NEW_SUBFILE_TYPE) subfile_type = values[0];
+                if (tag == TAG_IMAGE_WIDTH) page.width = values[0];
+                if (tag == TAG_IMAGE_LENGTH) page.height = values[0];
+                if (tag == TAG_BITS_PER_SAMPLE) bits = values[0];
+                if (tag == TAG_COMPRESSION) page.compression = static_cast<uint16_t>(values[0]);
+                if (tag == TAG_PHOTOMETRIC) photometric = values[0];
+                if (tag == TAG_SAMPLES_PER_PIXEL) samples = values[0];
+                if (tag == TAG_ROWS_PER_STRIP) page.rows_per_strip = values[0];
+                if (tag == TAG_PREDICTOR) page.predictor = static_cast<uint16_t>(values[0]);
+                if (tag == TAG_SAMPLE_FORMAT) sample_format = values[0];
+                break;
+            case TAG_STRIP_OFFSETS:
+                ok = bytes.values(entry, page.strip_offsets);
+                break;
+            case TAG_STRIP_BYTE_COUNTS:
+                ok = bytes.values(entry, page.strip_bytes);
+                break;
+            case TAG_TILE_WIDTH:
+                tiled = true;
+                break;
+            default:
+                break;
+            }
+        }
+        bytes.u32(ifd + 2 + uint64_t(entry_count) * IFD_ENTRY_SIZE, ifd);
+
+        if (!ok) {
+            std::cerr << "Malformed tag in TIFF page " << page_number << ": " << file.path << std::endl;
+            return false;
+        }
+
+        // Thumbnails and other reduced-resolution pages are not frames
+        if (subfile_type & 1) {
+            page_number++;
+            continue;
+        }
+
+        const char* problem = nullptr;
+        if (tiled) problem = "tiled pages are not supported";
+        else if (bits != 16 || samples != 1 || sample_format != 1) problem = "must be 16-bit unsigned grayscale";
+        else if (photometric != 1) problem = "must be BlackIsZero grayscale";
+        else if (page.width == 0 || page.height == 0) problem = "has no size";
+        else if (page.compression != COMPRESSION_NONE && page.compression != COMPRESSION_LZW &&
+                 page.compression != COMPRESSION_DEFLATE && page.compression != COMPRESSION_DEFLATE_OLD &&
+                 page.compression != COMPRESSION_PACKBITS)
+        {
+            problem = "uses an unsupported compression";
+        }
+        else if (page.predictor != 1 && page.predictor != PREDICTOR_HORIZONTAL) problem = "uses an unsupported predictor";
+
+        if (!problem) {
+            if (page.rows_per_strip == 0 || page.rows_per_strip > page.height) {
+                page.rows_per_strip = page.height;
+            }
+            const size_t strips = (page.height + page.rows_per_strip - 1) / page.rows_per_strip;
+            if (page.strip_offsets.size() != strips || page.strip_bytes.size() != strips) {
+                problem = "has inconsistent strips";
+            }
+            for (size_t s = 0; s < page.strip_offsets.size() && !problem; ++s) {
+                if (uint64_t(page.strip_offsets[s]) + page.strip_bytes[s] > file.size) {
+                    problem = "has strips past the end of the file";
+                }
+            }
+        }
+        if (problem) {
+            std::cerr << "TIFF page " << page_number << " " << problem << ": " << file.path << std::endl;
+            return false;
+        }
+
+        pages_.push_back(std::move(page));
+        page_number++;
+    }
+    return true;
+}
+
+bool TiffStackSource::is_compressed(const Page& page) const
+{
+    return page.compression != COMPRESSION_NONE;
+}
+
+const uint16_t* TiffStackSource::mapped_samples(size_t index) const
+{
+    if (index >= pages_.size()) {
+        return nullptr;
+    }
+    const Page& page = pages_[index];
+    const MappedFile& file = files_[page.file];
+    if (is_compressed(page) || page.predictor != 1 || file.big_endian != host_is_big_endian() ||
+        page.strip_offsets[0] % 2 != 0)
+    {
+        return nullptr;
+    }
+
+    // One contiguous run covering the whole page
+    uint64_t end = page.strip_offsets[0];
+    for (size_t s = 0; s < page.strip_offsets.size(); ++s) {
+        if (page.strip_offsets[s] != end) {
+            return nullptr;
+        }
+        end += page.strip_bytes[s];
+    }
+    if (end - page.strip_offsets[0] < uint64_t(page.width) * page.height * sizeof(uint16_t)) {
+        return nullptr;
+    }
+    return reinterpret_cast<const uint16_t*>(file.data + page.strip_offsets[0]);
+}
+
+bool TiffStackSource::decode_page(const Page& page, Frame& frame) const
+{
+    const MappedFile& file = files_[page.file];
+    const size_t row_bytes = size_t(page.width) * sizeof(uint16_t);
+
+    frame.width = page.width;
+    frame.height = page.height;
+    frame.data.resize(frame.pixel_count());
+    uint8_t* out = reinterpret_cast<uint8_t*>(frame.data.data());
+
+    // Contiguous uncompressed page in host order: one copy out of the mapping
+    const size_t index = static_cast<size_t>(&page - pages_.data());
+    if (const uint16_t* samples = mapped_samples(index)) {
+        std::memcpy(out, samples, frame.pixel_count() * sizeof(uint16_t));
+        return true;
+    }
+
+    for (size_t s = 0; s < page.strip_offsets.size(); ++s) {
+        const uint32_t first_row = static_cast<uint32_t>(s * page.rows_per_strip);
+        const uint32_t rows = std::min(page.rows_per_strip, page.height - first_row);
+        const size_t expected = rows * row_bytes;
+        const uint8_t* src = file.data + page.strip_offsets[s];
+        const size_t size = page.strip_bytes[s];
+        uint8_t* dst = out + first_row * row_bytes;
+
+        bool ok = false;
+        switch (page.compression) {
+        case COMPRESSION_NONE:
+            ok = size >= expected;
+            if (ok) std::memcpy(dst, src, expected);
+            break;
+        case COMPRESSION_PACKBITS:
+            ok = packbits_decode(src, size, dst, expected);
+            break;
+        case COMPRESSION_LZW:
+            ok = lzw_decode(src, size, dst, expected);
+            break;
+        default:
+            ok = deflate_decode(src, size, dst, expected);
+            break;
+        }
+        if (!ok) {
+            std::cerr << "Failed to decode TIFF strip " << s << ": " << file.path << std::endl;
+            return false;
+        }
+    }
+
+    if (file.big_endian != host_is_big_endian()) {
+        for (uint16_t& sample : frame.data) {
+            sample = static_cast<uint16_t>((sample << 8) | (sample >> 8));
+        }
+    }
+
+    if (page.predictor == PREDICTOR_HORIZONTAL) {
+        for (uint32_t y = 0; y < page.height; ++y) {
+            uint16_t* row = frame.data.data() + size_t(y) * page.width;
+            for (uint32_t x = 1; x < page.width; ++x) {
+                row[x] = static_cast<uint16_t>(row[x] + row[x - 1]);
+            }
+        }
+    }
+    return true;
+}
+
+void TiffStackSource::set_prefetch_pool(WorkerPool* pool, size_t depth)
+{
+    drain_prefetch();
+    prefetch_pool_ = pool;
+    prefetch_depth_ = depth;
+}
+
+bool TiffStackSource::read_frame(size_t index, Frame& frame)
+{
+    if (index >= pages_.size()) {
+        return false;
+    }
+
+    std::shared_ptr<Prefetched> ready;
+    {
+        std::unique_lock<std::mutex> lock(prefetch_mutex_);
+        // Pages skipped over are dropped (their decode keeps its own reference)
+        while (!ahead_.empty() && ahead_.front()->index < index) {
+            ahead_.pop_front();
+        }
+        if (!ahead_.empty() && ahead_.front()->index == index) {
+            ready = ahead_.front();
+            ahead_.pop_front();
+            prefetch_done_.wait(lock, [&ready]() { return ready->done; });
+        }
+    }
+
+    bool ok = false;
+    if (ready) {
+        ok = ready->ok;
+        frame.width = ready->frame.width;
+        frame.height = ready->frame.height;
+        frame.data.swap(ready->frame.data);
+    }
+    else {
+        ok = decode_page(pages_[index], frame);
+    }
+    frame.frame_index = static_cast<uint32_t>(index);
+    frame.timestamp = 0;
+
+    schedule_prefetch(index);
+    return ok;
+}
+
+void TiffStackSource::schedule_prefetch(size_t index)
+{
+    const size_t next_page = index + 1;
+    if (next_page >= pages_.size()) {
+        return;
+    }
+
+    // Uncompressed: let the kernel read the next page in while this one is encoded
+    const Page& next = pages_[next_page];
+    if (!is_compressed(next)) {
+        const MappedFile& file = files_[next.file];
+        const uint64_t begin = *std::min_element(next.strip_offsets.begin(), next.strip_offsets.end());
+        const long page_size = ::sysconf(_SC_PAGESIZE);
+        const uint64_t aligned = begin - begin % static_cast<uint64_t>(page_size);
+        const uint64_t end = std::min<uint64_t>(file.size, begin + uint64_t(next.width) * next.height * 2);
+        ::madvise(const_cast<uint8_t*>(file.data) + aligned, end - aligned, MADV_WILLNEED);
+    }
+
+    if (!prefetch_pool_) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(prefetch_mutex_);
+    size_t page = next_page;
+    if (!ahead_.empty()) {
+        page = std::max(page, ahead_.back()->index + 1);
+    }
+    for (; page <= index + prefetch_depth_ && page < pages_.size(); ++page) {
+        if (!is_compressed(pages_[page])) {
+            continue;
+        }
+        std::shared_ptr<Prefetched> job(new Prefetched());
+        job->index = page;
+        job->done = false;
+        job->ok = false;
+        ahead_.push_back(job);
+        in_flight_++;
+
+        prefetch_pool_->submit([this, job]() {
+            // Only this task touches job->frame until done is set
+            const bool ok = decode_page(pages_[job->index], job->frame);
+            {
+                std::lock_guard<std::mutex> done_lock(prefetch_mutex_);
+                job->ok = ok;
+                job->done = true;
+                in_flight_--;
+            }
+            prefetch_done_.notify_all();
+        });
+    }
+}
+
+void TiffStackSource::drain_prefetch()
+{
+    std::unique_lock<std::mutex> lock(prefetch_mutex_);
+    prefetch_done_.wait(lock, [this]() { return in_flight_ == 0; });
+    ahead_.clear();
+}
+
+std::string TiffStackSource::description() const
+{
+    std::ostringstream oss;
+    oss << path_ << " (" << pages_.size() << " TIFF pages in " << files_.size() << " files)";
+    return oss.str();
+}
+
+// ============================================================================
+// TiffStackWriter
+// ============================================================================
+
+bool TiffStackWriter::open(const std::string& path, TiffCompression compression,
+                           uint32_t rows_per_strip, bool big_endian)
+{
+    close();
+    compression_ = compression;
+    rows_per_strip_ = rows_per_strip;
+    big_endian_ = big_endian;
+    pages_ = 0;
+
+    out_.open(path, std::ios::binary | std::ios::trunc);
+    if (!out_) {
+        std::cerr << "Failed to open TIFF for writing: " << path << std::endl;
+        return false;
+    }
+
+    std::vector<uint8_t> header;
+    header.push_back(big_endian ? 'M' : 'I');
+    header.push_back(big_endian ? 'M' : 'I');
+    put16(header, 42, big_endian);
+    put32(header, 0, big_endian);   // First IFD, set by the first append
+    out_.write(reinterpret_cast<const char*>(header.data()), header.size());
+    last_ifd_next_ = 4;
+    return static_cast<bool>(out_);
+}
+
+bool TiffStackWriter::append(const Frame& frame)
+{
+    if (!out_.is_open() || frame.width == 0 || frame.height == 0 || !frame.is_valid()) {
+        return false;
+    }
+
+    const uint32_t rows_per_strip = (rows_per_strip_ == 0 || rows_per_strip_ > frame.height)
+                                  ? frame.height : rows_per_strip_;
+    const uint32_t strips = (frame.height + rows_per_strip - 1) / rows_per_strip;
+    std::vector<uint32_t> offsets(strips);
+    std::vector<uint32_t> counts(strips);
+
+    std::vector<uint8_t> raw;
+    std::vector<uint8_t> coded;
+    for (uint32_t s = 0; s < strips; ++s) {
+        const uint32_t first_row = s * rows_per_strip;
+        const uint32_t rows = std::min(rows_per_strip, frame.height - first_row);
+
+        raw.clear();
+        for (uint32_t y = first_row; y < first_row + rows; ++y) {
+            const uint16_t* row = frame.data.data() + size_t(y) * frame.width;
+            for (uint32_t x = 0; x < frame.width; ++x) {
+                const uint16_t value = (compression_ == TiffCompression::DEFLATE && x > 0)
+                                     ? static_cast<uint16_t>(row[x] - row[x - 1]) : row[x];
+                put16(raw, value, big_endian_);
+            }
+        }
+
+        const std::vector<uint8_t>* strip = &raw;
+        if (compression_ == TiffCompression::PACKBITS) {
+            coded.clear();
+            packbits_encode(raw.data(), raw.size(), coded);
+            strip = &coded;
+        }
+        else if (compression_ == TiffCompression::LZW) {
+            coded.clear();
+            lzw_encode(raw.data(), raw.size(), coded);
+            strip = &coded;
+        }
+        else if (compression_ == TiffCompression::DEFLATE) {
+            uLongf size = compressBound(raw.size());
+            coded.resize(size);
+            if (compress2(coded.data(), &size, raw.data(), raw.size(), Z_DEFAULT_COMPRESSION) != Z_OK) {
+                return false;
+            }
+            coded.resize(size);
+            strip = &coded;
+        }
+
+        offsets[s] = static_cast<uint32_t>(out_.tellp());
+        counts[s] = static_cast<uint32_t>(strip->size());
+        out_.write(reinterpret_cast<const char*>(strip->data()), strip->size());
+    }
+
+    // Strip arrays that do not fit in their entries
+    std::vector<uint8_t> block;
+    uint64_t position = static_cast<uint64_t>(out_.tellp());
+    if (position % 2) {
+        block.push_back(0);   // IFDs start on a word boundary
+    }
+    uint32_t offsets_at = offsets[0];
+    uint32_t counts_at = counts[0];
+    if (strips > 1) {
+        offsets_at = static_cast<uint32_t>(position + block.size());
+        for (uint32_t v : offsets) put32(block, v, big_endian_);
+        counts_at = static_cast<uint32_t>(position + block.size());
+        for (uint32_t v : counts) put32(block, v, big_endian_);
+    }
+    const uint64_t ifd_offset = position + block.size();
+    if (ifd_offset > 0xFFFFFFFFull) {
+        std::cerr << "TIFF stack exceeds 4 GB" << std::endl;
+        return false;
+    }
+
+    const uint16_t compression = (compression_ == TiffCompression::PACKBITS) ? COMPRESSION_PACKBITS
+                               : (compression_ == TiffCompression::LZW) ? COMPRESSION_LZW
+                               : (compression_ == TiffCompression::DEFLATE) ? COMPRESSION_DEFLATE
+                               : COMPRESSION_NONE;
+    struct Entry { uint16_t tag; uint16_t type; uint32_t count; uint32_t value; };
+    std::vector<Entry> entries = {
+        {TAG_IMAGE_WIDTH, TYPE_LONG, 1, frame.width},
+        {TAG_IMAGE_LENGTH, TYPE_LONG, 1, frame.height},
+        {TAG_BITS_PER_SAMPLE, TYPE_SHORT, 1, 16},
+        {TAG_COMPRESSION, TYPE_SHORT, 1, compression},
+        {TAG_PHOTOMETRIC, TYPE_SHORT, 1, 1},
+        {TAG_STRIP_OFFSETS, TYPE_LONG, strips, offsets_at},
+        {TAG_SAMPLES_PER_PIXEL, TYPE_SHORT, 1, 1},
+        {TAG_ROWS_PER_STRIP, TYPE_LONG, 1, rows_per_strip},
+        {TAG_STRIP_BYTE_COUNTS, TYPE_LONG, strips, counts_at},
+    };
+    if (compression_ == TiffCompression::DEFLATE) {
+        entries.push_back({TAG_PREDICTOR, TYPE_SHORT, 1, PREDICTOR_HORIZONTAL});
+    }
+
+    put16(block, static_cast<uint16_t>(entries.size()), big_endian_);
+    for (const Entry& entry : entries) {
+        put16(block, entry.tag, big_endian_);
+        put16(block, entry.type, big_endian_);
+        put32(block, entry.count, big_endian_);
+        if (entry.type == TYPE_SHORT) {
+            put16(block, static_cast<uint16_t>(entry.value), big_endian_);
+            put16(block, 0, big_endian_);
+        }
+        else {
+            put32(block, entry.value, big_endian_);
+        }
+    }
+    const uint64_t next_pointer = position + block.size();
+    put32(block, 0, big_endian_);
+    out_.write(reinterpret_cast<const char*>(block.data()), block.size());
+
+    // Link the previous IFD (or the header) to this one
+    std::vector<uint8_t> link;
+    put32(link, static_cast<uint32_t>(ifd_offset), big_endian_);
+    out_.seekp(static_cast<std::streamoff>(last_ifd_next_));
+    out_.write(reinterpret_cast<const char*>(link.data()), link.size());
+    out_.seekp(0, std::ios::end);
+    last_ifd_next_ = next_pointer;
+
+    pages_++;
+    return static_cast<bool>(out_);
+}
+
+bool TiffStackWriter::close()
+{
+    if (!out_.is_open()) {
+        return true;
+    }
+    out_.flush();
+    const bool ok = static_cast<bool>(out_);
+    out_.close();
+    return ok;
+}
+
+} // namespace lwir
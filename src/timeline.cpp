@@ -0,0 +1,61 @@
+/**
+ * @file timeline.cpp
+ * @brief Dropped-frame detection from capture timestamps
+ */
+
+#include "timeline.hpp"
+#include <cmath>
+#include <limits>
+
+namespace lwir {
+
+bool parse_gap_policy(const std::string& name, GapPolicy& policy)
+{
+    if (name == "keyframe") {
+        policy = GapPolicy::KEYFRAME;
+    }
+    else if (name == "widen") {
+        policy = GapPolicy::WIDEN;
+    }
+    else if (name == "ignore") {
+        policy = GapPolicy::IGNORE;
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+uint32_t count_dropped_frames(uint64_t previous, uint64_t current, double frame_period_us)
+{
+    if (frame_period_us <= 0.0 || current <= previous) {
+        return 0;
+    }
+
+    // Jitter up to half a period is still the next frame
+    const double periods = static_cast<double>(current - previous) / frame_period_us;
+    if (periods <= 1.5) {
+        return 0;
+    }
+
+    const double missing = std::floor(periods + 0.5) - 1.0;
+    if (missing >= static_cast<double>(std::numeric_limits<uint32_t>::max())) {
+        return std::numeric_limits<uint32_t>::max();
+    }
+    return static_cast<uint32_t>(missing);
+}
+
+uint32_t GapDetector::observe(uint64_t timestamp)
+{
+    const uint32_t dropped = has_last_ ? count_dropped_frames(last_timestamp_, timestamp, frame_period_us_) : 0;
+    seed(timestamp);
+    return dropped;
+}
+
+void GapDetector::seed(uint64_t timestamp)
+{
+    last_timestamp_ = timestamp;
+    has_last_ = true;
+}
+
+} // namespace lwir
@@ -0,0 +1,85 @@
+/**
+ * @file worker_pool.cpp
+ * @brief Fixed-size worker thread pool implementation
+ */
+
+#include "worker_pool.hpp"
+
+namespace lwir {
+
+WorkerPool::WorkerPool(size_t threads)
+    : active_(0)
+    , stopping_(false)
+{
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    if (threads == 0) {
+        threads = 1;
+    }
+
+    workers_.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        workers_.emplace_back(&WorkerPool::worker_loop, this);
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    task_ready_.notify_all();
+
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+void WorkerPool::submit(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(task));
+    }
+    task_ready_.notify_one();
+}
+
+void WorkerPool::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    all_done_.wait(lock, [this]() { return tasks_.empty() && active_ == 0; });
+}
+
+void WorkerPool::worker_loop()
+{
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            task_ready_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+
+            // Drain the queue before honouring a stop request
+            if (tasks_.empty()) {
+                return;
+            }
+
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+            active_++;
+        }
+
+        task();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            active_--;
+            if (tasks_.empty() && active_ == 0) {
+                all_done_.notify_all();
+            }
+        }
+    }
+}
+
+} // namespace lwir
@@ -0,0 +1,140 @@
+/**
+ * @file test_archive.cpp
+ * @brief Archive index: matches the record headers, survives resumes and crashes
+ */
+
+#include <gtest/gtest.h>
+#include "archive.hpp"
+#include "pipeline.hpp"
+#include "test_util.hpp"
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace lwir {
+namespace {
+
+void expect_same_entry(const ArchiveEntry& a, const ArchiveEntry& b)
+{
+    EXPECT_EQ(a.header.frame_index, b.header.frame_index);
+    EXPECT_EQ(a.header.width, b.header.width);
+    EXPECT_EQ(a.header.height, b.header.height);
+    EXPECT_EQ(a.header.timestamp, b.header.timestamp);
+    EXPECT_EQ(a.header.is_keyframe, b.header.is_keyframe);
+    EXPECT_EQ(a.header.near_lossless, b.header.near_lossless);
+    EXPECT_EQ(a.header.quant_Q, b.header.quant_Q);
+    EXPECT_EQ(a.header.dead_zone_T, b.header.dead_zone_T);
+    EXPECT_EQ(a.header.use_range_map, b.header.use_range_map);
+    EXPECT_EQ(a.payload_size, b.payload_size);
+}
+
+CompressedFrame header_only(uint32_t frame_index, size_t payload_size)
+{
+    CompressedFrame frame;
+    frame.width = 40;
+    frame.height = 32;
+    frame.frame_index = frame_index;
+    frame.timestamp = frame_index * 33333ull;
+    frame.is_keyframe = (frame_index == 0);
+    frame.compressed_data.assign(payload_size, 0);
+    return frame;
+}
+
+class ArchiveTest : public test::TempDirTest {
+protected:
+    std::string index_path() const { return dir_ + "/" + ARCHIVE_INDEX_FILE; }
+};
+
+TEST_F(ArchiveTest, PipelineIndexMatchesRecordHeaders)
+{
+    CompressionConfig config;
+    config.gop_period = 4;
+    config.frame_deadline_ms = 0.0;
+    config.decision_hysteresis_bpp = 0.0;
+    config.verbose = false;
+    config.sync_writes = false;
+    config.output_dir = dir_;
+
+    const std::vector<Frame> frames = test::make_sequence(40, 32, 10, 31);
+    {
+        CompressionPipeline pipeline(config);
+        for (const Frame& frame : frames) {
+            ASSERT_TRUE(pipeline.process_frame(frame, DeadlineMonitor::Clock::now()));
+        }
+    }
+
+    std::vector<ArchiveEntry> indexed;
+    std::vector<ArchiveEntry> scanned;
+    ASSERT_TRUE(read_archive_index(index_path(), indexed));
+    ASSERT_TRUE(scan_archive_headers(dir_, scanned));
+    EXPECT_EQ(count_frame_records(dir_), frames.size());
+    ASSERT_EQ(indexed.size(), frames.size());
+    ASSERT_EQ(scanned.size(), frames.size());
+
+    for (size_t i = 0; i < frames.size(); ++i) {
+        EXPECT_EQ(indexed[i].header.frame_index, i);
+        expect_same_entry(indexed[i], scanned[i]);
+    }
+    EXPECT_TRUE(indexed[0].header.is_keyframe);
+    EXPECT_TRUE(indexed[4].header.is_keyframe);
+}
+
+TEST_F(ArchiveTest, LaterEntryWinsAndPartialEntryIsTrimmed)
+{
+    {
+        ArchiveIndexWriter writer;
+        ASSERT_TRUE(writer.append(index_path(), header_only(0, 100)));
+        ASSERT_TRUE(writer.append(index_path(), header_only(1, 20)));
+        ASSERT_TRUE(writer.append(index_path(), header_only(2, 30)));
+        ASSERT_TRUE(writer.append(index_path(), header_only(1, 25)));   // Encoded again after a resume
+    }
+
+    // Crash in the middle of an append
+    {
+        std::ofstream ofs(index_path(), std::ios::binary | std::ios::app);
+        const char partial[17] = {};
+        ofs.write(partial, sizeof(partial));
+    }
+
+    std::vector<ArchiveEntry> entries;
+    ASSERT_TRUE(read_archive_index(index_path(), entries));
+    ASSERT_EQ(entries.size(), 3u);
+    EXPECT_EQ(entries[1].header.frame_index, 1u);
+    EXPECT_EQ(entries[1].payload_size, 25u);
+
+    // Appending after the crash keeps entries aligned
+    {
+        ArchiveIndexWriter writer;
+        ASSERT_TRUE(writer.append(index_path(), header_only(3, 40)));
+    }
+    ASSERT_TRUE(read_archive_index(index_path(), entries));
+    ASSERT_EQ(entries.size(), 4u);
+    EXPECT_EQ(entries[3].header.frame_index, 3u);
+    EXPECT_EQ(entries[3].payload_size, 40u);
+    EXPECT_EQ(entries[3].header.timestamp, 3 * 33333ull);
+}
+
+TEST_F(ArchiveTest, RebuiltIndexRoundTrips)
+{
+    std::vector<ArchiveEntry> entries(5);
+    for (uint32_t i = 0; i < entries.size(); ++i) {
+        entries[i].header = header_only(i * 2, 0);   // Every other frame missing
+        entries[i].payload_size = 10 + i;
+    }
+    ASSERT_TRUE(write_archive_index(index_path(), entries));
+
+    std::vector<ArchiveEntry> loaded;
+    ASSERT_TRUE(read_archive_index(index_path(), loaded));
+    ASSERT_EQ(loaded.size(), entries.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        expect_same_entry(loaded[i], entries[i]);
+    }
+
+    // Not an index
+    std::ofstream(dir_ + "/other.bin") << "not an index";
+    EXPECT_FALSE(read_archive_index(dir_ + "/other.bin", loaded));
+    EXPECT_FALSE(read_archive_index(dir_ + "/missing.lwidx", loaded));
+}
+
+} // anonymous namespace
+} // namespace lwir
@@ -0,0 +1,170 @@
+/**
+ * @file test_batch.cpp
+ * @brief Sharded batch compression: shard planning, worker retries, merge
+ */
+
+#include <gtest/gtest.h>
+#include "batch.hpp"
+#include "frame_format.hpp"
+#include "pipeline.hpp"
+#include "test_util.hpp"
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+namespace lwir {
+namespace {
+
+using BatchTest = test::TempDirTest;
+
+TEST(PlanShardsTest, ShardsAreWholeGops)
+{
+    const std::vector<ShardRange> plan = plan_shards(1000, 60, 4);   // 17 GOPs: 5 + 5 + 5 + 2
+    ASSERT_EQ(plan.size(), 4u);
+    for (size_t i = 0; i < plan.size(); ++i) {
+        EXPECT_EQ(plan[i].first, i * 300);
+        EXPECT_EQ(plan[i].count, i + 1 < plan.size() ? 300u : 100u);
+    }
+
+    // Fewer GOPs than shards: one GOP each
+    const std::vector<ShardRange> short_plan = plan_shards(100, 60, 32);
+    ASSERT_EQ(short_plan.size(), 2u);
+    EXPECT_EQ(short_plan[1].first, 60u);
+    EXPECT_EQ(short_plan[1].count, 40u);
+
+    EXPECT_TRUE(plan_shards(0, 60, 4).empty());
+    EXPECT_EQ(plan_shards(10, 60, 0).size(), 1u);
+}
+
+TEST(ShardTimelineTest, GapAtTheShardBoundaryIsCounted)
+{
+    // Two frames dropped just before frame 8, where the second shard starts
+    const uint64_t period_us = 33333;
+    std::vector<Frame> frames = test::make_sequence(32, 24, 16, 17);
+    for (size_t i = 0; i < frames.size(); ++i) {
+        frames[i].timestamp = (i < 8 ? i : i + 2) * period_us;
+    }
+
+    CompressionConfig config = test::lossless_config();
+    config.gop_period = 8;
+    config.frame_period_us = static_cast<double>(period_us);
+    config.frame_range_first = 8;
+    config.frame_range_count = 8;
+    config.dry_run = true;
+    config.verbose = false;
+
+    CompressionPipeline pipeline(config);
+    MemoryFrameSource source(frames);
+    ASSERT_TRUE(pipeline.run(source));
+    EXPECT_EQ(pipeline.session_stats().total_frames, 8u);
+    EXPECT_EQ(pipeline.session_stats().timestamp_gaps, 1u);
+    EXPECT_EQ(pipeline.session_stats().frames_dropped, 2u);
+}
+
+TEST_F(BatchTest, CoordinatorRetriesOnlyTheFailedShard)
+{
+    // Worker stand-in: shard "4:4" fails on its first attempt; every attempt is counted in <dir>.runs
+    const std::string script =
+        "echo run >> \"$4.runs\"; "
+        "if [ \"$2\" = 4:4 ] && [ $(wc -l < \"$4.runs\") -eq 1 ]; then exit 3; fi; "
+        "mkdir -p \"$4\" && echo \"$2\" > \"$4/range\"";
+    const std::vector<std::string> command = {"/bin/sh", "-c", script, "worker"};
+    const std::vector<ShardRange> shards = plan_shards(10, 2, 3);   // 0:4, 4:4, 8:2
+    ASSERT_EQ(shards.size(), 3u);
+
+    ShardCoordinator coordinator(command, dir_ + "/shards", 2, 1);
+    std::vector<ShardResult> results;
+    ASSERT_TRUE(coordinator.run(shards, results));
+    ASSERT_EQ(results.size(), 3u);
+    for (size_t i = 0; i < results.size(); ++i) {
+        EXPECT_TRUE(results[i].ok);
+        EXPECT_EQ(results[i].attempts, i == 1 ? 2u : 1u);
+        EXPECT_EQ(results[i].output_dir, coordinator.shard_dir(i));
+        std::string range;
+        std::ifstream(results[i].output_dir + "/range") >> range;
+        EXPECT_EQ(range, std::to_string(shards[i].first) + ":" + std::to_string(shards[i].count));
+    }
+
+    // A shard that always fails uses up its retries; the batch fails
+    const std::vector<std::string> failing = {"/bin/sh", "-c", "exit 1", "worker"};
+    ShardCoordinator broken(failing, dir_ + "/broken", 4, 2);
+    ASSERT_FALSE(broken.run({ShardRange(0, 4)}, results));
+    EXPECT_FALSE(results[0].ok);
+    EXPECT_EQ(results[0].attempts, 3u);
+}
+
+TEST_F(BatchTest, ShardsMergeIntoOneIndexedSegment)
+{
+    const std::vector<Frame> frames = test::make_sequence(32, 24, 30, 91);
+    const std::vector<ShardRange> shards = plan_shards(frames.size(), 8, 4);   // 0:8, 8:8, 16:8, 24:6
+    ASSERT_EQ(shards.size(), 4u);
+
+    // Each shard encoded on its own, as a worker would; the second one segmented
+    std::vector<std::string> shard_dirs;
+    for (size_t s = 0; s < shards.size(); ++s) {
+        CompressionConfig config;
+        config.output_dir = dir_ + "/shard_" + std::to_string(s);
+        config.gop_period = 8;
+        config.frame_range_first = shards[s].first;
+        config.frame_range_count = shards[s].count;
+        config.segment_gops = (s == 1) ? 1 : 0;
+        config.frame_deadline_ms = 0.0;
+        config.verbose = false;
+        ASSERT_TRUE(config.validate_parameters());
+
+        CompressionPipeline pipeline(config);
+        MemoryFrameSource source(frames);
+        ASSERT_TRUE(pipeline.run(source));
+        shard_dirs.push_back(config.output_dir);
+    }
+    std::vector<uint8_t> first_shard_record;
+    {
+        std::ifstream file(shard_dirs[0] + "/" + frame_file_name(5), std::ios::binary);
+        first_shard_record.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    CompressedFrame expected;
+    ASSERT_TRUE(read_frame_record(first_shard_record.data(), first_shard_record.size(), expected));
+
+    const std::string merged = dir_ + "/merged";
+    ASSERT_EQ(::mkdir(merged.c_str(), 0755), 0);
+    uint64_t written = 0;
+    ASSERT_TRUE(merge_archives(shard_dirs, merged, SegmentLimits(), &written));
+    EXPECT_EQ(written, frames.size());
+
+    SegmentReader reader;
+    ASSERT_TRUE(reader.open(merged));
+    ASSERT_EQ(reader.segments().size(), 1u);
+    const SegmentInfo& segment = reader.segments()[0];
+    EXPECT_TRUE(segment.complete);
+    EXPECT_EQ(segment.first_frame, 0u);
+    EXPECT_EQ(segment.last_frame, 29u);
+    EXPECT_EQ(segment.frame_count, 30u);
+
+    // One index for every frame; each shard starts with a keyframe
+    std::vector<ArchiveEntry> entries;
+    ASSERT_TRUE(reader.read_entries(0, entries));
+    ASSERT_EQ(entries.size(), frames.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        EXPECT_EQ(entries[i].header.frame_index, i);
+    }
+    for (const ShardRange& shard : shards) {
+        EXPECT_TRUE(entries[shard.first].header.is_keyframe) << "frame " << shard.first;
+    }
+
+    // Records are copied, not re-encoded
+    CompressedFrame copied;
+    ASSERT_TRUE(reader.read_frame(5, copied));
+    EXPECT_TRUE(copied.compressed_data == expected.compressed_data);
+    EXPECT_EQ(copied.is_keyframe, expected.is_keyframe);
+
+    // Never merged on top of an existing archive, nor out of order
+    EXPECT_FALSE(merge_archives(shard_dirs, merged, SegmentLimits()));
+    const std::string reversed = dir_ + "/reversed";
+    ASSERT_EQ(::mkdir(reversed.c_str(), 0755), 0);
+    EXPECT_FALSE(merge_archives({shard_dirs[1], shard_dirs[0]}, reversed, SegmentLimits()));
+}
+
+} // anonymous namespace
+} // namespace lwir
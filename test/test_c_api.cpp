@@ -0,0 +1,177 @@
+/**
+ * @file test_c_api.cpp
+ * @brief C ABI: round trip through caller buffers, status codes
+ */
+
+#include <gtest/gtest.h>
+#include "lwir_c.h"
+#include "test_util.hpp"
+#include <vector>
+
+namespace lwir {
+namespace {
+
+TEST(CApi, StridedRoundTripThroughCallerBuffers)
+{
+    const std::vector<Frame> frames = test::make_sequence(40, 30, 8, 5, 0);
+
+    lwir_config config;
+    lwir_config_init(&config);
+    config.gop_period = 4;
+    config.residual_near = 0;
+    config.dead_zone_T = 0;
+    config.quant_Q = 1.0;
+
+    lwir_encoder* enc = nullptr;
+    lwir_decoder* dec = nullptr;
+    ASSERT_EQ(lwir_encoder_create(&config, &enc), LWIR_OK);
+    ASSERT_EQ(lwir_decoder_create(&dec), LWIR_OK);
+
+    const size_t stride = 48;   // Samples per row, 8 of padding
+    std::vector<uint16_t> input(stride * 30, 0xFFFF);
+    std::vector<uint16_t> output(stride * 30, 0);
+    std::vector<uint8_t> record(lwir_record_bound(40, 30));
+
+    for (size_t i = 0; i < frames.size(); ++i) {
+        for (uint32_t y = 0; y < 30; ++y) {
+            std::copy(frames[i].data.begin() + y * 40, frames[i].data.begin() + (y + 1) * 40,
+                      input.begin() + y * stride);
+        }
+
+        size_t written = 0;
+        lwir_frame_info info;
+        ASSERT_EQ(lwir_encoder_encode(enc, input.data(), 40, 30, stride * 2, 1000 + i,
+                                      record.data(), record.size(), &written, &info), LWIR_OK);
+        EXPECT_EQ(info.frame_index, i);
+        EXPECT_EQ(info.record_bytes, written);
+
+        lwir_frame_info peek;
+        ASSERT_EQ(lwir_peek(record.data(), written, &peek), LWIR_OK);
+        EXPECT_EQ(peek.timestamp, 1000 + i);
+        EXPECT_EQ(peek.is_keyframe, info.is_keyframe);
+
+        ASSERT_EQ(lwir_decoder_decode(dec, record.data(), written,
+                                      output.data(), stride * 2, output.size() * 2, nullptr), LWIR_OK);
+        for (uint32_t y = 0; y < 30; ++y) {
+            ASSERT_TRUE(std::equal(output.begin() + y * stride, output.begin() + y * stride + 40,
+                                   frames[i].data.begin() + y * 40)) << "frame " << i << " row " << y;
+        }
+    }
+
+    lwir_encoder_destroy(enc);
+    lwir_decoder_destroy(dec);
+}
+
+TEST(CApi, ContiguousRoundTrip)
+{
+    const std::vector<Frame> frames = test::make_sequence(40, 30, 6, 9, 0);
+
+    lwir_config config;
+    lwir_config_init(&config);
+    EXPECT_EQ(config.frame_deadline_ms, 0.0);
+    config.gop_period = 3;
+    config.residual_near = 0;
+    config.dead_zone_T = 0;
+    config.quant_Q = 1.0;
+
+    lwir_encoder* enc = nullptr;
+    lwir_decoder* dec = nullptr;
+    ASSERT_EQ(lwir_encoder_create(&config, &enc), LWIR_OK);
+    ASSERT_EQ(lwir_decoder_create(&dec), LWIR_OK);
+
+    std::vector<uint8_t> record(lwir_record_bound(40, 30));
+    std::vector<uint16_t> output(40 * 30);
+    for (size_t i = 0; i < frames.size(); ++i) {
+        size_t written = 0;
+        ASSERT_EQ(lwir_encoder_encode(enc, frames[i].data.data(), 40, 30, 40 * 2, i,
+                                      record.data(), record.size(), &written, nullptr), LWIR_OK);
+        ASSERT_EQ(lwir_decoder_decode(dec, record.data(), written,
+                                      output.data(), 40 * 2, output.size() * 2, nullptr), LWIR_OK);
+        EXPECT_TRUE(output == frames[i].data) << "frame " << i;
+    }
+
+    lwir_encoder_destroy(enc);
+    lwir_decoder_destroy(dec);
+}
+
+TEST(CApi, FlagsRepeatFrames)
+{
+    lwir_encoder* enc = nullptr;
+    ASSERT_EQ(lwir_encoder_create_from_yaml("gop_period: 10\ndecision_hysteresis_bpp: 0\ndetect_repeats: true\n",
+                                            nullptr, &enc), LWIR_OK);
+    lwir_decoder* dec = nullptr;
+    ASSERT_EQ(lwir_decoder_create(&dec), LWIR_OK);
+
+    const std::vector<Frame> frames = test::make_sequence(40, 30, 1, 3, 0);
+    std::vector<uint8_t> record(lwir_record_bound(40, 30));
+    std::vector<uint16_t> output(40 * 30);
+    for (int i = 0; i < 2; ++i) {
+        size_t written = 0;
+        lwir_frame_info info;
+        ASSERT_EQ(lwir_encoder_encode(enc, frames[0].data.data(), 40, 30, 40 * 2, i,
+                                      record.data(), record.size(), &written, &info), LWIR_OK);
+        EXPECT_EQ(info.is_repeat, i);
+        if (i == 1) {
+            EXPECT_EQ(info.payload_bytes, 0u);
+        }
+
+        lwir_frame_info decoded;
+        ASSERT_EQ(lwir_decoder_decode(dec, record.data(), written,
+                                      output.data(), 40 * 2, output.size() * 2, &decoded), LWIR_OK);
+        EXPECT_EQ(decoded.is_repeat, i);
+        EXPECT_TRUE(output == frames[0].data);
+    }
+
+    lwir_encoder_destroy(enc);
+    lwir_decoder_destroy(dec);
+}
+
+TEST(CApi, ReportsErrors)
+{
+    lwir_config config;
+    lwir_config_init(&config);
+    config.quant_Q = 0.0;
+    lwir_encoder* enc = nullptr;
+    EXPECT_EQ(lwir_encoder_create(&config, &enc), LWIR_ERROR_INVALID_CONFIG);
+    EXPECT_EQ(enc, nullptr);
+
+    EXPECT_EQ(lwir_encoder_create_from_yaml("gop_period: [", nullptr, &enc), LWIR_ERROR_INVALID_CONFIG);
+    ASSERT_EQ(lwir_encoder_create_from_yaml("gop_period: 10\nquant_Q: 1.5\ndecision_hysteresis_bpp: 0\n",
+                                            nullptr, &enc), LWIR_OK);
+
+    // Static texture: expensive as intra, free as a residual
+    std::vector<uint16_t> pixels(16 * 16);
+    for (size_t i = 0; i < pixels.size(); ++i) {
+        pixels[i] = static_cast<uint16_t>(1000 + (i * 37) % 701);
+    }
+    std::vector<uint8_t> small(64);
+    size_t written = 0;
+    EXPECT_EQ(lwir_encoder_encode(enc, pixels.data(), 16, 16, 16, 0, small.data(), small.size(),
+                                  &written, nullptr), LWIR_ERROR_INVALID_ARGUMENT);   // Stride < row
+    EXPECT_EQ(lwir_encoder_encode(enc, pixels.data(), 16, 16, 32, 0, small.data(), small.size(),
+                                  &written, nullptr), LWIR_ERROR_BUFFER_TOO_SMALL);
+
+    // A residual record without its keyframe
+    std::vector<uint8_t> record(lwir_record_bound(16, 16));
+    lwir_frame_info info;
+    ASSERT_EQ(lwir_encoder_encode(enc, pixels.data(), 16, 16, 32, 0, record.data(), record.size(),
+                                  &written, &info), LWIR_OK);
+    ASSERT_EQ(lwir_encoder_encode(enc, pixels.data(), 16, 16, 32, 1, record.data(), record.size(),
+                                  &written, &info), LWIR_OK);
+    ASSERT_EQ(info.is_keyframe, 0);
+
+    lwir_decoder* dec = nullptr;
+    ASSERT_EQ(lwir_decoder_create(&dec), LWIR_OK);
+    EXPECT_EQ(lwir_decoder_decode(dec, record.data(), written, pixels.data(), 32, pixels.size() * 2, nullptr),
+              LWIR_ERROR_NO_REFERENCE);
+    EXPECT_EQ(lwir_decoder_decode(dec, record.data(), 20, pixels.data(), 32, pixels.size() * 2, nullptr),
+              LWIR_ERROR_TRUNCATED);
+
+    EXPECT_STREQ(lwir_status_string(LWIR_ERROR_TRUNCATED), "truncated record");
+
+    lwir_decoder_destroy(dec);
+    lwir_encoder_destroy(enc);
+}
+
+} // anonymous namespace
+} // namespace lwir
@@ -0,0 +1,147 @@
+/**
+ * @file test_checkpoint.cpp
+ * @brief Checkpoint/restore: a resumed session produces the same bitstream
+ */
+
+#include <gtest/gtest.h>
+#include "checkpoint.hpp"
+#include "frame_format.hpp"
+#include "pipeline.hpp"
+#include "test_util.hpp"
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+namespace lwir {
+namespace {
+
+CompressionConfig session_config()
+{
+    CompressionConfig config;
+    config.gop_period = 5;
+    config.keyframe_near = 0;
+    config.residual_near = 0;
+    config.dead_zone_T = 0;
+    config.quant_Q = 1.0;
+    config.frame_deadline_ms = 0.0;
+    config.decision_hysteresis_bpp = 0.0;   // Small frames: keep the GOP structure (keyframes 0, 5, 10)
+    config.verbose = false;
+    config.dry_run = true;
+    return config;
+}
+
+// Uninterrupted reference session
+std::vector<CompressedFrame> encode_all(const std::vector<Frame>& frames)
+{
+    std::vector<CompressedFrame> encoded;
+    CompressionPipeline pipeline(session_config());
+    pipeline.set_frame_sink([&](const CompressedFrame& frame, const FrameStats&) {
+        encoded.push_back(frame);
+        return true;
+    });
+    for (const Frame& frame : frames) {
+        EXPECT_TRUE(pipeline.process_frame(frame, DeadlineMonitor::Clock::now()));
+    }
+    return encoded;
+}
+
+std::vector<uint8_t> read_file(const std::string& path)
+{
+    std::ifstream ifs(path, std::ios::binary);
+    return std::vector<uint8_t>((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+}
+
+using CheckpointTest = test::TempDirTest;
+
+TEST_F(CheckpointTest, OnDemandSnapshotContinuesMidGop)
+{
+    const std::vector<Frame> frames = test::make_sequence(40, 32, 12, 11);
+    const std::vector<CompressedFrame> expected = encode_all(frames);
+    const std::string path = dir_ + "/encoder.ckpt";
+
+    {
+        CompressionPipeline first(session_config());
+        for (size_t i = 0; i < 7; ++i) {
+            ASSERT_TRUE(first.process_frame(frames[i], DeadlineMonitor::Clock::now()));
+        }
+        ASSERT_TRUE(first.save_checkpoint(path));
+    }
+
+    std::vector<CompressedFrame> resumed;
+    CompressionPipeline second(session_config());
+    second.set_frame_sink([&](const CompressedFrame& frame, const FrameStats&) {
+        resumed.push_back(frame);
+        return true;
+    });
+    ASSERT_TRUE(second.restore_checkpoint(path));
+    ASSERT_EQ(second.resume_frame_index(), 7u);
+    for (size_t i = 7; i < frames.size(); ++i) {
+        ASSERT_TRUE(second.process_frame(frames[i], DeadlineMonitor::Clock::now()));
+    }
+
+    // No keyframe is forced: the same records as the uninterrupted session
+    ASSERT_EQ(resumed.size(), frames.size() - 7);
+    EXPECT_FALSE(resumed[0].is_keyframe);
+    for (size_t i = 0; i < resumed.size(); ++i) {
+        EXPECT_EQ(resumed[i].is_keyframe, expected[7 + i].is_keyframe) << "frame " << 7 + i;
+        EXPECT_TRUE(resumed[i].compressed_data == expected[7 + i].compressed_data) << "frame " << 7 + i;
+    }
+}
+
+TEST_F(CheckpointTest, KeyframeSnapshotRollsForwardOverWrittenFrames)
+{
+    const std::vector<Frame> frames = test::make_sequence(40, 32, 12, 13);
+    const std::vector<CompressedFrame> expected = encode_all(frames);
+
+    CompressionConfig config = session_config();
+    config.dry_run = false;
+    config.output_dir = dir_ + "/out";
+    config.checkpoint_path = dir_ + "/encoder.ckpt";
+
+    {
+        CompressionPipeline first(config);
+        for (size_t i = 0; i < 9; ++i) {
+            ASSERT_TRUE(first.process_frame(frames[i], DeadlineMonitor::Clock::now()));
+        }
+    }
+
+    // The crash cut the last record short: it must be encoded again
+    const std::string last = config.output_dir + "/" + frame_file_name(8);
+    ASSERT_EQ(::truncate(last.c_str(), 20), 0);
+
+    CompressionPipeline second(config);
+    ASSERT_TRUE(second.restore_checkpoint(config.checkpoint_path));
+    EXPECT_EQ(second.resume_frame_index(), 8u);
+    for (size_t i = second.resume_frame_index(); i < frames.size(); ++i) {
+        ASSERT_TRUE(second.process_frame(frames[i], DeadlineMonitor::Clock::now()));
+    }
+
+    // Files on disk form one decodable stream, identical to the uninterrupted session
+    FrameEncoder decoder;
+    for (size_t i = 0; i < frames.size(); ++i) {
+        const std::vector<uint8_t> bytes = read_file(config.output_dir + "/" + frame_file_name(i));
+        CompressedFrame record;
+        ASSERT_TRUE(read_frame_record(bytes.data(), bytes.size(), record)) << "frame " << i;
+        EXPECT_TRUE(record.compressed_data == expected[i].compressed_data) << "frame " << i;
+
+        Frame decoded;
+        ASSERT_TRUE(decoder.decode_frame(record, decoded)) << "frame " << i;
+        EXPECT_TRUE(decoded.data == frames[i].data) << "frame " << i;
+    }
+}
+
+TEST_F(CheckpointTest, RejectsMissingOrCorruptFile)
+{
+    CompressionPipeline pipeline(session_config());
+    EXPECT_FALSE(pipeline.restore_checkpoint(dir_ + "/missing.ckpt"));
+
+    std::ofstream(dir_ + "/bad.ckpt") << "LWCK";
+    EXPECT_FALSE(pipeline.restore_checkpoint(dir_ + "/bad.ckpt"));
+    EXPECT_EQ(pipeline.resume_frame_index(), 0u);
+}
+
+} // anonymous namespace
+} // namespace lwir
@@ -0,0 +1,143 @@
+/**
+ * @file test_config_reload.cpp
+ * @brief Hot reload: frame/GOP boundaries, rejected files, file watching
+ */
+
+#include <gtest/gtest.h>
+#include "config_reload.hpp"
+#include "pipeline.hpp"
+#include "test_util.hpp"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+namespace lwir {
+namespace {
+
+class ConfigReloadTest : public ::testing::Test {
+protected:
+    std::string path_;
+
+    void SetUp() override
+    {
+        path_ = "/tmp/lwir_reload_test_" + std::to_string(::getpid()) + ".yaml";
+    }
+
+    void TearDown() override
+    {
+        std::remove(path_.c_str());
+    }
+
+    void write_config(double quant_Q, uint32_t keyframe_near)
+    {
+        // Write then rename, as editors do (one inotify event, never a partial file)
+        const std::string tmp = path_ + ".tmp";
+        std::ofstream ofs(tmp);
+        ofs << "gop_period: 4\n"
+            << "residual_near: 0\n"
+            << "dead_zone_T: 0\n"
+            << "quant_Q: " << quant_Q << "\n"
+            << "keyframe_near: " << keyframe_near << "\n"
+            << "frame_deadline_ms: 0\n"
+            << "verbose: false\n";
+        ofs.close();
+        std::rename(tmp.c_str(), path_.c_str());
+    }
+
+    static bool wait_until(const std::function<bool()>& done)
+    {
+        for (int i = 0; i < 500 && !done(); ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return done();
+    }
+};
+
+TEST_F(ConfigReloadTest, AppliesAtFrameAndGopBoundaries)
+{
+    write_config(1.0, 0);
+    CompressionConfig config;
+    ASSERT_TRUE(config.load_from_string("gop_period: 4\nresidual_near: 0\ndead_zone_T: 0\n"
+                                        "quant_Q: 1.0\nframe_deadline_ms: 0\nverbose: false\n"));
+
+    std::vector<CompressedFrame> encoded;
+    CompressionPipeline pipeline(config);
+    pipeline.set_frame_sink([&](const CompressedFrame& frame, const FrameStats&) {
+        encoded.push_back(frame);
+        return true;
+    });
+
+    ConfigReloader reloader(path_, "");
+    ASSERT_TRUE(reloader.start(false));
+    pipeline.set_config_reloader(&reloader);
+
+    const std::vector<Frame> frames = test::make_sequence(32, 24, 12, 3);
+    for (size_t i = 0; i < 6; ++i) {
+        ASSERT_TRUE(pipeline.process_frame(frames[i], DeadlineMonitor::Clock::now()));
+    }
+
+    write_config(3.0, 2);
+    reloader.request_reload();
+    ASSERT_TRUE(wait_until([&]() { return reloader.reloads() == 1; }));
+
+    for (size_t i = 6; i < frames.size(); ++i) {
+        ASSERT_TRUE(pipeline.process_frame(frames[i], DeadlineMonitor::Clock::now()));
+    }
+    ASSERT_EQ(encoded.size(), frames.size());
+
+    // Q applies from the next frame; keyframe NEAR only from the next keyframe
+    bool saw_new_keyframe = false;
+    for (size_t i = 0; i < encoded.size(); ++i) {
+        const CompressedFrame& f = encoded[i];
+        if (f.is_keyframe) {
+            EXPECT_EQ(f.near_lossless, i < 6 ? 0u : 2u) << "frame " << i;
+            saw_new_keyframe = saw_new_keyframe || i >= 6;
+        } else {
+            EXPECT_DOUBLE_EQ(f.quant_Q, i < 6 ? 1.0 : 3.0) << "frame " << i;
+        }
+    }
+    EXPECT_TRUE(saw_new_keyframe);
+    EXPECT_EQ(pipeline.config().keyframe_near, 2u);
+}
+
+TEST_F(ConfigReloadTest, KeepsRunningConfigWhenFileIsInvalid)
+{
+    write_config(1.0, 0);
+    ConfigReloader reloader(path_, "");
+    ASSERT_TRUE(reloader.start(false));
+
+    {
+        std::ofstream ofs(path_);
+        ofs << "quant_Q: -1\n";
+    }
+    reloader.request_reload();
+    ASSERT_TRUE(wait_until([&]() { return reloader.rejected() == 1; }));
+
+    CompressionConfig config;
+    EXPECT_FALSE(reloader.take(config));
+    EXPECT_EQ(reloader.reloads(), 0u);
+}
+
+#ifdef __linux__
+TEST_F(ConfigReloadTest, ReloadsWhenWatchedFileChanges)
+{
+    write_config(1.0, 0);
+    ConfigReloader reloader(path_, "");
+    ASSERT_TRUE(reloader.start(true));
+
+    write_config(2.5, 0);
+    ASSERT_TRUE(wait_until([&]() { return reloader.reloads() >= 1; }));
+
+    CompressionConfig config;
+    ASSERT_TRUE(reloader.take(config));
+    EXPECT_DOUBLE_EQ(config.quant_Q, 2.5);
+}
+#endif
+
+} // anonymous namespace
+} // namespace lwir
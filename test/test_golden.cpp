@@ -0,0 +1,276 @@
+/**
+ * @file test_golden.cpp
+ * @brief Golden-bitstream regression tests
+ *
+ * Fixed synthetic inputs are encoded with fixed settings and compared, frame
+ * by frame, against recorded hashes. There are two sets of golden files.
+ *
+ * test/golden/<case>.txt holds what lwir hands to JPEG-LS and what it
+ * reconstructs, for the NEAR=0 cases:
+ *
+ *   # frame kind bits plane_hash recon_hash
+ *   0 K 12 3f0c2a9d81e47b66 9a8e0d6c2b1f4e37
+ *
+ * plane_hash is FNV-1a over the plane given to CharLS, recon_hash over the
+ * encoder's reconstruction (both little-endian samples). Neither depends on
+ * the CharLS build, so these files are checked by every build.
+ *
+ * test/golden/<codec>/<case>.txt holds the JPEG-LS payloads for all cases,
+ * including the NEAR>0 ones, whose reconstruction is the decoded payload:
+ *
+ *   # frame kind bytes payload_hash recon_hash
+ *   0 K 10571 5b1e7a0c4d2f9e81 9a8e0d6c2b1f4e37
+ *
+ * <codec> is jpegls_codec_version() (e.g. "charls-2.4.2"): payloads differ
+ * between CharLS releases, so each release has its own directory. A
+ * versioned CharLS build fails if its directory is missing. Builds whose
+ * CharLS reports no version skip these checks and cannot record them.
+ *
+ * Re-record on purpose with
+ *
+ *   LWIR_UPDATE_GOLDEN=1 ./lwir_tests --gtest_filter='Golden*'
+ *
+ * This rewrites the golden files in full. Review the diff and commit it.
+ * A missing golden file is a failure, not a skip.
+ */
+
+#include <gtest/gtest.h>
+#include "encoder.hpp"
+#include "test_util.hpp"
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+#ifndef LWIR_GOLDEN_DIR
+#define LWIR_GOLDEN_DIR "golden"
+#endif
+
+namespace lwir {
+namespace {
+
+const char* const kUnversionedCodec = "charls-unversioned";
+
+struct GoldenCase {
+    const char* name;
+    uint32_t keyframe_near;
+    uint32_t residual_near;
+    uint32_t dead_zone_T;
+    double quant_Q;
+    bool map12;
+    uint32_t gop;
+};
+
+std::ostream& operator<<(std::ostream& os, const GoldenCase& c)
+{
+    return os << c.name;
+}
+
+/**
+ * One line of a golden file: frame, kind and three further columns
+ * (bits/plane_hash/recon_hash or bytes/payload_hash/recon_hash)
+ */
+struct GoldenRecord {
+    uint32_t frame;
+    char kind;
+    std::string a;
+    std::string b;
+    std::string recon_hash;
+};
+
+std::string hex64(uint64_t value)
+{
+    std::ostringstream oss;
+    oss << std::hex << std::setw(16) << std::setfill('0') << value;
+    return oss.str();
+}
+
+bool update_requested()
+{
+    const char* update = std::getenv("LWIR_UPDATE_GOLDEN");
+    return update && std::string(update) == "1";
+}
+
+// 20 frames with an FFC event at frame 12
+std::vector<Frame> golden_input()
+{
+    return test::make_sequence(80, 64, 20, 2024, 12);
+}
+
+/**
+ * Planes handed to CharLS and reconstructions (NEAR=0 cases only)
+ */
+std::vector<GoldenRecord> prepare_case(const GoldenCase& c)
+{
+    const std::vector<Frame> frames = golden_input();
+
+    FrameEncoder encoder;
+    encoder.set_verify_decode(false);
+    const QuantizationParams quant(c.dead_zone_T, c.quant_Q, 8);
+    std::vector<GoldenRecord> records;
+
+    for (size_t i = 0; i < frames.size(); ++i) {
+        const bool is_keyframe = (i % c.gop) == 0;
+        PreparedFrame prepared;
+        if (!encoder.prepare_frame(frames[i], is_keyframe, c.keyframe_near, c.residual_near,
+                                   quant, prepared, c.map12)) {
+            ADD_FAILURE() << "prepare failed at frame " << i;
+            return records;
+        }
+
+        GoldenRecord r;
+        r.frame = static_cast<uint32_t>(i);
+        r.kind = is_keyframe ? 'K' : 'R';
+        r.a = std::to_string(prepared.bits_per_sample);
+        r.b = hex64(test::hash_samples(prepared.plane));
+        r.recon_hash = hex64(test::hash_samples(encoder.reference_frame().data));
+        records.push_back(r);
+    }
+    return records;
+}
+
+/**
+ * JPEG-LS payloads and reconstructions
+ */
+std::vector<GoldenRecord> encode_case(const GoldenCase& c)
+{
+    const std::vector<Frame> frames = golden_input();
+
+    FrameEncoder encoder;
+    const QuantizationParams quant(c.dead_zone_T, c.quant_Q, 8);
+    std::vector<GoldenRecord> records;
+
+    for (size_t i = 0; i < frames.size(); ++i) {
+        const bool is_keyframe = (i % c.gop) == 0;
+        CompressedFrame compressed;
+        if (!encoder.encode_frame(frames[i], is_keyframe, c.keyframe_near, c.residual_near,
+                                  quant, compressed, c.map12)) {
+            ADD_FAILURE() << "encode failed at frame " << i;
+            return records;
+        }
+
+        GoldenRecord r;
+        r.frame = static_cast<uint32_t>(i);
+        r.kind = is_keyframe ? 'K' : 'R';
+        r.a = std::to_string(compressed.compressed_data.size());
+        r.b = hex64(test::fnv1a64(compressed.compressed_data.data(),
+                                  compressed.compressed_data.size()));
+        r.recon_hash = hex64(test::hash_samples(encoder.reference_frame().data));
+        records.push_back(r);
+    }
+    return records;
+}
+
+bool read_golden(const std::string& path, std::vector<GoldenRecord>& records)
+{
+    std::ifstream ifs(path);
+    if (!ifs) {
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(ifs, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream iss(line);
+        GoldenRecord r;
+        if (iss >> r.frame >> r.kind >> r.a >> r.b >> r.recon_hash) {
+            records.push_back(r);
+        }
+    }
+    return true;
+}
+
+bool write_golden(const std::string& path, const std::string& header,
+                  const std::vector<GoldenRecord>& records)
+{
+    std::ofstream ofs(path);
+    if (!ofs) {
+        return false;
+    }
+    ofs << header << "\n";
+    for (const GoldenRecord& r : records) {
+        ofs << r.frame << " " << r.kind << " " << r.a << " " << r.b << " " << r.recon_hash << "\n";
+    }
+    return static_cast<bool>(ofs);
+}
+
+/**
+ * Compare against a golden file, or rewrite it under LWIR_UPDATE_GOLDEN=1
+ */
+void check_golden(const std::string& path, const std::string& header,
+                  const char* a_name, const char* b_name,
+                  const std::vector<GoldenRecord>& actual)
+{
+    if (update_requested()) {
+        ASSERT_TRUE(write_golden(path, header, actual)) << "cannot write " << path;
+        std::cout << "Recorded " << path << std::endl;
+        return;
+    }
+
+    std::vector<GoldenRecord> golden;
+    ASSERT_TRUE(read_golden(path, golden)) << "no golden file " << path
+                                           << " (record with LWIR_UPDATE_GOLDEN=1)";
+    ASSERT_EQ(golden.size(), actual.size()) << path;
+    for (size_t i = 0; i < golden.size(); ++i) {
+        ASSERT_EQ(golden[i].frame, actual[i].frame);
+        EXPECT_EQ(golden[i].kind, actual[i].kind) << "frame type changed at frame " << i;
+        EXPECT_EQ(golden[i].a, actual[i].a) << a_name << " changed at frame " << i;
+        EXPECT_EQ(golden[i].b, actual[i].b) << b_name << " changed at frame " << i;
+        EXPECT_EQ(golden[i].recon_hash, actual[i].recon_hash) << "reconstruction changed at frame " << i;
+    }
+}
+
+const GoldenCase kLosslessCases[] = {
+    {"lossless_16bit",        0,  0, 0, 1.0, false, 10},
+    {"lossless_12bit",        0,  0, 0, 1.0, true,  10},
+    {"quantized_t2_q2",       0,  0, 2, 2.0, true,   8},
+    {"quantized_t4_q3_16bit", 0,  0, 4, 3.0, false,  8},
+};
+
+const GoldenCase kNearLosslessCases[] = {
+    {"near10_t2_q2",          0, 10, 2, 2.0, true,   8},
+    {"near3_keyframes",       3,  5, 2, 2.0, true,   4},
+};
+
+class GoldenPlaneTest : public ::testing::TestWithParam<GoldenCase> {};
+
+TEST_P(GoldenPlaneTest, PlanesMatchGolden)
+{
+    const GoldenCase& c = GetParam();
+    check_golden(std::string(LWIR_GOLDEN_DIR) + "/" + c.name + ".txt",
+                 "# frame kind bits plane_hash recon_hash",
+                 "bits per sample", "plane", prepare_case(c));
+}
+
+INSTANTIATE_TEST_SUITE_P(Golden, GoldenPlaneTest, ::testing::ValuesIn(kLosslessCases));
+
+class GoldenPayloadTest : public ::testing::TestWithParam<GoldenCase> {};
+
+TEST_P(GoldenPayloadTest, PayloadsMatchGolden)
+{
+    const std::string codec = jpegls_codec_version();
+    if (codec == kUnversionedCodec) {
+        GTEST_SKIP() << "CharLS reports no version; payload goldens are kept per CharLS release";
+    }
+
+    const std::string dir = std::string(LWIR_GOLDEN_DIR) + "/" + codec;
+    if (update_requested()) {
+        ::mkdir(dir.c_str(), 0755);
+    }
+
+    const GoldenCase& c = GetParam();
+    check_golden(dir + "/" + c.name + ".txt",
+                 "# frame kind bytes payload_hash recon_hash",
+                 "payload size", "payload", encode_case(c));
+}
+
+INSTANTIATE_TEST_SUITE_P(GoldenLossless, GoldenPayloadTest, ::testing::ValuesIn(kLosslessCases));
+INSTANTIATE_TEST_SUITE_P(GoldenNearLossless, GoldenPayloadTest, ::testing::ValuesIn(kNearLosslessCases));
+
+} // anonymous namespace
+} // namespace lwir
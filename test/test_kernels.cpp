@@ -0,0 +1,361 @@
+/**
+ * @file test_kernels.cpp
+ * @brief Kernel equivalence against scalar reference implementations
+ *
+ * Each production kernel (auto-vectorized, NEON or size-specialized) is
+ * compared element for element with a plain scalar implementation of the
+ * documented formula. Lengths cover vector-width tails and the inputs
+ * include the 0 / 32767 / 32768 / 65535 edge values. Any new SIMD or
+ * specialized path must be added here before it is used by the encoder.
+ */
+
+#include <gtest/gtest.h>
+#include "residual.hpp"
+#include "kernels.hpp"
+#include "bitdepth.hpp"
+#include "stats.hpp"
+#include "test_util.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+namespace lwir {
+namespace {
+
+// Lengths around common vector widths plus one odd-sized frame row block
+const size_t kLengths[] = {1, 3, 7, 8, 15, 16, 17, 31, 33, 64, 127, 1923};
+
+// ============================================================================
+// Scalar references
+// ============================================================================
+
+int16_t ref_residual(uint16_t current, uint16_t previous)
+{
+    // Difference modulo 2^16, as stored in int16
+    return static_cast<int16_t>(static_cast<uint16_t>(current - previous));
+}
+
+int16_t ref_quantize(int16_t r, const QuantizationParams& p)
+{
+    const int64_t a = std::abs(static_cast<int64_t>(r));
+    const int64_t a2 = std::max<int64_t>(0, a - p.dead_zone_T);
+    const int64_t q = ((a2 << p.fp_bits) + p.quant_Q_fixed / 2) / p.quant_Q_fixed;
+    return static_cast<int16_t>(r >= 0 ? q : -q);
+}
+
+int16_t ref_dequantize(int16_t q, const QuantizationParams& p)
+{
+    if (q == 0) {
+        return 0;
+    }
+    const int64_t a = std::abs(static_cast<int64_t>(q));
+    const int64_t r = ((a * p.quant_Q_fixed) >> p.fp_bits) + p.dead_zone_T / 2;
+    return static_cast<int16_t>(q > 0 ? r : -r);
+}
+
+uint16_t ref_reconstruct(int16_t r, uint16_t previous)
+{
+    const int32_t v = static_cast<int32_t>(previous) + r;
+    return static_cast<uint16_t>(v < 0 ? 0 : (v > 65535 ? 65535 : v));
+}
+
+uint16_t ref_map_to_12bit(uint16_t v, const RangeMap& m)
+{
+    if (m.range == 0) {
+        return 0;
+    }
+    return static_cast<uint16_t>((static_cast<uint64_t>(v - m.min_value) * 4095 + m.range / 2) / m.range);
+}
+
+uint16_t ref_map_from_12bit(uint16_t v, const RangeMap& m)
+{
+    if (m.range == 0) {
+        return m.min_value;
+    }
+    return static_cast<uint16_t>((static_cast<uint64_t>(v) * m.range + 2047) / 4095 + m.min_value);
+}
+
+// ============================================================================
+// Inputs
+// ============================================================================
+
+std::vector<uint16_t> random_pixels(size_t n, test::Rng& rng, uint16_t lo = 0, uint16_t hi = 65535)
+{
+    static const uint16_t edges[] = {0, 1, 32767, 32768, 65534, 65535};
+    std::vector<uint16_t> v(n);
+    for (size_t i = 0; i < n; ++i) {
+        if (lo == 0 && hi == 65535 && rng.uniform(16) == 0) {
+            v[i] = edges[rng.uniform(6)];
+        } else {
+            v[i] = static_cast<uint16_t>(lo + rng.uniform(static_cast<uint32_t>(hi - lo) + 1));
+        }
+    }
+    return v;
+}
+
+// Residual-like values: mostly small, some large, some extreme
+std::vector<int16_t> random_residuals(size_t n, test::Rng& rng)
+{
+    std::vector<int16_t> v(n);
+    for (size_t i = 0; i < n; ++i) {
+        const uint32_t kind = rng.uniform(10);
+        if (kind < 7) {
+            v[i] = static_cast<int16_t>(static_cast<int32_t>(rng.uniform(41)) - 20);
+        } else if (kind < 9) {
+            v[i] = static_cast<int16_t>(static_cast<int32_t>(rng.uniform(4001)) - 2000);
+        } else {
+            v[i] = rng.uniform(2) ? 32767 : -32767;
+        }
+    }
+    return v;
+}
+
+std::vector<QuantizationParams> quant_sets()
+{
+    return {
+        QuantizationParams(0, 1.0, 8),
+        QuantizationParams(2, 2.0, 8),
+        QuantizationParams(4, 3.0, 8),
+        QuantizationParams(1, 1.5, 8),
+        QuantizationParams(2, 2.75, 12),
+        QuantizationParams(3, 7.0, 4),
+    };
+}
+
+// ============================================================================
+// Tests
+// ============================================================================
+
+TEST(Kernels, ComputeResidualMatchesScalar)
+{
+    test::Rng rng(1);
+    for (size_t n : kLengths) {
+        const std::vector<uint16_t> cur = random_pixels(n, rng);
+        const std::vector<uint16_t> prev = random_pixels(n, rng);
+        std::vector<int16_t> out(n);
+        compute_residual(cur.data(), prev.data(), out.data(), n);
+        for (size_t i = 0; i < n; ++i) {
+            ASSERT_EQ(ref_residual(cur[i], prev[i]), out[i]) << "n=" << n << " i=" << i;
+        }
+    }
+}
+
+TEST(Kernels, QuantizeMatchesScalar)
+{
+    test::Rng rng(2);
+    for (const QuantizationParams& p : quant_sets()) {
+        for (size_t n : kLengths) {
+            const std::vector<int16_t> r = random_residuals(n, rng);
+            std::vector<int16_t> q(n);
+            quantize_residual(r.data(), q.data(), n, p);
+            for (size_t i = 0; i < n; ++i) {
+                ASSERT_EQ(ref_quantize(r[i], p), q[i])
+                    << "T=" << p.dead_zone_T << " Q=" << p.get_Q() << " n=" << n << " r=" << r[i];
+            }
+        }
+    }
+}
+
+TEST(Kernels, DequantizeMatchesScalar)
+{
+    test::Rng rng(3);
+    for (const QuantizationParams& p : quant_sets()) {
+        for (size_t n : kLengths) {
+            std::vector<int16_t> r = random_residuals(n, rng);
+            std::vector<int16_t> q(n);
+            // Quantized symbols of realistic residuals
+            quantize_residual(r.data(), q.data(), n, p);
+            dequantize_residual(q.data(), r.data(), n, p);
+            for (size_t i = 0; i < n; ++i) {
+                ASSERT_EQ(ref_dequantize(q[i], p), r[i])
+                    << "T=" << p.dead_zone_T << " Q=" << p.get_Q() << " n=" << n << " q=" << q[i];
+            }
+        }
+    }
+}
+
+TEST(Kernels, QuantizationErrorIsBounded)
+{
+    // |R - R_hat| <= T + Q/2 + 1 (fixed-point rounding). Residuals are kept
+    // inside the codable range; near +/-32767 R_hat can leave int16.
+    test::Rng rng(4);
+    for (const QuantizationParams& p : quant_sets()) {
+        std::vector<int16_t> r(4096);
+        for (int16_t& v : r) {
+            v = static_cast<int16_t>(static_cast<int32_t>(rng.uniform(4001)) - 2000);
+        }
+        std::vector<int16_t> q(r.size()), rh(r.size());
+        quantize_residual(r.data(), q.data(), r.size(), p);
+        dequantize_residual(q.data(), rh.data(), r.size(), p);
+        const double bound = p.dead_zone_T + p.get_Q() / 2.0 + 1.0;
+        for (size_t i = 0; i < r.size(); ++i) {
+            ASSERT_LE(std::abs(static_cast<int32_t>(r[i]) - rh[i]), bound)
+                << "T=" << p.dead_zone_T << " Q=" << p.get_Q() << " r=" << r[i];
+        }
+    }
+}
+
+TEST(Kernels, SelectsSpecializationForFleetGeometry)
+{
+    EXPECT_STREQ("640x512/fp8", select_residual_kernels(640, 512, 8).name);
+    EXPECT_STREQ("1024x768/fp8", select_residual_kernels(1024, 768, 8).name);
+    EXPECT_STREQ("640x512", select_residual_kernels(640, 512, 12).name);
+    EXPECT_STREQ("1024x768", select_residual_kernels(1024, 768, 4).name);
+    EXPECT_STREQ("fp8", select_residual_kernels(320, 256, 8).name);
+    EXPECT_STREQ("generic", select_residual_kernels(320, 256, 12).name);
+    EXPECT_EQ(&generic_residual_kernels(), &select_residual_kernels(512, 640, 6));
+}
+
+TEST(Kernels, SpecializedKernelsMatchScalar)
+{
+    // Each specialization at its own size, plus mismatched lengths that must
+    // take the generic fallback
+    test::Rng rng(9);
+    const uint32_t geometries[][2] = {{640, 512}, {1024, 768}, {40, 32}};
+    for (const auto& g : geometries) {
+        const size_t frame_pixels = static_cast<size_t>(g[0]) * g[1];
+        for (const QuantizationParams& p : quant_sets()) {
+            const ResidualKernels& k = select_residual_kernels(g[0], g[1], p.fp_bits);
+            for (size_t n : {frame_pixels, size_t(17), size_t(1923)}) {
+                const std::vector<uint16_t> cur = random_pixels(n, rng);
+                const std::vector<uint16_t> prev = random_pixels(n, rng);
+                const std::vector<int16_t> r = random_residuals(n, rng);
+                std::vector<int16_t> d(n), q(n), rh(n);
+                std::vector<uint16_t> out(n);
+
+                k.compute_residual(cur.data(), prev.data(), d.data(), n);
+                k.quantize_residual(r.data(), q.data(), n, p);
+                k.dequantize_residual(q.data(), rh.data(), n, p);
+                k.reconstruct_frame(r.data(), prev.data(), out.data(), n);
+                for (size_t i = 0; i < n; ++i) {
+                    ASSERT_EQ(ref_residual(cur[i], prev[i]), d[i]) << k.name << " n=" << n;
+                    ASSERT_EQ(ref_quantize(r[i], p), q[i]) << k.name << " Q=" << p.get_Q() << " r=" << r[i];
+                    ASSERT_EQ(ref_dequantize(q[i], p), rh[i]) << k.name << " Q=" << p.get_Q() << " q=" << q[i];
+                    ASSERT_EQ(ref_reconstruct(r[i], prev[i]), out[i]) << k.name << " n=" << n;
+                }
+            }
+        }
+    }
+}
+
+TEST(Kernels, ReciprocalQuantizerIsExact)
+{
+    // The fp8 quantizer replaces the division by Q_fixed with a reciprocal
+    // multiply; check every int16 residual across small, random and limit
+    // step sizes (2^24 and above take the generic path)
+    std::vector<int16_t> r;
+    for (int32_t v = -32768; v <= 32767; ++v) {
+        r.push_back(static_cast<int16_t>(v));
+    }
+
+    std::vector<uint32_t> steps;
+    for (uint32_t q = 1; q <= 300; ++q) {
+        steps.push_back(q);
+    }
+    for (uint32_t b = 9; b <= 24; ++b) {
+        steps.push_back((1u << b) - 1);
+        steps.push_back(1u << b);
+        steps.push_back((1u << b) + 1);
+    }
+    test::Rng rng(10);
+    for (int i = 0; i < 50; ++i) {
+        steps.push_back(1 + rng.uniform((1u << 24) - 1));
+    }
+
+    const ResidualKernels& k = select_residual_kernels(100, 100, 8);
+    std::vector<int16_t> q(r.size());
+    for (uint32_t T : {0u, 3u}) {
+        for (uint32_t step : steps) {
+            QuantizationParams p(T, 1.0, 8);
+            p.quant_Q_fixed = step;
+            k.quantize_residual(r.data(), q.data(), r.size(), p);
+            for (size_t i = 0; i < r.size(); ++i) {
+                ASSERT_EQ(ref_quantize(r[i], p), q[i]) << "T=" << T << " Q_fixed=" << step << " r=" << r[i];
+            }
+        }
+    }
+}
+
+TEST(Kernels, BiasRoundTrip)
+{
+    test::Rng rng(5);
+    for (size_t n : kLengths) {
+        std::vector<int16_t> r(n);
+        for (size_t i = 0; i < n; ++i) {
+            r[i] = static_cast<int16_t>(static_cast<int32_t>(rng.uniform(2048)) - 1024);
+        }
+        std::vector<uint16_t> biased(n);
+        std::vector<int16_t> back(n);
+        bias_residual(r.data(), biased.data(), n);
+        unbias_residual(biased.data(), back.data(), n);
+        for (size_t i = 0; i < n; ++i) {
+            ASSERT_EQ(static_cast<uint16_t>(r[i] + 1024), biased[i]);
+            ASSERT_EQ(r[i], back[i]);
+        }
+    }
+}
+
+TEST(Kernels, ReconstructMatchesScalar)
+{
+    test::Rng rng(6);
+    for (size_t n : kLengths) {
+        const std::vector<int16_t> r = random_residuals(n, rng);
+        const std::vector<uint16_t> prev = random_pixels(n, rng);
+        std::vector<uint16_t> out(n);
+        reconstruct_frame(r.data(), prev.data(), out.data(), n);
+        for (size_t i = 0; i < n; ++i) {
+            ASSERT_EQ(ref_reconstruct(r[i], prev[i]), out[i]) << "n=" << n << " i=" << i;
+        }
+    }
+}
+
+TEST(Kernels, RangeMapMatchesScalar)
+{
+    test::Rng rng(7);
+    const uint16_t bounds[][2] = {{29134, 34436}, {0, 4095}, {100, 100}, {0, 65535}, {1000, 1001}};
+    for (const auto& b : bounds) {
+        for (size_t n : kLengths) {
+            const std::vector<uint16_t> src = random_pixels(n, rng, b[0], b[1]);
+
+            const RangeMap m = compute_range_map(src.data(), n);
+            EXPECT_EQ(*std::min_element(src.begin(), src.end()), m.min_value);
+            EXPECT_EQ(*std::max_element(src.begin(), src.end()), m.max_value);
+
+            std::vector<uint16_t> mapped(n), back(n);
+            map_to_12bit(src.data(), mapped.data(), n, m);
+            map_from_12bit(mapped.data(), back.data(), n, m);
+            for (size_t i = 0; i < n; ++i) {
+                ASSERT_EQ(ref_map_to_12bit(src[i], m), mapped[i]) << "n=" << n << " v=" << src[i];
+                ASSERT_LE(mapped[i], 4095);
+                ASSERT_EQ(ref_map_from_12bit(mapped[i], m), back[i]) << "n=" << n << " v=" << src[i];
+            }
+        }
+    }
+}
+
+TEST(Kernels, DeltaStatsMatchMaterializedResidual)
+{
+    test::Rng rng(8);
+    for (uint32_t T : {0u, 2u, 5u}) {
+        const size_t n = 1923;
+        const std::vector<uint16_t> prev = random_pixels(n, rng, 20000, 40000);
+        std::vector<uint16_t> cur(prev);
+        for (size_t i = 0; i < n; ++i) {
+            cur[i] = static_cast<uint16_t>(cur[i] + rng.uniform(61) - 30);
+        }
+
+        std::vector<int16_t> r(n);
+        compute_residual(cur.data(), prev.data(), r.data(), n);
+
+        const ResidualStats a = compute_residual_stats(r.data(), n, T);
+        const ResidualStats b = compute_delta_stats(cur.data(), prev.data(), n, T, 1);
+        EXPECT_DOUBLE_EQ(a.mean_abs, b.mean_abs);
+        EXPECT_DOUBLE_EQ(a.zero_mass, b.zero_mass);
+        EXPECT_DOUBLE_EQ(a.p95, b.p95);
+        EXPECT_DOUBLE_EQ(a.p99, b.p99);
+        EXPECT_DOUBLE_EQ(a.entropy, b.entropy);
+    }
+}
+
+} // anonymous namespace
+} // namespace lwir
@@ -0,0 +1,159 @@
+/**
+ * @file test_overlapped_encode.cpp
+ * @brief Split encode (prepare + entropy code) and the overlapped pipeline
+ *
+ * Preparing a frame and entropy coding it later must give the same record
+ * and the same reference as encode_frame(). A pipeline with encode workers
+ * must write every frame in order, decodable, and produce the same
+ * bitstream on every run whatever the worker timing.
+ */
+
+#include <gtest/gtest.h>
+#include "encoder.hpp"
+#include "pipeline.hpp"
+#include "test_util.hpp"
+#include <vector>
+
+namespace lwir {
+namespace {
+
+void expect_same_record(const CompressedFrame& a, const CompressedFrame& b, size_t i)
+{
+    EXPECT_EQ(a.frame_index, b.frame_index) << "frame " << i;
+    EXPECT_EQ(a.is_keyframe, b.is_keyframe) << "frame " << i;
+    EXPECT_EQ(a.use_range_map, b.use_range_map) << "frame " << i;
+    EXPECT_EQ(a.range_min, b.range_min) << "frame " << i;
+    EXPECT_EQ(a.range_max, b.range_max) << "frame " << i;
+    EXPECT_EQ(a.dead_zone_T, b.dead_zone_T) << "frame " << i;
+    EXPECT_EQ(a.fp_bits, b.fp_bits) << "frame " << i;
+    EXPECT_TRUE(a.compressed_data == b.compressed_data) << "frame " << i;
+}
+
+TEST(OverlappedEncode, PrepareThenEntropyCodeMatchesEncodeFrame)
+{
+    const std::vector<Frame> frames = test::make_sequence(96, 72, 12, 21);
+    const QuantizationParams quant(2, 2.0, 8);
+
+    for (bool map12 : {false, true}) {
+        FrameEncoder serial;
+        FrameEncoder split;
+        serial.set_verify_decode(false);
+        split.set_verify_decode(false);
+
+        for (size_t i = 0; i < frames.size(); ++i) {
+            const bool is_keyframe = (i % 5) == 0;
+
+            CompressedFrame expected;
+            ASSERT_TRUE(serial.encode_frame(frames[i], is_keyframe, 0, 0, quant, expected, map12));
+
+            ASSERT_TRUE(split.can_prepare(is_keyframe, 0, 0));
+            PreparedFrame prepared;
+            ASSERT_TRUE(split.prepare_frame(frames[i], is_keyframe, 0, 0, quant, prepared, map12));
+
+            // The reference advances before the payload exists
+            EXPECT_TRUE(prepared.frame.compressed_data.empty());
+            ASSERT_TRUE(split.reference_frame().data == serial.reference_frame().data) << "frame " << i;
+
+            ASSERT_TRUE(entropy_code(prepared));
+            expect_same_record(prepared.frame, expected, i);
+        }
+    }
+}
+
+TEST(OverlappedEncode, OnlyFramesWithoutClosedLoopDecodeArePrepared)
+{
+    FrameEncoder encoder;
+    EXPECT_FALSE(encoder.can_prepare(true, 0, 0));             // Verification decode is on
+    encoder.set_verify_decode(false);
+    EXPECT_TRUE(encoder.can_prepare(true, 0, 10));
+    EXPECT_FALSE(encoder.can_prepare(true, 3, 0));             // Near-lossless keyframe
+    EXPECT_FALSE(encoder.can_prepare(false, 0, 0));            // No reference yet
+
+    const std::vector<Frame> frames = test::make_sequence(40, 32, 1, 22);
+    CompressedFrame keyframe;
+    ASSERT_TRUE(encoder.encode_intra_frame(frames[0], 0, keyframe));
+    EXPECT_TRUE(encoder.can_prepare(false, 0, 0));
+    EXPECT_FALSE(encoder.can_prepare(false, 0, 10));           // Closed loop needs the decode
+
+    PreparedFrame prepared;
+    EXPECT_FALSE(encoder.prepare_frame(frames[0], false, 0, 10, QuantizationParams(), prepared));
+}
+
+CompressionConfig overlap_config(uint32_t workers)
+{
+    CompressionConfig config;
+    config.gop_period = 6;
+    config.keyframe_near = 0;
+    config.residual_near = 0;
+    config.dead_zone_T = 2;
+    config.quant_Q = 2.0;
+    config.enable_12bit_mode = true;
+    config.frame_deadline_ms = 0.0;
+    config.decision_hysteresis_bpp = 0.0;   // Small frames: keep the GOP structure
+    config.verbose = false;
+    config.dry_run = true;
+    config.encode_workers = workers;
+    return config;
+}
+
+std::vector<CompressedFrame> encode_session(const CompressionConfig& config, const std::vector<Frame>& frames)
+{
+    std::vector<CompressedFrame> encoded;
+    CompressionPipeline pipeline(config);
+    pipeline.set_frame_sink([&](const CompressedFrame& frame, const FrameStats& stats) {
+        EXPECT_EQ(stats.frame_index, frame.frame_index);
+        EXPECT_EQ(stats.compressed_bytes, frame.compressed_data.size());
+        encoded.push_back(frame);
+        return true;
+    });
+    for (const Frame& frame : frames) {
+        EXPECT_TRUE(pipeline.process_frame(frame, DeadlineMonitor::Clock::now()));
+    }
+    EXPECT_TRUE(pipeline.finish());
+    EXPECT_EQ(pipeline.session_stats().total_frames, frames.size());
+    return encoded;
+}
+
+TEST(OverlappedEncode, PipelineWritesInOrderAndIsDeterministic)
+{
+    const std::vector<Frame> frames = test::make_sequence(64, 48, 40, 23);
+
+    for (uint32_t residual_near : {0u, 2u}) {
+        CompressionConfig config = overlap_config(3);
+        config.residual_near = residual_near;   // NEAR > 0 residuals stay inline
+
+        const std::vector<CompressedFrame> first = encode_session(config, frames);
+        const std::vector<CompressedFrame> second = encode_session(config, frames);
+        ASSERT_EQ(first.size(), frames.size());
+        ASSERT_EQ(second.size(), frames.size());
+
+        FrameEncoder decoder;
+        for (size_t i = 0; i < frames.size(); ++i) {
+            ASSERT_EQ(first[i].frame_index, i);
+            expect_same_record(first[i], second[i], i);
+
+            Frame decoded;
+            ASSERT_TRUE(decoder.decode_frame(first[i], decoded)) << "frame " << i;
+            if (residual_near == 0 && first[i].is_keyframe) {
+                EXPECT_TRUE(decoded.data == frames[i].data) << "frame " << i;
+            }
+        }
+    }
+}
+
+TEST(OverlappedEncode, MatchesSerialWhenDecisionsDoNotDependOnSizes)
+{
+    // A fixed GOP makes the decisions independent of the lagging size
+    // feedback, so the overlapped bitstream equals the serial one
+    const std::vector<Frame> frames = test::make_sequence(64, 48, 25, 24);
+    const std::vector<CompressedFrame> serial = encode_session(overlap_config(0), frames);
+    const std::vector<CompressedFrame> overlapped = encode_session(overlap_config(4), frames);
+
+    ASSERT_EQ(serial.size(), overlapped.size());
+    for (size_t i = 0; i < serial.size(); ++i) {
+        expect_same_record(overlapped[i], serial[i], i);
+    }
+}
+
+} // anonymous namespace
+} // namespace lwir
@@ -0,0 +1,174 @@
+/**
+ * @file test_packed.cpp
+ * @brief RAW12/RAW14 unpacking and the packed directory source
+ */
+
+#include <gtest/gtest.h>
+#include "frame_source.hpp"
+#include "packed.hpp"
+#include "pipeline.hpp"
+#include "test_util.hpp"
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace lwir {
+namespace {
+
+TEST(Packed, MipiByteLayout)
+{
+    // RAW12: P0 = 0xABC, P1 = 0x123
+    const uint8_t raw12[] = {0xAB, 0x12, 0x3C};
+    uint16_t out12[2];
+    unpack_raw12(raw12, out12, 2);
+    EXPECT_EQ(out12[0], 0xABC);
+    EXPECT_EQ(out12[1], 0x123);
+
+    // RAW14: P0 = 0x3FFF, P1 = 0x0001, P2 = 0x2AAA, P3 = 0x1555
+    const uint16_t samples14[] = {0x3FFF, 0x0001, 0x2AAA, 0x1555};
+    uint8_t raw14[7];
+    pack_pixels(PackedFormat::RAW14, samples14, raw14, 4);
+    EXPECT_EQ(raw14[0], 0xFF);
+    EXPECT_EQ(raw14[1], 0x00);
+    EXPECT_EQ(raw14[2], 0xAA);
+    EXPECT_EQ(raw14[3], 0x55);
+    EXPECT_EQ(raw14[4], 0x7F);   // P1[1:0] P0[5:0]
+    EXPECT_EQ(raw14[5], 0xA0);   // P2[3:0] P1[5:2]
+    EXPECT_EQ(raw14[6], 0x56);   // P3[5:0] P2[5:4]
+    uint16_t out14[4];
+    unpack_raw14(raw14, out14, 4);
+    for (size_t i = 0; i < 4; ++i) {
+        EXPECT_EQ(out14[i], samples14[i]) << "pixel " << i;
+    }
+
+    EXPECT_EQ(packed_frame_bytes(PackedFormat::RAW12, 640, 512), 640u * 512 * 3 / 2);
+    EXPECT_EQ(packed_frame_bytes(PackedFormat::RAW14, 640, 512), 640u * 512 * 7 / 4);
+    EXPECT_EQ(packed_frame_bytes(PackedFormat::RAW14, 642, 512), 0u);
+    PackedFormat format;
+    EXPECT_TRUE(parse_packed_format("raw14", format));
+    EXPECT_EQ(format, PackedFormat::RAW14);
+    EXPECT_FALSE(parse_packed_format("raw10", format));
+}
+
+TEST(Packed, RoundTripEverySampleValue)
+{
+    for (PackedFormat format : {PackedFormat::RAW12, PackedFormat::RAW14}) {
+        const uint32_t bits = (format == PackedFormat::RAW12) ? 12 : 14;
+        std::vector<uint16_t> samples(size_t(1) << bits);
+        for (size_t i = 0; i < samples.size(); ++i) {
+            samples[i] = static_cast<uint16_t>((i * 2654435761u) & (samples.size() - 1));
+        }
+        std::vector<uint8_t> packed(samples.size() / packed_group_pixels(format) * packed_group_bytes(format));
+        pack_pixels(format, samples.data(), packed.data(), samples.size());
+
+        std::vector<uint16_t> unpacked(samples.size());
+        unpack_pixels(format, packed.data(), unpacked.data(), unpacked.size());
+        EXPECT_TRUE(unpacked == samples) << bits << "-bit";
+    }
+}
+
+class PackedSourceTest : public test::TempDirTest {
+protected:
+    // Top 12 bits of each sample, as a RAW12 core delivers them
+    static std::vector<Frame> sensor_frames(uint32_t count)
+    {
+        std::vector<Frame> frames = test::make_sequence(40, 24, count, 71);
+        for (Frame& frame : frames) {
+            for (uint16_t& sample : frame.data) {
+                sample >>= 4;
+            }
+        }
+        return frames;
+    }
+
+    void write_dump(const std::string& name, const std::vector<Frame>& frames) const
+    {
+        std::ofstream ofs(dir_ + "/" + name, std::ios::binary);
+        for (const Frame& frame : frames) {
+            std::vector<uint8_t> bytes(packed_frame_bytes(PackedFormat::RAW12, frame.width, frame.height));
+            pack_pixels(PackedFormat::RAW12, frame.data.data(), bytes.data(), frame.pixel_count());
+            ofs.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+        }
+    }
+};
+
+TEST_F(PackedSourceTest, ReadsSingleAndMultiFrameDumps)
+{
+    const std::vector<Frame> frames = sensor_frames(5);
+    write_dump("jenoptik_000000.raw", {frames[0]});
+    write_dump("jenoptik_000003.raw", {frames[1]});   // Sequence numbers give a gap
+    write_dump("jenoptik_000004.raw", {frames[2], frames[3], frames[4]});
+    std::ofstream(dir_ + "/mask.raw") << "ignored";
+
+    PackedDirectorySource source(PackedFormat::RAW12, 40, 24);
+    source.set_frame_period(1000.0);
+    ASSERT_TRUE(source.open(dir_));
+    ASSERT_EQ(source.frame_count(), frames.size());
+
+    for (size_t i = 0; i < frames.size(); ++i) {
+        Frame frame;
+        ASSERT_TRUE(source.read_frame(i, frame));
+        EXPECT_EQ(frame.width, 40u);
+        EXPECT_EQ(frame.height, 24u);
+        EXPECT_EQ(frame.frame_index, i);
+        EXPECT_TRUE(frame.data == frames[i].data) << "frame " << i;
+    }
+
+    Frame frame;
+    ASSERT_TRUE(source.read_frame(1, frame));
+    EXPECT_EQ(frame.timestamp, 3000u);
+    ASSERT_TRUE(source.read_frame(3, frame));
+    EXPECT_EQ(frame.timestamp, 0u);   // Multi-frame dump: no per-frame number
+
+    // Width must be whole groups
+    PackedDirectorySource odd(PackedFormat::RAW14, 42, 24);
+    EXPECT_FALSE(odd.open(dir_));
+}
+
+TEST_F(PackedSourceTest, PipelineMatchesUnpackedFrames)
+{
+    const std::vector<Frame> frames = sensor_frames(6);
+    write_dump("jenoptik_000000.raw", frames);
+
+    CompressionConfig config;
+    config.input_dir = dir_;
+    config.output_dir = "";
+    config.input_format = "raw12";
+    config.input_width = 40;
+    config.input_height = 24;
+    config.residual_near = 1;
+    config.frame_deadline_ms = 0.0;
+    config.verbose = false;
+    config.dry_run = true;
+    ASSERT_TRUE(config.validate_parameters());
+
+    std::vector<CompressedFrame> expected;
+    {
+        CompressionPipeline pipeline(config);
+        pipeline.set_frame_sink([&](const CompressedFrame& frame, const FrameStats&) {
+            expected.push_back(frame);
+            return true;
+        });
+        MemoryFrameSource source(frames);
+        ASSERT_TRUE(pipeline.run(source));
+    }
+
+    std::vector<CompressedFrame> actual;
+    CompressionPipeline pipeline(config);
+    pipeline.set_frame_sink([&](const CompressedFrame& frame, const FrameStats&) {
+        actual.push_back(frame);
+        return true;
+    });
+    ASSERT_TRUE(pipeline.run());
+
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < actual.size(); ++i) {
+        EXPECT_TRUE(actual[i].compressed_data == expected[i].compressed_data) << "frame " << i;
+    }
+
+    config.input_width = 41;   // Not whole RAW12 groups
+    EXPECT_FALSE(config.validate_parameters());
+}
+
+} // anonymous namespace
+} // namespace lwir
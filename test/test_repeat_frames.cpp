@@ -0,0 +1,193 @@
+/**
+ * @file test_repeat_frames.cpp
+ * @brief Repeat records: exact repeats, static gating, format and pipeline
+ */
+
+#include <gtest/gtest.h>
+#include "encoder.hpp"
+#include "frame_format.hpp"
+#include "pipeline.hpp"
+#include "residual.hpp"
+#include "test_util.hpp"
+#include <algorithm>
+#include <vector>
+
+namespace lwir {
+namespace {
+
+// Frame i of `frames` with a new index and timestamp (a frozen driver buffer)
+Frame repeat_of(const Frame& frame, uint32_t frame_index)
+{
+    Frame copy = frame;
+    copy.frame_index = frame_index;
+    copy.timestamp = frame_index * 33333ull;
+    return copy;
+}
+
+TEST(RepeatFrames, HashSeesEverySample)
+{
+    const std::vector<Frame> frames = test::make_sequence(37, 11, 1, 41);   // 407 samples: odd tail
+    std::vector<uint16_t> samples = frames[0].data;
+    const uint64_t base = hash_samples(samples.data(), samples.size());
+    EXPECT_EQ(hash_samples(samples.data(), samples.size()), base);
+
+    for (size_t i : {size_t(0), size_t(5), size_t(200), samples.size() - 1}) {
+        samples[i] ^= 1;
+        EXPECT_NE(hash_samples(samples.data(), samples.size()), base) << "sample " << i;
+        samples[i] ^= 1;
+    }
+    EXPECT_NE(hash_samples(samples.data(), samples.size() - 1), base);
+}
+
+TEST(RepeatFrames, ExactRepeatsAreHeaderOnly)
+{
+    const std::vector<Frame> source = test::make_sequence(48, 40, 3, 42);
+    const std::vector<Frame> frames = {
+        source[0], repeat_of(source[0], 1),   // Repeat right after a keyframe
+        repeat_of(source[1], 2), repeat_of(source[1], 3), repeat_of(source[1], 4),
+        repeat_of(source[2], 5),
+    };
+    const QuantizationParams quant(2, 2.0, 8);
+
+    FrameEncoder encoder;
+    encoder.set_repeat_detection(true, false);
+    FrameEncoder decoder;
+    Frame previous;
+
+    for (size_t i = 0; i < frames.size(); ++i) {
+        const bool is_keyframe = (i == 0);
+        CompressedFrame compressed;
+        ASSERT_TRUE(encoder.encode_frame(frames[i], is_keyframe, 0, 3, quant, compressed, true));
+
+        const bool expect_repeat = (i == 1 || i == 3 || i == 4);
+        EXPECT_EQ(compressed.is_repeat, expect_repeat) << "frame " << i;
+        EXPECT_EQ(compressed.compressed_data.empty(), expect_repeat) << "frame " << i;
+
+        // Type survives the record format
+        std::vector<uint8_t> record(frame_record_size(compressed));
+        ASSERT_EQ(write_frame_record(compressed, record.data(), record.size()), record.size());
+        CompressedFrame parsed;
+        ASSERT_TRUE(read_frame_record(record.data(), record.size(), parsed));
+        EXPECT_EQ(parsed.is_repeat, expect_repeat);
+        EXPECT_EQ(parsed.is_keyframe, is_keyframe);
+        EXPECT_EQ(parsed.frame_index, frames[i].frame_index);
+        EXPECT_EQ(parsed.timestamp, frames[i].timestamp);
+
+        Frame decoded;
+        ASSERT_TRUE(decoder.decode_frame(parsed, decoded)) << "frame " << i;
+        EXPECT_EQ(decoded.frame_index, frames[i].frame_index);
+        EXPECT_EQ(decoded.timestamp, frames[i].timestamp);
+        EXPECT_TRUE(decoded.data == encoder.reference_frame().data) << "frame " << i;
+        if (expect_repeat) {
+            EXPECT_TRUE(decoded.data == previous.data) << "frame " << i;
+        }
+        previous = decoded;
+    }
+}
+
+TEST(RepeatFrames, KeyframesAreNeverRepeats)
+{
+    const std::vector<Frame> source = test::make_sequence(32, 24, 1, 43);
+    FrameEncoder encoder;
+    encoder.set_repeat_detection(true, true);
+
+    CompressedFrame compressed;
+    for (uint32_t i = 0; i < 3; ++i) {
+        ASSERT_TRUE(encoder.encode_frame(repeat_of(source[0], i), true, 0, 0, QuantizationParams(), compressed));
+        EXPECT_TRUE(compressed.is_keyframe);
+        EXPECT_FALSE(compressed.is_repeat);
+        EXPECT_FALSE(compressed.compressed_data.empty());
+    }
+}
+
+TEST(RepeatFrames, StaticGatingUsesTheDeadZone)
+{
+    const std::vector<Frame> source = test::make_sequence(40, 30, 1, 44);
+    const QuantizationParams quant(3, 2.0, 8);
+
+    // Sensor noise within T of the reference, then one pixel just outside
+    Frame noisy = repeat_of(source[0], 1);
+    for (size_t i = 0; i < noisy.data.size(); ++i) {
+        const int32_t value = static_cast<int32_t>(noisy.data[i]) + static_cast<int32_t>(i % 7) - 3;
+        noisy.data[i] = static_cast<uint16_t>(std::min(std::max(value, 0), 65535));
+    }
+    Frame moved = repeat_of(noisy, 2);
+    const uint16_t base = source[0].data[123];
+    moved.data[123] = static_cast<uint16_t>(base >= 4 ? base - 4 : base + 4);
+
+    for (bool gating : {false, true}) {
+        FrameEncoder encoder;
+        encoder.set_repeat_detection(true, gating);
+        CompressedFrame compressed;
+        ASSERT_TRUE(encoder.encode_frame(source[0], true, 0, 0, quant, compressed));
+
+        ASSERT_TRUE(encoder.encode_frame(noisy, false, 0, 0, quant, compressed));
+        EXPECT_EQ(compressed.is_repeat, gating);
+
+        ASSERT_TRUE(encoder.encode_frame(moved, false, 0, 0, quant, compressed));
+        EXPECT_FALSE(compressed.is_repeat);
+    }
+}
+
+CompressionConfig repeat_config(uint32_t workers)
+{
+    CompressionConfig config;
+    config.gop_period = 8;
+    config.keyframe_near = 0;
+    config.residual_near = 0;
+    config.dead_zone_T = 0;                 // Lossless residuals
+    config.quant_Q = 1.0;
+    config.frame_deadline_ms = 0.0;
+    config.decision_hysteresis_bpp = 0.0;   // Small frames: keep the GOP structure
+    config.verbose = false;
+    config.dry_run = true;
+    config.detect_repeats = true;
+    config.encode_workers = workers;
+    return config;
+}
+
+TEST(RepeatFrames, PipelineKeepsTimelineAndGopStructure)
+{
+    // Every third frame is frozen
+    const std::vector<Frame> source = test::make_sequence(48, 32, 24, 45);
+    std::vector<Frame> frames;
+    for (uint32_t i = 0; i < source.size(); ++i) {
+        frames.push_back(repeat_of(source[(i % 3 == 2) ? i - 1 : i], i));
+    }
+
+    for (uint32_t workers : {0u, 2u}) {
+        std::vector<CompressedFrame> encoded;
+        CompressionPipeline pipeline(repeat_config(workers));
+        pipeline.set_frame_sink([&](const CompressedFrame& frame, const FrameStats& stats) {
+            EXPECT_EQ(stats.is_repeat, frame.is_repeat);
+            encoded.push_back(frame);
+            return true;
+        });
+        for (const Frame& frame : frames) {
+            ASSERT_TRUE(pipeline.process_frame(frame, DeadlineMonitor::Clock::now()));
+        }
+        ASSERT_TRUE(pipeline.finish());
+        ASSERT_EQ(encoded.size(), frames.size());
+
+        uint32_t repeats = 0;
+        FrameEncoder decoder;
+        for (uint32_t i = 0; i < frames.size(); ++i) {
+            EXPECT_EQ(encoded[i].frame_index, i);
+            EXPECT_EQ(encoded[i].timestamp, frames[i].timestamp);
+            EXPECT_EQ(encoded[i].is_keyframe, i % 8 == 0) << "frame " << i;
+            EXPECT_EQ(encoded[i].is_repeat, i % 3 == 2 && i % 8 != 0) << "frame " << i;
+            repeats += encoded[i].is_repeat ? 1 : 0;
+
+            // Lossless settings: every frame, repeats included, decodes exactly
+            Frame decoded;
+            ASSERT_TRUE(decoder.decode_frame(encoded[i], decoded)) << "frame " << i;
+            EXPECT_TRUE(decoded.data == frames[i].data) << "frame " << i;
+        }
+        EXPECT_EQ(pipeline.session_stats().repeat_frames, repeats);
+        EXPECT_EQ(pipeline.session_stats().keyframes + pipeline.session_stats().residual_frames + repeats,
+                  frames.size());
+    }
+}
+
+} // anonymous namespace
+} // namespace lwir
@@ -0,0 +1,122 @@
+/**
+ * @file test_roundtrip.cpp
+ * @brief Encoder/decoder round-trip conformance
+ *
+ * For every coding mode the encoder's reconstructed reference must equal
+ * the decoder's output bit for bit, frame after frame; any mismatch means
+ * the two sides drift apart over a GOP.
+ */
+
+#include <gtest/gtest.h>
+#include "encoder.hpp"
+#include "test_util.hpp"
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace lwir {
+namespace {
+
+struct RoundTripMode {
+    const char* name;
+    uint32_t keyframe_near;
+    uint32_t residual_near;
+    uint32_t dead_zone_T;
+    double quant_Q;
+    uint32_t fp_bits;
+    bool map12;
+    bool verify_decode;
+    uint32_t gop;
+};
+
+std::ostream& operator<<(std::ostream& os, const RoundTripMode& mode)
+{
+    return os << mode.name;
+}
+
+class RoundTripTest : public ::testing::TestWithParam<RoundTripMode> {};
+
+TEST_P(RoundTripTest, EncoderReferenceMatchesDecoderOutput)
+{
+    const RoundTripMode& mode = GetParam();
+    const std::vector<Frame> frames = test::make_sequence(96, 72, 14, 7, 9);
+
+    FrameEncoder encoder;
+    FrameEncoder decoder;
+    encoder.set_verify_decode(mode.verify_decode);
+    const QuantizationParams quant(mode.dead_zone_T, mode.quant_Q, mode.fp_bits);
+
+    for (size_t i = 0; i < frames.size(); ++i) {
+        const bool is_keyframe = (i % mode.gop) == 0;
+
+        CompressedFrame compressed;
+        ASSERT_TRUE(encoder.encode_frame(frames[i], is_keyframe, mode.keyframe_near,
+                                         mode.residual_near, quant, compressed, mode.map12))
+            << "frame " << i;
+        ASSERT_EQ(compressed.is_keyframe, is_keyframe);
+
+        Frame decoded;
+        ASSERT_TRUE(decoder.decode_frame(compressed, decoded)) << "frame " << i;
+
+        ASSERT_EQ(decoded.width, frames[i].width);
+        ASSERT_EQ(decoded.height, frames[i].height);
+        ASSERT_EQ(decoded.frame_index, frames[i].frame_index);
+        ASSERT_EQ(decoded.timestamp, frames[i].timestamp);
+        ASSERT_TRUE(decoded.data == encoder.reference_frame().data)
+            << "encoder/decoder mismatch at frame " << i
+            << (is_keyframe ? " (keyframe)" : " (residual)");
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Modes, RoundTripTest,
+    ::testing::Values(
+        RoundTripMode{"lossless_16bit",           0,  0, 0, 1.0, 8, false, true,  5},
+        RoundTripMode{"lossless_12bit",           0,  0, 0, 1.0, 8, true,  true,  5},
+        RoundTripMode{"lossless_no_verify",       0,  0, 0, 1.0, 8, true,  false, 5},
+        RoundTripMode{"quantized_near0",          0,  0, 2, 2.0, 8, true,  true,  7},
+        RoundTripMode{"quantized_near0_16bit",    0,  0, 4, 3.0, 8, false, false, 7},
+        RoundTripMode{"near_lossless_residual",   0, 10, 2, 2.0, 8, true,  true,  7},
+        RoundTripMode{"near_lossless_keyframe",   3, 10, 2, 2.0, 8, true,  true,  7},
+        RoundTripMode{"near_lossless_16bit",      3,  5, 1, 1.5, 8, false, true, 14},
+        RoundTripMode{"fractional_q_fp12",        0,  5, 2, 2.75, 12, true, true,  7},
+        RoundTripMode{"all_intra",                0,  0, 2, 2.0, 8, true,  true,  1}
+    ));
+
+TEST(RoundTrip, LosslessSettingsReproduceInput)
+{
+    // T=0, Q=1 and NEAR=0 everywhere: every frame must come back exactly
+    const std::vector<Frame> frames = test::make_sequence(64, 48, 10, 11, 0);
+
+    FrameEncoder encoder;
+    FrameEncoder decoder;
+    const QuantizationParams quant(0, 1.0, 8);
+
+    for (size_t i = 0; i < frames.size(); ++i) {
+        CompressedFrame compressed;
+        ASSERT_TRUE(encoder.encode_frame(frames[i], i == 0, 0, 0, quant, compressed, false));
+
+        Frame decoded;
+        ASSERT_TRUE(decoder.decode_frame(compressed, decoded));
+        EXPECT_TRUE(decoded.data == frames[i].data) << "frame " << i;
+    }
+}
+
+TEST(RoundTrip, ResidualWithoutKeyframeIsRejected)
+{
+    const std::vector<Frame> frames = test::make_sequence(32, 32, 1);
+
+    FrameEncoder encoder;
+    CompressedFrame compressed;
+    EXPECT_FALSE(encoder.encode_frame(frames[0], false, 0, 0, QuantizationParams(), compressed));
+
+    FrameEncoder decoder;
+    compressed.is_keyframe = false;
+    compressed.width = 32;
+    compressed.height = 32;
+    Frame decoded;
+    EXPECT_FALSE(decoder.decode_frame(compressed, decoded));
+}
+
+} // anonymous namespace
+} // namespace lwir
@@ -0,0 +1,147 @@
+/**
+ * @file test_row_bands.cpp
+ * @brief Row-band ingestion: banded frames match whole-frame encoding
+ */
+
+#include <gtest/gtest.h>
+#include "encoder.hpp"
+#include "pipeline.hpp"
+#include "residual.hpp"
+#include "test_util.hpp"
+#include <algorithm>
+#include <vector>
+
+namespace lwir {
+namespace {
+
+constexpr uint32_t WIDTH = 48;
+constexpr uint32_t HEIGHT = 37;   // Prime: the last band is short for every band size
+
+void expect_same_record(const CompressedFrame& banded, const CompressedFrame& whole, size_t i)
+{
+    EXPECT_EQ(banded.is_keyframe, whole.is_keyframe) << "frame " << i;
+    EXPECT_EQ(banded.is_repeat, whole.is_repeat) << "frame " << i;
+    EXPECT_EQ(banded.near_lossless, whole.near_lossless) << "frame " << i;
+    EXPECT_EQ(banded.frame_index, whole.frame_index) << "frame " << i;
+    EXPECT_EQ(banded.timestamp, whole.timestamp) << "frame " << i;
+    EXPECT_TRUE(banded.compressed_data == whole.compressed_data) << "frame " << i;
+}
+
+// Frames 0 and 5 are keyframes, frame 3 repeats frame 2, NEAR alternates 0 / 3
+TEST(RowBands, MatchWholeFrameEncoding)
+{
+    std::vector<Frame> frames = test::make_sequence(WIDTH, HEIGHT, 8, 61);
+    frames[3].data = frames[2].data;
+    const QuantizationParams quant(2, 2.0, 8);
+
+    for (uint32_t band_rows : {1u, 4u, 8u, HEIGHT}) {
+        FrameEncoder whole;
+        FrameEncoder banded;
+        whole.set_repeat_detection(true, true);
+        banded.set_repeat_detection(true, true);
+
+        for (size_t i = 0; i < frames.size(); ++i) {
+            const Frame& frame = frames[i];
+            const bool is_keyframe = (i == 0 || i == 5);
+            const uint32_t residual_near = (i % 2 == 0) ? 0 : 3;
+
+            CompressedFrame expected;
+            ASSERT_TRUE(whole.encode_frame(frame, is_keyframe, 0, residual_near, quant, expected, true));
+
+            Frame header(frame.width, frame.height, frame.frame_index, frame.timestamp);
+            header.data.clear();
+            ASSERT_TRUE(banded.begin_banded_frame(header, is_keyframe, 0, residual_near, quant, true));
+            for (uint32_t y = 0; y < HEIGHT; y += band_rows) {
+                const uint32_t rows = std::min(band_rows, HEIGHT - y);
+                ASSERT_TRUE(banded.encode_band(y, frame.data.data() + y * WIDTH, rows));
+            }
+            CompressedFrame actual;
+            ASSERT_TRUE(banded.finish_banded_frame(actual));
+
+            expect_same_record(actual, expected, i);
+            EXPECT_EQ(actual.is_repeat, i == 3);
+            EXPECT_TRUE(banded.reference_frame().data == whole.reference_frame().data)
+                << "band rows " << band_rows << ", frame " << i;
+        }
+    }
+}
+
+TEST(RowBands, RejectsBandsOutOfOrder)
+{
+    const std::vector<Frame> frames = test::make_sequence(WIDTH, HEIGHT, 2, 62);
+    const QuantizationParams quant(2, 2.0, 8);
+    FrameEncoder encoder;
+
+    // Residual without a reference
+    EXPECT_FALSE(encoder.begin_banded_frame(frames[0], false, 0, 0, quant));
+
+    ASSERT_TRUE(encoder.begin_banded_frame(frames[0], true, 0, 0, quant));
+    EXPECT_FALSE(encoder.encode_band(4, frames[0].data.data(), 4));   // Skips rows 0-3
+    ASSERT_TRUE(encoder.encode_band(0, frames[0].data.data(), 4));
+    EXPECT_FALSE(encoder.encode_band(0, frames[0].data.data(), 4));   // Repeats rows 0-3
+    EXPECT_FALSE(encoder.encode_band(4, frames[0].data.data(), HEIGHT));   // Past the bottom
+    EXPECT_EQ(encoder.banded_rows(), 4u);
+
+    CompressedFrame compressed;
+    EXPECT_FALSE(encoder.finish_banded_frame(compressed));   // Incomplete
+}
+
+TEST(RowBands, PipelineMatchesWholeFrames)
+{
+    const std::vector<Frame> frames = test::make_sequence(WIDTH, HEIGHT, 10, 63);
+
+    CompressionConfig config;
+    config.gop_period = 4;
+    config.residual_near = 2;
+    config.frame_deadline_ms = 0.0;
+    config.enable_decision_stats = false;   // Not available before the pixels
+    config.verbose = false;
+    config.dry_run = true;
+
+    std::vector<CompressedFrame> expected;
+    {
+        CompressionPipeline pipeline(config);
+        pipeline.set_frame_sink([&](const CompressedFrame& frame, const FrameStats&) {
+            expected.push_back(frame);
+            return true;
+        });
+        for (const Frame& frame : frames) {
+            ASSERT_TRUE(pipeline.process_frame(frame, DeadlineMonitor::Clock::now()));
+        }
+        ASSERT_TRUE(pipeline.finish());
+    }
+
+    std::vector<CompressedFrame> actual;
+    CompressionPipeline pipeline(config);
+    pipeline.set_frame_sink([&](const CompressedFrame& frame, const FrameStats&) {
+        actual.push_back(frame);
+        return true;
+    });
+
+    // Bands of 6 rows out of a padded readout buffer
+    const size_t stride = WIDTH + 16;
+    std::vector<uint16_t> readout(stride * HEIGHT);
+    for (const Frame& frame : frames) {
+        for (uint32_t y = 0; y < HEIGHT; ++y) {
+            std::copy_n(frame.data.begin() + y * WIDTH, WIDTH, readout.begin() + y * stride);
+        }
+        ASSERT_TRUE(pipeline.begin_frame(WIDTH, HEIGHT, frame.frame_index, frame.timestamp,
+                                         DeadlineMonitor::Clock::now()));
+        EXPECT_FALSE(pipeline.process_frame(frame, DeadlineMonitor::Clock::now()));   // Frame in progress
+        for (uint32_t y = 0; y < HEIGHT; y += 6) {
+            ASSERT_TRUE(pipeline.push_rows(y, readout.data() + y * stride, std::min(6u, HEIGHT - y), stride));
+        }
+    }
+    ASSERT_TRUE(pipeline.finish());
+
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < actual.size(); ++i) {
+        expect_same_record(actual[i], expected[i], i);
+    }
+    EXPECT_TRUE(actual[0].is_keyframe);
+    EXPECT_TRUE(actual[4].is_keyframe);
+    EXPECT_FALSE(actual[1].is_keyframe);
+}
+
+} // anonymous namespace
+} // namespace lwir
@@ -0,0 +1,355 @@
+/**
+ * @file test_segments.cpp
+ * @brief Segmented output: rollover at keyframes, manifest, recovery, resume, ring storage
+ */
+
+#include <gtest/gtest.h>
+#include "frame_format.hpp"
+#include "pipeline.hpp"
+#include "segment.hpp"
+#include "test_util.hpp"
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace lwir {
+namespace {
+
+// Record with a keyframe every 4 frames, 33 ms apart, payload derived from the index
+CompressedFrame make_record(uint32_t index, size_t payload_size = 100)
+{
+    CompressedFrame frame;
+    frame.width = 16;
+    frame.height = 8;
+    frame.frame_index = index;
+    frame.timestamp = uint64_t(index) * 33333;
+    frame.is_keyframe = (index % 4 == 0);
+    frame.compressed_data.resize(payload_size);
+    for (size_t i = 0; i < payload_size; ++i) {
+        frame.compressed_data[i] = static_cast<uint8_t>(index * 31 + i);
+    }
+    return frame;
+}
+
+using SegmentTest = test::TempDirTest;
+
+TEST_F(SegmentTest, RollsOverAtKeyframesAfterEachLimit)
+{
+    struct Case {
+        SegmentLimits limits;
+        std::vector<uint32_t> first_frames;
+    };
+    std::vector<Case> cases(3);
+    cases[0].limits.gops = 2;                 // Keyframes 0, 4 | 8, 12 | 16
+    cases[0].first_frames = {0, 8, 16};
+    cases[1].limits.bytes = 5 * (FRAME_HEADER_SIZE + 100);
+    cases[1].first_frames = {0, 8, 16};       // 5 records reached mid-GOP: wait for the keyframe
+    cases[2].limits.duration_us = 150000;     // 4.5 frames of capture time
+    cases[2].first_frames = {0, 8, 16};
+
+    for (const Case& c : cases) {
+        std::vector<uint32_t> completed;
+        SegmentWriter writer;
+        writer.set_completion_callback([&](const std::string& dir, const SegmentInfo& segment) {
+            EXPECT_EQ(dir, dir_);
+            EXPECT_TRUE(segment.complete);
+            completed.push_back(segment.first_frame);
+        });
+        ASSERT_TRUE(writer.open(dir_, c.limits));
+        for (uint32_t i = 0; i < 20; ++i) {
+            ASSERT_TRUE(writer.append(make_record(i)));
+        }
+
+        // The open segment is listed, and not complete
+        std::vector<SegmentInfo> listed;
+        ASSERT_TRUE(read_segment_manifest(dir_, listed));
+        ASSERT_EQ(listed.size(), c.first_frames.size());
+        EXPECT_FALSE(listed.back().complete);
+        EXPECT_EQ(completed.size(), c.first_frames.size() - 1);
+
+        ASSERT_TRUE(writer.close());
+        EXPECT_TRUE(completed == c.first_frames);
+
+        ASSERT_TRUE(read_segment_manifest(dir_, listed));
+        ASSERT_EQ(listed.size(), c.first_frames.size());
+        for (size_t s = 0; s < listed.size(); ++s) {
+            EXPECT_TRUE(listed[s].complete);
+            EXPECT_EQ(listed[s].sequence, s);
+            EXPECT_EQ(listed[s].first_frame, c.first_frames[s]);
+            EXPECT_EQ(listed[s].first_timestamp, c.first_frames[s] * 33333u);
+            const uint32_t last = (s + 1 < listed.size()) ? c.first_frames[s + 1] - 1 : 19;
+            EXPECT_EQ(listed[s].last_frame, last);
+            EXPECT_EQ(listed[s].frame_count, last - c.first_frames[s] + 1);
+            EXPECT_EQ(listed[s].keyframes, listed[s].frame_count / 4 + (listed[s].frame_count % 4 ? 1 : 0));
+            EXPECT_EQ(listed[s].bytes, listed[s].frame_count * (FRAME_HEADER_SIZE + 100));
+        }
+
+        ASSERT_TRUE(remove_directory_tree(dir_));
+        ASSERT_EQ(::mkdir(dir_.c_str(), 0700), 0);
+    }
+}
+
+TEST_F(SegmentTest, ReaderOpensOnlyTheSegmentsItNeeds)
+{
+    SegmentLimits limits;
+    limits.gops = 1;
+    {
+        SegmentWriter writer;
+        ASSERT_TRUE(writer.open(dir_, limits));
+        for (uint32_t i = 0; i < 16; ++i) {
+            ASSERT_TRUE(writer.append(make_record(i, 40 + i), i == 5 ? 3 : 0));
+        }
+    }
+
+    SegmentReader reader;
+    ASSERT_TRUE(reader.open(dir_));
+    ASSERT_EQ(reader.segments().size(), 4u);
+
+    // Frames 5 - 9 span segments 1 and 2
+    const std::vector<size_t> between = reader.segments_between(5 * 33333, 9 * 33333);
+    ASSERT_EQ(between.size(), 2u);
+    EXPECT_EQ(between[0], 1u);
+    EXPECT_EQ(between[1], 2u);
+
+    std::vector<ArchiveEntry> entries;
+    std::vector<uint64_t> offsets;
+    ASSERT_TRUE(reader.read_entries(1, entries, &offsets));
+    ASSERT_EQ(entries.size(), 4u);
+    EXPECT_EQ(entries[0].header.frame_index, 4u);
+    EXPECT_EQ(entries[1].frames_dropped, 3u);
+    EXPECT_EQ(offsets[0], 0u);
+    EXPECT_EQ(offsets[1], FRAME_HEADER_SIZE + 44u);
+
+    for (uint32_t i : {15u, 0u, 7u, 8u}) {
+        CompressedFrame frame;
+        ASSERT_TRUE(reader.read_frame(i, frame));
+        EXPECT_EQ(frame.frame_index, i);
+        EXPECT_TRUE(frame.compressed_data == make_record(i, 40 + i).compressed_data) << "frame " << i;
+    }
+    CompressedFrame missing;
+    EXPECT_FALSE(reader.read_frame(16, missing));
+
+    // No manifest: not a segmented archive
+    SegmentReader empty;
+    EXPECT_FALSE(empty.open(dir_ + "/missing"));
+}
+
+TEST_F(SegmentTest, RecoversSegmentLeftOpenByCrash)
+{
+    SegmentLimits limits;
+    limits.gops = 1;
+    {
+        SegmentWriter writer;
+        ASSERT_TRUE(writer.open(dir_, limits));
+        for (uint32_t i = 0; i < 7; ++i) {
+            ASSERT_TRUE(writer.append(make_record(i)));
+        }
+    }
+
+    // As the crash left it: manifest from when segment 1 started, index
+    // missing its last entry, half a record at the end
+    std::vector<SegmentInfo> listed;
+    ASSERT_TRUE(read_segment_manifest(dir_, listed));
+    listed[1] = SegmentInfo();
+    listed[1].sequence = 1;
+    ASSERT_TRUE(write_segment_manifest(dir_, listed));
+    const std::string index = dir_ + "/" + segment_index_name(1);
+    ASSERT_EQ(::truncate(index.c_str(), ARCHIVE_INDEX_MAGIC_SIZE + 2 * ARCHIVE_INDEX_ENTRY_SIZE), 0);
+    {
+        std::ofstream ofs(dir_ + "/" + segment_file_name(1), std::ios::binary | std::ios::app);
+        ofs << "partial record";
+    }
+
+    SegmentReader reader;
+    ASSERT_TRUE(reader.open(dir_));
+    ASSERT_EQ(reader.segments().size(), 2u);
+    const SegmentInfo& recovered = reader.segments()[1];
+    EXPECT_FALSE(recovered.complete);
+    EXPECT_EQ(recovered.first_frame, 4u);
+    EXPECT_EQ(recovered.last_frame, 6u);
+    EXPECT_EQ(recovered.frame_count, 3u);
+    EXPECT_EQ(recovered.last_timestamp, 6 * 33333u);
+    CompressedFrame frame;
+    ASSERT_TRUE(reader.read_frame(6, frame));
+    EXPECT_TRUE(frame.compressed_data == make_record(6).compressed_data);
+
+    // A new session closes it and continues the numbering
+    SegmentWriter writer;
+    ASSERT_TRUE(writer.open(dir_, limits));
+    ASSERT_TRUE(writer.append(make_record(8)));
+    ASSERT_TRUE(writer.close());
+    ASSERT_TRUE(read_segment_manifest(dir_, listed));
+    ASSERT_EQ(listed.size(), 3u);
+    EXPECT_TRUE(listed[1].complete);
+    EXPECT_EQ(listed[1].frame_count, 3u);
+    EXPECT_EQ(listed[2].sequence, 2u);
+    EXPECT_EQ(listed[2].first_frame, 8u);
+}
+
+uint64_t segment_files_size(const std::string& dir, const std::vector<SegmentInfo>& segments)
+{
+    uint64_t total = 0;
+    for (const SegmentInfo& segment : segments) {
+        for (const std::string& name : {segment_file_name(segment.sequence), segment_index_name(segment.sequence)}) {
+            std::ifstream ifs(dir + "/" + name, std::ios::binary | std::ios::ate);
+            total += static_cast<uint64_t>(ifs.tellg());
+        }
+    }
+    return total;
+}
+
+TEST_F(SegmentTest, RingKeepsNewestSegmentsWithinBudget)
+{
+    // 150-byte records, keyframe every 4: segments of 8 frames (1200 B
+    // plus a 440 B index), two of which fit in the budget
+    SegmentLimits limits;
+    limits.bytes = 5 * (FRAME_HEADER_SIZE + 100);
+    limits.budget_bytes = 4000;
+
+    SegmentWriter writer;
+    ASSERT_TRUE(writer.open(dir_, limits));
+    for (uint32_t i = 0; i < 100; ++i) {
+        ASSERT_TRUE(writer.append(make_record(i)));
+        ASSERT_LE(segment_files_size(dir_, writer.segments()), limits.budget_bytes) << "frame " << i;
+    }
+    ASSERT_TRUE(writer.close());
+    EXPECT_EQ(writer.reclaimed_segments(), 11u);
+
+    // A consistent recent window: frames 88 - 99, starting at a keyframe
+    SegmentReader reader;
+    ASSERT_TRUE(reader.open(dir_));
+    ASSERT_EQ(reader.segments().size(), 2u);
+    EXPECT_EQ(reader.segments()[0].sequence, 11u);
+    EXPECT_EQ(reader.segments()[0].first_frame, 88u);
+    for (uint32_t i = 88; i < 100; ++i) {
+        CompressedFrame frame;
+        ASSERT_TRUE(reader.read_frame(i, frame)) << "frame " << i;
+        EXPECT_TRUE(frame.compressed_data == make_record(i).compressed_data) << "frame " << i;
+    }
+    CompressedFrame reclaimed;
+    EXPECT_FALSE(reader.read_frame(87, reclaimed));
+    std::ifstream oldest(dir_ + "/" + segment_file_name(10));
+    EXPECT_FALSE(oldest.good());
+
+    // Power loss between the manifest update and the delete leaves orphans,
+    // removed when the ring is opened again
+    std::ofstream(dir_ + "/" + segment_file_name(10)) << "orphan";
+    std::ofstream(dir_ + "/" + segment_index_name(10)) << "orphan";
+    ASSERT_TRUE(writer.open(dir_, limits));
+    std::ifstream orphan(dir_ + "/" + segment_file_name(10));
+    EXPECT_FALSE(orphan.good());
+    ASSERT_TRUE(writer.append(make_record(100)));
+    ASSERT_TRUE(writer.close());
+    ASSERT_TRUE(reader.open(dir_));
+    EXPECT_EQ(reader.segments().back().sequence, 13u);
+
+    CompressionConfig config;
+    config.storage_budget_mb = 64;
+    EXPECT_FALSE(config.validate_parameters());   // No segment size
+    config.segment_mb = 48;
+    EXPECT_FALSE(config.validate_parameters());   // Not two segments
+    config.segment_mb = 16;
+    EXPECT_TRUE(config.validate_parameters());
+}
+
+CompressionConfig segment_config(const std::string& output_dir)
+{
+    CompressionConfig config;
+    config.output_dir = output_dir;
+    config.gop_period = 5;
+    config.keyframe_near = 0;
+    config.residual_near = 0;
+    config.dead_zone_T = 0;
+    config.quant_Q = 1.0;
+    config.frame_deadline_ms = 0.0;
+    config.decision_hysteresis_bpp = 0.0;   // Keep the GOP structure (keyframes 0, 5, 10, ...)
+    config.segment_gops = 2;
+    config.verbose = false;
+    return config;
+}
+
+TEST_F(SegmentTest, PipelineWritesDecodableSegments)
+{
+    const std::vector<Frame> frames = test::make_sequence(40, 32, 23, 91);
+    CompressionConfig config = segment_config(dir_ + "/out");
+    ASSERT_TRUE(config.validate_parameters());
+
+    std::vector<uint32_t> completed;
+    {
+        CompressionPipeline pipeline(config);
+        pipeline.set_segment_callback([&](const std::string&, const SegmentInfo& segment) {
+            completed.push_back(segment.sequence);
+        });
+        for (const Frame& frame : frames) {
+            ASSERT_TRUE(pipeline.process_frame(frame, DeadlineMonitor::Clock::now()));
+        }
+        ASSERT_TRUE(pipeline.finish());
+    }
+    EXPECT_EQ(completed.size(), 3u);   // Frames 0-9, 10-19, 20-22
+
+    std::ifstream per_frame(config.output_dir + "/" + frame_file_name(0));
+    EXPECT_FALSE(per_frame.good());
+
+    SegmentReader reader;
+    ASSERT_TRUE(reader.open(config.output_dir));
+    ASSERT_EQ(reader.segments().size(), 3u);
+    EXPECT_EQ(reader.segments()[1].first_frame, 10u);
+
+    // Each segment decodes on its own, starting at its keyframe
+    for (const SegmentInfo& segment : reader.segments()) {
+        FrameEncoder decoder;
+        for (uint32_t i = segment.first_frame; i <= segment.last_frame; ++i) {
+            CompressedFrame record;
+            ASSERT_TRUE(reader.read_frame(i, record)) << "frame " << i;
+            EXPECT_EQ(record.is_keyframe, i == segment.first_frame || i % 5 == 0) << "frame " << i;
+            Frame decoded;
+            ASSERT_TRUE(decoder.decode_frame(record, decoded)) << "frame " << i;
+            EXPECT_TRUE(decoded.data == frames[i].data) << "frame " << i;
+        }
+    }
+}
+
+TEST_F(SegmentTest, ResumedSessionRollsForwardThroughSegments)
+{
+    const std::vector<Frame> frames = test::make_sequence(40, 32, 14, 92);
+    CompressionConfig config = segment_config(dir_ + "/out");
+    config.checkpoint_path = dir_ + "/encoder.ckpt";
+
+    {
+        CompressionPipeline first(config);
+        for (size_t i = 0; i < 8; ++i) {
+            ASSERT_TRUE(first.process_frame(frames[i], DeadlineMonitor::Clock::now()));
+        }
+    }
+
+    // Checkpoint of keyframe 5, frames 6 and 7 rolled forward from the segment
+    CompressionPipeline second(config);
+    ASSERT_TRUE(second.restore_checkpoint(config.checkpoint_path));
+    EXPECT_EQ(second.resume_frame_index(), 8u);
+    for (size_t i = second.resume_frame_index(); i < frames.size(); ++i) {
+        ASSERT_TRUE(second.process_frame(frames[i], DeadlineMonitor::Clock::now()));
+    }
+    ASSERT_TRUE(second.finish());
+
+    SegmentReader reader;
+    ASSERT_TRUE(reader.open(config.output_dir));
+    ASSERT_EQ(reader.segments().size(), 2u);
+    EXPECT_EQ(reader.segments()[0].last_frame, 7u);
+    EXPECT_EQ(reader.segments()[1].first_frame, 8u);   // The resumed session's segment starts mid-GOP
+    EXPECT_EQ(reader.segments()[1].keyframes, 1u);
+
+    FrameEncoder decoder;
+    for (uint32_t i = 0; i < frames.size(); ++i) {
+        CompressedFrame record;
+        ASSERT_TRUE(reader.read_frame(i, record)) << "frame " << i;
+        Frame decoded;
+        ASSERT_TRUE(decoder.decode_frame(record, decoded)) << "frame " << i;
+        EXPECT_TRUE(decoded.data == frames[i].data) << "frame " << i;
+    }
+}
+
+} // anonymous namespace
+} // namespace lwir
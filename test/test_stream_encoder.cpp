@@ -0,0 +1,151 @@
+/**
+ * @file test_stream_encoder.cpp
+ * @brief StreamEncoder delivery order, stride handling and backpressure
+ */
+
+#include <gtest/gtest.h>
+#include "stream_encoder.hpp"
+#include "test_util.hpp"
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+namespace lwir {
+namespace {
+
+TEST(StreamEncoder, DeliversDecodableFramesInOrder)
+{
+    const std::vector<Frame> frames = test::make_sequence(48, 40, 12, 3, 0);
+
+    std::vector<CompressedFrame> encoded;
+    {
+        StreamEncoder stream(test::lossless_config(),
+                             [&](const CompressedFrame& frame, const FrameStats&) {
+                                 encoded.push_back(frame);
+                             });
+
+        // Padded rows: 48 samples of image, 16 of garbage
+        const size_t stride = 64;
+        std::vector<uint16_t> padded(stride * 40, 0xBEEF);
+        for (const Frame& f : frames) {
+            for (uint32_t y = 0; y < f.height; ++y) {
+                std::copy(f.data.begin() + y * f.width, f.data.begin() + (y + 1) * f.width,
+                          padded.begin() + y * stride);
+            }
+            ASSERT_TRUE(stream.push(FrameView(padded.data(), f.width, f.height, stride, f.timestamp), true));
+        }
+        ASSERT_TRUE(stream.flush());
+        EXPECT_EQ(stream.frames_pushed(), frames.size());
+        EXPECT_EQ(stream.frames_dropped(), 0u);
+        EXPECT_EQ(stream.stats().total_frames, frames.size());
+    }
+
+    ASSERT_EQ(encoded.size(), frames.size());
+    EXPECT_TRUE(encoded[0].is_keyframe);
+    FrameEncoder decoder;
+    for (size_t i = 0; i < encoded.size(); ++i) {
+        EXPECT_EQ(encoded[i].frame_index, i);
+        EXPECT_EQ(encoded[i].timestamp, frames[i].timestamp);
+
+        Frame decoded;
+        ASSERT_TRUE(decoder.decode_frame(encoded[i], decoded));
+        EXPECT_TRUE(decoded.data == frames[i].data) << "frame " << i;
+    }
+}
+
+TEST(StreamEncoder, OverlappedCodingKeepsOrderAndBitstream)
+{
+    const std::vector<Frame> frames = test::make_sequence(48, 40, 16, 13, 0);
+
+    std::vector<CompressedFrame> encoded[2];
+    for (uint32_t workers = 0; workers < 2; ++workers) {
+        CompressionConfig config = test::lossless_config();
+        config.encode_workers = workers * 2;
+        StreamEncoder stream(config, [&](const CompressedFrame& frame, const FrameStats&) {
+            encoded[workers].push_back(frame);
+        });
+        for (const Frame& f : frames) {
+            ASSERT_TRUE(stream.push(FrameView(f.data.data(), f.width, f.height, 0, f.timestamp), true));
+        }
+        ASSERT_TRUE(stream.flush());
+        ASSERT_EQ(encoded[workers].size(), frames.size());   // Nothing left with the workers
+    }
+
+    for (size_t i = 0; i < frames.size(); ++i) {
+        EXPECT_EQ(encoded[1][i].frame_index, i);
+        EXPECT_EQ(encoded[1][i].is_keyframe, encoded[0][i].is_keyframe) << "frame " << i;
+        EXPECT_TRUE(encoded[1][i].compressed_data == encoded[0][i].compressed_data) << "frame " << i;
+    }
+}
+
+TEST(StreamEncoder, DropsWhenBuffersAreBusy)
+{
+    const std::vector<Frame> frames = test::make_sequence(32, 32, 1);
+
+    std::mutex gate;
+    gate.lock();   // Hold the encoder thread inside the first callback
+    uint32_t delivered = 0;
+    StreamEncoder stream(test::lossless_config(),
+                         [&](const CompressedFrame&, const FrameStats&) {
+                             std::lock_guard<std::mutex> hold(gate);
+                             delivered++;
+                         },
+                         2);
+
+    const FrameView view(frames[0].data.data(), 32, 32);
+    uint32_t accepted = 0;
+    for (int i = 0; i < 5; ++i) {
+        accepted += stream.push(view) ? 1 : 0;
+    }
+    EXPECT_EQ(accepted, 2u);
+    EXPECT_EQ(stream.frames_dropped(), 3u);
+
+    gate.unlock();
+    ASSERT_TRUE(stream.flush());
+    EXPECT_EQ(delivered, 2u);
+}
+
+using StreamEncoderSession = test::TempDirTest;
+
+TEST_F(StreamEncoderSession, FinishEndsTheSessionOnce)
+{
+    const std::string stats_path = dir_ + "/compression_stats.json";
+
+    const std::vector<Frame> frames = test::make_sequence(32, 32, 4);
+    CompressionConfig config = test::lossless_config();
+    config.output_dir = dir_;
+    uint32_t delivered = 0;
+    {
+        StreamEncoder stream(config, [&](const CompressedFrame&, const FrameStats&) { delivered++; });
+        for (const Frame& f : frames) {
+            ASSERT_TRUE(stream.push(FrameView(f.data.data(), f.width, f.height), true));
+        }
+        ASSERT_TRUE(stream.flush());
+        EXPECT_FALSE(std::ifstream(stats_path).good());   // flush() keeps the session open
+
+        ASSERT_TRUE(stream.finish());
+        EXPECT_EQ(delivered, frames.size());
+        EXPECT_TRUE(std::ifstream(stats_path).good());
+        EXPECT_EQ(stream.stats().total_frames, frames.size());
+
+        // Closed: nothing more is taken, and a second finish changes nothing
+        EXPECT_FALSE(stream.push(FrameView(frames[0].data.data(), 32, 32), true));
+        ASSERT_EQ(::unlink(stats_path.c_str()), 0);
+        EXPECT_TRUE(stream.finish());
+    }
+    EXPECT_FALSE(std::ifstream(stats_path).good());   // Nor does the destructor
+}
+
+TEST(StreamEncoder, RejectsInvalidView)
+{
+    StreamEncoder stream(test::lossless_config(), nullptr);
+    std::vector<uint16_t> pixels(16);
+    EXPECT_FALSE(stream.push(FrameView(nullptr, 4, 4)));
+    EXPECT_FALSE(stream.push(FrameView(pixels.data(), 4, 4, 2)));
+    EXPECT_TRUE(stream.ok());
+}
+
+} // anonymous namespace
+} // namespace lwir
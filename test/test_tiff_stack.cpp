@@ -0,0 +1,186 @@
+/**
+ * @file test_tiff_stack.cpp
+ * @brief Multi-page TIFF stacks: page walk, strip codings, prefetch, pipeline input
+ */
+
+#include <gtest/gtest.h>
+#include "pipeline.hpp"
+#include "test_util.hpp"
+#include "tiff_stack.hpp"
+#include "worker_pool.hpp"
+#include <fstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+namespace lwir {
+namespace {
+
+class TiffStackTest : public test::TempDirTest {
+protected:
+    std::string write_stack(const std::string& name, const std::vector<Frame>& frames,
+                            TiffCompression compression, uint32_t rows_per_strip = 0, bool big_endian = false)
+    {
+        const std::string path = dir_ + "/" + name;
+        TiffStackWriter writer;
+        EXPECT_TRUE(writer.open(path, compression, rows_per_strip, big_endian));
+        for (const Frame& frame : frames) {
+            EXPECT_TRUE(writer.append(frame));
+        }
+        EXPECT_EQ(writer.page_count(), frames.size());
+        EXPECT_TRUE(writer.close());
+        return path;
+    }
+};
+
+TEST_F(TiffStackTest, EveryStripCodingRoundTrips)
+{
+    std::vector<Frame> frames = test::make_sequence(37, 23, 3, 81);   // Odd sizes: uneven last strip
+    frames[1].data.assign(frames[1].data.size(), 4242);                // Long runs for PackBits/LZW
+    const TiffCompression codings[] = {
+        TiffCompression::NONE, TiffCompression::PACKBITS, TiffCompression::LZW, TiffCompression::DEFLATE,
+    };
+
+    for (TiffCompression coding : codings) {
+        for (bool big_endian : {false, true}) {
+            for (uint32_t rows_per_strip : {0u, 5u}) {
+                const std::string path = write_stack("stack.tif", frames, coding, rows_per_strip, big_endian);
+                TiffStackSource source;
+                ASSERT_TRUE(source.open(path));
+                ASSERT_EQ(source.frame_count(), frames.size());
+                for (size_t i = 0; i < frames.size(); ++i) {
+                    Frame frame;
+                    ASSERT_TRUE(source.read_frame(i, frame));
+                    EXPECT_EQ(frame.width, 37u);
+                    EXPECT_EQ(frame.height, 23u);
+                    EXPECT_EQ(frame.frame_index, i);
+                    EXPECT_TRUE(frame.data == frames[i].data)
+                        << "coding " << static_cast<int>(coding) << (big_endian ? " MM" : " II")
+                        << ", rows per strip " << rows_per_strip << ", page " << i;
+                }
+            }
+        }
+    }
+}
+
+TEST_F(TiffStackTest, LzwResetsItsTable)
+{
+    // Enough distinct strings to fill the 4096-entry table several times
+    Frame frame(512, 256, 0, 0);
+    uint32_t state = 12345;
+    for (uint16_t& sample : frame.data) {
+        state = state * 1103515245u + 12345u;
+        sample = static_cast<uint16_t>(state >> 16);
+    }
+    const std::string path = write_stack("noise.tif", {frame}, TiffCompression::LZW);
+
+    TiffStackSource source;
+    ASSERT_TRUE(source.open(path));
+    Frame decoded;
+    ASSERT_TRUE(source.read_frame(0, decoded));
+    EXPECT_TRUE(decoded.data == frame.data);
+}
+
+TEST_F(TiffStackTest, UncompressedPagesAreMapped)
+{
+    const std::vector<Frame> frames = test::make_sequence(32, 16, 2, 82);
+    TiffStackSource plain;
+    ASSERT_TRUE(plain.open(write_stack("plain.tif", frames, TiffCompression::NONE, 4)));
+    const uint16_t* samples = plain.mapped_samples(1);
+    ASSERT_NE(samples, nullptr);
+    EXPECT_TRUE(std::equal(frames[1].data.begin(), frames[1].data.end(), samples));
+    EXPECT_EQ(plain.mapped_samples(2), nullptr);
+
+    TiffStackSource deflate;
+    ASSERT_TRUE(deflate.open(write_stack("deflate.tif", frames, TiffCompression::DEFLATE)));
+    EXPECT_EQ(deflate.mapped_samples(0), nullptr);
+}
+
+TEST_F(TiffStackTest, PrefetchedPagesMatchInlineDecode)
+{
+    const std::vector<Frame> frames = test::make_sequence(48, 32, 12, 83);
+    const std::string path = write_stack("stack.tif", frames, TiffCompression::DEFLATE, 8);
+
+    WorkerPool pool(3);
+    TiffStackSource source;
+    ASSERT_TRUE(source.open(path));
+    source.set_prefetch_pool(&pool, 4);
+
+    // In order, then skipping ahead and going back
+    const size_t order[] = {0, 1, 2, 3, 4, 8, 9, 2, 3, 11, 10};
+    for (size_t index : order) {
+        Frame frame;
+        ASSERT_TRUE(source.read_frame(index, frame));
+        EXPECT_EQ(frame.frame_index, index);
+        EXPECT_TRUE(frame.data == frames[index].data) << "page " << index;
+    }
+}
+
+TEST_F(TiffStackTest, DirectoryOfStacksAndBadInput)
+{
+    const std::vector<Frame> frames = test::make_sequence(24, 16, 5, 84);
+    write_stack("flight_b.tif", {frames[3], frames[4]}, TiffCompression::PACKBITS);
+    write_stack("flight_a.tiff", {frames[0], frames[1], frames[2]}, TiffCompression::NONE);
+
+    TiffStackSource source;
+    ASSERT_TRUE(source.open(dir_));
+    ASSERT_EQ(source.frame_count(), 5u);
+    for (size_t i = 0; i < frames.size(); ++i) {
+        Frame frame;
+        ASSERT_TRUE(source.read_frame(i, frame));
+        EXPECT_TRUE(frame.data == frames[i].data) << "frame " << i;
+    }
+
+    std::ofstream(dir_ + "/not_a.tif") << "definitely not a TIFF";
+    TiffStackSource bad;
+    EXPECT_FALSE(bad.open(dir_));
+    EXPECT_FALSE(bad.open(dir_ + "/missing.tif"));
+
+    // Cut short inside the first page, before its IFD
+    const std::string path = write_stack("cut.tif", frames, TiffCompression::NONE);
+    ASSERT_EQ(::truncate(path.c_str(), 200), 0);
+    EXPECT_FALSE(bad.open(path));
+}
+
+TEST_F(TiffStackTest, PipelineReadsStacks)
+{
+    const std::vector<Frame> frames = test::make_sequence(40, 24, 6, 85);
+    write_stack("flight.tif", frames, TiffCompression::DEFLATE, 8);
+
+    CompressionConfig config;
+    config.input_dir = dir_ + "/flight.tif";
+    config.input_format = "tiff";
+    config.prefetch_workers = 2;
+    config.residual_near = 1;
+    config.frame_deadline_ms = 0.0;
+    config.verbose = false;
+    config.dry_run = true;
+    ASSERT_TRUE(config.validate_parameters());
+
+    std::vector<CompressedFrame> expected;
+    {
+        CompressionPipeline pipeline(config);
+        pipeline.set_frame_sink([&](const CompressedFrame& frame, const FrameStats&) {
+            expected.push_back(frame);
+            return true;
+        });
+        MemoryFrameSource source(frames);
+        ASSERT_TRUE(pipeline.run(source));
+    }
+
+    std::vector<CompressedFrame> actual;
+    CompressionPipeline pipeline(config);
+    pipeline.set_frame_sink([&](const CompressedFrame& frame, const FrameStats&) {
+        actual.push_back(frame);
+        return true;
+    });
+    ASSERT_TRUE(pipeline.run());
+
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < actual.size(); ++i) {
+        EXPECT_TRUE(actual[i].compressed_data == expected[i].compressed_data) << "frame " << i;
+    }
+}
+
+} // anonymous namespace
+} // namespace lwir
@@ -0,0 +1,233 @@
+/**
+ * @file test_timeline.cpp
+ * @brief Dropped-frame detection, gap policies and gap records in the index
+ */
+
+#include <gtest/gtest.h>
+#include "archive.hpp"
+#include "frame_source.hpp"
+#include "pipeline.hpp"
+#include "test_util.hpp"
+#include "timeline.hpp"
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace lwir {
+namespace {
+
+constexpr double PERIOD_US = 33333.0;
+
+TEST(Timeline, CountsWholePeriodsMissing)
+{
+    EXPECT_EQ(count_dropped_frames(0, 33333, PERIOD_US), 0u);
+    EXPECT_EQ(count_dropped_frames(0, 45000, PERIOD_US), 0u);    // Jitter
+    EXPECT_EQ(count_dropped_frames(0, 66666, PERIOD_US), 1u);
+    EXPECT_EQ(count_dropped_frames(0, 60000, PERIOD_US), 1u);    // 1.8 periods
+    EXPECT_EQ(count_dropped_frames(100, 100 + 5 * 33333, PERIOD_US), 4u);
+    EXPECT_EQ(count_dropped_frames(66666, 33333, PERIOD_US), 0u); // Backwards
+    EXPECT_EQ(count_dropped_frames(0, 1000000, 0.0), 0u);         // No period
+
+    GapDetector detector(PERIOD_US);
+    EXPECT_EQ(detector.observe(500000), 0u);   // First frame
+    EXPECT_EQ(detector.observe(533333), 0u);
+    EXPECT_EQ(detector.observe(633332), 2u);
+    detector.reset();
+    EXPECT_EQ(detector.observe(2000000), 0u);
+    detector.seed(0);
+    EXPECT_EQ(detector.observe(3 * 33333), 2u);
+
+    GapPolicy policy;
+    EXPECT_TRUE(parse_gap_policy("widen", policy));
+    EXPECT_EQ(policy, GapPolicy::WIDEN);
+    EXPECT_FALSE(parse_gap_policy("skip", policy));
+}
+
+// Capture of 12 frames with frames 5 and 6 dropped, numbered by position
+std::vector<Frame> capture_with_gap()
+{
+    const std::vector<Frame> source = test::make_sequence(40, 32, 12, 51);
+    std::vector<Frame> frames;
+    for (const Frame& frame : source) {
+        if (frame.frame_index == 5 || frame.frame_index == 6) {
+            continue;
+        }
+        frames.push_back(frame);
+        frames.back().frame_index = static_cast<uint32_t>(frames.size() - 1);
+    }
+    return frames;
+}
+
+CompressionConfig gap_config(const std::string& policy)
+{
+    CompressionConfig config;
+    config.gop_period = 60;
+    config.residual_near = 2;
+    config.frame_deadline_ms = 0.0;
+    config.decision_hysteresis_bpp = 0.0;   // Small frames: keep the GOP structure
+    config.verbose = false;
+    config.dry_run = true;
+    config.frame_period_us = PERIOD_US;
+    config.gap_policy = policy;
+    config.gap_widen_near = 3;
+    return config;
+}
+
+std::vector<CompressedFrame> run_pipeline(CompressionPipeline& pipeline, const std::vector<Frame>& frames,
+                                          std::vector<FrameStats>* stats = nullptr)
+{
+    std::vector<CompressedFrame> encoded;
+    pipeline.set_frame_sink([&](const CompressedFrame& frame, const FrameStats& frame_stats) {
+        encoded.push_back(frame);
+        if (stats) {
+            stats->push_back(frame_stats);
+        }
+        return true;
+    });
+    for (const Frame& frame : frames) {
+        EXPECT_TRUE(pipeline.process_frame(frame, DeadlineMonitor::Clock::now()));
+    }
+    EXPECT_TRUE(pipeline.finish());
+    return encoded;
+}
+
+TEST(Timeline, GapPolicies)
+{
+    const std::vector<Frame> frames = capture_with_gap();
+
+    {
+        CompressionPipeline pipeline(gap_config("keyframe"));
+        std::vector<FrameStats> stats;
+        const std::vector<CompressedFrame> encoded = run_pipeline(pipeline, frames, &stats);
+        ASSERT_EQ(encoded.size(), frames.size());
+        for (size_t i = 0; i < encoded.size(); ++i) {
+            EXPECT_EQ(encoded[i].is_keyframe, i == 0 || i == 5) << "frame " << i;
+            EXPECT_EQ(stats[i].frames_dropped, i == 5 ? 2u : 0u) << "frame " << i;
+        }
+        EXPECT_EQ(pipeline.session_stats().timestamp_gaps, 1u);
+        EXPECT_EQ(pipeline.session_stats().frames_dropped, 2u);
+    }
+
+    {
+        CompressionPipeline pipeline(gap_config("widen"));
+        const std::vector<CompressedFrame> encoded = run_pipeline(pipeline, frames);
+        ASSERT_EQ(encoded.size(), frames.size());
+        EXPECT_FALSE(encoded[5].is_keyframe);
+        EXPECT_EQ(encoded[4].near_lossless, 2u);
+        EXPECT_EQ(encoded[5].near_lossless, 5u);
+        EXPECT_EQ(encoded[6].near_lossless, 2u);
+    }
+
+    {
+        CompressionPipeline pipeline(gap_config("ignore"));
+        const std::vector<CompressedFrame> encoded = run_pipeline(pipeline, frames);
+        ASSERT_EQ(encoded.size(), frames.size());
+        EXPECT_FALSE(encoded[5].is_keyframe);
+        EXPECT_EQ(encoded[5].near_lossless, 2u);
+        EXPECT_EQ(pipeline.session_stats().timestamp_gaps, 1u);
+    }
+
+    // Without a nominal period nothing is detected
+    CompressionConfig config = gap_config("keyframe");
+    config.frame_period_us = 0.0;
+    CompressionPipeline pipeline(config);
+    const std::vector<CompressedFrame> encoded = run_pipeline(pipeline, frames);
+    EXPECT_FALSE(encoded[5].is_keyframe);
+    EXPECT_EQ(pipeline.session_stats().timestamp_gaps, 0u);
+}
+
+class TimelineArchiveTest : public test::TempDirTest {
+protected:
+    std::string index_path() const { return dir_ + "/" + ARCHIVE_INDEX_FILE; }
+};
+
+TEST_F(TimelineArchiveTest, IndexRecordsDroppedFrames)
+{
+    CompressionConfig config = gap_config("keyframe");
+    config.dry_run = false;
+    config.output_dir = dir_;
+
+    const std::vector<Frame> frames = capture_with_gap();
+    {
+        CompressionPipeline pipeline(config);
+        for (const Frame& frame : frames) {
+            ASSERT_TRUE(pipeline.process_frame(frame, DeadlineMonitor::Clock::now()));
+        }
+    }
+
+    std::vector<ArchiveEntry> entries;
+    ASSERT_TRUE(read_archive_index(index_path(), entries));
+    ASSERT_EQ(entries.size(), frames.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        EXPECT_EQ(entries[i].header.timestamp, frames[i].timestamp);
+        EXPECT_EQ(entries[i].frames_dropped, i == 5 ? 2u : 0u) << "frame " << i;
+    }
+
+    // Record headers do not carry the gap
+    std::vector<ArchiveEntry> scanned;
+    ASSERT_TRUE(scan_archive_headers(dir_, scanned));
+    EXPECT_EQ(scanned[5].frames_dropped, 0u);
+}
+
+TEST_F(TimelineArchiveTest, VersionOneIndexIsUpgradedOnAppend)
+{
+    // Headers-only index as written before gap counts existed
+    std::vector<uint8_t> bytes(ARCHIVE_INDEX_MAGIC_SIZE + 2 * FRAME_HEADER_SIZE);
+    std::memcpy(bytes.data(), "LWIRIDX1", ARCHIVE_INDEX_MAGIC_SIZE);
+    for (uint32_t i = 0; i < 2; ++i) {
+        CompressedFrame frame;
+        frame.width = 40;
+        frame.height = 32;
+        frame.frame_index = i;
+        frame.timestamp = i * 33333ull;
+        write_frame_header(frame, 100 + i, bytes.data() + ARCHIVE_INDEX_MAGIC_SIZE + i * FRAME_HEADER_SIZE,
+                           FRAME_HEADER_SIZE);
+    }
+    std::ofstream(index_path(), std::ios::binary).write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+
+    std::vector<ArchiveEntry> entries;
+    ASSERT_TRUE(read_archive_index(index_path(), entries));
+    ASSERT_EQ(entries.size(), 2u);
+    EXPECT_EQ(entries[1].payload_size, 101u);
+    EXPECT_EQ(entries[1].frames_dropped, 0u);
+
+    CompressedFrame next;
+    next.width = 40;
+    next.height = 32;
+    next.frame_index = 2;
+    next.timestamp = 5 * 33333ull;
+    next.compressed_data.assign(30, 0);
+    {
+        ArchiveIndexWriter writer;
+        ASSERT_TRUE(writer.append(index_path(), next, 3));
+    }
+
+    ASSERT_TRUE(read_archive_index(index_path(), entries));
+    ASSERT_EQ(entries.size(), 3u);
+    EXPECT_EQ(entries[0].payload_size, 100u);
+    EXPECT_EQ(entries[2].payload_size, 30u);
+    EXPECT_EQ(entries[2].frames_dropped, 3u);
+    EXPECT_EQ(entries[2].header.timestamp, 5 * 33333ull);
+}
+
+TEST_F(TimelineArchiveTest, PngTimestampsRoundTrip)
+{
+    const std::vector<Frame> frames = test::make_sequence(16, 8, 3, 52);
+    for (const Frame& frame : frames) {
+        ASSERT_TRUE(write_frame_png(frame, dir_ + "/jenoptik_00000" + std::to_string(frame.frame_index) + ".png"));
+    }
+
+    PngDirectorySource source;
+    ASSERT_TRUE(source.open(dir_));
+    ASSERT_EQ(source.frame_count(), frames.size());
+    for (size_t i = 0; i < frames.size(); ++i) {
+        Frame frame;
+        ASSERT_TRUE(source.read_frame(i, frame));
+        EXPECT_EQ(frame.timestamp, frames[i].timestamp);
+        EXPECT_TRUE(frame.data == frames[i].data);
+    }
+}
+
+} // anonymous namespace
+} // namespace lwir
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <stdlib.h>
+#include "batch.hpp"
+#include "config.hpp"
+#include "frame.hpp"
+#include "synthetic.hpp"
+
+namespace lwir {
+namespace test {
+
+/**
+ * @file test_util.hpp
+ * @brief Shared helpers for the test suite
+ */
+
+/**
+ * Small deterministic synthetic sequence (fast enough for unit tests)
+ */
+inline std::vector<Frame> make_sequence(uint32_t width, uint32_t height, uint32_t count,
+                                        uint64_t seed = 7, uint32_t ffc_period = 0)
+{
+    SyntheticConfig config;
+    config.width = width;
+    config.height = height;
+    config.frame_count = count;
+    config.seed = seed;
+    config.ffc_period = ffc_period;
+    config.velocity_x = 1.3;   // Enough motion for non-trivial residuals
+    config.velocity_y = 0.4;
+
+    const SyntheticSequence sequence(config);
+    std::vector<Frame> frames(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        sequence.generate(i, frames[i]);
+    }
+    return frames;
+}
+
+/**
+ * Lossless coding, GOP 5, no frame deadline (decoded output equals input)
+ */
+inline CompressionConfig lossless_config()
+{
+    CompressionConfig config;
+    config.gop_period = 5;
+    config.keyframe_near = 0;
+    config.residual_near = 0;
+    config.dead_zone_T = 0;
+    config.quant_Q = 1.0;
+    config.frame_deadline_ms = 0.0;
+    return config;
+}
+
+/**
+ * 64-bit FNV-1a hash
+ */
+inline uint64_t fnv1a64(const void* data, size_t size)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 0x100000001B3ull;
+    }
+    return hash;
+}
+
+/**
+ * Hash of 16-bit samples in little-endian byte order (platform independent)
+ */
+inline uint64_t hash_samples(const std::vector<uint16_t>& samples)
+{
+    std::vector<uint8_t> bytes(samples.size() * 2);
+    for (size_t i = 0; i < samples.size(); ++i) {
+        bytes[2 * i] = static_cast<uint8_t>(samples[i] & 0xFF);
+        bytes[2 * i + 1] = static_cast<uint8_t>(samples[i] >> 8);
+    }
+    return fnv1a64(bytes.data(), bytes.size());
+}
+
+/**
+ * Fixture with an empty directory of its own under /tmp (dir_), removed
+ * with everything in it after the test
+ */
+class TempDirTest : public ::testing::Test {
+protected:
+    std::string dir_;
+
+    void SetUp() override
+    {
+        char pattern[] = "/tmp/lwir_test_XXXXXX";
+        ASSERT_NE(::mkdtemp(pattern), nullptr);
+        dir_ = pattern;
+    }
+
+    void TearDown() override
+    {
+        EXPECT_TRUE(remove_directory_tree(dir_));
+    }
+};
+
+/**
+ * Small xorshift generator for kernel inputs
+ */
+class Rng {
+public:
+    explicit Rng(uint64_t seed) : state_(seed ? seed : 1) {}
+
+    uint64_t next()
+    {
+        state_ ^= state_ << 13;
+        state_ ^= state_ >> 7;
+        state_ ^= state_ << 17;
+        return state_;
+    }
+
+    uint32_t uniform(uint32_t bound) { return static_cast<uint32_t>(next() % bound); }
+
+private:
+    uint64_t state_;
+};
+
+} // namespace test
+} // namespace lwir
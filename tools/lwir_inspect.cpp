@@ -0,0 +1,787 @@
+/**
+ * @file lwir_inspect.cpp
+ * @brief Archive overview from record headers only
+ *
+ * Summarizes a directory of compressed frames without reading a single
+ * payload byte: frame count and missing indices, GOP layout, bytes per frame
+ * by type, NEAR/Q/T/fp_bits settings, range-map usage, timestamp gaps,
+ * frames the capture dropped (as recorded in the index) and the bitrate
+ * over time. The headers come from index.lwidx (one mapped
+ * file) when the index matches the records on disk, otherwise from the
+ * first FRAME_HEADER_SIZE bytes of every frame_*.lwir file. --rebuild-index
+ * writes a fresh index from the records (e.g. for archives written before
+ * the index existed). A segmented archive (segments.json) is read through
+ * its per-segment indexes, and its segments are listed.
+ *
+ * Usage:
+ *   lwir_inspect /data/flight_042
+ *   lwir_inspect /data/flight_042 --csv frames.csv --json summary.json
+ *   lwir_inspect /data/flight_042 --scan --rebuild-index
+ */
+
+#include "archive.hpp"
+#include "frame_format.hpp"
+#include "segment.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+struct InspectOptions {
+    std::string archive_dir;
+    bool scan = false;                  // Ignore the index, read record headers
+    bool rebuild_index = false;
+    double rate_hz = 0.0;               // Frame rate when timestamps are not recorded
+    double window_s = 1.0;              // Bitrate window
+    double gap_factor = 1.5;            // Gap: interval > factor x median interval
+    uint32_t max_listed = 10;           // Gaps / missing ranges / settings printed
+    std::string csv_path;
+    std::string json_path;
+};
+
+// Counts and sizes for one frame type
+struct TypeSummary {
+    uint32_t frames = 0;
+    uint64_t bytes = 0;                 // Whole records
+    uint32_t min_bytes = 0;
+    uint32_t max_bytes = 0;
+    double bpp_sum = 0.0;               // Payload bits per pixel
+    uint32_t range_mapped = 0;
+
+    void add(const lwir::ArchiveEntry& entry, double bpp)
+    {
+        const uint32_t size = static_cast<uint32_t>(entry.record_size());
+        min_bytes = (frames == 0) ? size : std::min(min_bytes, size);
+        max_bytes = std::max(max_bytes, size);
+        frames++;
+        bytes += size;
+        bpp_sum += bpp;
+        if (entry.header.use_range_map) {
+            range_mapped++;
+        }
+    }
+
+    double mean_bytes() const { return frames ? static_cast<double>(bytes) / frames : 0.0; }
+    double mean_bpp() const { return frames ? bpp_sum / frames : 0.0; }
+};
+
+// Coding parameters shared by a set of frames
+struct Setting {
+    bool is_keyframe;
+    uint32_t near;
+    double quant_Q;
+    uint32_t dead_zone_T;
+    uint32_t fp_bits;
+
+    bool operator<(const Setting& o) const
+    {
+        return std::tie(is_keyframe, near, quant_Q, dead_zone_T, fp_bits) <
+               std::tie(o.is_keyframe, o.near, o.quant_Q, o.dead_zone_T, o.fp_bits);
+    }
+};
+
+struct SettingUse {
+    uint32_t frames = 0;
+    uint32_t first_frame = 0;
+};
+
+// Interval between consecutive frames well above the usual period
+struct TimestampGap {
+    uint32_t after_frame;
+    double interval_ms;
+};
+
+// Frames the capture dropped before a frame, as recorded by the encoder
+struct DroppedRun {
+    uint32_t before_frame;
+    uint32_t frames;
+};
+
+struct MissingRange {
+    uint32_t first;
+    uint32_t count;
+};
+
+struct BitrateWindow {
+    double start_s;
+    double mbps;
+};
+
+struct InspectReport {
+    std::string source;                 // "index", "headers" or "segments"
+    double read_ms = 0.0;
+    size_t records_on_disk = 0;
+    std::vector<lwir::SegmentInfo> segments;
+
+    uint32_t frames = 0;
+    uint32_t first_index = 0;
+    uint32_t last_index = 0;
+    std::vector<MissingRange> missing;
+    uint32_t missing_frames = 0;
+
+    std::map<std::pair<uint32_t, uint32_t>, uint32_t> geometries;
+    TypeSummary keyframes;
+    TypeSummary residuals;
+    TypeSummary repeats;
+    uint64_t total_bytes = 0;
+    uint64_t raw_bytes = 0;             // 16-bit samples
+
+    std::map<uint32_t, uint32_t> gop_lengths;   // Length -> count (complete GOPs)
+    uint32_t open_gop = 0;                      // Frames after the last keyframe
+
+    std::map<Setting, SettingUse> settings;
+
+    bool has_timestamps = false;
+    double duration_s = 0.0;
+    double median_interval_ms = 0.0;
+    uint32_t non_monotonic = 0;
+    std::vector<TimestampGap> gaps;
+    std::vector<DroppedRun> dropped;
+    uint64_t dropped_frames = 0;
+
+    std::vector<BitrateWindow> bitrate;
+    double mean_mbps = 0.0;
+    double min_mbps = 0.0;
+    double max_mbps = 0.0;
+};
+
+void print_usage(const char* program_name)
+{
+    std::cout << "LWIR Archive Inspector" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Usage:" << std::endl;
+    std::cout << "  " << program_name << " <archive_dir> [options]" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --scan                 Read record headers even if index.lwidx exists" << std::endl;
+    std::cout << "  --rebuild-index        Rewrite index.lwidx from the record headers" << std::endl;
+    std::cout << "  --rate <Hz>            Frame rate for the bitrate when timestamps are not recorded" << std::endl;
+    std::cout << "  --window <s>           Bitrate window (default: 1)" << std::endl;
+    std::cout << "  --gap-factor <x>       Report intervals above x times the median (default: 1.5)" << std::endl;
+    std::cout << "  --list <N>             Gaps, missing ranges and settings printed (default: 10)" << std::endl;
+    std::cout << "  --csv <path>           Write one line per frame" << std::endl;
+    std::cout << "  --json <path>          Write the summary (and bitrate series) as JSON" << std::endl;
+    std::cout << "  --help                 Show this help message" << std::endl;
+    std::cout << std::endl;
+}
+
+bool parse_command_line(int argc, char** argv, InspectOptions& opts)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const bool has_value = (i + 1 < argc);
+
+        if (arg == "--help" || arg == "-h") {
+            return false;
+        }
+        else if (arg == "--scan") {
+            opts.scan = true;
+        }
+        else if (arg == "--rebuild-index") {
+            opts.rebuild_index = true;
+        }
+        else if (arg == "--rate" && has_value) {
+            opts.rate_hz = std::stod(argv[++i]);
+        }
+        else if (arg == "--window" && has_value) {
+            opts.window_s = std::stod(argv[++i]);
+        }
+        else if (arg == "--gap-factor" && has_value) {
+            opts.gap_factor = std::stod(argv[++i]);
+        }
+        else if (arg == "--list" && has_value) {
+            opts.max_listed = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--csv" && has_value) {
+            opts.csv_path = argv[++i];
+        }
+        else if (arg == "--json" && has_value) {
+            opts.json_path = argv[++i];
+        }
+        else if (!arg.empty() && arg[0] != '-' && opts.archive_dir.empty()) {
+            opts.archive_dir = arg;
+        }
+        else {
+            std::cerr << "Error: Unknown or incomplete argument: " << arg << std::endl;
+            return false;
+        }
+    }
+
+    if (opts.archive_dir.empty()) {
+        std::cerr << "Error: archive directory is required" << std::endl;
+        return false;
+    }
+    if (opts.window_s <= 0.0) {
+        std::cerr << "Error: --window must be > 0" << std::endl;
+        return false;
+    }
+    if (opts.gap_factor <= 1.0) {
+        std::cerr << "Error: --gap-factor must be > 1" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Dropped-frame counts exist only in the index: copy them onto scanned
+ * entries (both sorted by frame index)
+ */
+void carry_dropped_counts(const std::vector<lwir::ArchiveEntry>& indexed, std::vector<lwir::ArchiveEntry>& entries)
+{
+    size_t j = 0;
+    for (lwir::ArchiveEntry& entry : entries) {
+        while (j < indexed.size() && indexed[j].header.frame_index < entry.header.frame_index) {
+            j++;
+        }
+        if (j < indexed.size() && indexed[j].header.frame_index == entry.header.frame_index) {
+            entry.frames_dropped = indexed[j].frames_dropped;
+        }
+    }
+}
+
+/**
+ * Headers of every segment; of a frame written twice (resumed session) the
+ * later segment's copy wins
+ */
+bool load_segment_entries(const lwir::SegmentReader& reader, std::vector<lwir::ArchiveEntry>& entries)
+{
+    std::vector<lwir::ArchiveEntry> part;
+    for (size_t i = 0; i < reader.segments().size(); ++i) {
+        if (!reader.read_entries(i, part)) {
+            return false;
+        }
+        entries.insert(entries.end(), part.begin(), part.end());
+    }
+
+    std::stable_sort(entries.begin(), entries.end(), [](const lwir::ArchiveEntry& a, const lwir::ArchiveEntry& b) {
+        return a.header.frame_index < b.header.frame_index;
+    });
+    std::vector<lwir::ArchiveEntry> latest;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (i + 1 == entries.size() || entries[i + 1].header.frame_index != entries[i].header.frame_index) {
+            latest.push_back(entries[i]);
+        }
+    }
+    entries.swap(latest);
+    return true;
+}
+
+/**
+ * Headers from the index when it covers every record, else from the records
+ */
+bool load_entries(const InspectOptions& opts, std::vector<lwir::ArchiveEntry>& entries, InspectReport& report)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    lwir::SegmentReader segments;
+    if (segments.open(opts.archive_dir)) {
+        if (opts.rebuild_index) {
+            std::cerr << "Segmented archive: each segment keeps its own index, --rebuild-index ignored" << std::endl;
+        }
+        if (!load_segment_entries(segments, entries)) {
+            return false;
+        }
+        report.segments = segments.segments();
+        report.source = "segments";
+        report.read_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return true;
+    }
+
+    const std::string index_path = opts.archive_dir + "/" + lwir::ARCHIVE_INDEX_FILE;
+
+    report.records_on_disk = lwir::count_frame_records(opts.archive_dir);
+
+    bool loaded = false;
+    std::vector<lwir::ArchiveEntry> indexed;
+    const bool have_index = lwir::read_archive_index(index_path, indexed);
+    if (have_index && !opts.scan) {
+        if (indexed.size() == report.records_on_disk) {
+            entries.swap(indexed);
+            report.source = "index";
+            loaded = true;
+        }
+        else {
+            std::cerr << "Index lists " << indexed.size() << " frames but " << report.records_on_disk
+                      << " records are on disk; reading record headers" << std::endl;
+        }
+    }
+
+    if (!loaded) {
+        if (!lwir::scan_archive_headers(opts.archive_dir, entries)) {
+            return false;
+        }
+        carry_dropped_counts(indexed, entries);
+        report.source = "headers";
+    }
+
+    report.read_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    if (opts.rebuild_index) {
+        if (!lwir::write_archive_index(index_path, entries)) {
+            return false;
+        }
+        std::cout << "Index written to " << index_path << " (" << entries.size() << " frames)" << std::endl;
+    }
+    return true;
+}
+
+double payload_bpp(const lwir::ArchiveEntry& entry)
+{
+    const double pixels = static_cast<double>(entry.header.width) * entry.header.height;
+    return pixels > 0.0 ? entry.payload_size * 8.0 / pixels : 0.0;
+}
+
+double median(std::vector<double> values)
+{
+    if (values.empty()) {
+        return 0.0;
+    }
+    const size_t mid = values.size() / 2;
+    std::nth_element(values.begin(), values.begin() + mid, values.end());
+    return values[mid];
+}
+
+void analyze_timing(const InspectOptions& opts, const std::vector<lwir::ArchiveEntry>& entries,
+                    InspectReport& report)
+{
+    // Timestamps are microseconds; an archive without them records 0 throughout
+    report.has_timestamps = false;
+    for (size_t i = 1; i < entries.size(); ++i) {
+        if (entries[i].header.timestamp != entries[0].header.timestamp) {
+            report.has_timestamps = true;
+            break;
+        }
+    }
+
+    // Frame start times in seconds
+    std::vector<double> times(entries.size());
+    if (report.has_timestamps) {
+        std::vector<double> intervals;
+        intervals.reserve(entries.size());
+        for (size_t i = 0; i < entries.size(); ++i) {
+            times[i] = (entries[i].header.timestamp - static_cast<double>(entries[0].header.timestamp)) * 1e-6;
+            if (i == 0) {
+                continue;
+            }
+            if (entries[i].header.timestamp <= entries[i - 1].header.timestamp) {
+                report.non_monotonic++;
+            }
+            else {
+                intervals.push_back((entries[i].header.timestamp - entries[i - 1].header.timestamp) * 1e-3);
+            }
+        }
+        report.median_interval_ms = median(intervals);
+
+        const double limit_ms = opts.gap_factor * report.median_interval_ms;
+        for (size_t i = 1; i < entries.size(); ++i) {
+            if (entries[i].header.timestamp <= entries[i - 1].header.timestamp) {
+                continue;
+            }
+            const double interval_ms = (entries[i].header.timestamp - entries[i - 1].header.timestamp) * 1e-3;
+            if (interval_ms > limit_ms) {
+                report.gaps.push_back({entries[i - 1].header.frame_index, interval_ms});
+            }
+        }
+        report.duration_s = times.back() + report.median_interval_ms * 1e-3;
+    }
+    else if (opts.rate_hz > 0.0) {
+        for (size_t i = 0; i < entries.size(); ++i) {
+            times[i] = (entries[i].header.frame_index - static_cast<double>(entries[0].header.frame_index)) / opts.rate_hz;
+        }
+        report.duration_s = times.back() + 1.0 / opts.rate_hz;
+    }
+    else {
+        return;   // No time base: bytes per frame only
+    }
+
+    if (report.duration_s <= 0.0) {
+        return;
+    }
+
+    // Record bytes per window (out-of-order timestamps land in the first window)
+    const size_t windows = static_cast<size_t>(report.duration_s / opts.window_s) + 1;
+    std::vector<uint64_t> bytes(windows, 0);
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const size_t w = std::min(windows - 1, static_cast<size_t>(std::max(0.0, times[i]) / opts.window_s));
+        bytes[w] += entries[i].record_size();
+    }
+
+    for (size_t w = 0; w < windows; ++w) {
+        const double start_s = w * opts.window_s;
+        const double length_s = std::min(opts.window_s, report.duration_s - start_s);
+        if (length_s <= 0.0) {
+            continue;
+        }
+        report.bitrate.push_back({start_s, bytes[w] * 8.0 / length_s * 1e-6});
+    }
+
+    report.mean_mbps = report.total_bytes * 8.0 / report.duration_s * 1e-6;
+    report.min_mbps = report.bitrate.empty() ? 0.0 : report.bitrate[0].mbps;
+    report.max_mbps = report.min_mbps;
+    for (const BitrateWindow& window : report.bitrate) {
+        report.min_mbps = std::min(report.min_mbps, window.mbps);
+        report.max_mbps = std::max(report.max_mbps, window.mbps);
+    }
+}
+
+void analyze(const InspectOptions& opts, const std::vector<lwir::ArchiveEntry>& entries, InspectReport& report)
+{
+    report.frames = static_cast<uint32_t>(entries.size());
+    if (entries.empty()) {
+        return;
+    }
+    report.first_index = entries.front().header.frame_index;
+    report.last_index = entries.back().header.frame_index;
+
+    bool seen_keyframe = false;
+    uint32_t last_keyframe = 0;
+
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const lwir::ArchiveEntry& entry = entries[i];
+        const lwir::CompressedFrame& h = entry.header;
+
+        if (i > 0 && h.frame_index != entries[i - 1].header.frame_index + 1) {
+            const uint32_t first = entries[i - 1].header.frame_index + 1;
+            report.missing.push_back({first, h.frame_index - first});
+            report.missing_frames += h.frame_index - first;
+        }
+
+        if (entry.frames_dropped > 0) {
+            report.dropped.push_back({h.frame_index, entry.frames_dropped});
+            report.dropped_frames += entry.frames_dropped;
+        }
+
+        report.geometries[std::make_pair(h.width, h.height)]++;
+        report.total_bytes += entry.record_size();
+        report.raw_bytes += static_cast<uint64_t>(h.width) * h.height * 2;
+        TypeSummary& type = h.is_keyframe ? report.keyframes : h.is_repeat ? report.repeats : report.residuals;
+        type.add(entry, payload_bpp(entry));
+
+        if (h.is_keyframe) {
+            if (seen_keyframe) {
+                report.gop_lengths[h.frame_index - last_keyframe]++;
+            }
+            seen_keyframe = true;
+            last_keyframe = h.frame_index;
+        }
+
+        // Repeats carry no coding parameters, keyframes only NEAR and the range map
+        if (h.is_repeat) {
+            continue;
+        }
+        const Setting setting = {h.is_keyframe, h.near_lossless,
+                                 h.is_keyframe ? 0.0 : h.quant_Q,
+                                 h.is_keyframe ? 0u : h.dead_zone_T,
+                                 h.is_keyframe ? 0u : h.fp_bits};
+        SettingUse& use = report.settings[setting];
+        if (use.frames == 0) {
+            use.first_frame = h.frame_index;
+        }
+        use.frames++;
+    }
+    report.open_gop = seen_keyframe ? report.last_index - last_keyframe + 1 : report.frames;
+
+    analyze_timing(opts, entries, report);
+}
+
+void print_type(const char* name, const TypeSummary& type)
+{
+    std::cout << "  " << std::left << std::setw(10) << name << std::right
+              << std::setw(8) << type.frames << " frames";
+    if (type.frames > 0) {
+        std::cout << std::fixed << std::setprecision(0)
+                  << " | mean " << type.mean_bytes() << " B"
+                  << " (min " << type.min_bytes << ", max " << type.max_bytes << ")"
+                  << std::setprecision(3) << " | " << type.mean_bpp() << " bpp";
+        if (type.range_mapped > 0) {
+            std::cout << " | range-mapped " << type.range_mapped;
+        }
+    }
+    std::cout << std::endl;
+}
+
+void print_report(const InspectOptions& opts, const InspectReport& report)
+{
+    std::cout << "=== LWIR Archive: " << opts.archive_dir << " ===" << std::endl;
+    std::cout << "Read " << report.frames << " headers from "
+              << (report.source == "index" ? std::string(lwir::ARCHIVE_INDEX_FILE)
+                  : report.source == "segments" ? std::to_string(report.segments.size()) + " segments"
+                  : std::string("record files"))
+              << " in " << std::fixed << std::setprecision(1) << report.read_ms << " ms" << std::endl;
+    for (size_t i = 0; i < report.segments.size() && i < opts.max_listed; ++i) {
+        const lwir::SegmentInfo& segment = report.segments[i];
+        std::cout << "  " << lwir::segment_file_name(segment.sequence) << ": frames " << segment.first_frame
+                  << " - " << segment.last_frame << " (" << segment.keyframes << " keyframes, "
+                  << segment.bytes << " B), timestamps " << segment.first_timestamp << " - "
+                  << segment.last_timestamp << (segment.complete ? "" : ", open") << std::endl;
+    }
+    if (report.frames == 0) {
+        std::cout << "No frames" << std::endl;
+        return;
+    }
+
+    std::cout << "Frames: " << report.frames << " (" << report.first_index << " - " << report.last_index << ")";
+    if (report.missing_frames > 0) {
+        std::cout << ", " << report.missing_frames << " missing";
+    }
+    std::cout << std::endl;
+    for (size_t i = 0; i < report.missing.size() && i < opts.max_listed; ++i) {
+        std::cout << "  missing " << report.missing[i].first;
+        if (report.missing[i].count > 1) {
+            std::cout << " - " << report.missing[i].first + report.missing[i].count - 1;
+        }
+        std::cout << std::endl;
+    }
+
+    std::cout << "Geometry:";
+    for (const auto& geometry : report.geometries) {
+        std::cout << " " << geometry.first.first << "x" << geometry.first.second
+                  << " (" << geometry.second << ")";
+    }
+    std::cout << std::endl;
+
+    std::cout << "Size: " << report.total_bytes << " B, ratio " << std::setprecision(2)
+              << (report.total_bytes ? static_cast<double>(report.raw_bytes) / report.total_bytes : 0.0)
+              << "x vs 16-bit raw" << std::endl;
+    print_type("keyframe", report.keyframes);
+    print_type("residual", report.residuals);
+    if (report.repeats.frames > 0) {
+        print_type("repeat", report.repeats);
+    }
+
+    std::cout << "GOP lengths:";
+    if (report.gop_lengths.empty()) {
+        std::cout << " none complete";
+    }
+    for (const auto& gop : report.gop_lengths) {
+        std::cout << " " << gop.first << " x" << gop.second;
+    }
+    std::cout << " | open GOP " << report.open_gop << " frames" << std::endl;
+
+    std::cout << "Settings:" << std::endl;
+    size_t listed = 0;
+    for (const auto& setting : report.settings) {
+        if (listed++ == opts.max_listed) {
+            std::cout << "  ... " << report.settings.size() - opts.max_listed << " more" << std::endl;
+            break;
+        }
+        const Setting& s = setting.first;
+        std::cout << "  " << (s.is_keyframe ? "keyframe" : "residual") << " NEAR " << s.near;
+        if (!s.is_keyframe) {
+            std::cout << std::setprecision(2) << " Q " << s.quant_Q << " T " << s.dead_zone_T
+                      << " fp " << s.fp_bits;
+        }
+        std::cout << ": " << setting.second.frames << " frames from " << setting.second.first_frame << std::endl;
+    }
+
+    if (report.has_timestamps) {
+        std::cout << "Timestamps: " << std::setprecision(3) << report.duration_s << " s, median interval "
+                  << report.median_interval_ms << " ms, " << report.gaps.size() << " gaps";
+        if (report.non_monotonic > 0) {
+            std::cout << ", " << report.non_monotonic << " non-increasing";
+        }
+        std::cout << std::endl;
+        for (size_t i = 0; i < report.gaps.size() && i < opts.max_listed; ++i) {
+            std::cout << "  after frame " << report.gaps[i].after_frame << ": "
+                      << std::setprecision(1) << report.gaps[i].interval_ms << " ms" << std::endl;
+        }
+    }
+    else {
+        std::cout << "Timestamps: not recorded" << std::endl;
+    }
+
+    if (!report.dropped.empty()) {
+        std::cout << "Dropped by capture: " << report.dropped_frames << " frames in "
+                  << report.dropped.size() << " gaps" << std::endl;
+        for (size_t i = 0; i < report.dropped.size() && i < opts.max_listed; ++i) {
+            std::cout << "  before frame " << report.dropped[i].before_frame << ": "
+                      << report.dropped[i].frames << std::endl;
+        }
+    }
+
+    if (!report.bitrate.empty()) {
+        std::cout << "Bitrate (" << std::setprecision(1) << opts.window_s << " s windows"
+                  << (report.has_timestamps ? "" : ", from --rate") << "): "
+                  << std::setprecision(3) << "mean " << report.mean_mbps << " Mbit/s, min "
+                  << report.min_mbps << ", max " << report.max_mbps << std::endl;
+    }
+}
+
+bool write_csv(const std::string& path, const std::vector<lwir::ArchiveEntry>& entries)
+{
+    std::ofstream ofs(path);
+    if (!ofs) {
+        std::cerr << "Failed to write " << path << std::endl;
+        return false;
+    }
+
+    ofs << "frame_index,type,timestamp_us,record_bytes,payload_bytes,bpp,width,height,"
+           "near,quant_Q,dead_zone_T,fp_bits,range_map,range_min,range_max,frames_dropped\n";
+    ofs << std::fixed;
+    for (const lwir::ArchiveEntry& entry : entries) {
+        const lwir::CompressedFrame& h = entry.header;
+        ofs << h.frame_index << ","
+            << (h.is_keyframe ? "keyframe" : h.is_repeat ? "repeat" : "residual") << ","
+            << h.timestamp << ","
+            << entry.record_size() << ","
+            << entry.payload_size << ","
+            << std::setprecision(4) << payload_bpp(entry) << ","
+            << h.width << "," << h.height << ","
+            << h.near_lossless << ","
+            << std::setprecision(3) << h.quant_Q << ","
+            << h.dead_zone_T << ","
+            << h.fp_bits << ","
+            << (h.use_range_map ? 1 : 0) << ","
+            << h.range_min << ","
+            << h.range_max << ","
+            << entry.frames_dropped << "\n";
+    }
+
+    std::cout << "Per-frame log written to " << path << std::endl;
+    return true;
+}
+
+void write_type_json(std::ofstream& ofs, const TypeSummary& type)
+{
+    ofs << "{\"frames\": " << type.frames
+        << ", \"bytes\": " << type.bytes
+        << ", \"mean_bytes\": " << type.mean_bytes()
+        << ", \"min_bytes\": " << type.min_bytes
+        << ", \"max_bytes\": " << type.max_bytes
+        << ", \"mean_bpp\": " << type.mean_bpp()
+        << ", \"range_mapped\": " << type.range_mapped << "}";
+}
+
+bool write_json(const std::string& path, const InspectOptions& opts, const InspectReport& report)
+{
+    std::ofstream ofs(path);
+    if (!ofs) {
+        std::cerr << "Failed to write " << path << std::endl;
+        return false;
+    }
+
+    ofs << std::fixed << std::setprecision(3);
+    ofs << "{\n";
+    ofs << "  \"archive\": \"" << opts.archive_dir << "\",\n";
+    ofs << "  \"source\": \"" << report.source << "\",\n";
+    ofs << "  \"read_ms\": " << report.read_ms << ",\n";
+    ofs << "  \"segments\": " << report.segments.size() << ",\n";
+    ofs << "  \"frames\": " << report.frames << ",\n";
+    ofs << "  \"first_index\": " << report.first_index << ",\n";
+    ofs << "  \"last_index\": " << report.last_index << ",\n";
+    ofs << "  \"missing_frames\": " << report.missing_frames << ",\n";
+    ofs << "  \"missing_ranges\": [";
+    for (size_t i = 0; i < report.missing.size(); ++i) {
+        ofs << (i ? ", " : "") << "{\"first\": " << report.missing[i].first
+            << ", \"count\": " << report.missing[i].count << "}";
+    }
+    ofs << "],\n";
+    ofs << "  \"geometries\": [";
+    size_t n = 0;
+    for (const auto& geometry : report.geometries) {
+        ofs << (n++ ? ", " : "") << "{\"width\": " << geometry.first.first
+            << ", \"height\": " << geometry.first.second << ", \"frames\": " << geometry.second << "}";
+    }
+    ofs << "],\n";
+    ofs << "  \"total_bytes\": " << report.total_bytes << ",\n";
+    ofs << "  \"compression_ratio\": "
+        << (report.total_bytes ? static_cast<double>(report.raw_bytes) / report.total_bytes : 0.0) << ",\n";
+    ofs << "  \"keyframes\": ";
+    write_type_json(ofs, report.keyframes);
+    ofs << ",\n";
+    ofs << "  \"residuals\": ";
+    write_type_json(ofs, report.residuals);
+    ofs << ",\n";
+    ofs << "  \"repeats\": ";
+    write_type_json(ofs, report.repeats);
+    ofs << ",\n";
+    ofs << "  \"gop_lengths\": [";
+    n = 0;
+    for (const auto& gop : report.gop_lengths) {
+        ofs << (n++ ? ", " : "") << "{\"length\": " << gop.first << ", \"count\": " << gop.second << "}";
+    }
+    ofs << "],\n";
+    ofs << "  \"open_gop_frames\": " << report.open_gop << ",\n";
+    ofs << "  \"settings\": [";
+    n = 0;
+    for (const auto& setting : report.settings) {
+        const Setting& s = setting.first;
+        ofs << (n++ ? ",\n    " : "\n    ")
+            << "{\"type\": \"" << (s.is_keyframe ? "keyframe" : "residual") << "\""
+            << ", \"near\": " << s.near;
+        if (!s.is_keyframe) {
+            ofs << ", \"quant_Q\": " << s.quant_Q << ", \"dead_zone_T\": " << s.dead_zone_T
+                << ", \"fp_bits\": " << s.fp_bits;
+        }
+        ofs << ", \"frames\": " << setting.second.frames
+            << ", \"first_frame\": " << setting.second.first_frame << "}";
+    }
+    ofs << (report.settings.empty() ? "],\n" : "\n  ],\n");
+    ofs << "  \"timestamps\": {\"recorded\": " << (report.has_timestamps ? "true" : "false")
+        << ", \"duration_s\": " << report.duration_s
+        << ", \"median_interval_ms\": " << report.median_interval_ms
+        << ", \"non_increasing\": " << report.non_monotonic
+        << ", \"gaps\": [";
+    for (size_t i = 0; i < report.gaps.size(); ++i) {
+        ofs << (i ? ", " : "") << "{\"after_frame\": " << report.gaps[i].after_frame
+            << ", \"interval_ms\": " << report.gaps[i].interval_ms << "}";
+    }
+    ofs << "]},\n";
+    ofs << "  \"dropped_frames\": " << report.dropped_frames << ",\n";
+    ofs << "  \"dropped_runs\": [";
+    for (size_t i = 0; i < report.dropped.size(); ++i) {
+        ofs << (i ? ", " : "") << "{\"before_frame\": " << report.dropped[i].before_frame
+            << ", \"frames\": " << report.dropped[i].frames << "}";
+    }
+    ofs << "],\n";
+    ofs << "  \"bitrate\": {\"window_s\": " << opts.window_s
+        << ", \"mean_mbps\": " << report.mean_mbps
+        << ", \"min_mbps\": " << report.min_mbps
+        << ", \"max_mbps\": " << report.max_mbps
+        << ", \"series_mbps\": [";
+    for (size_t i = 0; i < report.bitrate.size(); ++i) {
+        ofs << (i ? ", " : "") << report.bitrate[i].mbps;
+    }
+    ofs << "]}\n";
+    ofs << "}\n";
+
+    std::cout << "Summary written to " << path << std::endl;
+    return true;
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+    InspectOptions opts;
+    if (!parse_command_line(argc, argv, opts)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    std::vector<lwir::ArchiveEntry> entries;
+    InspectReport report;
+    if (!load_entries(opts, entries, report)) {
+        return 1;
+    }
+
+    analyze(opts, entries, report);
+    print_report(opts, report);
+
+    if (!opts.csv_path.empty() && !write_csv(opts.csv_path, entries)) {
+        return 1;
+    }
+    if (!opts.json_path.empty() && !write_json(opts.json_path, opts, report)) {
+        return 1;
+    }
+    return report.frames > 0 ? 0 : 1;
+}
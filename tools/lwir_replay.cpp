@@ -0,0 +1,648 @@
+/**
+ * @file lwir_replay.cpp
+ * @brief Real-time camera replay harness
+ *
+ * Feeds a corpus into the live CompressionPipeline at camera rate instead of
+ * as fast as possible. A producer thread plays the camera: it releases one
+ * frame per period (optionally with timing jitter and bursts, where several
+ * frames are delivered back to back after a stall), stamps its arrival time
+ * and hands it to a bounded capture queue. When the queue is full the frame
+ * is dropped, as a camera driver with no free buffer would. The pipeline
+ * thread drains the queue, and every frame is timed from arrival until its
+ * output file is durable (fsync'd, unless --no-sync).
+ *
+ * The report gives the arrival-to-durable latency distribution, deadline
+ * misses, queue high-water mark and drop count. The exit code is non-zero
+ * when the configuration is not flight-safe: any drop beyond --max-drops or
+ * a latency percentile above --max-latency-ms.
+ *
+ * Usage:
+ *   lwir_replay --synthetic 300 --size 640x512 --output /data/replay
+ *   lwir_replay --input frames/ --config flight.yaml --output out/ \
+ *       --rate 30 --jitter 2 --burst-every 90 --burst-size 4 --json replay.json
+ */
+
+#include "pipeline.hpp"
+#include "config.hpp"
+#include "frame_source.hpp"
+#include "synthetic.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+namespace {
+
+using Clock = lwir::DeadlineMonitor::Clock;
+
+struct ReplayOptions {
+    // Corpus
+    std::string input_dir;              // Empty = synthetic
+    uint32_t frames = 300;
+    uint32_t width = 640;
+    uint32_t height = 512;
+    uint64_t seed = 1;
+    uint32_t loops = 1;
+
+    // Pipeline configuration
+    std::string config_path;
+    std::string profile;
+    std::string output_dir;
+    bool dry_run = false;
+    bool sync_writes = true;
+    bool verbose = false;
+
+    // Camera model
+    double rate_hz = 30.0;
+    double jitter_ms = 0.0;             // Uniform +/- jitter on each release
+    uint32_t burst_every = 0;           // 0 = no bursts
+    uint32_t burst_size = 4;
+    uint32_t queue_capacity = 4;        // Capture buffers
+
+    // Flight-safety limits
+    double max_latency_ms = -1.0;       // < 0: frame_deadline_ms from config
+    double percentile = 99.0;
+    uint32_t max_drops = 0;
+
+    // Reports
+    std::string json_path;
+    std::string csv_path;
+};
+
+// One frame as seen by the camera model
+struct FrameRecord {
+    uint32_t sequence;
+    bool dropped;
+    double arrival_ms;        // Since replay start
+    double latency_ms;        // Arrival to durable write
+    uint32_t queue_depth;     // Frames waiting behind it when processing started
+};
+
+struct CaptureItem {
+    lwir::Frame frame;
+    Clock::time_point arrival;
+};
+
+/**
+ * Bounded capture queue shared by the camera and pipeline threads
+ */
+class CaptureQueue {
+public:
+    explicit CaptureQueue(size_t capacity) : capacity_(capacity), closed_(false) {}
+
+    // Returns false (frame dropped) when every buffer is in use
+    bool try_push(CaptureItem&& item)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (queue_.size() >= capacity_) {
+                return false;
+            }
+            queue_.push_back(std::move(item));
+        }
+        cv_.notify_one();
+        return true;
+    }
+
+    // Returns false once the queue is closed and empty
+    bool pop(CaptureItem& item, uint32_t& depth_behind)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return closed_ || !queue_.empty(); });
+        if (queue_.empty()) {
+            return false;
+        }
+        item = std::move(queue_.front());
+        queue_.pop_front();
+        depth_behind = static_cast<uint32_t>(queue_.size());
+        return true;
+    }
+
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        cv_.notify_all();
+    }
+
+private:
+    size_t capacity_;
+    bool closed_;
+    std::deque<CaptureItem> queue_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+};
+
+void print_usage(const char* program_name)
+{
+    std::cout << "LWIR Real-Time Replay Harness" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Usage:" << std::endl;
+    std::cout << "  " << program_name << " --output <dir> [options]" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Corpus:" << std::endl;
+    std::cout << "  --input <dir>          PNG directory (default: synthetic)" << std::endl;
+    std::cout << "  --frames <N>           Frames to load into memory (default: 300)" << std::endl;
+    std::cout << "  --size <WxH>           Synthetic frame size (default: 640x512)" << std::endl;
+    std::cout << "  --seed <N>             Synthetic and jitter seed (default: 1)" << std::endl;
+    std::cout << "  --loops <N>            Replay the corpus N times (default: 1)" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Pipeline:" << std::endl;
+    std::cout << "  --config <path>        Configuration file (YAML)" << std::endl;
+    std::cout << "  --profile <name>       Profile within the configuration" << std::endl;
+    std::cout << "  --output <dir>         Output directory for compressed frames" << std::endl;
+    std::cout << "  --no-sync              Do not fsync frames (latency to page cache)" << std::endl;
+    std::cout << "  --dry-run              Encode without writing (latency to encode end)" << std::endl;
+    std::cout << "  --verbose              Per-frame pipeline output" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Camera model:" << std::endl;
+    std::cout << "  --rate <Hz>            Frame rate (default: 30)" << std::endl;
+    std::cout << "  --jitter <ms>          Uniform +/- release jitter (default: 0)" << std::endl;
+    std::cout << "  --burst-every <N>      Deliver a burst every N frames (default: off)" << std::endl;
+    std::cout << "  --burst-size <N>       Frames per burst, released back to back (default: 4)" << std::endl;
+    std::cout << "  --queue <N>            Capture buffers; frames are dropped when full (default: 4)" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Flight-safety limits:" << std::endl;
+    std::cout << "  --max-latency-ms <ms>  Latency limit (default: frame_deadline_ms, else period)" << std::endl;
+    std::cout << "  --percentile <p>       Percentile checked against the limit (default: 99)" << std::endl;
+    std::cout << "  --max-drops <N>        Dropped frames allowed (default: 0)" << std::endl;
+    std::cout << std::endl;
+    std::cout << "  --json <path>          Write report as JSON" << std::endl;
+    std::cout << "  --csv <path>           Write per-frame arrival/latency log" << std::endl;
+    std::cout << "  --help                 Show this help message" << std::endl;
+    std::cout << std::endl;
+}
+
+bool parse_command_line(int argc, char** argv, ReplayOptions& opts)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const bool has_value = (i + 1 < argc);
+
+        if (arg == "--help" || arg == "-h") {
+            return false;
+        }
+        else if (arg == "--input" && has_value) {
+            opts.input_dir = argv[++i];
+        }
+        else if ((arg == "--frames" || arg == "--synthetic") && has_value) {
+            opts.frames = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--size" && has_value) {
+            const std::string size = argv[++i];
+            const size_t x = size.find('x');
+            if (x == std::string::npos) {
+                std::cerr << "Error: --size expects WxH" << std::endl;
+                return false;
+            }
+            opts.width = static_cast<uint32_t>(std::stoul(size.substr(0, x)));
+            opts.height = static_cast<uint32_t>(std::stoul(size.substr(x + 1)));
+        }
+        else if (arg == "--seed" && has_value) {
+            opts.seed = std::stoull(argv[++i]);
+        }
+        else if (arg == "--loops" && has_value) {
+            opts.loops = std::max(1u, static_cast<uint32_t>(std::stoul(argv[++i])));
+        }
+        else if (arg == "--config" && has_value) {
+            opts.config_path = argv[++i];
+        }
+        else if (arg == "--profile" && has_value) {
+            opts.profile = argv[++i];
+        }
+        else if (arg == "--output" && has_value) {
+            opts.output_dir = argv[++i];
+        }
+        else if (arg == "--no-sync") {
+            opts.sync_writes = false;
+        }
+        else if (arg == "--dry-run") {
+            opts.dry_run = true;
+        }
+        else if (arg == "--verbose") {
+            opts.verbose = true;
+        }
+        else if (arg == "--rate" && has_value) {
+            opts.rate_hz = std::stod(argv[++i]);
+        }
+        else if (arg == "--jitter" && has_value) {
+            opts.jitter_ms = std::stod(argv[++i]);
+        }
+        else if (arg == "--burst-every" && has_value) {
+            opts.burst_every = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--burst-size" && has_value) {
+            opts.burst_size = std::max(1u, static_cast<uint32_t>(std::stoul(argv[++i])));
+        }
+        else if (arg == "--queue" && has_value) {
+            opts.queue_capacity = std::max(1u, static_cast<uint32_t>(std::stoul(argv[++i])));
+        }
+        else if (arg == "--max-latency-ms" && has_value) {
+            opts.max_latency_ms = std::stod(argv[++i]);
+        }
+        else if (arg == "--percentile" && has_value) {
+            opts.percentile = std::stod(argv[++i]);
+        }
+        else if (arg == "--max-drops" && has_value) {
+            opts.max_drops = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--json" && has_value) {
+            opts.json_path = argv[++i];
+        }
+        else if (arg == "--csv" && has_value) {
+            opts.csv_path = argv[++i];
+        }
+        else {
+            std::cerr << "Error: Unknown or incomplete argument: " << arg << std::endl;
+            return false;
+        }
+    }
+
+    if (opts.output_dir.empty() && !opts.dry_run) {
+        std::cerr << "Error: --output is required (or --dry-run)" << std::endl;
+        return false;
+    }
+    if (opts.rate_hz <= 0.0) {
+        std::cerr << "Error: --rate must be > 0" << std::endl;
+        return false;
+    }
+    if (opts.jitter_ms < 0.0) {
+        std::cerr << "Error: --jitter must be >= 0" << std::endl;
+        return false;
+    }
+    if (opts.percentile <= 0.0 || opts.percentile > 100.0) {
+        std::cerr << "Error: --percentile must be in (0, 100]" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool make_directory(const std::string& path)
+{
+    struct stat st;
+    if (stat(path.c_str(), &st) == 0) {
+        return true;
+    }
+    if (mkdir(path.c_str(), 0755) != 0) {
+        std::cerr << "Failed to create output directory: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Decode the corpus into memory once so replay timing excludes PNG decoding
+ */
+bool load_corpus(const ReplayOptions& opts, std::vector<lwir::Frame>& corpus, std::string& description)
+{
+    if (opts.input_dir.empty()) {
+        lwir::SyntheticConfig synth;
+        synth.width = opts.width;
+        synth.height = opts.height;
+        synth.frame_count = opts.frames;
+        synth.seed = opts.seed;
+        synth.frame_period_us = 1e6 / opts.rate_hz;
+
+        lwir::SyntheticFrameSource source(synth);
+        description = source.description();
+        corpus.resize(source.frame_count());
+        for (size_t i = 0; i < corpus.size(); ++i) {
+            source.read_frame(i, corpus[i]);
+        }
+        return !corpus.empty();
+    }
+
+    lwir::PngDirectorySource source;
+    if (!source.open(opts.input_dir)) {
+        return false;
+    }
+    description = source.description();
+
+    const size_t count = std::min<size_t>(opts.frames, source.frame_count());
+    corpus.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        if (!source.read_frame(i, corpus[i])) {
+            std::cerr << "Failed to load corpus frame " << i << std::endl;
+            return false;
+        }
+    }
+    return !corpus.empty();
+}
+
+/**
+ * Nominal release time of every frame (ms since start), jitter and bursts
+ * applied. A burst holds back burst_size frames and releases them together
+ * at the time of the last one, so the average rate is unchanged.
+ */
+std::vector<double> build_schedule(const ReplayOptions& opts, uint32_t total)
+{
+    const double period_ms = 1000.0 / opts.rate_hz;
+    std::mt19937_64 rng(opts.seed);
+    std::uniform_real_distribution<double> jitter(-opts.jitter_ms, opts.jitter_ms);
+
+    std::vector<double> release(total);
+    for (uint32_t k = 0; k < total; ++k) {
+        release[k] = k * period_ms + (opts.jitter_ms > 0.0 ? jitter(rng) : 0.0);
+    }
+
+    if (opts.burst_every > 0 && opts.burst_size > 1) {
+        for (uint32_t start = opts.burst_every; start < total; start += opts.burst_every) {
+            const uint32_t end = std::min(total, start + opts.burst_size);
+            for (uint32_t k = start; k < end; ++k) {
+                release[k] = release[end - 1];
+            }
+        }
+    }
+
+    // The camera never delivers out of order
+    for (uint32_t k = 1; k < total; ++k) {
+        release[k] = std::max(release[k], release[k - 1]);
+    }
+    if (total > 0 && release[0] < 0.0) {
+        const double shift = -release[0];
+        for (double& t : release) {
+            t += shift;
+        }
+    }
+    return release;
+}
+
+double percentile(std::vector<double> values, double p)
+{
+    if (values.empty()) {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    const size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * values.size()));
+    return values[std::min(values.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
+
+struct ReplayReport {
+    std::string corpus;
+    uint32_t emitted;
+    uint32_t encoded;
+    uint32_t dropped;
+    uint32_t max_queue_depth;
+    uint32_t deadline_misses;
+    double elapsed_s;
+    double limit_ms;
+    double latency_at_percentile;
+    std::vector<double> latencies;
+    std::vector<uint32_t> dropped_frames;
+    bool safe;
+};
+
+bool write_csv(const std::string& path, const std::vector<FrameRecord>& records)
+{
+    std::ofstream ofs(path);
+    if (!ofs) {
+        std::cerr << "Failed to write " << path << std::endl;
+        return false;
+    }
+    ofs << "frame,arrival_ms,dropped,queue_depth,latency_ms\n";
+    ofs << std::fixed << std::setprecision(3);
+    for (const FrameRecord& r : records) {
+        ofs << r.sequence << "," << r.arrival_ms << "," << (r.dropped ? 1 : 0) << ",";
+        if (r.dropped) {
+            ofs << ",\n";
+        } else {
+            ofs << r.queue_depth << "," << r.latency_ms << "\n";
+        }
+    }
+    return true;
+}
+
+bool write_json(const std::string& path, const ReplayOptions& opts, const ReplayReport& report)
+{
+    std::ofstream ofs(path);
+    if (!ofs) {
+        std::cerr << "Failed to write " << path << std::endl;
+        return false;
+    }
+
+    const std::vector<double>& lat = report.latencies;
+    double mean = 0.0;
+    for (double v : lat) {
+        mean += v;
+    }
+    mean = lat.empty() ? 0.0 : mean / lat.size();
+
+    // 1 ms bins up to twice the limit, last bin is overflow
+    const uint32_t bins = static_cast<uint32_t>(std::max(1.0, std::ceil(2.0 * report.limit_ms))) + 1;
+    std::vector<uint32_t> histogram(bins, 0);
+    for (double v : lat) {
+        histogram[std::min<size_t>(bins - 1, static_cast<size_t>(std::max(0.0, v)))]++;
+    }
+
+    ofs << std::fixed << std::setprecision(3);
+    ofs << "{\n";
+    ofs << "  \"corpus\": \"" << report.corpus << "\",\n";
+    ofs << "  \"camera\": {\"rate_hz\": " << opts.rate_hz
+        << ", \"jitter_ms\": " << opts.jitter_ms
+        << ", \"burst_every\": " << opts.burst_every
+        << ", \"burst_size\": " << opts.burst_size
+        << ", \"queue_capacity\": " << opts.queue_capacity << "},\n";
+    ofs << "  \"durable_writes\": " << (opts.sync_writes && !opts.dry_run ? "true" : "false") << ",\n";
+    ofs << "  \"elapsed_s\": " << report.elapsed_s << ",\n";
+    ofs << "  \"frames_emitted\": " << report.emitted << ",\n";
+    ofs << "  \"frames_encoded\": " << report.encoded << ",\n";
+    ofs << "  \"frames_dropped\": " << report.dropped << ",\n";
+    ofs << "  \"dropped_frames\": [";
+    for (size_t i = 0; i < report.dropped_frames.size(); ++i) {
+        ofs << (i ? ", " : "") << report.dropped_frames[i];
+    }
+    ofs << "],\n";
+    ofs << "  \"max_queue_depth\": " << report.max_queue_depth << ",\n";
+    ofs << "  \"deadline_misses\": " << report.deadline_misses << ",\n";
+    ofs << "  \"latency_ms\": {"
+        << "\"min\": " << percentile(lat, 0.0) << ", "
+        << "\"mean\": " << mean << ", "
+        << "\"p50\": " << percentile(lat, 50.0) << ", "
+        << "\"p90\": " << percentile(lat, 90.0) << ", "
+        << "\"p99\": " << percentile(lat, 99.0) << ", "
+        << "\"p99_9\": " << percentile(lat, 99.9) << ", "
+        << "\"max\": " << percentile(lat, 100.0) << "},\n";
+    ofs << "  \"latency_histogram\": {\"bin_ms\": 1, \"counts\": [";
+    for (size_t i = 0; i < histogram.size(); ++i) {
+        ofs << (i ? ", " : "") << histogram[i];
+    }
+    ofs << "]},\n";
+    ofs << "  \"limits\": {\"max_latency_ms\": " << report.limit_ms
+        << ", \"percentile\": " << opts.percentile
+        << ", \"max_drops\": " << opts.max_drops << "},\n";
+    ofs << "  \"latency_at_percentile_ms\": " << report.latency_at_percentile << ",\n";
+    ofs << "  \"flight_safe\": " << (report.safe ? "true" : "false") << "\n";
+    ofs << "}\n";
+
+    std::cout << "Report written to " << path << std::endl;
+    return true;
+}
+
+void print_report(const ReplayOptions& opts, const ReplayReport& report)
+{
+    const std::vector<double>& lat = report.latencies;
+
+    std::cout << std::endl;
+    std::cout << "=== Replay Summary ===" << std::endl;
+    std::cout << "Frames: emitted " << report.emitted << ", encoded " << report.encoded
+              << ", dropped " << report.dropped << std::fixed << std::setprecision(2)
+              << " (" << (report.emitted ? 100.0 * report.dropped / report.emitted : 0.0) << "%)"
+              << " in " << report.elapsed_s << " s" << std::endl;
+    std::cout << "Latency ms (arrival to " << (opts.dry_run ? "encoded" : (opts.sync_writes ? "durable" : "written"))
+              << "): min " << percentile(lat, 0.0)
+              << " | p50 " << percentile(lat, 50.0)
+              << " | p90 " << percentile(lat, 90.0)
+              << " | p99 " << percentile(lat, 99.0)
+              << " | p99.9 " << percentile(lat, 99.9)
+              << " | max " << percentile(lat, 100.0) << std::endl;
+    std::cout << "Deadline misses: " << report.deadline_misses
+              << " | max queue depth " << report.max_queue_depth << "/" << opts.queue_capacity << std::endl;
+
+    std::cout << "Verdict: " << (report.safe ? "FLIGHT-SAFE" : "NOT FLIGHT-SAFE")
+              << " (p" << std::setprecision(1) << opts.percentile << " " << std::setprecision(2)
+              << report.latency_at_percentile << " ms vs limit " << report.limit_ms << " ms, "
+              << report.dropped << " drop(s) vs limit " << opts.max_drops << ")" << std::endl;
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+    ReplayOptions opts;
+    if (!parse_command_line(argc, argv, opts)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    lwir::CompressionConfig config;
+    if (!opts.config_path.empty() && !config.load_from_yaml(opts.config_path, opts.profile)) {
+        std::cerr << "Failed to load configuration from " << opts.config_path << std::endl;
+        return 1;
+    }
+    config.output_dir = opts.output_dir;
+    config.dry_run = opts.dry_run;
+    config.sync_writes = opts.sync_writes;
+    config.verbose = opts.verbose;
+
+    if (!opts.dry_run && !make_directory(opts.output_dir)) {
+        return 1;
+    }
+
+    std::vector<lwir::Frame> corpus;
+    ReplayReport report = {};
+    if (!load_corpus(opts, corpus, report.corpus)) {
+        return 1;
+    }
+
+    const double period_ms = 1000.0 / opts.rate_hz;
+    report.limit_ms = opts.max_latency_ms >= 0.0 ? opts.max_latency_ms
+                    : (config.frame_deadline_ms > 0.0 ? config.frame_deadline_ms : period_ms);
+
+    const uint32_t total = static_cast<uint32_t>(corpus.size()) * opts.loops;
+    const std::vector<double> schedule = build_schedule(opts, total);
+
+    std::cout << "=== LWIR Real-Time Replay ===" << std::endl;
+    std::cout << "Corpus: " << report.corpus << " x" << opts.loops << " (" << total << " frames)" << std::endl;
+    std::cout << "Camera: " << opts.rate_hz << " Hz, jitter +/-" << opts.jitter_ms << " ms";
+    if (opts.burst_every > 0) {
+        std::cout << ", burst of " << opts.burst_size << " every " << opts.burst_every << " frames";
+    }
+    std::cout << ", " << opts.queue_capacity << " capture buffers" << std::endl;
+    std::cout << "Writes: " << (opts.dry_run ? "none (dry run)" : (opts.sync_writes ? "durable (fsync)" : "page cache"))
+              << std::endl;
+
+    lwir::CompressionPipeline pipeline(config);
+    CaptureQueue queue(opts.queue_capacity);
+    std::vector<FrameRecord> records(total);
+
+    const Clock::time_point start = Clock::now();
+
+    // Camera: release frames on schedule, drop when no buffer is free
+    std::thread camera([&]() {
+        for (uint32_t k = 0; k < total; ++k) {
+            CaptureItem item;
+            item.frame = corpus[k % corpus.size()];
+            item.frame.frame_index = k;
+            item.frame.timestamp = static_cast<uint64_t>(schedule[k] * 1000.0 + 0.5);
+
+            std::this_thread::sleep_until(
+                start + std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double, std::milli>(schedule[k])));
+
+            item.arrival = Clock::now();
+            FrameRecord& r = records[k];
+            r.sequence = k;
+            r.arrival_ms = std::chrono::duration<double, std::milli>(item.arrival - start).count();
+            r.dropped = !queue.try_push(std::move(item));
+        }
+        queue.close();
+    });
+
+    // Pipeline: drain the capture queue
+    bool ok = true;
+    CaptureItem item;
+    uint32_t depth_behind = 0;
+    while (queue.pop(item, depth_behind)) {
+        if (!ok) {
+            continue;  // Keep draining so the camera thread can finish
+        }
+        if (!pipeline.process_frame(item.frame, item.arrival, depth_behind)) {
+            ok = false;
+            continue;
+        }
+        FrameRecord& r = records[item.frame.frame_index];
+        r.latency_ms = pipeline.deadline_monitor().last_latency_ms();
+        r.queue_depth = depth_behind;
+        report.max_queue_depth = std::max(report.max_queue_depth, depth_behind + 1);
+    }
+    camera.join();
+
+    report.elapsed_s = std::chrono::duration<double>(Clock::now() - start).count();
+
+    if (!ok) {
+        std::cerr << "Replay aborted: pipeline error" << std::endl;
+        return 1;
+    }
+    if (!pipeline.finish()) {
+        return 1;
+    }
+
+    report.emitted = total;
+    for (const FrameRecord& r : records) {
+        if (r.dropped) {
+            report.dropped_frames.push_back(r.sequence);
+        } else {
+            report.latencies.push_back(r.latency_ms);
+        }
+    }
+    report.dropped = static_cast<uint32_t>(report.dropped_frames.size());
+    report.encoded = static_cast<uint32_t>(report.latencies.size());
+    report.deadline_misses = pipeline.deadline_monitor().misses();
+    report.latency_at_percentile = percentile(report.latencies, opts.percentile);
+    report.safe = report.dropped <= opts.max_drops && report.latency_at_percentile <= report.limit_ms;
+
+    print_report(opts, report);
+
+    if (!opts.csv_path.empty() && !write_csv(opts.csv_path, records)) {
+        return 1;
+    }
+    if (!opts.json_path.empty() && !write_json(opts.json_path, opts, report)) {
+        return 1;
+    }
+
+    return report.safe ? 0 : 1;
+}
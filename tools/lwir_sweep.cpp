@@ -0,0 +1,618 @@
+/**
+ * @file lwir_sweep.cpp
+ * @brief Parallel parameter sweep with Pareto-frontier report
+ *
+ * Evaluates every combination of quant_Q, dead_zone_T, residual_near,
+ * gop_period (and optionally 12-bit mode) on a worker pool over a sampled
+ * subset of the input. The input is decoded once and shared read-only by
+ * all workers. Each combination is scored by compressed bytes, RMSE, max
+ * error and encode fps; the non-dominated set is reported as CSV and the
+ * smallest frontier point that meets the quality/speed limits is written
+ * as a ready-to-use YAML configuration.
+ *
+ * The input is sampled as evenly spaced contiguous clips, so the temporal
+ * residual path sees real frame-to-frame motion; each clip starts with a
+ * keyframe.
+ *
+ * Usage:
+ *   lwir_sweep --input frames/ --output sweep/ --q 1.5:3.0:0.5 --t 1,2,4 --near 0,5,10 --gop 30,60,120
+ *   lwir_sweep --synthetic 600 --output sweep/ --max-rmse 3 --min-fps 30
+ */
+
+#include "pipeline.hpp"
+#include "config.hpp"
+#include "frame_source.hpp"
+#include "synthetic.hpp"
+#include "worker_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+namespace {
+
+struct SweepOptions {
+    // Corpus
+    std::string input_dir;              // Empty = synthetic
+    uint32_t synthetic_frames = 600;
+    uint32_t width = 640;
+    uint32_t height = 512;
+    uint32_t clips = 3;
+    uint32_t clip_length = 120;
+
+    // Base configuration (non-swept parameters)
+    std::string config_path;
+    std::string profile;
+
+    // Parameter ranges
+    std::vector<double> quant_Q = {1.5, 2.0, 3.0};
+    std::vector<double> dead_zone_T = {1, 2, 4};
+    std::vector<double> residual_near = {0, 5, 10};
+    std::vector<double> gop_period = {30, 60, 120};
+    std::vector<double> map12 = {1};
+
+    // Recommendation limits
+    double max_rmse = -1.0;             // < 0 = no limit
+    double max_error = -1.0;
+    double min_fps = 30.0;
+
+    uint32_t jobs = 0;                  // 0 = hardware concurrency
+    std::string output_dir;
+};
+
+struct SweepPoint {
+    double quant_Q;
+    uint32_t dead_zone_T;
+    uint32_t residual_near;
+    uint32_t gop_period;
+    bool map12;
+
+    bool ok;
+    uint32_t frames;
+    uint64_t original_bytes;
+    uint64_t compressed_bytes;
+    double rmse;
+    double max_error;
+    double encode_fps;
+    bool pareto;
+};
+
+void print_usage(const char* program_name)
+{
+    std::cout << "LWIR Parameter Sweep" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Usage:" << std::endl;
+    std::cout << "  " << program_name << " --output <dir> [--input <dir> | --synthetic <N>] [options]" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Corpus:" << std::endl;
+    std::cout << "  --input <dir>          PNG directory (default: synthetic)" << std::endl;
+    std::cout << "  --synthetic <N>        Synthetic sequence length (default: 600)" << std::endl;
+    std::cout << "  --size <WxH>           Synthetic frame size (default: 640x512)" << std::endl;
+    std::cout << "  --clips <N>            Evenly spaced clips to sample (default: 3)" << std::endl;
+    std::cout << "  --clip-length <N>      Frames per clip (default: 120)" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Parameters (list a,b,c or range start:stop:step):" << std::endl;
+    std::cout << "  --config <path>        Base configuration for non-swept parameters" << std::endl;
+    std::cout << "  --profile <name>       Profile within the base configuration" << std::endl;
+    std::cout << "  --q <range>            quant_Q (default: 1.5,2,3)" << std::endl;
+    std::cout << "  --t <range>            dead_zone_T (default: 1,2,4)" << std::endl;
+    std::cout << "  --near <range>         residual_near (default: 0,5,10)" << std::endl;
+    std::cout << "  --gop <range>          gop_period (default: 30,60,120)" << std::endl;
+    std::cout << "  --12bit <range>        enable_12bit_mode 0/1 (default: 1)" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Recommendation:" << std::endl;
+    std::cout << "  --max-rmse <DN>        Highest acceptable RMSE (default: none)" << std::endl;
+    std::cout << "  --max-error <DN>       Highest acceptable max error (default: none)" << std::endl;
+    std::cout << "  --min-fps <fps>        Lowest acceptable encode rate (default: 30)" << std::endl;
+    std::cout << std::endl;
+    std::cout << "  --jobs <N>             Worker threads (default: all cores)" << std::endl;
+    std::cout << "  --output <dir>         Output directory for CSV and YAML" << std::endl;
+    std::cout << "  --help                 Show this help message" << std::endl;
+    std::cout << std::endl;
+}
+
+/**
+ * Parse "a,b,c" or "start:stop:step" (inclusive)
+ */
+bool parse_range(const std::string& text, std::vector<double>& values)
+{
+    values.clear();
+
+    if (text.find(':') != std::string::npos) {
+        double start = 0.0, stop = 0.0, step = 0.0;
+        char c1 = 0, c2 = 0;
+        std::istringstream iss(text);
+        if (!(iss >> start >> c1 >> stop >> c2 >> step) || c1 != ':' || c2 != ':' || step <= 0.0) {
+            return false;
+        }
+        for (double v = start; v <= stop + step * 1e-6; v += step) {
+            values.push_back(v);
+        }
+        return !values.empty();
+    }
+
+    std::istringstream iss(text);
+    std::string item;
+    while (std::getline(iss, item, ',')) {
+        std::istringstream item_stream(item);
+        double value;
+        if (!(item_stream >> value)) {
+            return false;
+        }
+        values.push_back(value);
+    }
+    return !values.empty();
+}
+
+bool parse_command_line(int argc, char** argv, SweepOptions& opts)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const bool has_value = (i + 1 < argc);
+        bool range_ok = true;
+
+        if (arg == "--help" || arg == "-h") {
+            return false;
+        }
+        else if (arg == "--input" && has_value) {
+            opts.input_dir = argv[++i];
+        }
+        else if (arg == "--synthetic" && has_value) {
+            opts.synthetic_frames = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--size" && has_value) {
+            const std::string size = argv[++i];
+            const size_t x = size.find('x');
+            if (x == std::string::npos) {
+                std::cerr << "Error: --size expects WxH" << std::endl;
+                return false;
+            }
+            opts.width = static_cast<uint32_t>(std::stoul(size.substr(0, x)));
+            opts.height = static_cast<uint32_t>(std::stoul(size.substr(x + 1)));
+        }
+        else if (arg == "--clips" && has_value) {
+            opts.clips = std::max(1u, static_cast<uint32_t>(std::stoul(argv[++i])));
+        }
+        else if (arg == "--clip-length" && has_value) {
+            opts.clip_length = std::max(1u, static_cast<uint32_t>(std::stoul(argv[++i])));
+        }
+        else if (arg == "--config" && has_value) {
+            opts.config_path = argv[++i];
+        }
+        else if (arg == "--profile" && has_value) {
+            opts.profile = argv[++i];
+        }
+        else if (arg == "--q" && has_value) {
+            range_ok = parse_range(argv[++i], opts.quant_Q);
+        }
+        else if (arg == "--t" && has_value) {
+            range_ok = parse_range(argv[++i], opts.dead_zone_T);
+        }
+        else if (arg == "--near" && has_value) {
+            range_ok = parse_range(argv[++i], opts.residual_near);
+        }
+        else if (arg == "--gop" && has_value) {
+            range_ok = parse_range(argv[++i], opts.gop_period);
+        }
+        else if (arg == "--12bit" && has_value) {
+            range_ok = parse_range(argv[++i], opts.map12);
+        }
+        else if (arg == "--max-rmse" && has_value) {
+            opts.max_rmse = std::stod(argv[++i]);
+        }
+        else if (arg == "--max-error" && has_value) {
+            opts.max_error = std::stod(argv[++i]);
+        }
+        else if (arg == "--min-fps" && has_value) {
+            opts.min_fps = std::stod(argv[++i]);
+        }
+        else if (arg == "--jobs" && has_value) {
+            opts.jobs = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--output" && has_value) {
+            opts.output_dir = argv[++i];
+        }
+        else {
+            std::cerr << "Error: Unknown or incomplete argument: " << arg << std::endl;
+            return false;
+        }
+
+        if (!range_ok) {
+            std::cerr << "Error: " << arg << " expects a,b,c or start:stop:step" << std::endl;
+            return false;
+        }
+    }
+
+    if (opts.output_dir.empty()) {
+        std::cerr << "Error: --output is required" << std::endl;
+        return false;
+    }
+    for (double q : opts.quant_Q) {
+        if (q <= 0.0) {
+            std::cerr << "Error: --q values must be > 0" << std::endl;
+            return false;
+        }
+    }
+    for (double gop : opts.gop_period) {
+        if (gop < 1.0) {
+            std::cerr << "Error: --gop values must be >= 1" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Decode the sampled clips once; workers only read them
+ */
+bool load_clips(const SweepOptions& opts, std::vector<std::vector<lwir::Frame>>& clips,
+                std::string& description)
+{
+    lwir::PngDirectorySource png_source;
+    std::unique_ptr<lwir::SyntheticFrameSource> synth_source;
+    lwir::FrameSource* source = nullptr;
+
+    if (opts.input_dir.empty()) {
+        lwir::SyntheticConfig synth;
+        synth.width = opts.width;
+        synth.height = opts.height;
+        synth.frame_count = opts.synthetic_frames;
+        synth_source.reset(new lwir::SyntheticFrameSource(synth));
+        source = synth_source.get();
+    }
+    else {
+        if (!png_source.open(opts.input_dir)) {
+            return false;
+        }
+        source = &png_source;
+    }
+    description = source->description();
+
+    // Clips that would cover everything collapse into the whole sequence
+    const size_t total = source->frame_count();
+    size_t clip_count = opts.clips;
+    size_t clip_len = std::min<size_t>(opts.clip_length, total);
+    if (clip_count * clip_len >= total) {
+        clip_count = 1;
+        clip_len = total;
+    }
+
+    clips.assign(clip_count, std::vector<lwir::Frame>());
+    for (size_t c = 0; c < clip_count; ++c) {
+        const size_t start = (clip_count > 1) ? c * (total - clip_len) / (clip_count - 1) : 0;
+        clips[c].resize(clip_len);
+        for (size_t i = 0; i < clip_len; ++i) {
+            if (!source->read_frame(start + i, clips[c][i])) {
+                std::cerr << "Failed to load frame " << (start + i) << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void evaluate_point(const lwir::CompressionConfig& base,
+                    const std::vector<std::vector<lwir::Frame>>& clips,
+                    SweepPoint& point)
+{
+    lwir::CompressionConfig config = base;
+    config.quant_Q = point.quant_Q;
+    config.dead_zone_T = point.dead_zone_T;
+    config.residual_near = point.residual_near;
+    config.gop_period = point.gop_period;
+    config.enable_12bit_mode = point.map12;
+    config.frame_deadline_ms = 0.0;
+    config.enable_perf_counters = false;
+    config.compute_error_stats = true;
+    config.verbose = false;
+    config.dry_run = true;
+
+    double rmse_weighted = 0.0;
+    double encode_ms = 0.0;
+    point.ok = true;
+
+    for (const std::vector<lwir::Frame>& clip : clips) {
+        lwir::MemoryFrameSource source(clip);
+        lwir::CompressionPipeline pipeline(config);
+        if (!pipeline.run(source)) {
+            point.ok = false;
+            return;
+        }
+
+        const lwir::SessionStats& stats = pipeline.session_stats();
+        point.frames += stats.total_frames;
+        point.original_bytes += stats.total_original_bytes;
+        point.compressed_bytes += stats.total_compressed_bytes;
+        rmse_weighted += stats.avg_rmse * stats.total_frames;
+        encode_ms += stats.avg_encode_time_ms * stats.total_frames;
+        point.max_error = std::max(point.max_error, stats.peak_max_error);
+    }
+
+    point.rmse = point.frames > 0 ? rmse_weighted / point.frames : 0.0;
+    point.encode_fps = encode_ms > 0.0 ? 1000.0 * point.frames / encode_ms : 0.0;
+}
+
+/**
+ * a dominates b: no worse on every objective and better on at least one
+ */
+bool dominates(const SweepPoint& a, const SweepPoint& b)
+{
+    const bool no_worse = a.compressed_bytes <= b.compressed_bytes &&
+                          a.rmse <= b.rmse &&
+                          a.max_error <= b.max_error &&
+                          a.encode_fps >= b.encode_fps;
+    const bool better = a.compressed_bytes < b.compressed_bytes ||
+                        a.rmse < b.rmse ||
+                        a.max_error < b.max_error ||
+                        a.encode_fps > b.encode_fps;
+    return no_worse && better;
+}
+
+void mark_pareto(std::vector<SweepPoint>& points)
+{
+    for (SweepPoint& p : points) {
+        p.pareto = p.ok;
+        for (const SweepPoint& q : points) {
+            if (p.pareto && q.ok && dominates(q, p)) {
+                p.pareto = false;
+            }
+        }
+    }
+}
+
+/**
+ * Smallest frontier point within the limits; falls back to the smallest
+ * frontier point if none qualifies
+ * @return Index into points, or -1 if there are no valid points
+ */
+int recommend(const SweepOptions& opts, const std::vector<SweepPoint>& points, bool& within_limits)
+{
+    int best = -1;
+    int fallback = -1;
+    for (size_t i = 0; i < points.size(); ++i) {
+        const SweepPoint& p = points[i];
+        if (!p.pareto) {
+            continue;
+        }
+        if (fallback < 0 || p.compressed_bytes < points[fallback].compressed_bytes) {
+            fallback = static_cast<int>(i);
+        }
+
+        const bool ok = (opts.max_rmse < 0.0 || p.rmse <= opts.max_rmse) &&
+                        (opts.max_error < 0.0 || p.max_error <= opts.max_error) &&
+                        p.encode_fps >= opts.min_fps;
+        if (ok && (best < 0 || p.compressed_bytes < points[best].compressed_bytes)) {
+            best = static_cast<int>(i);
+        }
+    }
+
+    within_limits = (best >= 0);
+    return within_limits ? best : fallback;
+}
+
+void write_csv_row(std::ostream& os, const SweepPoint& p)
+{
+    const double ratio = p.compressed_bytes > 0
+        ? static_cast<double>(p.original_bytes) / p.compressed_bytes : 0.0;
+    os << std::fixed
+       << std::setprecision(3) << p.quant_Q << ","
+       << p.dead_zone_T << ","
+       << p.residual_near << ","
+       << p.gop_period << ","
+       << (p.map12 ? 1 : 0) << ","
+       << p.frames << ","
+       << p.compressed_bytes << ","
+       << std::setprecision(3) << ratio << ","
+       << std::setprecision(4) << p.rmse << ","
+       << std::setprecision(1) << p.max_error << ","
+       << std::setprecision(1) << p.encode_fps << ","
+       << (p.pareto ? 1 : 0) << "\n";
+}
+
+bool write_csv(const std::string& path, const std::vector<SweepPoint>& points, bool pareto_only)
+{
+    std::ofstream ofs(path);
+    if (!ofs) {
+        std::cerr << "Failed to write " << path << std::endl;
+        return false;
+    }
+
+    ofs << "quant_Q,dead_zone_T,residual_near,gop_period,enable_12bit_mode,"
+           "frames,compressed_bytes,compression_ratio,rmse,max_error,encode_fps,pareto\n";
+
+    std::vector<const SweepPoint*> rows;
+    for (const SweepPoint& p : points) {
+        if (p.ok && (!pareto_only || p.pareto)) {
+            rows.push_back(&p);
+        }
+    }
+    std::sort(rows.begin(), rows.end(), [](const SweepPoint* a, const SweepPoint* b) {
+        return a->compressed_bytes < b->compressed_bytes;
+    });
+    for (const SweepPoint* p : rows) {
+        write_csv_row(ofs, *p);
+    }
+    return true;
+}
+
+std::string limit_text(double limit)
+{
+    if (limit < 0.0) {
+        return "none";
+    }
+    std::ostringstream oss;
+    oss << limit;
+    return oss.str();
+}
+
+bool write_recommended_yaml(const std::string& path, const lwir::CompressionConfig& base,
+                            const SweepOptions& opts, const SweepPoint& p, bool within_limits)
+{
+    std::ofstream ofs(path);
+    if (!ofs) {
+        std::cerr << "Failed to write " << path << std::endl;
+        return false;
+    }
+
+    ofs << "# Recommended by lwir_sweep: smallest Pareto-optimal point";
+    if (within_limits) {
+        ofs << " within limits";
+    } else {
+        ofs << " (no point met the limits)";
+    }
+    ofs << "\n";
+    ofs << "# Limits: max_rmse=" << limit_text(opts.max_rmse)
+        << " max_error=" << limit_text(opts.max_error)
+        << " min_fps=" << opts.min_fps << "\n";
+    ofs << std::fixed << std::setprecision(4)
+        << "# Sweep result: rmse=" << p.rmse << " max_error=" << std::setprecision(1) << p.max_error
+        << " encode_fps=" << p.encode_fps << " compressed_bytes=" << p.compressed_bytes
+        << " over " << p.frames << " frames\n";
+    ofs << "\n";
+    ofs << "input_dir: \"" << base.input_dir << "\"\n";
+    ofs << "output_dir: \"" << base.output_dir << "\"\n";
+    ofs << "\n";
+    ofs << "gop_period: " << p.gop_period << "\n";
+    ofs << "keyframe_near: " << base.keyframe_near << "\n";
+    ofs << "residual_near: " << p.residual_near << "\n";
+    ofs << "dead_zone_T: " << p.dead_zone_T << "\n";
+    ofs << std::setprecision(3) << "quant_Q: " << p.quant_Q << "\n";
+    ofs << "fp_bits: " << base.fp_bits << "\n";
+    ofs << "enable_12bit_mode: " << (p.map12 ? "true" : "false") << "\n";
+    return true;
+}
+
+bool make_directory(const std::string& path)
+{
+    struct stat st;
+    if (stat(path.c_str(), &st) == 0) {
+        return true;
+    }
+    if (mkdir(path.c_str(), 0755) != 0) {
+        std::cerr << "Failed to create output directory: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+    SweepOptions opts;
+    if (!parse_command_line(argc, argv, opts)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    // Non-swept parameters come from the base configuration
+    lwir::CompressionConfig base;
+    if (!opts.config_path.empty() && !base.load_from_yaml(opts.config_path, opts.profile)) {
+        std::cerr << "Failed to load base configuration from " << opts.config_path << std::endl;
+        return 1;
+    }
+    if (base.input_dir.empty()) {
+        base.input_dir = opts.input_dir.empty() ? "frames" : opts.input_dir;
+    }
+    if (base.output_dir.empty()) {
+        base.output_dir = "compressed";
+    }
+
+    if (!make_directory(opts.output_dir)) {
+        return 1;
+    }
+
+    std::vector<std::vector<lwir::Frame>> clips;
+    std::string description;
+    if (!load_clips(opts, clips, description)) {
+        return 1;
+    }
+
+    std::vector<SweepPoint> points;
+    for (double q : opts.quant_Q)
+    for (double t : opts.dead_zone_T)
+    for (double near : opts.residual_near)
+    for (double gop : opts.gop_period)
+    for (double map12 : opts.map12) {
+        SweepPoint p = {};
+        p.quant_Q = q;
+        p.dead_zone_T = static_cast<uint32_t>(std::lround(t));
+        p.residual_near = static_cast<uint32_t>(std::lround(near));
+        p.gop_period = static_cast<uint32_t>(std::lround(gop));
+        p.map12 = (map12 != 0.0);
+        points.push_back(p);
+    }
+
+    lwir::WorkerPool pool(opts.jobs);
+
+    std::cout << "=== LWIR Parameter Sweep ===" << std::endl;
+    std::cout << "Corpus: " << description << ", " << clips.size() << " clip(s) of "
+              << clips[0].size() << " frames" << std::endl;
+    std::cout << "Combinations: " << points.size() << " on " << pool.size() << " workers" << std::endl;
+    std::cout << std::endl;
+
+    std::atomic<size_t> completed(0);
+    std::mutex print_mutex;
+    for (SweepPoint& p : points) {
+        SweepPoint* point = &p;
+        pool.submit([&, point]() {
+            evaluate_point(base, clips, *point);
+            const size_t done = ++completed;
+            std::lock_guard<std::mutex> lock(print_mutex);
+            std::cout << "  [" << done << "/" << points.size() << "] "
+                      << "Q=" << point->quant_Q << " T=" << point->dead_zone_T
+                      << " NEAR=" << point->residual_near << " GOP=" << point->gop_period
+                      << (point->ok ? "" : "  FAILED") << std::endl;
+        });
+    }
+    pool.wait();
+
+    mark_pareto(points);
+
+    const std::string all_csv = opts.output_dir + "/sweep_results.csv";
+    const std::string pareto_csv = opts.output_dir + "/pareto_frontier.csv";
+    if (!write_csv(all_csv, points, false) || !write_csv(pareto_csv, points, true)) {
+        return 1;
+    }
+
+    bool within_limits = false;
+    const int best = recommend(opts, points, within_limits);
+    if (best < 0) {
+        std::cerr << "No combination completed successfully" << std::endl;
+        return 1;
+    }
+
+    const std::string yaml_path = opts.output_dir + "/recommended.yaml";
+    if (!write_recommended_yaml(yaml_path, base, opts, points[best], within_limits)) {
+        return 1;
+    }
+
+    size_t frontier = 0;
+    for (const SweepPoint& p : points) {
+        frontier += p.pareto ? 1 : 0;
+    }
+
+    const SweepPoint& r = points[best];
+    std::cout << std::endl;
+    std::cout << "Pareto frontier: " << frontier << " of " << points.size() << " combinations" << std::endl;
+    std::cout << "Recommended: Q=" << r.quant_Q << " T=" << r.dead_zone_T
+              << " NEAR=" << r.residual_near << " GOP=" << r.gop_period
+              << std::fixed << std::setprecision(3) << " | rmse " << r.rmse
+              << std::setprecision(1) << " | max error " << r.max_error
+              << " | " << r.encode_fps << " fps | " << r.compressed_bytes << " bytes" << std::endl;
+    if (!within_limits) {
+        std::cout << "Warning: no frontier point met the limits; recommending the smallest" << std::endl;
+    }
+    std::cout << "Results: " << all_csv << ", " << pareto_csv << ", " << yaml_path << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,243 @@
+/**
+ * @file lwir_synth.cpp
+ * @brief Command-line generator for synthetic LWIR sequences
+ *
+ * Writes a deterministic thermal-like sequence as 16-bit PNG frames named
+ * like flight captures (jenoptik_NNNNNN.png) so they can be fed directly to
+ * lwir_compress, as headerless raw little-endian frames, as MIPI packed
+ * RAW12/RAW14 dumps (the top 12 / 14 bits of each sample), or as one
+ * multi-page TIFF stack (jenoptik_stack.tif).
+ *
+ * Usage:
+ *   lwir_synth --output frames/ --frames 600 --size 640x512 --seed 7
+ *   lwir_synth --output raw/ --format raw --ffc-period 300
+ *   lwir_synth --output packed/ --format raw12
+ *   lwir_synth --output stack/ --format tiff-deflate
+ */
+
+#include "synthetic.hpp"
+#include "packed.hpp"
+#include "tiff_stack.hpp"
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+namespace {
+
+void print_usage(const char* program_name)
+{
+    std::cout << "LWIR Synthetic Sequence Generator" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Usage:" << std::endl;
+    std::cout << "  " << program_name << " --output <dir> [options]" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --output <dir>         Output directory" << std::endl;
+    std::cout << "  --frames <N>           Number of frames (default: 300)" << std::endl;
+    std::cout << "  --size <WxH>           Frame size (default: 640x512)" << std::endl;
+    std::cout << "  --seed <N>             Random seed (default: 1)" << std::endl;
+    std::cout << "  --format <name>        png, raw (16-bit LE), raw12, raw14, tiff or tiff-deflate" << std::endl;
+    std::cout << "                         (default: png)" << std::endl;
+    std::cout << "  --noise <DN>           Temporal noise sigma (default: 10)" << std::endl;
+    std::cout << "  --fpn <DN>             Fixed-pattern noise sigma (default: 15)" << std::endl;
+    std::cout << "  --velocity <vx,vy>     Translation in pixels/frame (default: 0.6,0.15)" << std::endl;
+    std::cout << "  --rotation <deg>       Rotation in degrees/frame (default: 0.01)" << std::endl;
+    std::cout << "  --drift <DN>           Global drift per frame (default: 0.3)" << std::endl;
+    std::cout << "  --ffc-period <N>       Frames between FFC events, 0 = none (default: 900)" << std::endl;
+    std::cout << "  --dead-pixels <N>      Number of dead pixels (default: 12)" << std::endl;
+    std::cout << "  --help                 Show this help message" << std::endl;
+    std::cout << std::endl;
+}
+
+bool parse_command_line(int argc, char** argv, lwir::SyntheticConfig& config,
+                        std::string& output_dir, std::string& format)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const bool has_value = (i + 1 < argc);
+
+        if (arg == "--help" || arg == "-h") {
+            return false;
+        }
+        else if (arg == "--output" && has_value) {
+            output_dir = argv[++i];
+        }
+        else if (arg == "--frames" && has_value) {
+            config.frame_count = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--size" && has_value) {
+            const std::string size = argv[++i];
+            const size_t x = size.find('x');
+            if (x == std::string::npos) {
+                std::cerr << "Error: --size expects WxH" << std::endl;
+                return false;
+            }
+            config.width = static_cast<uint32_t>(std::stoul(size.substr(0, x)));
+            config.height = static_cast<uint32_t>(std::stoul(size.substr(x + 1)));
+        }
+        else if (arg == "--seed" && has_value) {
+            config.seed = std::stoull(argv[++i]);
+        }
+        else if (arg == "--format" && has_value) {
+            format = argv[++i];
+        }
+        else if (arg == "--noise" && has_value) {
+            config.temporal_noise_dn = std::stod(argv[++i]);
+        }
+        else if (arg == "--fpn" && has_value) {
+            config.fpn_dn = std::stod(argv[++i]);
+        }
+        else if (arg == "--velocity" && has_value) {
+            const std::string v = argv[++i];
+            const size_t comma = v.find(',');
+            if (comma == std::string::npos) {
+                std::cerr << "Error: --velocity expects vx,vy" << std::endl;
+                return false;
+            }
+            config.velocity_x = std::stod(v.substr(0, comma));
+            config.velocity_y = std::stod(v.substr(comma + 1));
+        }
+        else if (arg == "--rotation" && has_value) {
+            config.rotation_deg_per_frame = std::stod(argv[++i]);
+        }
+        else if (arg == "--drift" && has_value) {
+            config.drift_dn_per_frame = std::stod(argv[++i]);
+        }
+        else if (arg == "--ffc-period" && has_value) {
+            config.ffc_period = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--dead-pixels" && has_value) {
+            config.dead_pixels = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else {
+            std::cerr << "Error: Unknown or incomplete argument: " << arg << std::endl;
+            return false;
+        }
+    }
+
+    if (output_dir.empty()) {
+        std::cerr << "Error: --output is required" << std::endl;
+        return false;
+    }
+    lwir::PackedFormat packed;
+    if (format != "png" && format != "raw" && format != "tiff" && format != "tiff-deflate" &&
+        !lwir::parse_packed_format(format, packed))
+    {
+        std::cerr << "Error: --format must be png, raw, raw12, raw14, tiff or tiff-deflate" << std::endl;
+        return false;
+    }
+    if (lwir::parse_packed_format(format, packed) &&
+        lwir::packed_frame_bytes(packed, config.width, config.height) == 0)
+    {
+        std::cerr << "Error: " << format << " width must be a multiple of "
+                  << lwir::packed_group_pixels(packed) << std::endl;
+        return false;
+    }
+    if (config.width == 0 || config.height == 0) {
+        std::cerr << "Error: frame size must be non-zero" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Packed dump of the top bits of each sample, as a 12/14-bit core sends them
+ */
+bool write_frame_packed(const lwir::Frame& frame, lwir::PackedFormat format, const std::string& path)
+{
+    const uint32_t shift = (format == lwir::PackedFormat::RAW12) ? 4 : 2;
+    std::vector<uint16_t> samples(frame.data.size());
+    for (size_t i = 0; i < samples.size(); ++i) {
+        samples[i] = static_cast<uint16_t>(frame.data[i] >> shift);
+    }
+
+    std::vector<uint8_t> bytes(lwir::packed_frame_bytes(format, frame.width, frame.height));
+    lwir::pack_pixels(format, samples.data(), bytes.data(), samples.size());
+
+    std::ofstream ofs(path, std::ios::binary);
+    if (!ofs) {
+        std::cerr << "Failed to open raw file for writing: " << path << std::endl;
+        return false;
+    }
+    ofs.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    return static_cast<bool>(ofs);
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+    lwir::SyntheticConfig config;
+    std::string output_dir;
+    std::string format = "png";
+
+    if (!parse_command_line(argc, argv, config, output_dir, format)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    struct stat st;
+    if (stat(output_dir.c_str(), &st) != 0 && mkdir(output_dir.c_str(), 0755) != 0) {
+        std::cerr << "Failed to create output directory: " << output_dir << std::endl;
+        return 1;
+    }
+
+    std::cout << "Generating " << config.frame_count << " frames "
+              << config.width << "x" << config.height
+              << " (seed " << config.seed << ", " << format << ") into " << output_dir << std::endl;
+
+    const lwir::SyntheticSequence sequence(config);
+    lwir::Frame frame;
+
+    // TIFF: every frame is a page of one stack
+    const bool tiff = (format == "tiff" || format == "tiff-deflate");
+    lwir::TiffStackWriter stack;
+    if (tiff && !stack.open(output_dir + "/jenoptik_stack.tif",
+                            format == "tiff" ? lwir::TiffCompression::NONE : lwir::TiffCompression::DEFLATE,
+                            16))
+    {
+        return 1;
+    }
+
+    for (uint32_t i = 0; i < sequence.frame_count(); ++i) {
+        sequence.generate(i, frame);
+
+        std::ostringstream filename;
+        filename << output_dir << "/jenoptik_" << std::setw(6) << std::setfill('0') << i
+                 << (format == "png" ? ".png" : ".raw");
+
+        lwir::PackedFormat packed;
+        bool ok = false;
+        if (tiff) {
+            ok = stack.append(frame);
+        }
+        else if (format == "png") {
+            ok = lwir::write_frame_png(frame, filename.str());
+        }
+        else if (lwir::parse_packed_format(format, packed)) {
+            ok = write_frame_packed(frame, packed, filename.str());
+        }
+        else {
+            ok = lwir::write_frame_raw(frame, filename.str());
+        }
+        if (!ok) {
+            return 1;
+        }
+
+        if ((i + 1) % 100 == 0 || i + 1 == sequence.frame_count()) {
+            std::cout << "  " << (i + 1) << "/" << sequence.frame_count() << std::endl;
+        }
+    }
+
+    if (tiff && !stack.close()) {
+        std::cerr << "Failed to write TIFF stack" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}